@@ -99,16 +99,26 @@ struct OverlayState {
 /// Avoids re-reading MINC files from disk during QC row switches.
 class VolumeCache {
 public:
-    explicit VolumeCache(size_t maxEntries = 8) : maxEntries_(maxEntries) {}
+    /// Default memory budget for the voxel data of cached volumes.
+    static constexpr size_t kDefaultMaxBytes = size_t(2) << 30;   // 2 GiB
+
+    explicit VolumeCache(size_t maxEntries = 64, size_t maxBytes = kDefaultMaxBytes)
+        : maxEntries_(maxEntries), maxBytes_(maxBytes) {}
 
     /// Try to retrieve a cached volume.  On hit, moves the entry to the
-    /// front of the LRU list and returns a copy.  On miss, returns nullptr
-    /// wrapped in std::optional (empty optional).
+    /// front of the LRU list, copies it into @p out and returns true.
+    /// The copy is made under the lock, so a background thread filling the
+    /// cache cannot evict the entry while it is read.
+    /// Thread-safe: acquires internal mutex.
+    bool get(const std::string& path, Volume& out);
+
+    /// True if @p path is cached.  Does not change the LRU order.
     /// Thread-safe: acquires internal mutex.
-    Volume* get(const std::string& path);
+    bool contains(const std::string& path) const;
 
-    /// Insert a volume into the cache, evicting the least-recently-used
-    /// entry if capacity is exceeded.  The Volume is moved in.
+    /// Insert a volume into the cache, evicting least-recently-used
+    /// entries while either the entry count or the byte budget is
+    /// exceeded.  The newest entry is always kept.  The Volume is moved in.
     /// Thread-safe: acquires internal mutex.
     void put(const std::string& path, Volume vol);
 
@@ -117,11 +127,12 @@ public:
     void clear();
 
     size_t size() const { std::lock_guard<std::mutex> lk(mutex_); return map_.size(); }
+    size_t bytes() const { std::lock_guard<std::mutex> lk(mutex_); return bytes_; }
     size_t capacity() const { return maxEntries_; }
+    size_t maxBytes() const { return maxBytes_; }
 
-    /// Expose mutex for external callers that need to hold the lock
-    /// across a get()+copy sequence.
-    std::mutex& mutex() { return mutex_; }
+    /// Memory held by a cached volume (its voxel data).
+    static size_t volumeBytes(const Volume& vol) { return vol.data.size() * sizeof(float); }
 
 private:
     struct Entry {
@@ -129,6 +140,8 @@ private:
         Volume vol;
     };
     size_t maxEntries_;
+    size_t maxBytes_;
+    size_t bytes_ = 0;
     mutable std::mutex mutex_;
     std::list<Entry> lru_;                           // front = most recent
     std::unordered_map<std::string,
@@ -141,6 +154,9 @@ public:
     std::vector<std::string> volumeNames_;
     std::vector<std::string> volumePaths_;
     std::vector<VolumeViewState> viewStates_;
+    /// Per column: placeholder whose volume is still being read in the
+    /// background (see addPendingVolume()).  May be shorter than volumes_.
+    std::vector<bool> volumeLoading_;
     OverlayState overlay_;
 
     bool tagsVisible_ = true;
@@ -151,6 +167,8 @@ public:
     bool syncZoom_ = false;
     bool syncPan_ = false;
     bool showCrosshairs_ = true;
+    bool gpuSlicing_ = false;  ///< Slice/colour-map on the GPU when the backend supports it
+    bool palettedSlices_ = false;  ///< Upload slices as colour indices plus a LUT
     int lastSyncSource_ = 0;
     int lastSyncView_ = 0;
     bool cursorSyncDirty_ = false;
@@ -199,8 +217,25 @@ public:
     const VolumeViewState& getViewState(int index) const { return viewStates_[index]; }
 
     void loadVolume(const std::string& path);
+
+    /// Append a placeholder column for @p path whose volume is loaded in
+    /// the background and handed over with installVolume().
+    void addPendingVolume(const std::string& path);
+
+    /// Replace the placeholder at @p index with its loaded volume (or, if
+    /// @p vol has no data, mark the load as finished) and reset the
+    /// column's view state.
+    void installVolume(int index, Volume vol);
+
+    bool isVolumeLoading(int index) const
+    {
+        return index >= 0 && index < static_cast<int>(volumeLoading_.size()) &&
+               volumeLoading_[index];
+    }
     void loadTagsForVolume(int index);
     void initializeViewStates();
+    /// initializeViewStates() for one column.
+    void initializeViewState(int index);
 
     /// Resolve duplicate basenames in volumeNames_ by progressively
     /// prepending parent directory components from volumePaths_ until
@@ -221,6 +256,9 @@ public:
     /// is set and we have 2+ volumes, otherwise per-volume.
     void saveTags();
     void applyConfig(const AppConfig& cfg, int defaultWindowWidth, int defaultWindowHeight);
+    /// The per-volume part of applyConfig() (colour map, range, slices,
+    /// zoom/pan) for one column.
+    void applyVolumeConfig(const AppConfig& cfg, int index);
 
     /// Recompute the transform from tag point pairs (vol 0 -> vol 1).
     /// Only recomputes if transformOutOfDate_ is true.
@@ -249,5 +287,7 @@ public:
     /// Failed loads produce placeholder volumes with name "(error)".
     /// Caller must call ViewManager::initializeAllTextures() afterward.
     /// Uses volumeCache_ to avoid re-reading previously loaded files.
-    void loadVolumeSet(const std::vector<std::string>& paths);
+    /// If @p loadSeconds is given, it receives the time spent on each path.
+    void loadVolumeSet(const std::vector<std::string>& paths,
+                       std::vector<double>* loadSeconds = nullptr);
 };
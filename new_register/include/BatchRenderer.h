@@ -0,0 +1,52 @@
+#pragma once
+
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+class AppState;
+class QCState;
+
+/// One image rendered by batch mode: a set of volumes shown as columns.
+struct BatchItem
+{
+    std::string name;                 ///< output file name without ".png"
+    std::vector<std::string> paths;   ///< one volume per column
+    int qcRow = -1;                   ///< QC row index, -1 outside QC mode
+};
+
+/// Settings for runBatch().
+struct BatchOptions
+{
+    std::string outputDir;
+    int jobs = 0;                     ///< worker processes; 0 = one per core
+    int width = 1280;                 ///< framebuffer size in pixels
+    int height = 720;
+    std::optional<float> scale;       ///< UI scale (--scale), default 1
+    std::string fontPath;
+    float fontSize = 13.0f;
+    bool gpuSlicing = false;
+    bool palettedSlices = false;
+};
+
+/// Applies configuration to an item's freshly loaded volumes (config file,
+/// QC column settings, CLI options, tags) before its textures are created.
+using BatchSetup = std::function<void(AppState& state, const BatchItem& item)>;
+
+/// Render every item's full UI layout into @p options.outputDir/<name>.png
+/// with the OffscreenBackend: no window, no vsync, no input.
+///
+/// With more than one job the items are shared out to forked worker
+/// processes, each with its own software GL context, which take the next
+/// unrendered item from a shared counter; PNG encoding overlaps rendering
+/// within each process.  @p state and @p qcState are used by each worker
+/// (forked copies, in more than one job) and must not hold volumes yet.
+///
+/// @return 0 if every image was written, 1 otherwise.
+int runBatch(const std::vector<BatchItem>& items, const BatchOptions& options,
+             AppState& state, QCState& qcState, const BatchSetup& setup);
+
+/// Items for a QC session: one per row, named after the row ID (characters
+/// unsafe in file names replaced by '_').
+std::vector<BatchItem> batchItemsForQC(const QCState& qcState);
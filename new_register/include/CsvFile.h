@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// One field of a CSV record, pointing into the CsvFile mapping.
+struct CsvField
+{
+    std::string_view text;     ///< field contents, without enclosing quotes
+    bool escaped = false;      ///< text still holds doubled ("") quotes
+
+    /// The field value, with doubled quotes unescaped.
+    std::string str() const;
+
+    /// Compare with @p value without unescaping when not needed.
+    bool operator==(std::string_view value) const;
+};
+
+/// A CSV file (RFC 4180) mapped read-only into memory.
+///
+/// Records are found with memchr and split into CsvField views into the
+/// mapping, so scanning a file allocates nothing per field; callers copy
+/// out only what they keep.  Quoted fields may contain commas, doubled
+/// quotes and line breaks.  Both "\n" and "\r\n" line ends are accepted,
+/// and blank lines are skipped.
+///
+/// Records are addressed by byte offset: begin() is the first record and
+/// readRecord() returns the offset of the next one, so a caller can index
+/// the offsets in one pass and parse records later, in any order.  The
+/// file must not be truncated while it is mapped.
+class CsvFile
+{
+public:
+    /// Map @p path.  Throws std::runtime_error if it cannot be read.
+    explicit CsvFile(const std::string& path);
+    ~CsvFile();
+
+    // Not copyable or movable (owns the mapping).
+    CsvFile(const CsvFile&) = delete;
+    CsvFile& operator=(const CsvFile&) = delete;
+
+    size_t size() const { return size_; }
+
+    /// Offset of the first record, or size() if there is none.
+    size_t begin() const { return skipBlankLines(0); }
+
+    /// Split the record at @p offset into @p fields (cleared first).
+    /// @return offset of the next record, or size() after the last one.
+    size_t readRecord(size_t offset, std::vector<CsvField>& fields) const;
+
+    /// Offset of the record after the one at @p offset, without splitting
+    /// it.  If @p firstField is given, it receives the record's first field.
+    size_t skipRecord(size_t offset, CsvField* firstField = nullptr) const;
+
+    /// False if the last record has no line break, e.g. because a writer
+    /// was interrupted while appending it.
+    bool endsWithNewline() const { return size_ == 0 || data_[size_ - 1] == '\n'; }
+
+private:
+    size_t skipBlankLines(size_t offset) const;
+
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+};
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Files that only speed up startup (e.g. the Vulkan pipeline cache) and
+// can be rebuilt at any time.  None of these functions throw: a missing
+// or unwritable cache just means a slower start.
+
+/// Per-user cache directory: $XDG_CACHE_HOME/new_register, falling back
+/// to $HOME/.cache/new_register.  Empty if neither variable is set.
+std::string userCacheDir();
+
+/// Read a whole file into @p data.  Returns false if it cannot be read.
+bool readCacheFile(const std::string& path, std::vector<uint8_t>& data);
+
+/// Write @p data to @p path, creating parent directories.  The file is
+/// written under a temporary name and renamed, so concurrent instances
+/// never read a partial cache.  Returns false on I/O errors.
+bool writeCacheFile(const std::string& path, const std::vector<uint8_t>& data);
+
+/// True if @p data starts with a Vulkan pipeline cache header
+/// (VkPipelineCacheHeaderVersionOne) for the given device: header
+/// version 1, vendor and device IDs, and the driver's pipelineCacheUUID.
+/// Drivers must reject foreign data themselves, but some crash instead.
+bool pipelineCacheHeaderMatches(const std::vector<uint8_t>& data,
+                                uint32_t vendorId, uint32_t deviceId,
+                                const uint8_t uuid[16]);
+
+/// Lowercase hex of @p size bytes, used to name per-device cache files.
+std::string hexString(const uint8_t* bytes, size_t size);
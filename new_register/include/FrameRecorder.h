@@ -0,0 +1,81 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// Writes captured frames to PNG files on a small pool of worker threads,
+/// so neither encoding nor disk I/O runs on the UI thread.
+///
+/// The encode queue is bounded: submit() refuses a frame instead of
+/// blocking when the backlog is full, so a recording that outpaces the
+/// disk drops frames rather than UI frame rate.  All methods are
+/// thread-safe; the destructor finishes every queued write.
+class FrameRecorder {
+public:
+    struct Stats {
+        uint64_t written = 0;
+        uint64_t failed = 0;    ///< frames whose file could not be written
+        uint64_t dropped = 0;   ///< frames refused because the queue was full
+    };
+
+    /// @param threads    encoder threads; 0 = half the hardware threads, at
+    ///                   least 2 (PNG encoding is the bottleneck of recording)
+    /// @param maxQueued  frames that may be queued or encoding; 0 = twice
+    ///                   the thread count
+    explicit FrameRecorder(int threads = 0, size_t maxQueued = 0);
+    ~FrameRecorder();
+
+    // Not copyable or movable (owns the worker threads).
+    FrameRecorder(const FrameRecorder&) = delete;
+    FrameRecorder& operator=(const FrameRecorder&) = delete;
+
+    /// Queue a w x h RGBA8 image (rows top to bottom) to be written to
+    /// @p path.  Returns false, counting the frame as dropped, if the
+    /// queue is full.
+    bool submit(std::string path, std::vector<uint8_t> pixels, int w, int h);
+
+    /// Block until every queued frame has been written.
+    void waitIdle();
+
+    /// Frames queued or being encoded.
+    size_t pending() const;
+
+    Stats stats() const;
+
+    /// First index N such that no file @p prefix + N (six digits, zero
+    /// padded) + @p suffix in @p dir has an index of N or above.  One
+    /// directory scan; 1 if @p dir does not exist.  With an empty suffix
+    /// directories are matched as well, e.g. nextFreeIndex(".", "record", "").
+    static int nextFreeIndex(const std::string& dir, const std::string& prefix,
+                             const std::string& suffix);
+
+    /// @p prefix + @p index as six zero-padded digits + @p suffix.
+    static std::string numberedName(const std::string& prefix, int index,
+                                    const std::string& suffix);
+
+private:
+    struct Frame {
+        std::string path;
+        std::vector<uint8_t> pixels;
+        int width = 0;
+        int height = 0;
+    };
+
+    void workerLoop();
+
+    const size_t maxQueued_;
+    mutable std::mutex mutex_;
+    std::condition_variable workCv_;   ///< frame queued or stopping
+    std::condition_variable idleCv_;   ///< a frame finished
+    std::deque<Frame> queue_;
+    size_t active_ = 0;                ///< frames being encoded
+    bool stop_ = false;
+    Stats stats_;
+    std::vector<std::thread> workers_;
+};
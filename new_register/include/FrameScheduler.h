@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <utility>
+
+/// Decides once per main-loop iteration whether the loop may block for
+/// events or has to render straight away, and meters the time spent on
+/// background work (prefetching, cache warm-up) between frames.
+///
+/// An idle viewer should not redraw at the display refresh rate.  The loop
+/// blocks (glfwWaitEventsTimeout) unless frames were requested: input
+/// requests a few frames so ImGui can settle hover and layout state, and
+/// callers report pending work through shouldWait().  Worker threads call
+/// notify() when they post results; it wakes a blocked loop through the
+/// wake function (glfwPostEmptyEvent).
+///
+/// Header-only so that new_qc, which does not link nr_core, can use it.
+/// notify() is thread-safe; everything else belongs to the main thread.
+class FrameScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// Frames rendered after input before the loop blocks again.
+    static constexpr int kSettleFrames = 3;
+
+    /// Longest block when idle, in seconds.  Each timeout renders one
+    /// frame, which keeps tooltips and deferred releases moving.
+    static constexpr double kDefaultIdleTimeout = 0.5;
+
+    /// Background work per frame; one item is always allowed to start.
+    static constexpr std::chrono::microseconds kDefaultWorkBudget{4000};
+
+    explicit FrameScheduler(std::function<void()> wake = {},
+                            std::chrono::microseconds workBudget = kDefaultWorkBudget,
+                            double idleTimeout = kDefaultIdleTimeout)
+        : wake_(std::move(wake))
+        , workBudget_(workBudget)
+        , idleTimeout_(idleTimeout)
+    {
+    }
+
+    // Not copyable or movable (workers hold a pointer for notify()).
+    FrameScheduler(const FrameScheduler&) = delete;
+    FrameScheduler& operator=(const FrameScheduler&) = delete;
+
+    /// Render at least @p frames more frames before blocking again.
+    void requestFrames(int frames = kSettleFrames)
+    {
+        if (frames > framesWanted_)
+            framesWanted_ = frames;
+    }
+
+    /// A worker has results for the main thread: render a frame, waking
+    /// the loop if it is blocked.  Thread-safe.
+    void notify()
+    {
+        notified_.store(true, std::memory_order_release);
+        if (wake_)
+            wake_();
+    }
+
+    /// True if the loop may block for events: no frames requested, no
+    /// notification pending, and the caller is not @p busy (captures in
+    /// flight, prefetch queued, text cursor blinking...).
+    bool shouldWait(bool busy = false) const
+    {
+        return !busy && framesWanted_ == 0 &&
+               !notified_.load(std::memory_order_acquire);
+    }
+
+    /// Timeout to pass to glfwWaitEventsTimeout().
+    double idleTimeout() const { return idleTimeout_; }
+
+    /// Start a frame after polling or waiting.  @p input: events arrived
+    /// since the previous frame.  Starts this frame's work budget.
+    void beginFrame(bool input)
+    {
+        notified_.store(false, std::memory_order_relaxed);
+        if (input)
+            requestFrames(kSettleFrames);
+        if (framesWanted_ > 0)
+            --framesWanted_;
+        workDeadline_ = Clock::now() + workBudget_;
+    }
+
+    /// True while this frame's background-work budget lasts.
+    bool workTimeLeft() const { return Clock::now() < workDeadline_; }
+
+    /// Frames still requested (after the current one).
+    int framesWanted() const { return framesWanted_; }
+
+private:
+    std::function<void()> wake_;
+    std::chrono::microseconds workBudget_;
+    double idleTimeout_;
+    int framesWanted_ = kSettleFrames;   ///< the first frames always render
+    std::atomic<bool> notified_{false};
+    Clock::time_point workDeadline_{};
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+/// Streaming RGBA8 texture updates through pixel buffer objects.
+///
+/// Each update is written into an orphaned PBO and glTexSubImage2D sources
+/// from it, so the driver copies asynchronously and the CPU can write the
+/// next slice while the previous one is still being consumed.  PBOs are
+/// double-buffered per size class (power-of-two byte sizes), so a view
+/// that updates every frame alternates between two buffers of one class.
+///
+/// Entry points beyond GL 1.1 are loaded through a proc-address callback.
+/// initialize() returns false when the context has no pixel buffer objects
+/// (GL < 2.1 without ARB_pixel_buffer_object, e.g. indirect GLX over X2Go);
+/// upload() then calls glTexSubImage2D from client memory as before.
+///
+/// The same buffers serve the other direction: beginReadback() starts an
+/// asynchronous glReadPixels into a pack buffer, and endReadback() maps it
+/// once the caller judges the frame finished (a frame or two later).
+class GLPixelStream
+{
+public:
+    using GLProc = void (*)();
+    using ProcLoader = GLProc (*)(const char* name);
+
+    GLPixelStream();
+    ~GLPixelStream();
+
+    GLPixelStream(const GLPixelStream&) = delete;
+    GLPixelStream& operator=(const GLPixelStream&) = delete;
+
+    /// Resolve buffer-object entry points.  The context must be current.
+    /// Returns false if PBO streaming is unavailable.
+    bool initialize(ProcLoader loader);
+
+    /// Delete all buffers (context must still be current).
+    void shutdown();
+
+    bool supported() const { return supported_; }
+
+    /// Replace the whole of the w x h RGBA8 2D texture @p tex (GL name)
+    /// with @p data (w*h*4 bytes, rows top to bottom as in glTexSubImage2D).
+    void upload(unsigned int tex, int w, int h, const void* data);
+
+    /// Start reading the lower-left w x h RGBA8 region of the current read
+    /// buffer into a pixel pack buffer.  glReadPixels returns immediately.
+    /// @return readback handle, or 0 without pixel buffer objects.
+    unsigned int beginReadback(int w, int h);
+
+    /// Copy a readback started by beginReadback(w, h) into @p pixels (rows
+    /// bottom to top, as glReadPixels returns them) and recycle its buffer.
+    /// Mapping waits only if the GPU has not finished the copy yet.
+    bool endReadback(unsigned int readback, int w, int h, std::vector<uint8_t>& pixels);
+
+private:
+    /// Two PBOs of one size class, used alternately.
+    struct BufferPair {
+        unsigned int buffers[2] = {0, 0};
+        int next = 0;
+    };
+
+    struct GLFunctions;
+    std::unique_ptr<GLFunctions> gl_;
+
+    bool supported_ = false;
+    std::map<size_t, BufferPair> pairs_;   ///< keyed by size-class bytes
+    std::vector<unsigned int> packBuffers_;  ///< all readback buffers
+    std::vector<unsigned int> packFree_;     ///< readback buffers not in use
+};
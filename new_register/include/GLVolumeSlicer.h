@@ -0,0 +1,123 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include "GraphicsBackend.h"
+
+/// GPU volume slicing for OpenGL 2.x contexts.
+///
+/// Volumes live in float 3D textures; a GLSL 1.10 fragment shader extracts
+/// the slice, applies range/log/clamp colour mapping through a per-layer
+/// colour-slot row and (for overlays) blends up to kMaxVolumeSliceLayers
+/// volumes, rendering into an RGBA8 texture through a framebuffer object.
+///
+/// It also resolves paletted slices: an 8/16-bit index texture looked up in
+/// a 1D colour LUT texture, which needs shaders and framebuffer objects but
+/// no 3D or float textures.
+///
+/// Everything beyond GL 1.1 is loaded through a proc-address callback, so
+/// the slicer works with any context provider (GLFW, OSMesa).  initialize()
+/// fails cleanly when the context lacks shaders or framebuffer objects (e.g.
+/// indirect GLX over X2Go), and supported() is false without 3D or float
+/// textures; callers then keep using the CPU renderer.
+class GLVolumeSlicer
+{
+public:
+    using GLProc = void (*)();
+    using ProcLoader = GLProc (*)(const char* name);
+
+    GLVolumeSlicer();
+    ~GLVolumeSlicer();
+
+    GLVolumeSlicer(const GLVolumeSlicer&) = delete;
+    GLVolumeSlicer& operator=(const GLVolumeSlicer&) = delete;
+
+    /// Resolve GL entry points and check capabilities.  The context must be
+    /// current.  Returns false if neither volume slicing nor paletted slices
+    /// are available.
+    bool initialize(ProcLoader loader);
+
+    /// Delete all GL objects (context must still be current).
+    void shutdown();
+
+    /// True if volume textures and render() are available.
+    bool supported() const { return supported_; }
+
+    /// True if index textures and renderPaletted() are available.
+    bool palettedSupported() const { return palettedSupported_; }
+
+    std::unique_ptr<VolumeTexture> createVolumeTexture(int dimX, int dimY, int dimZ,
+                                                       const float* data);
+    void destroyVolumeTexture(VolumeTexture* vt);
+
+    /// Render into the RGBA8 2D texture @p targetTex (GL name) of size w x h.
+    /// See GraphicsBackend::renderVolumeSlice().
+    bool render(unsigned int targetTex, int w, int h,
+                const VolumeSliceLayer* layers, int count, bool blend);
+
+    /// Index textures: LUMINANCE8 / LUMINANCE16, nearest filtering.
+    std::unique_ptr<IndexTexture> createIndexTexture(int w, int h, int indexBytes);
+    bool updateIndexTexture(IndexTexture* it, const void* indices);
+    void destroyIndexTexture(IndexTexture* it);
+
+    /// Render @p indices through @p palette into the RGBA8 2D texture
+    /// @p targetTex (GL name) of the same size.
+    /// See GraphicsBackend::renderPalettedSlice().
+    bool renderPaletted(unsigned int targetTex, const IndexTexture& indices,
+                        const uint32_t* palette, int paletteSize);
+
+private:
+    struct Program {
+        unsigned int program = 0;
+        int uSlots = -1;
+        int uSlotRows = -1;
+        int uHeight = -1;
+        int uVol[kMaxVolumeSliceLayers] = {};
+        int uDims = -1;
+        int uBase = -1;
+        int uDpx = -1;
+        int uDpy = -1;
+        int uRange = -1;      ///< vec4 per layer: rangeMin, rangeMax, invSpan, useLog
+        int uAlpha = -1;
+    };
+
+    struct PalettedProgram {
+        unsigned int program = 0;
+        int uIndex = -1;
+        int uLut = -1;
+        int uSize = -1;
+        int uIndexScale = -1;  ///< 255 or 65535: normalized texel -> index
+        int uLutSize = -1;
+    };
+
+    /// Program for @p count layers in single or blend mode (built on demand).
+    const Program* program(int count, bool blend);
+
+    /// Compile and link the shared vertex shader with @p fragmentSrc.
+    /// Returns 0 (after logging) on failure.
+    unsigned int buildProgram(const std::string& fragmentSrc);
+
+    /// Bind @p targetTex to the framebuffer object and draw a full-screen
+    /// quad of w x h with the current program; GL state is restored.
+    /// @p bind sets up textures and uniforms and @p unbind resets textures.
+    template <typename Bind, typename Unbind>
+    bool drawInto(unsigned int targetTex, int w, int h, unsigned int prog,
+                  Bind&& bind, Unbind&& unbind);
+
+    struct GLFunctions;
+    std::unique_ptr<GLFunctions> gl_;
+
+    bool supported_ = false;
+    bool palettedSupported_ = false;
+    bool index16Exact_ = false;       ///< LUMINANCE16 keeps all 16 bits
+    int maxLayers_ = kMaxVolumeSliceLayers;
+    unsigned int volumeFormat_ = 0;   ///< internal format of volume textures
+    int max3DSize_ = 0;
+    unsigned int fbo_ = 0;
+    unsigned int slotTex_ = 0;        ///< kVolumeSliceSlots x kMaxVolumeSliceLayers RGBA8
+    std::map<int, Program> programs_; ///< keyed by count * 2 + blend
+    unsigned int lutTex_ = 0;         ///< kVolumeSliceSlots RGBA8 1D texture
+    PalettedProgram paletted_;
+};
@@ -26,11 +26,79 @@ enum class BackendType
 ///   - OpenGL: GLuint texture name cast to ImTextureID
 ///   - Metal:  MTLTexture* cast to ImTextureID
 /// Application code should never interpret `id` — only pass it to ImGui::Image().
+///
+/// A backend may pack several textures into one image (the Vulkan backend
+/// atlases slice textures), in which case `uv0`/`uv1` give the texture's
+/// sub-rectangle of that image and texture coordinates must be mapped
+/// through them; see isSubImage().
 struct Texture
 {
     ImTextureID id = 0;
     int width  = 0;
     int height = 0;
+    ImVec2 uv0 = ImVec2(0.0f, 0.0f);
+    ImVec2 uv1 = ImVec2(1.0f, 1.0f);
+
+    /// True if the texture occupies only part of the image behind `id`.
+    bool isSubImage() const
+    {
+        return uv0.x != 0.0f || uv0.y != 0.0f || uv1.x != 1.0f || uv1.y != 1.0f;
+    }
+
+    /// Map texture coordinates (0..1 over this texture) to the image.
+    ImVec2 mapUV(const ImVec2& uv) const
+    {
+        return ImVec2(uv0.x + uv.x * (uv1.x - uv0.x), uv0.y + uv.y * (uv1.y - uv0.y));
+    }
+};
+
+/// Backend-owned single-channel float 3D texture holding one volume's voxels
+/// (x fastest, as in Volume::data).  Created by createVolumeTexture().
+struct VolumeTexture
+{
+    uintptr_t id = 0;   ///< backend-specific handle (e.g. GL texture name)
+    int dimX = 0;
+    int dimY = 0;
+    int dimZ = 0;
+};
+
+/// Backend-owned single-channel texture of 8- or 16-bit colour indices (one
+/// slice from renderSliceIndices(), rows top to bottom), turned into colours
+/// by renderPalettedSlice().  Created by createIndexTexture().
+struct IndexTexture
+{
+    uintptr_t id = 0;   ///< backend-specific handle (e.g. GL texture name)
+    int width  = 0;
+    int height = 0;
+    int indexBytes = 1; ///< 1 (uint8) or 2 (uint16, native endian)
+};
+
+/// Number of colour slots per layer: [0] under colour, [1..256] colour-map
+/// LUT (already inverted if requested), [257] over colour — the layout of
+/// ColourTransfer::slots.
+constexpr int kVolumeSliceSlots = 258;
+
+/// Most layers a single renderVolumeSlice() call may blend.
+constexpr int kMaxVolumeSliceLayers = 8;
+
+/// One volume sampled by renderVolumeSlice().
+///
+/// Output pixel (px, py), with py counted upwards from the bottom row as in
+/// the CPU slice renderer, samples the voxel nearest to
+/// base + px*dpx + py*dpy in the layer's voxel grid.  The value is then
+/// colour-mapped exactly like ColourTransfer::map().
+struct VolumeSliceLayer
+{
+    const VolumeTexture* volume = nullptr;
+    float base[3] = {0.0f, 0.0f, 0.0f};
+    float dpx[3]  = {1.0f, 0.0f, 0.0f};
+    float dpy[3]  = {0.0f, 1.0f, 0.0f};
+    const uint32_t* slots = nullptr;  ///< kVolumeSliceSlots packed 0xAABBGGRR colours
+    float rangeMin = 0.0f;            ///< log10 domain when useLog is set
+    float rangeMax = 1.0f;
+    float invSpan  = 1.0f;
+    bool  useLog   = false;
+    float alpha    = 1.0f;            ///< blend weight (blend mode only)
 };
 
 /// Abstract graphics backend interface.
@@ -130,12 +198,37 @@ public:
     ///          vector on failure.
     virtual std::vector<uint8_t> captureScreenshot(int& width, int& height) = 0;
 
+    /// True if requestCapture() is implemented.  Otherwise callers fall back
+    /// to captureScreenshot(), which stalls until the GPU is idle.
+    virtual bool supportsAsyncCapture() const { return false; }
+
+    /// Read back the frame being built once endFrame() has rendered it,
+    /// without waiting for the GPU: the copy is recorded with the frame into
+    /// a persistent buffer and handed out by takeCapture() a few frames
+    /// later.  Repeated requests within one frame return the same id.
+    /// @return capture id (increasing), or 0 if async capture is
+    ///         unsupported or every readback buffer is still in flight.
+    virtual uint64_t requestCapture() { return 0; }
+
+    /// Take the oldest completed capture, if any; never blocks.  After
+    /// waitIdle() every requested capture is complete.  A requested id that
+    /// is skipped (its readback could not be recorded) is never returned.
+    /// @param[out] pixels  RGBA8 rows, top to bottom.
+    /// @param[out] id      The id requestCapture() returned for the frame.
+    virtual bool takeCapture(std::vector<uint8_t>& pixels, int& width, int& height,
+                             uint64_t& id)
+    {
+        (void)pixels; (void)width; (void)height; (void)id;
+        return false;
+    }
+
     // --- Texture management ---
 
     /// Create a GPU texture from RGBA8 pixel data.
     /// @param w     Texture width in pixels.
     /// @param h     Texture height in pixels.
-    /// @param data  Pointer to w*h*4 bytes of RGBA8 pixel data.
+    /// @param data  Pointer to w*h*4 bytes of RGBA8 pixel data, or null for
+    ///              a texture filled later by renderVolumeSlice().
     /// @return Opaque texture handle. Caller owns the returned pointer.
     virtual std::unique_ptr<Texture> createTexture(int w, int h, const void* data) = 0;
 
@@ -153,6 +246,84 @@ public:
     /// Called once at application exit, before shutdownImGui()/shutdown().
     virtual void shutdownTextureSystem() = 0;
 
+    // --- GPU volume slicing (optional) ---
+    //
+    // Backends that support it keep each volume on the GPU as a 3D texture
+    // and extract, colour-map and blend slices in a shader, rendering
+    // straight into a slice texture: scrolling or changing the value range
+    // then costs no CPU pixel work and no pixel upload.  Callers must fall
+    // back to the CPU renderer whenever these return false / nullptr.
+
+    /// True if createVolumeTexture()/renderVolumeSlice() are available.
+    virtual bool supportsVolumeSlicing() const { return false; }
+
+    /// Upload a volume as a single-channel float 3D texture.
+    /// @return nullptr if unsupported or the volume does not fit.
+    virtual std::unique_ptr<VolumeTexture> createVolumeTexture(
+        int dimX, int dimY, int dimZ, const float* data)
+    {
+        (void)dimX; (void)dimY; (void)dimZ; (void)data;
+        return nullptr;
+    }
+
+    /// Release the GPU resources of a volume texture.
+    virtual void destroyVolumeTexture(VolumeTexture* vt) { (void)vt; }
+
+    /// Render @p count layers into the whole of @p tex.
+    /// With @p blend false, @p count must be 1 and the layer's colour
+    /// (including alpha) is written as is.  With @p blend true the colours
+    /// of the layers that cover a pixel with non-zero alpha are averaged,
+    /// weighted by VolumeSliceLayer::alpha, and written opaque.
+    /// @return false if the slice was not rendered.
+    virtual bool renderVolumeSlice(Texture* tex, const VolumeSliceLayer* layers,
+                                   int count, bool blend)
+    {
+        (void)tex; (void)layers; (void)count; (void)blend;
+        return false;
+    }
+
+    // --- Paletted slices (optional) ---
+    //
+    // Backends that support it take slices as 8/16-bit colour indices and
+    // apply a small colour LUT in a shader, rendering into an RGBA8 slice
+    // texture.  Slice uploads shrink to a quarter (8-bit indices) and a
+    // colour map, invert or clamp change only uploads the ~1 KB palette.
+    // Callers must fall back to updateTexture() whenever these return
+    // false / nullptr.
+
+    /// True if the index texture functions below are available.
+    virtual bool supportsPalettedSlices() const { return false; }
+
+    /// Create a w x h index texture of @p indexBytes (1 or 2) per texel,
+    /// filled later by updateIndexTexture().
+    /// @return nullptr if unsupported (e.g. no exact 16-bit texture format).
+    virtual std::unique_ptr<IndexTexture> createIndexTexture(int w, int h, int indexBytes)
+    {
+        (void)w; (void)h; (void)indexBytes;
+        return nullptr;
+    }
+
+    /// Upload width * height * indexBytes bytes of indices.
+    virtual bool updateIndexTexture(IndexTexture* it, const void* indices)
+    {
+        (void)it; (void)indices;
+        return false;
+    }
+
+    /// Release the GPU resources of an index texture.
+    virtual void destroyIndexTexture(IndexTexture* it) { (void)it; }
+
+    /// Render @p indices into the whole of @p tex (same size), the colour of
+    /// index k being @p palette[k] (packed 0xAABBGGRR).
+    /// @param paletteSize  Number of palette entries, at most kVolumeSliceSlots.
+    /// @return false if the slice was not rendered.
+    virtual bool renderPalettedSlice(Texture* tex, const IndexTexture* indices,
+                                     const uint32_t* palette, int paletteSize)
+    {
+        (void)tex; (void)indices; (void)palette; (void)paletteSize;
+        return false;
+    }
+
     // --- Factory ---
 
     /// Create a backend of the specified type.
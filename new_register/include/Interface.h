@@ -1,16 +1,21 @@
 #pragma once
 
+#include <map>
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <imgui.h>
 
 #include "AppState.h"
 #include "GraphicsBackend.h"
+#include "ThumbnailCache.h"
 
 class ViewManager;
 class QCState;
 class Prefetcher;
+class FrameRecorder;
 
 class Interface {
 public:
@@ -18,11 +23,45 @@ public:
     ~Interface();
 
     void render(GraphicsBackend& backend, GLFWwindow* window);
+
+    /// Save the frame being rendered as the next free screenshotNNNNNN.png.
+    /// The readback and PNG encoding happen off the UI thread when the
+    /// backend supports asynchronous capture.
     void saveScreenshot(GraphicsBackend& backend);
 
+    /// Write every @p every-th rendered frame to @p dir/frameNNNNNN.png
+    /// until stopRecording().  An empty @p dir picks the next free
+    /// recordNNNNNN directory.  Frames are dropped, not waited for, when
+    /// readback or encoding falls behind.
+    void startRecording(const std::string& dir, int every = 1);
+    void stopRecording();
+    bool isRecording() const { return recording_; }
+
+    /// Frame interval used when recording is started with Shift+P.
+    void setRecordEvery(int every) { recordEvery_ = every > 1 ? every : 1; }
+
+    /// True while captures are in flight or a recording runs: the main
+    /// loop must keep rendering rather than block for events.
+    bool needsFrames() const
+    {
+        return recording_ || screenshotPending_ || !captureTargets_.empty();
+    }
+
+    /// Hand the remaining captures to the encoders and wait for all files
+    /// to be written.  Call after backend.waitIdle(), before shutdown.
+    void finishCaptures(GraphicsBackend& backend);
+
     /// Set the prefetcher instance (optional, only used in QC mode).
     void setPrefetcher(Prefetcher* prefetcher) { prefetcher_ = prefetcher; }
 
+    /// Set the thumbnail cache behind the QC thumbnail panel (optional,
+    /// only used in QC mode).
+    void setThumbnails(ThumbnailCache* thumbnails) { thumbnails_ = thumbnails; }
+
+    /// Destroy the thumbnail panel's textures.  Call before the backend's
+    /// shutdownTextureSystem().
+    void releaseThumbnails(GraphicsBackend& backend);
+
     static uint32_t resolveClampColour(int mode, ColourMapType currentMap, bool isOver);
     static const char* clampColourLabel(int mode);
 
@@ -32,6 +71,19 @@ private:
     QCState& qcState_;
     Prefetcher* prefetcher_ = nullptr;
 
+    // --- QC thumbnail panel ---
+    ThumbnailCache* thumbnails_ = nullptr;
+    bool thumbnailsVisible_ = false;
+    /// Uploaded thumbnail of one volume, kept while its row is on screen.
+    struct ThumbnailTexture {
+        ThumbnailCache::ThumbnailPtr source;   ///< what the texture shows
+        std::unique_ptr<Texture> texture;
+        int lastFrame = 0;
+    };
+    std::unordered_map<std::string, ThumbnailTexture> thumbnailTextures_;  ///< by volume path
+    int thumbnailFrame_ = 0;
+    uint64_t thumbnailRequestKey_ = 0;   ///< rows and colours last requested
+
     std::vector<std::string> columnNames_;
     bool scrollToCurrentRow_ = true;
     bool autosave_ = true;
@@ -52,6 +104,34 @@ private:
     std::string configFileDialogCurrentPath_;
     std::string configFileDialogFilename_;
 
+    // --- Screenshots and recording ---
+    struct CaptureTarget {
+        std::string path;
+        bool announce = true;   ///< print "Screenshot saved" (not for recorded frames)
+    };
+    std::unique_ptr<FrameRecorder> recorder_;       ///< created on first use
+    std::map<uint64_t, std::vector<CaptureTarget>> captureTargets_;  ///< by capture id
+    int screenshotIndex_ = 0;          ///< next screenshot number, 0 = not scanned yet
+    bool screenshotPending_ = false;   ///< waiting for a free readback buffer
+    bool recording_ = false;
+    std::string recordDir_;
+    int recordEvery_ = 1;
+    uint64_t recordFrame_ = 0;         ///< frames rendered since startRecording()
+    int recordIndex_ = 1;              ///< next frame file number
+    uint64_t recordCaptured_ = 0;
+    uint64_t recordDropped_ = 0;       ///< frames the backend could not read back
+    uint64_t recordEncoderDropped_ = 0;  ///< encoder drop count at start
+
+    FrameRecorder& recorder();
+    std::string nextScreenshotPath();
+    /// Route finished captures to the encoders.
+    void processCaptures(GraphicsBackend& backend);
+    /// Blocking fallback for backends without async capture.
+    void captureNow(GraphicsBackend& backend, const CaptureTarget& target);
+    void submitCapture(const CaptureTarget& target, std::vector<uint8_t> pixels,
+                       int width, int height);
+    void recordFrame(GraphicsBackend& backend);
+
     std::unique_ptr<Texture> transparentIcon_;
     std::unique_ptr<Texture> currentIcon_;
 
@@ -69,8 +149,12 @@ private:
     void renderTagListWindow();
     void renderTagListContent();
     void renderQCVerdictPanel(int volumeIndex);
-    void renderQCSingleVerdictPanel(GraphicsBackend& backend);
-    void switchQCRow(int newRow, GraphicsBackend& backend);
+    void renderQCSingleVerdictPanel();
+    void switchQCRow(int newRow);
+    void renderThumbnailPanel(GraphicsBackend& backend);
+    /// Thumbnail of column @p column's volume @p path, coloured as the
+    /// column is configured.
+    ThumbnailCache::Request thumbnailRequest(int column, const std::string& path) const;
     int renderSliceView(int vi, int viewIndex, const ImVec2& childSize);
     int renderOverlayView(int viewIndex, const ImVec2& childSize);
     bool drawTagsOnSlice(int viewIndex, const ImVec2& imgPos,
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "OpenGL2Backend.h"
+
+#include <cstdint>
+#include <vector>
+
+/// OpenGL 2 rendering into an OSMesa (software) framebuffer, without a
+/// window or display.  Used by batch mode to render the full UI layout
+/// straight to images.
+///
+/// Textures, GPU slicing and ImGui drawing are OpenGL2Backend's; this class
+/// replaces the GLFW parts: initialize() ignores the window and creates an
+/// OSMesa context of the size given to the constructor, endFrame() renders
+/// without swapping (there is no vsync to wait for), and ImGui runs without
+/// a platform backend (no input).  captureScreenshot() returns the frame
+/// rendered by the last endFrame().
+///
+/// Only built into new_register_batch: libOSMesa exports the GL entry
+/// points itself, so it cannot share an executable with a windowed
+/// OpenGL context.
+class OffscreenBackend : public OpenGL2Backend
+{
+public:
+    OffscreenBackend(int width, int height);
+    ~OffscreenBackend() override;
+
+    // --- Lifecycle ---
+    void setWindowHints() override;
+    void initialize(GLFWwindow* window) override;
+    void shutdown() override;
+
+    // --- Frame cycle ---
+    bool needsSwapchainRebuild() const override;
+    void rebuildSwapchain(int width, int height) override;
+    void beginFrame() override;
+    void endFrame() override;
+
+    // --- ImGui integration ---
+    void initImGui(GLFWwindow* window) override;
+    void shutdownImGui() override;
+    void imguiNewFrame() override;
+    void imguiRenderDrawData() override;
+
+    // --- Screenshot ---
+    std::vector<uint8_t> captureScreenshot(int& width, int& height) override;
+    bool supportsAsyncCapture() const override;
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+
+private:
+    bool makeCurrent();
+
+    void* context_ = nullptr;       ///< OSMesaContext
+    std::vector<uint8_t> buffer_;   ///< RGBA8 colour buffer, rows top to bottom
+    int width_;
+    int height_;
+};
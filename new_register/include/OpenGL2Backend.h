@@ -2,19 +2,26 @@
 
 #include "GraphicsBackend.h"
 
+#include <deque>
 #include <map>
+#include <memory>
 
 struct GLFWwindow;
+class GLPixelStream;
+class GLVolumeSlicer;
 
 /// OpenGL 2 (fixed-function pipeline) backend.
 /// Uses ImGui's imgui_impl_opengl2 renderer backend.
 /// This is the simplest backend, suitable for legacy Linux systems,
 /// software renderers (Mesa llvmpipe), and SSH/X11 forwarding.
+///
+/// Everything but the window (context, swap, input) is shared with
+/// OffscreenBackend through the protected helpers below.
 class OpenGL2Backend : public GraphicsBackend
 {
 public:
-    OpenGL2Backend() = default;
-    ~OpenGL2Backend() override = default;
+    OpenGL2Backend();
+    ~OpenGL2Backend() override;
 
     // --- Lifecycle ---
     void setWindowHints() override;
@@ -42,6 +49,10 @@ public:
 
     // --- Screenshot ---
     std::vector<uint8_t> captureScreenshot(int& width, int& height) override;
+    bool supportsAsyncCapture() const override;
+    uint64_t requestCapture() override;
+    bool takeCapture(std::vector<uint8_t>& pixels, int& width, int& height,
+                     uint64_t& id) override;
 
     // --- Texture management ---
     std::unique_ptr<Texture> createTexture(int w, int h, const void* data) override;
@@ -49,8 +60,39 @@ public:
     void destroyTexture(Texture* tex) override;
     void shutdownTextureSystem() override;
 
+    // --- GPU volume slicing ---
+    bool supportsVolumeSlicing() const override;
+    std::unique_ptr<VolumeTexture> createVolumeTexture(
+        int dimX, int dimY, int dimZ, const float* data) override;
+    void destroyVolumeTexture(VolumeTexture* vt) override;
+    bool renderVolumeSlice(Texture* tex, const VolumeSliceLayer* layers,
+                           int count, bool blend) override;
+
+    // --- Paletted slices ---
+    bool supportsPalettedSlices() const override;
+    std::unique_ptr<IndexTexture> createIndexTexture(int w, int h, int indexBytes) override;
+    bool updateIndexTexture(IndexTexture* it, const void* indices) override;
+    void destroyIndexTexture(IndexTexture* it) override;
+    bool renderPalettedSlice(Texture* tex, const IndexTexture* indices,
+                             const uint32_t* palette, int paletteSize) override;
+
+protected:
+    using GLProc = void (*)();
+    using ProcLoader = GLProc (*)(const char* name);
+
+    /// Set up texture streaming and the slicer for the current context,
+    /// resolving GL entry points through @p loader.
+    void initializeGL(ProcLoader loader, const char* contextName);
+
+    /// Create the ImGui context: style, DPI scaling and fonts.
+    void createImGuiContext();
+
+    /// Clear the framebuffer and draw ImGui's draw data (no swap).
+    void renderDrawData(ImDrawData* drawData);
+
 private:
     GLFWwindow* window_ = nullptr;
+    ProcLoader procLoader_ = nullptr;
     float contentScale_     = 1.0f;
     float framebufferScale_ = 1.0f;
     bool  manualScale_      = false;
@@ -61,4 +103,31 @@ private:
 
     /// Map from ImTextureID to OpenGL texture name (GLuint), for cleanup.
     std::map<ImTextureID, unsigned int> glTextures_;
+
+    /// Texture updates (PBO streaming, or client memory without PBOs).
+    std::unique_ptr<GLPixelStream> pixelStream_;
+
+    /// Framebuffer readbacks started in endFrame(), oldest first.  Without
+    /// fences a readback is mapped once kCaptureLatency more frames have
+    /// been swapped, by which time the driver has long finished the copy.
+    struct PendingCapture {
+        unsigned int readback = 0;
+        int width = 0;
+        int height = 0;
+        uint64_t frame = 0;
+        uint64_t id = 0;
+    };
+    static constexpr int kMaxPendingCaptures = 3;
+    static constexpr uint64_t kCaptureLatency = 2;
+    std::deque<PendingCapture> pendingCaptures_;
+    uint64_t requestedCapture_ = 0;   ///< id to read back this frame, 0 = none
+    uint64_t lastCaptureId_ = 0;
+    uint64_t frameCount_ = 0;         ///< frames swapped
+    bool capturesIdle_ = false;       ///< glFinish() since the last readback
+
+    /// Shader-based slicer (volume slicing and paletted slices), probed on
+    /// first use (shaders are only compiled when either is requested).
+    GLVolumeSlicer* slicer() const;
+    mutable std::unique_ptr<GLVolumeSlicer> slicer_;
+    mutable bool slicerProbed_ = false;
 };
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+/// Decides which QC rows the Prefetcher loads ahead of the rater.
+///
+/// The window holds `ahead()` rows in the navigation direction and
+/// `behind()` rows against it.  The depth follows the measured pace: rows
+/// that take longer to read than the rater spends on a row need more rows
+/// in flight, so ahead() is the load time of one row divided by the time
+/// spent per row, plus one row of margin.  It never exceeds what the
+/// VolumeCache can hold next to the current row, or prefetched rows would
+/// evict each other before they are shown.
+///
+/// Header-only and clock-agnostic (callers pass the time), so the policy
+/// can be tested without threads or files.  Not thread-safe.
+class PrefetchWindow {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr int kMinAhead = 2;
+    static constexpr int kMaxAhead = 32;
+    static constexpr int kBehind = 1;
+
+    /// Weight of the newest sample in the moving averages.
+    static constexpr double kSmoothing = 0.3;
+
+    /// Pauses longer than this (a break, a long look at a difficult
+    /// case) are not counted towards the time spent per row.
+    static constexpr double kMaxDwellSeconds = 30.0;
+
+    /// Size the window against the cache that receives the rows.
+    void setCacheLimits(size_t maxBytes, size_t maxEntries, int columns)
+    {
+        maxBytes_ = maxBytes;
+        maxEntries_ = maxEntries;
+        columns_ = std::max(1, columns);
+    }
+
+    /// The rater moved to @p row.  Steps of one row update the pace;
+    /// any move sets the direction.
+    void rowChanged(int row, Clock::time_point now)
+    {
+        if (row_ >= 0 && row != row_)
+        {
+            int step = row - row_;
+            direction_ = step > 0 ? 1 : -1;
+            double dwell = std::chrono::duration<double>(now - changedAt_).count();
+            if (std::abs(step) == 1 && dwell <= kMaxDwellSeconds)
+                secondsPerRow_ = smooth(secondsPerRow_, dwell);
+        }
+        row_ = row;
+        changedAt_ = now;
+    }
+
+    /// A volume of @p bytes voxel data took @p seconds to read.
+    void volumeLoaded(double seconds, size_t bytes)
+    {
+        volumeSeconds_ = smooth(volumeSeconds_, seconds);
+        volumeBytes_ = smooth(volumeBytes_, static_cast<double>(bytes));
+    }
+
+    /// Rows to keep loaded in the navigation direction.
+    int ahead() const
+    {
+        int wanted = kMinAhead;
+        if (secondsPerRow_ > 0.0)
+        {
+            double rows = std::ceil(rowLoadSeconds() / secondsPerRow_) + 1.0;
+            wanted = std::max(kMinAhead, static_cast<int>(std::min(rows, double(kMaxAhead))));
+        }
+        return std::max(1, std::min({wanted, kMaxAhead, cachedRows() - 1 - kBehind}));
+    }
+
+    /// Rows to keep loaded against the navigation direction.
+    int behind() const { return kBehind; }
+
+    /// +1 when moving down the list, -1 when moving up.
+    int direction() const { return direction_; }
+
+    /// Average time spent per row, 0 until two adjacent rows were shown.
+    double secondsPerRow() const { return secondsPerRow_; }
+
+    /// Average time to read all volumes of one row, 0 until one was read.
+    double rowLoadSeconds() const { return volumeSeconds_ * columns_; }
+
+    /// Rows whose volumes fit in the cache at once.
+    int cachedRows() const
+    {
+        size_t rows = maxEntries_ / static_cast<size_t>(columns_);
+        double rowBytes = volumeBytes_ * columns_;
+        if (rowBytes > 0.0)
+            rows = std::min(rows, static_cast<size_t>(static_cast<double>(maxBytes_) / rowBytes));
+        return static_cast<int>(std::min(rows, static_cast<size_t>(kMaxAhead + kBehind + 1)));
+    }
+
+    /// Rows to load around @p row, most urgent first: the next row in the
+    /// navigation direction, the previous one, then further ahead.
+    std::vector<int> plan(int row, int rowCount) const
+    {
+        std::vector<int> rows;
+        int aheadRows = ahead();
+        int behindRows = behind();
+        for (int k = 1; k <= std::max(aheadRows, behindRows); ++k)
+        {
+            int next = row + direction_ * k;
+            int prev = row - direction_ * k;
+            if (k <= aheadRows && next >= 0 && next < rowCount)
+                rows.push_back(next);
+            if (k <= behindRows && prev >= 0 && prev < rowCount)
+                rows.push_back(prev);
+        }
+        return rows;
+    }
+
+private:
+    static double smooth(double average, double sample)
+    {
+        return average > 0.0 ? average + kSmoothing * (sample - average) : sample;
+    }
+
+    size_t maxBytes_ = std::numeric_limits<size_t>::max();
+    size_t maxEntries_ = std::numeric_limits<size_t>::max();
+    int columns_ = 1;
+
+    int row_ = -1;
+    int direction_ = 1;
+    Clock::time_point changedAt_{};
+
+    double secondsPerRow_ = 0.0;
+    double volumeSeconds_ = 0.0;
+    double volumeBytes_ = 0.0;
+};
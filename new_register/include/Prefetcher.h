@@ -1,49 +1,86 @@
 #pragma once
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include "PrefetchWindow.h"
+
+class QCState;
 class VolumeCache;
 
-/// Eager prefetcher for QC mode.  Queues volume paths for adjacent QC rows
-/// and loads them into the shared VolumeCache on the **main thread** so that
-/// row switches are instant (cache hit) rather than blocking on disk I/O.
+/// Look-ahead prefetcher for QC mode.  A background thread reads the
+/// volumes of the rows around the current one into the shared VolumeCache,
+/// so row switches are served from memory instead of blocking on disk I/O.
 ///
-/// File loading happens synchronously on the main thread because neither
-/// libminc nor HDF5 is thread-safe; background loading caused segfaults
-/// when accessing MINC files over NFS.
+/// The rows are chosen by a PrefetchWindow: deeper in the direction the
+/// rater is moving, and deeper when rows take longer to read than to rate,
+/// within what the cache can hold.  Volumes are read one at a time; MINC
+/// reads hold libmincMutex(), as libminc and HDF5 are not thread-safe.
 ///
 /// Usage:
-///   1. Construct with a reference to the shared VolumeCache.
-///   2. After each row switch, call requestPrefetch() with the paths for
-///      the neighbouring rows (prev + next).
-///   3. Call loadPending() once per frame from the main loop.  It loads
-///      at most one volume per call to avoid stalling the UI.
+///   1. Construct with a reference to the shared VolumeCache (it must
+///      outlive the Prefetcher).
+///   2. On each row switch, call rowChanged() and then awaitRow() with the
+///      new row's paths before AppState::loadVolumeSet().
+///   3. stats() reports the session's hit rate and stall time.
 class Prefetcher {
 public:
+    struct Stats {
+        int switches = 0;            ///< row switches after the first row
+        int hits = 0;                ///< ... whose volumes were all cached
+        double stallSeconds = 0.0;   ///< time awaitRow() waited, in total
+        double maxStallSeconds = 0.0;
+        int loaded = 0;              ///< volumes read by the worker
+        int failed = 0;
+        double rowLoadSeconds = 0.0; ///< average time to read one row
+        double secondsPerRow = 0.0;  ///< average time the rater spends per row
+        int ahead = 0;               ///< current window
+        int behind = 0;
+    };
+
     explicit Prefetcher(VolumeCache& cache);
-    ~Prefetcher() = default;
+    ~Prefetcher();
 
-    // Not copyable or movable.
+    // Not copyable or movable (owns the worker thread).
     Prefetcher(const Prefetcher&) = delete;
     Prefetcher& operator=(const Prefetcher&) = delete;
 
-    /// Queue paths for prefetching.  Replaces any previously queued paths.
-    /// Paths already present in the cache will be skipped at load time.
-    void requestPrefetch(const std::vector<std::string>& paths);
+    /// The current row is now @p row: queue its volumes first, then the
+    /// rows of the updated window.  Replaces any previously queued paths.
+    void rowChanged(int row, const QCState& qcState);
+
+    /// Block until none of @p paths is queued or being read, so that
+    /// AppState::loadVolumeSet() finds them cached.  The wait counts as a
+    /// stall in stats().
+    void awaitRow(const std::vector<std::string>& paths);
 
-    /// Cancel any pending (not yet loaded) prefetch work.
+    /// Cancel any pending (not yet started) prefetch work.
     void cancelPending();
 
-    /// Load at most one queued volume into the cache.
-    /// Call this once per frame from the main loop.
-    /// Returns true if a volume was loaded (or skipped), false if the
-    /// queue is empty.
-    bool loadPending();
+    Stats stats() const;
 
 private:
+    void run();
+    bool isPending(const std::vector<std::string>& paths) const;   // mutex_ held
+
     VolumeCache& cache_;
 
-    /// Paths remaining to be loaded.
-    std::vector<std::string> pendingPaths_;
+    mutable std::mutex mutex_;
+    std::condition_variable workCv_;     ///< queue filled or stop requested
+    std::condition_variable doneCv_;     ///< a queued path was finished
+    std::deque<std::string> queue_;      ///< most urgent first
+    std::string inFlight_;               ///< path the worker is reading
+    bool hintPending_ = false;           ///< queue_ not yet hinted to the OS
+    bool stop_ = false;
+
+    PrefetchWindow window_;
+    Stats stats_;
+    int rowsSeen_ = 0;
+    bool rowWasCached_ = false;
+
+    std::thread worker_;   ///< declared last: started once the rest exists
 };
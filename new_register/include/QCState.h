@@ -1,10 +1,15 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "AppConfig.h"
+#include "CsvFile.h"
+#include "QCWorkQueue.h"
 
 /// Verdict for a single volume column within a QC row.
 /// Stored as an integer index into QCState::verdictOptions.
@@ -13,14 +18,56 @@
 using QCVerdict = int;
 constexpr QCVerdict QC_UNKNOWN = -1;
 
-/// Per-row QC result: one verdict + comment per column.
+/// Per-row QC result: one verdict + comment per column (the row's ID is
+/// QCState::rowIds[row]).
 struct QCRowResult
 {
-    std::string id;
     std::vector<QCVerdict> verdicts;   // parallel with columnNames
     std::vector<std::string> comments; // parallel with columnNames
 };
 
+/// Timing of one visit to a QC row, from the row switch until the next
+/// one (see QCState::beginRowVisit()).  Durations are in seconds, -1
+/// where the event did not happen during the visit.
+struct QCRowVisit
+{
+    int row = -1;
+    int fromRow = -1;             ///< row navigated from, -1 for the first
+    double start = 0.0;           ///< switch start, since the first visit
+    // Phases of the row switch
+    double read = 0.0;            ///< waiting for the prefetcher
+    double load = 0.0;            ///< AppState::loadVolumeSet()
+    double textures = 0.0;        ///< texture upload
+    double firstImage = -1.0;     ///< switch start to the first frame shown
+    // Volumes in the cache when the switch started, and their share of
+    // the read and load time
+    int cacheHits = 0;
+    int cacheMisses = 0;
+    double hitLoad = 0.0;
+    double missLoad = 0.0;
+    double verdict = -1.0;        ///< first image to the first verdict
+    double dwell = 0.0;           ///< switch start to leaving the row
+    int verdictChanges = 0;
+
+    double switchSeconds() const { return read + load + textures; }
+};
+
+/// Latency percentiles and cache split of a session's finished row visits
+/// (QCState::timingSummary()).
+struct QCTimingSummary
+{
+    int visits = 0;
+    double switchP50 = 0.0, switchP95 = 0.0;
+    double firstImageP50 = 0.0, firstImageP95 = 0.0;
+    double verdictP50 = 0.0;
+    double dwellP50 = 0.0;
+    int cacheHits = 0;
+    int cacheMisses = 0;
+    double hitLoad = 0.0;         ///< totals, in seconds
+    double missLoad = 0.0;
+    double rowsPerHour = 0.0;     ///< visits per hour spent on rows
+};
+
 /// Full QC session state: input CSV data, output results, runtime navigation.
 class QCState
 {
@@ -33,11 +80,12 @@ public:
     /// Column names parsed from the input CSV header (excluding "ID").
     std::vector<std::string> columnNames;
 
-    /// Per-row data from the input CSV.
+    /// Per-row IDs from the input CSV (file paths: see pathsForRow()).
     std::vector<std::string> rowIds;
-    std::vector<std::vector<std::string>> rowPaths; // rowPaths[row][col]
 
-    /// Per-row results (parallel with rowIds).
+    /// Per-row results (parallel with rowIds).  Change verdicts through
+    /// setVerdict() (or call recountVerdicts() after bulk edits) so that
+    /// the progress counters stay current.
     std::vector<QCRowResult> results;
 
     /// Per-column display config (from JSON config, keyed by column name).
@@ -58,31 +106,174 @@ public:
     /// If true, one verdict+comment per row (not per column). Set by --qc1.
     bool singleVerdictMode = false;
 
+    /// Shared work queue (--qc-queue), or null when this instance rates the
+    /// whole study.  With a queue, only the rows of its held blocks are
+    /// available, verdicts are journaled to the rater's journal in the
+    /// queue directory, and the output CSV merges all raters' journals.
+    /// Set before loadOutputCsv().
+    std::shared_ptr<QCWorkQueue> workQueue;
+
     // --- CSV I/O ---
 
-    /// Parse the input CSV file. Populates columnNames, rowIds, rowPaths,
-    /// and initialises results to unknown (-1) / empty.
+    /// Parse the input CSV file. Populates columnNames and rowIds, and
+    /// initialises results to unknown (-1) / empty.  The file stays mapped:
+    /// a row's paths are parsed when pathsForRow() first asks for them, so
+    /// million-row studies load in one memchr pass over the file.
     /// Throws std::runtime_error on missing ID column or empty file.
     void loadInputCsv(const std::string& path);
 
-    /// Load previously saved verdicts from the output CSV.
-    /// If the file does not exist, returns silently (results stay UNRATED).
+    /// Load previously saved verdicts from the output CSV, then replay its
+    /// journal (see recordRow()) if the last session did not compact it,
+    /// or with a work queue, the journals of all raters.
+    /// Missing files are skipped silently (results stay UNRATED).
     void loadOutputCsv(const std::string& path);
 
-    /// Write all results to outputCsvPath (truncate mode, immediate flush).
-    void saveOutputCsv() const;
+    /// Write all results to outputCsvPath and remove the journal.  The CSV
+    /// is written to a temporary file, synced and renamed over the old one,
+    /// so a crash leaves either the old or the new file.  With a work
+    /// queue, the other raters' journals are merged in first and the
+    /// journals are kept: they remain the record of each rater's verdicts.
+    void saveOutputCsv();
+
+    // --- Verdict journal ---
+
+    /// Journal entries written before recordRow() compacts the journal
+    /// into the output CSV.
+    static constexpr int kJournalCompactEntries = 500;
+
+    /// outputCsvPath + ".journal", or the rater's journal of the work queue.
+    std::string journalPath() const;
+
+    /// Append @p row's verdicts and comments to the journal and sync it to
+    /// disk, instead of rewriting the whole output CSV on every change.
+    /// The journal is a CSV with the output CSV's header; later entries
+    /// replace earlier ones for the same ID.  Compacts (saveOutputCsv())
+    /// every kJournalCompactEntries entries, or straight away if the
+    /// journal cannot be written.
+    void recordRow(int row);
+
+    /// Entries in the journal since the last compaction.
+    int journalEntries() const { return journalEntries_; }
+
+    // --- Navigation ---
+
+    /// True if @p row may be shown: always, unless a work queue is set and
+    /// another rater may hold the row.
+    bool rowAvailable(int row) const;
+
+    /// The available row @p step (+1 or -1) rows on from @p row, or -1.
+    /// With a work queue, moving forward past the held blocks finishes the
+    /// fully rated ones, merges the other raters' verdicts and claims the
+    /// next block with unrated rows, returning its first unrated row.
+    int stepRow(int row, int step);
+
+    /// Hand the work queue's blocks back at the end of a session: fully
+    /// rated blocks are marked done, the others released.
+    void closeWorkQueue();
+
+    // --- Session timing ---
+
+    using Clock = std::chrono::steady_clock;
+
+    /// outputCsvPath + ".timing.csv", or the rater's timing file of the
+    /// work queue (raters on other machines would otherwise append to one
+    /// file over NFS): one line per finished row visit, appended across
+    /// sessions.
+    std::string timingPath() const;
+
+    /// A row switch to @p visit.row, begun at @p switchStart, has finished:
+    /// end the previous visit and start timing this one.  The caller fills
+    /// in the row, the switch phases and the cache split.
+    void beginRowVisit(QCRowVisit visit, Clock::time_point switchStart);
+
+    /// A frame was presented at @p when; the first one after a row switch
+    /// is the row's first image.
+    void frameShown(Clock::time_point when);
+
+    /// End the current visit at @p when and append it to timingPath().
+    void endRowVisit(Clock::time_point when);
+
+    /// This session's visits; the last one is still open while
+    /// rowVisitOpen().
+    const std::vector<QCRowVisit>& rowVisits() const { return visits_; }
+    bool rowVisitOpen() const { return visitOpen_; }
+
+    /// Summary of the finished visits, recomputed when one was added.
+    const QCTimingSummary& timingSummary() const;
+
+    /// The @p p-th percentile (0..1) of @p values, nearest rank; 0 if empty.
+    static double percentile(std::vector<double> values, double p);
 
     // --- Accessors ---
 
     int columnCount() const;
     int rowCount() const;
 
+    /// Set results[row].verdicts[column], updating the counters below and
+    /// the timing of the current row visit.
+    void setVerdict(int row, int column, QCVerdict verdict);
+
+    /// Rebuild the counters from results.
+    void recountVerdicts();
+
     /// Number of rows with at least one non-unknown verdict.
-    int ratedCount() const;
+    int ratedCount() const { return ratedRows_; }
+
+    /// Number of verdicts (cells; rows in single-verdict mode) set to
+    /// verdictOptions[@p verdict].
+    int verdictCount(QCVerdict verdict) const;
 
     /// Index of first row where ALL verdicts are unknown (-1), or -1 if all rated.
     int firstUnratedRow() const;
 
-    /// Get file paths for a specific row.
+    /// Get file paths for a specific row (one per column), parsing the
+    /// row on first use.  Not thread-safe.
     const std::vector<std::string>& pathsForRow(int row) const;
+
+private:
+    /// Output CSV header and one row, as written by saveOutputCsv().
+    std::vector<std::string> outputHeader() const;
+    std::vector<std::string> outputRow(int row) const;
+
+    /// Apply verdicts from an output CSV or journal to results.  With
+    /// @p completeRecordsOnly, a last record without line break is ignored;
+    /// with @p skipHeldRows, so are the rows of the work queue's blocks.
+    void applyOutput(const CsvFile& csv, bool completeRecordsOnly, bool skipHeldRows = false);
+
+    /// Apply the other raters' journals, except to the held rows.
+    void mergeWorkQueueJournals();
+
+    /// True if every row of work queue block @p block is rated.
+    bool blockRated(int block) const;
+
+    /// True if any of @p row's verdicts is set.
+    bool rowRated(int row) const;
+
+    /// Append @p visit to timingPath(), with a header if the file is new.
+    void writeRowVisit(const QCRowVisit& visit) const;
+
+    int journalEntries_ = 0;
+
+    // Session timing
+    std::vector<QCRowVisit> visits_;
+    bool visitOpen_ = false;
+    Clock::time_point sessionStart_;      ///< switch start of the first visit
+    Clock::time_point visitStart_;        ///< switch start of the current visit
+    Clock::time_point visitShown_;        ///< first image (or switch end)
+    int64_t sessionId_ = 0;               ///< wall-clock start, Unix seconds
+    mutable QCTimingSummary summary_;
+    mutable size_t summaryVisits_ = 0;    ///< finished visits in summary_
+
+    // Progress counters, kept current by setVerdict() so the UI does not
+    // scan every row each frame
+    int ratedRows_ = 0;
+    std::vector<int> verdictCounts_;     ///< per verdict option
+    mutable int firstUnratedHint_ = 0;   ///< no unrated row before this one
+
+    /// Input CSV, shared by copies of this state.
+    std::shared_ptr<const CsvFile> inputCsv_;
+    std::vector<size_t> rowOffsets_;   ///< record offset of each row in inputCsv_
+
+    /// Parsed rows; empty until pathsForRow() is first called for a row.
+    mutable std::vector<std::vector<std::string>> rowPaths_;
 };
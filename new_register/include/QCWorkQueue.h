@@ -0,0 +1,124 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+/// Work queue shared by several raters of one QC study (--qc-queue <dir>).
+/// Each new_register instance claims blocks of consecutive rows through
+/// lease files in a directory that all raters reach (typically an NFS
+/// share), shows and prefetches only the rows of its blocks, and journals
+/// its verdicts to a file of its own there; QCState merges the journals
+/// into the output CSV.
+///
+/// No file locks are taken, as they are unreliable over NFS.  A lease is
+/// claimed by creating its file with O_EXCL, which is atomic on NFSv3 and
+/// later, and renewed by touching it.  A lease not renewed for the lease
+/// time has expired and is taken over by renaming it away first: of
+/// several raters trying, only one rename succeeds.  Expiry is judged on
+/// the file server's clock, read from the mtime of the rater's heartbeat
+/// file, so the raters' machines need not agree on the time.  A finished
+/// block gets a done file, also created with O_EXCL, so finishing never
+/// rewrites a lease another rater may have taken over meanwhile.
+///
+/// Layout of the directory:
+///   queue                       "rows <N> block <B>", written once
+///   leases/<first row>.lease    "claimed <rater>"
+///   leases/<first row>.done     "done <rater>", written once
+///   raters/<rater>              heartbeat, touched to read the time
+///   journals/<rater>.csv        the rater's verdict journal
+///   timing/<rater>.csv          the rater's row-visit timing
+///
+/// Not thread-safe; used from the UI thread.
+class QCWorkQueue
+{
+public:
+    /// Rows per lease.
+    static constexpr int kDefaultBlockRows = 20;
+
+    /// Seconds without renewal after which a lease may be taken over.
+    static constexpr int kDefaultLeaseSeconds = 30 * 60;
+
+    /// Open the queue in @p dir for a study of @p rowCount rows, creating
+    /// it if needed.  @p blockRows only applies to a new queue.  Throws
+    /// std::runtime_error if the directory cannot be set up, or holds the
+    /// queue of a study with another number of rows.
+    QCWorkQueue(const std::string& dir, const std::string& rater, int rowCount,
+                int blockRows = kDefaultBlockRows, int leaseSeconds = kDefaultLeaseSeconds);
+
+    const std::string& dir() const { return dir_; }
+    const std::string& rater() const { return rater_; }
+    int blockRows() const { return blockRows_; }
+    int blockCount() const { return (rowCount_ + blockRows_ - 1) / blockRows_; }
+    int blockOf(int row) const { return row / blockRows_; }
+
+    /// Claim the first block that is neither done nor leased to another
+    /// rater (expired leases excepted) and that has a row for which
+    /// @p needsRating is true.  Returns the block, or -1 if there is none.
+    int claim(const std::function<bool(int row)>& needsRating);
+
+    /// True if @p row is in a block this instance holds.
+    bool owns(int row) const;
+
+    /// Held blocks, in row order.
+    const std::vector<int>& heldBlocks() const { return held_; }
+
+    /// The nearest held row after (@p step > 0) or before @p row, or -1.
+    int nextHeldRow(int row, int step) const;
+
+    /// Touch the held leases if a quarter of the lease time has passed
+    /// since they were last renewed (or if @p force).  Leases taken over
+    /// by another rater meanwhile, and blocks another rater finished, are
+    /// dropped from heldBlocks().
+    void renew(bool force = false);
+
+    /// Mark held @p block as done, so it is never claimed again.
+    void finish(int block);
+
+    /// Give held @p block back to the queue.
+    void release(int block);
+
+    /// This rater's journal.
+    std::string journalPath() const;
+
+    /// The journals of all raters, this one included, sorted by name.
+    std::vector<std::string> journalPaths() const;
+
+    /// This rater's timing sidecar (QCState::timingPath()).
+    std::string timingPath() const;
+
+    /// "$USER@hostname", the rater name used when none is given.
+    static std::string defaultRater();
+
+    /// Called between renaming an expired lease away and checking it was
+    /// not renewed meanwhile; lets tests renew at the worst moment.
+    void setTakeOverHook(std::function<void()> hook) { takeOverHook_ = std::move(hook); }
+
+private:
+    std::string leasePath(int block) const;
+    std::string donePath(int block) const;
+    bool isDone(int block) const;
+
+    /// Contents of a lease, "" if there is none.
+    static std::string readLease(const std::string& path);
+
+    /// Create @p path with @p content, failing if it exists.
+    static bool createExclusive(const std::string& path, const std::string& content);
+
+    /// Current time on the file server, in seconds since the epoch.
+    double serverTime() const;
+
+    /// Try to lease @p block; takes over an expired lease.
+    bool tryLease(int block, double now);
+
+    std::string dir_;
+    std::string rater_;
+    int rowCount_ = 0;
+    int blockRows_ = kDefaultBlockRows;
+    int leaseSeconds_ = kDefaultLeaseSeconds;
+    std::vector<int> held_;
+    int nextBlock_ = 0;   ///< claim() starts searching here
+    std::chrono::steady_clock::time_point renewed_;
+    std::function<void()> takeOverHook_;
+};
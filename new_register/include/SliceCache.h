@@ -0,0 +1,153 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "SliceRenderer.h"
+
+/// Identifies one rendered slice: volume index, view (0=axial, 1=sagittal,
+/// 2=coronal), slice index along the view's axis, and a hash of everything
+/// that determines its colours (see sliceParamsHash()).
+struct SliceKey
+{
+    int volume = 0;
+    int view = 0;
+    int slice = 0;
+    uint64_t paramsHash = 0;
+
+    bool operator==(const SliceKey& o) const
+    {
+        return volume == o.volume && view == o.view && slice == o.slice &&
+               paramsHash == o.paramsHash;
+    }
+};
+
+struct SliceKeyHash
+{
+    size_t operator()(const SliceKey& k) const
+    {
+        uint64_t h = k.paramsHash;
+        h ^= (static_cast<uint64_t>(static_cast<uint32_t>(k.slice)) << 8) ^
+             (static_cast<uint64_t>(k.view) << 4) ^
+             (static_cast<uint64_t>(static_cast<uint32_t>(k.volume)) << 40);
+        h *= 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(h ^ (h >> 32));
+    }
+};
+
+/// Hash of the colour-relevant render parameters (overlay alpha excluded,
+/// as in ColourTransfer::matches()) combined with @p contentVersion, the
+/// volume's Volume::contentVersion().  That version is renewed whenever the
+/// volume's data is replaced or its label state changes, so slices of a
+/// reloaded or relabelled volume never hit stale cache entries.
+uint64_t sliceParamsHash(const VolumeRenderParams& params, uint64_t contentVersion);
+
+/// Bounded-memory LRU cache of rendered slices with a background worker
+/// that renders queued prefetch jobs.
+///
+/// Cached slices are handed out as shared_ptr so an entry can be evicted
+/// while the caller is still uploading its pixels.  All methods are
+/// thread-safe.
+///
+/// Prefetch jobs run on a single worker thread started on first use.  The
+/// render callbacks must only read data that outlives the job: callers that
+/// replace the underlying volumes must call clear() (or cancelPending())
+/// first, which also waits for any job already running.
+class SliceCache {
+public:
+    using SlicePtr = std::shared_ptr<const RenderedSlice>;
+
+    /// Default memory budget for cached pixels (256 MiB).
+    static constexpr size_t kDefaultBudgetBytes = size_t(256) << 20;
+
+    /// A slice to pre-render in the background.
+    struct Job {
+        SliceKey key;
+        std::function<RenderedSlice()> render;
+    };
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t prefetched = 0;   ///< slices rendered by the worker
+        uint64_t evictions = 0;
+        size_t bytes = 0;          ///< pixel bytes currently cached
+        size_t entries = 0;
+    };
+
+    explicit SliceCache(size_t budgetBytes = kDefaultBudgetBytes);
+    ~SliceCache();
+
+    // Not copyable or movable (owns the worker thread).
+    SliceCache(const SliceCache&) = delete;
+    SliceCache& operator=(const SliceCache&) = delete;
+
+    /// Look up a slice, marking it most recently used.  Returns nullptr on
+    /// a miss.
+    SlicePtr find(const SliceKey& key);
+
+    /// Store a rendered slice, evicting least recently used entries beyond
+    /// the budget.  Returns the cached slice (the existing one if @p key was
+    /// already present).
+    SlicePtr insert(const SliceKey& key, RenderedSlice slice);
+
+    /// Queue background renders for one (volume, view) stream, replacing
+    /// any jobs still pending for that stream.  Jobs run in the given order;
+    /// keys already cached are skipped.
+    void prefetch(int volume, int view, std::vector<Job> jobs);
+
+    /// Drop all pending jobs and wait for the running one (if any) to finish.
+    void cancelPending();
+
+    /// cancelPending(), then drop every cached slice.
+    void clear();
+
+    /// Block until the job queue is empty and the worker is idle.
+    void waitIdle();
+
+    Stats stats() const;
+
+    size_t budgetBytes() const { return budgetBytes_; }
+
+private:
+    struct Entry {
+        SlicePtr slice;
+        std::list<SliceKey>::iterator lruPos;
+    };
+
+    void workerLoop();
+    SlicePtr insertLocked(const SliceKey& key, SlicePtr slice);
+    void waitForWorkerLocked(std::unique_lock<std::mutex>& lock);
+
+    static size_t sliceBytes(const RenderedSlice& s)
+    {
+        return s.pixels.size() * sizeof(uint32_t);
+    }
+
+    const size_t budgetBytes_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable workCv_;   ///< signals the worker
+    std::condition_variable idleCv_;   ///< signals waitIdle()/cancelPending()
+
+    std::unordered_map<SliceKey, Entry, SliceKeyHash> entries_;
+    std::list<SliceKey> lru_;          ///< front = most recently used
+    size_t bytes_ = 0;
+
+    std::deque<Job> pending_;
+    bool busy_ = false;                ///< worker is rendering a job
+    uint64_t generation_ = 0;          ///< bumped by cancelPending()/clear()
+    bool stop_ = false;
+    std::thread worker_;
+
+    Stats stats_;
+};
@@ -1,7 +1,10 @@
 #pragma once
 
+#include <array>
 #include <vector>
 #include <cstdint>
+#include <cmath>
+#include <cstring>
 #include <unordered_map>
 
 #include <glm/glm.hpp>
@@ -33,6 +36,154 @@ struct VolumeRenderParams
     bool invertColourMap = false;
 };
 
+/// Value-to-colour transfer function with the value range, log transform,
+/// colour-map inversion and under/over clamping folded into precomposed
+/// tables.  Build it once per parameter change (buildColourTransfer) and
+/// share it across every slice rendered with the same parameters; map() is
+/// then a range test and a single table gather per voxel.
+///
+/// In log mode the log10 is precomputed too: every float is keyed by the
+/// upper 16 bits of its IEEE-754 pattern, and keys whose whole value span
+/// lands in one slot resolve with a table load.  Keys straddling a slot
+/// boundary fall back to the exact per-value computation, so the output is
+/// identical to evaluating log10 per voxel.
+struct ColourTransfer
+{
+    static constexpr int kUnderSlot = 0;
+    static constexpr int kOverSlot  = kLutSize + 1;
+    static constexpr uint16_t kMixedKey = 0xFFFF;
+
+    /// [0] under colour, [1..256] colour map (inverted when requested),
+    /// [257] over colour.  Transparent clamp modes are stored as 0.
+    std::array<uint32_t, kLutSize + 2> slots{};
+
+    float rangeMin = 0.0f;   ///< window bounds (log10 domain in log mode)
+    float rangeMax = 1.0f;
+    float invSpan  = 1.0f;
+    bool  useLog   = false;
+
+    /// Log mode only: slot per 16-bit float key, kMixedKey = evaluate exactly.
+    std::vector<uint16_t> logSlots;
+
+    /// Parameters this transfer was built from (see matches()).
+    VolumeRenderParams params;
+
+    /// Exact slot for a raw voxel value (kUnderSlot, 1 + LUT index, kOverSlot).
+    int slotOf(float val) const
+    {
+        float displayVal = val;
+        if (useLog)
+        {
+            // Values <= 0 use the under colour
+            if (val <= 0.0f)
+                return kUnderSlot;
+            displayVal = std::log10(val);
+        }
+        if (displayVal < rangeMin)
+            return kUnderSlot;
+        if (displayVal > rangeMax)
+            return kOverSlot;
+        int idx = static_cast<int>((displayVal - rangeMin) * invSpan * 255.0f + 0.5f);
+        if (idx > 255)
+            idx = 255;
+        return 1 + idx;
+    }
+
+    /// Slot for a raw voxel value through the precomposed tables; always
+    /// equal to slotOf(val).
+    int slot(float val) const
+    {
+        if (useLog)
+        {
+            uint32_t bits;
+            std::memcpy(&bits, &val, sizeof(bits));
+            uint16_t s = logSlots[bits >> 16];
+            if (s != kMixedKey)
+                return s;
+            return slotOf(val);
+        }
+        if (val < rangeMin)
+            return kUnderSlot;
+        if (val > rangeMax)
+            return kOverSlot;
+        int idx = static_cast<int>((val - rangeMin) * invSpan * 255.0f + 0.5f);
+        if (idx > 255)
+            idx = 255;
+        return 1 + idx;
+    }
+
+    /// Map a raw voxel value to a packed 0xAABBGGRR colour.
+    uint32_t map(float val) const { return slots[slot(val)]; }
+
+    /// Colour-map entry (0..255) with inversion applied, for label ranks.
+    uint32_t lutColour(int idx) const { return slots[1 + idx]; }
+
+    /// Bytes per colour index needed by renderSliceIndices(): 1 when the
+    /// under/over colours equal the ends of the colour map (the default
+    /// "current" clamp modes), so under/over values can share LUT entries
+    /// 0 and 255; otherwise 2, indexing all kLutSize + 2 slots.
+    int indexBytes() const
+    {
+        return (slots[kUnderSlot] == slots[1] && slots[kOverSlot] == slots[kLutSize])
+            ? 1 : 2;
+    }
+
+    /// True if @p p has the same colour-relevant fields as params
+    /// (overlayAlpha is not part of the transfer).
+    bool matches(const VolumeRenderParams& p) const
+    {
+        return p.valueMin == params.valueMin &&
+               p.valueMax == params.valueMax &&
+               p.colourMap == params.colourMap &&
+               p.underColourMode == params.underColourMode &&
+               p.overColourMode == params.overColourMode &&
+               p.useLogTransform == params.useLogTransform &&
+               p.invertColourMap == params.invertColourMap;
+    }
+};
+
+/// Precompose the colour transfer tables for @p params.
+ColourTransfer buildColourTransfer(const VolumeRenderParams& params);
+
+/// Dense label id -> packed colour palette for label volumes.
+///
+/// Built once from the volume's unique label ids, its label LUT and the
+/// colour transfer, so label pixels are coloured by direct array indexing
+/// instead of per-pixel hash lookups.  Rebuild when Volume::contentVersion()
+/// or the colour transfer changes.  Ids outside the dense span (and label 0)
+/// are transparent.
+struct LabelPalette
+{
+    /// Largest dense id span; wider (very sparse) id sets use `sparse`.
+    static constexpr int kMaxDenseSpan = 1 << 20;
+
+    int minId = 0;
+    std::vector<uint32_t> colours;               ///< colours[id - minId]
+    std::unordered_map<int, uint32_t> sparse;    ///< fallback for huge spans
+    uint64_t contentVersion = 0;                 ///< Volume::contentVersion() at build
+
+    uint32_t colour(int labelId) const
+    {
+        uint32_t off = static_cast<uint32_t>(labelId - minId);
+        if (off < colours.size())
+            return colours[off];
+        if (!sparse.empty())
+        {
+            auto it = sparse.find(labelId);
+            if (it != sparse.end())
+                return it->second;
+        }
+        return 0x00000000;
+    }
+};
+
+/// Build the label palette for @p vol.  Labels are ranked through the
+/// colour map (rank+1)*255/count when @p useColourMap is set, otherwise
+/// coloured from the per-label LUT (invisible labels transparent, unknown
+/// labels a deterministic gray).
+LabelPalette buildLabelPalette(const Volume& vol, const ColourTransfer& transfer,
+                               bool useColourMap = true);
+
 /// Result of rendering a single slice — a CPU pixel buffer.
 struct RenderedSlice
 {
@@ -53,6 +204,55 @@ RenderedSlice renderSlice(
     int viewIndex,
     int sliceIndex);
 
+/// Render a single 2D slice with a prebuilt colour transfer.  The label
+/// palette of a label volume is still built on every call; use the overload
+/// taking a LabelPalette when rendering many slices of one volume.
+RenderedSlice renderSlice(
+    const Volume& vol,
+    const ColourTransfer& transfer,
+    int viewIndex,
+    int sliceIndex);
+
+/// Render a single 2D slice with a prebuilt colour transfer and label
+/// palette.  A non-null @p palette colours the volume as a label volume;
+/// only the voxel data and dimensions of @p vol are read, so this is safe
+/// to call from a worker thread while the UI edits label state.
+RenderedSlice renderSlice(
+    const Volume& vol,
+    const ColourTransfer& transfer,
+    const LabelPalette* palette,
+    int viewIndex,
+    int sliceIndex);
+
+/// Colour indices of a single slice, for paletted textures: the colour of
+/// pixel i is palette[index i], with the palette from slicePalette().
+struct IndexedSlice
+{
+    std::vector<uint8_t> indices;   ///< width*height indices of indexBytes each
+    int width  = 0;
+    int height = 0;
+    int indexBytes = 1;             ///< 1 (uint8) or 2 (uint16, native endian)
+};
+
+/// Render the colour indices of a slice (same layout as renderSlice()).
+/// The indices depend only on the value range, log mode and voxel data, so
+/// colour-map, invert and clamp changes only need a new palette as long as
+/// transfer.indexBytes() stays the same.  @p indexBytes is normally
+/// transfer.indexBytes(); 2 is always exact.  Label volumes are not
+/// supported (empty result).
+IndexedSlice renderSliceIndices(
+    const Volume& vol,
+    const ColourTransfer& transfer,
+    int indexBytes,
+    int viewIndex,
+    int sliceIndex);
+
+/// Palette for indices of @p indexBytes width: the kLutSize colour-map
+/// entries (1 byte) or all kLutSize + 2 colour slots (2 bytes).
+/// @return the number of colours written to @p out.
+int slicePalette(const ColourTransfer& transfer, int indexBytes,
+                 uint32_t out[kLutSize + 2]);
+
 /// Render an overlay composite of multiple volumes at a given plane position.
 ///
 /// All volumes are resampled into volume 0's voxel grid and alpha-blended.
@@ -73,3 +273,18 @@ RenderedSlice renderOverlaySlice(
     int viewIndex,
     int sliceIndex,
     const TransformResult* transform = nullptr);
+
+/// Render an overlay composite with prebuilt per-volume colour transfers
+/// and label palettes.  @p transfers[i] is buildColourTransfer(params[i]);
+/// @p palettes[i] is the label palette of volume i, or nullptr if it is not
+/// a label volume.  Use this when rendering many slices of the same volumes
+/// (e.g. mosaics) so the tables and palettes are built only once; @p params
+/// only supplies the overlay alphas.
+RenderedSlice renderOverlaySlice(
+    const std::vector<const Volume*>& volumes,
+    const std::vector<VolumeRenderParams>& params,
+    const std::vector<ColourTransfer>& transfers,
+    const std::vector<const LabelPalette*>& palettes,
+    int viewIndex,
+    int sliceIndex,
+    const TransformResult* transform = nullptr);
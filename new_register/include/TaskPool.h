@@ -0,0 +1,57 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// Worker threads that run batches of independent tasks, for CPU work that
+/// the UI thread has to wait for anyway (e.g. colour-mapping every view
+/// after a QC row switch).
+///
+/// run() hands out the tasks of one batch to the workers and to the
+/// calling thread, and returns once all have finished, so a pool of N
+/// threads spreads a batch over N + 1 cores.  The threads start on the
+/// first run() with more than one task; a pool constructed before fork()
+/// (batch mode) therefore owns no threads yet.
+///
+/// Batches come from one thread at a time; tasks must not call run().
+class TaskPool {
+public:
+    using Task = std::function<void()>;
+
+    /// @p threads workers; 0 picks one per hardware thread, less the
+    /// calling thread.
+    explicit TaskPool(unsigned threads = 0);
+    ~TaskPool();
+
+    // Not copyable or movable (owns the worker threads).
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    /// Run every task of @p tasks and wait for them.  If a task throws,
+    /// the others still run and the first exception is rethrown here.
+    void run(std::vector<Task>& tasks);
+
+    /// Workers (not counting the calling thread).
+    unsigned threadCount() const { return threadCount_; }
+
+private:
+    void workerLoop();
+    void work(std::unique_lock<std::mutex>& lock);   // mutex_ held
+
+    unsigned threadCount_;
+
+    std::mutex mutex_;
+    std::condition_variable workCv_;   ///< a batch started or stop requested
+    std::condition_variable doneCv_;   ///< the batch's last task finished
+    std::vector<Task>* batch_ = nullptr;
+    size_t next_ = 0;                  ///< next task of batch_ to start
+    size_t done_ = 0;                  ///< tasks of batch_ finished
+    std::exception_ptr error_;
+    bool stop_ = false;
+    std::vector<std::thread> threads_;
+};
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/// Where an allocation lives inside an atlas page, in texels.  x/y/width/
+/// height cover the texture itself; the gutter around it is not included.
+struct AtlasRegion
+{
+    int page = -1;
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+};
+
+/// Shelf allocator for packing many small textures (slice views) into a
+/// few large square pages, so a backend needs one image, sampler and
+/// descriptor per page instead of one per texture.
+///
+/// Pages are split into horizontal shelves.  An allocation goes into the
+/// existing shelf with the least wasted height that has a wide enough
+/// free span, else into a new shelf at the bottom of the page.  Freed
+/// spans are merged and reused; shelves that empty out at the bottom of a
+/// page are returned to it.  Every allocation is surrounded by a gutter of
+/// unused texels, which the backend keeps cleared, so linear filtering at
+/// the edge of one texture never picks up its neighbours.
+///
+/// Holes left by freed allocations of other sizes are recovered by
+/// compact(), which repacks a page's live allocations into a fresh page.
+///
+/// The allocator does no GPU work: the backend creates a page image when
+/// addPage() opens one, and copies texels for each move compact() reports.
+/// Not thread-safe.
+class TextureAtlas
+{
+public:
+    using Handle = uint32_t;   ///< 0 = no allocation
+
+    /// One allocation moved by compact().
+    struct Move {
+        Handle handle = 0;
+        AtlasRegion from;
+        AtlasRegion to;
+    };
+
+    TextureAtlas(int pageSize, int maxPages, int gutter = 1);
+
+    int pageSize() const { return pageSize_; }
+    int maxPages() const { return maxPages_; }
+    int gutter() const { return gutter_; }
+
+    /// True if a w x h texture may be placed in the atlas at all.  Anything
+    /// larger than half a page in either dimension is not worth sharing.
+    bool accepts(int w, int h) const;
+
+    /// Place a w x h texture in one of the open pages.
+    /// @return 0 if it is not accepted or no open page has room.
+    Handle allocate(int w, int h);
+
+    /// Free an allocation (no-op for 0 or an already freed handle).
+    void release(Handle handle);
+
+    /// Region of a live allocation.
+    const AtlasRegion& region(Handle handle) const;
+
+    /// Region including the gutter, i.e. the texels that must be cleared
+    /// before the allocation is first shown.
+    AtlasRegion paddedRegion(Handle handle) const;
+
+    /// Open an empty page, reusing the slot of a closed one if possible.
+    /// @return the page index, or -1 if maxPages pages are already open.
+    int addPage();
+
+    /// Number of page slots (open or closed); page indices are below this.
+    int pageSlots() const { return static_cast<int>(pages_.size()); }
+
+    bool pageOpen(int page) const;
+
+    /// Live allocations in @p page.
+    int pageAllocations(int page) const;
+
+    /// Fraction of the page's area covered by live allocations (with
+    /// gutters), 0..1.
+    double pageOccupancy(int page) const;
+
+    /// The open page with the lowest occupancy whose live allocations,
+    /// repacked tightly, leave room for a w x h texture; -1 if none.
+    int compactionCandidate(int w, int h) const;
+
+    /// Repack the live allocations of @p page into a newly opened page and
+    /// close @p page.  Handles stay valid; region() reports the new place.
+    /// @return the moves, or an empty list (and nothing changed) if no page
+    ///         slot is free or the allocations do not repack.
+    std::vector<Move> compact(int page);
+
+private:
+    struct Span {
+        int x = 0;
+        int width = 0;
+    };
+
+    struct Shelf {
+        int y = 0;
+        int height = 0;
+        int live = 0;
+        std::vector<Span> free;  ///< sorted by x, never adjacent
+    };
+
+    struct Page {
+        bool open = false;
+        int top = 0;             ///< first row below the last shelf
+        int live = 0;
+        int64_t usedArea = 0;    ///< padded area of live allocations
+        std::vector<Shelf> shelves;
+    };
+
+    struct Entry {
+        AtlasRegion region;
+        int shelf = -1;
+        bool live = false;
+    };
+
+    /// Best place for a padded pw x ph allocation in @p p: shelf index and
+    /// span index, shelf == -1 for a new shelf.  False if it does not fit.
+    bool findSpot(const Page& p, int pw, int ph, int& shelf, int& span, int& waste) const;
+
+    /// Carve a padded pw x ph allocation at the spot from findSpot().
+    /// @return shelf index and sets @p x / @p y to the padded origin.
+    int place(Page& p, int shelf, int span, int pw, int ph, int& x, int& y) const;
+
+    /// Return the padded span at @p x to @p shelf of @p p.
+    void unplace(Page& p, int shelf, int x, int pw, int ph) const;
+
+    /// True if padded sizes @p sizes (sorted by decreasing height) all fit
+    /// into an empty page.
+    bool packs(const std::vector<std::pair<int, int>>& sizes) const;
+
+    Handle newHandle();
+
+    int pageSize_;
+    int maxPages_;
+    int gutter_;
+    std::vector<Page> pages_;
+    std::vector<Entry> entries_;       ///< indexed by handle - 1
+    std::vector<Handle> freeHandles_;
+};
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "SliceRenderer.h"
+
+class Volume;
+
+/// Low-resolution mid-slice thumbnails of QC volumes, rendered on a
+/// background thread and kept in a cache file (next to the QC output CSV)
+/// across sessions, so the QC thumbnail panel can show every row without
+/// switching to it.
+///
+/// A thumbnail is the axial mid-slice rendered with renderSlice() and
+/// box-filtered into a size x size square, keeping the voxel aspect.  It
+/// is keyed by volume path and remembers the render parameters and the
+/// file's size and modification time: entries read from the cache file are
+/// re-checked against the file when first requested, and re-rendered if
+/// the file or the column's colours changed.
+///
+/// The worker thread starts on the first request(), so a cache created
+/// before fork() owns no thread.  All methods are thread-safe.
+class ThumbnailCache {
+public:
+    /// Reads a volume, or at least its middle axial slice (a thumbnail
+    /// shows slice dimensions.z / 2); throws on failure.  Called on the
+    /// worker.
+    using LoadFn = std::function<Volume(const std::string& path)>;
+
+    struct Thumbnail {
+        std::vector<uint32_t> pixels;   ///< packed 0xAABBGGRR, top row first
+        int width = 0;                  ///< 0 if the volume could not be read
+        int height = 0;
+    };
+    using ThumbnailPtr = std::shared_ptr<const Thumbnail>;
+
+    /// One volume to show: its path and how its column is coloured.
+    struct Request {
+        std::string path;
+        VolumeRenderParams params;
+        bool autoRange = true;   ///< use the volume's range, not params.value*
+    };
+
+    struct Stats {
+        int rendered = 0;   ///< thumbnails rendered this session
+        int fromFile = 0;   ///< entries read from the cache file
+        int failed = 0;
+    };
+
+    /// Thumbnail edge in pixels.
+    static constexpr int kDefaultSize = 96;
+
+    /// Rendered thumbnails between saves of the cache file by the worker.
+    static constexpr int kSaveEvery = 200;
+
+    explicit ThumbnailCache(LoadFn load, int size = kDefaultSize);
+    ~ThumbnailCache();
+
+    // Not copyable or movable (owns the worker thread).
+    ThumbnailCache(const ThumbnailCache&) = delete;
+    ThumbnailCache& operator=(const ThumbnailCache&) = delete;
+
+    /// Read the thumbnails of cache file @p path, which save() writes from
+    /// then on.  A missing, foreign or damaged file is ignored (false).
+    bool open(const std::string& path);
+
+    /// Write all thumbnails to the cache file if any were rendered since
+    /// the last save.  Returns false on I/O errors.
+    bool save();
+
+    /// Render @p requests, most urgent first.  Replaces the requests of
+    /// the previous call that have not started yet.
+    void request(const std::vector<Request>& requests);
+
+    /// The thumbnail for @p request if it is up to date, else null.  A
+    /// volume that could not be read has a thumbnail of size 0.
+    ThumbnailPtr find(const Request& request) const;
+
+    /// Called on the worker after each thumbnail (e.g. to wake the main
+    /// loop).
+    void setNotify(std::function<void()> notify);
+
+    int size() const { return size_; }
+    Stats stats() const;
+
+    /// Render the thumbnail of @p vol for @p request.
+    static Thumbnail render(const Volume& vol, const Request& request, int size);
+
+    /// Box-filter @p slice into at most @p size x @p size pixels, with
+    /// pixels @p aspect times as wide as high.  Slices smaller than that
+    /// are only stretched to the aspect.
+    static Thumbnail downsample(const RenderedSlice& slice, double aspect, int size);
+
+    /// Hash of what a thumbnail's colours depend on.
+    static uint64_t requestHash(const Request& request);
+
+private:
+    struct Entry {
+        ThumbnailPtr thumbnail;
+        uint64_t hash = 0;         ///< requestHash() it was rendered for
+        int64_t fileTime = 0;      ///< volume file's modification time
+        uint64_t fileSize = 0;
+        bool checked = false;      ///< file time and size verified
+    };
+
+    void run();
+    bool current(const Entry& e, const Request& r) const;   // mutex_ held
+    std::vector<uint8_t> serialize() const;                  // mutex_ held
+    bool writeFile();                                        // mutex_ not held
+    void notify();
+
+    LoadFn load_;
+    const int size_;
+
+    std::mutex saveMutex_;             ///< one writer of the cache file at a time
+    mutable std::mutex mutex_;
+    std::condition_variable workCv_;   ///< queue filled or stop requested
+    std::unordered_map<std::string, Entry> entries_;
+    std::deque<Request> queue_;        ///< most urgent first
+    std::string cachePath_;
+    int unsaved_ = 0;                  ///< thumbnails rendered since save()
+    bool stop_ = false;
+    Stats stats_;
+    std::function<void()> notify_;
+
+    std::thread worker_;   ///< started on the first request()
+};
@@ -1,18 +1,27 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
+#include <memory>
 #include <unordered_map>
 #include <vector>
 
 #include <glm/glm.hpp>
 
 #include "AppState.h"
+#include "SliceCache.h"
+#include "SliceRenderer.h"
+#include "TaskPool.h"
 
 class GraphicsBackend;
+struct IndexTexture;
+struct Texture;
+struct VolumeTexture;
 
 class ViewManager {
 public:
     ViewManager(AppState& state, GraphicsBackend& backend);
+    ~ViewManager();
 
     void updateSliceTexture(int volumeIndex, int viewIndex);
     void updateOverlayTexture(int viewIndex);
@@ -23,27 +32,176 @@ public:
     void resetViews();
 
     /// Create/update slice textures for all loaded volumes and overlay.
-    /// Skips placeholder volumes (empty data).
+    /// Skips placeholder volumes (empty data).  The slices and overlay
+    /// bands are rendered in parallel; the uploads follow in one batch.
     void initializeAllTextures();
 
-    /// Destroy all slice textures and overlay textures.
+    /// Destroy all slice textures and overlay textures (also clears the
+    /// slice cache, see clearSliceCache()).
     void destroyAllTextures();
 
+    /// Like destroyAllTextures(), but keep the slice and overlay textures
+    /// aside while the volumes are replaced.  reattachTextures() then hands
+    /// them to the new volumes' views (by column), where
+    /// initializeAllTextures() updates same-sized ones in place instead of
+    /// recreating them.
+    void detachTextures();
+    void reattachTextures();
+
+    /// Whether a view is on screen, reported by the Interface each frame.
+    /// Updates of views that are not drawn (plane hidden, column collapsed
+    /// or clipped, overlay panel closed) are deferred: the view is marked
+    /// stale and regenerated as soon as it is reported drawn again.  Views
+    /// count as drawn until reported otherwise.
+    void setViewDrawn(int volumeIndex, int viewIndex, bool drawn);
+    void setOverlayViewDrawn(int viewIndex, bool drawn);
+
+    /// True if the view's texture is behind its state (update deferred).
+    bool isViewStale(int volumeIndex, int viewIndex) const;
+    bool isOverlayViewStale(int viewIndex) const;
+
+    /// Cancel background slice renders and drop all cached slices.  Must be
+    /// called before the loaded volumes are replaced: prefetch jobs read
+    /// volume data from a worker thread.
+    void clearSliceCache();
+
     static void sliceIndicesToWorld(const Volume& vol, const int indices[3], double world[3]);
     static void worldToSliceIndices(const Volume& vol, const double world[3], int indices[3]);
 
-    /// Invalidate label-to-index cache for a volume (call when colour map changes)
+    /// Invalidate the label palette for a volume (call when the colour map
+    /// changes or the volume is replaced).
     void invalidateLabelCache(int volumeIndex);
 
 private:
+    /// A view update split into its parts: prepare*() on the UI thread
+    /// (state, caches, GPU paths), the CPU rendering on the task pool, and
+    /// finish*() back on the UI thread for the upload.  Defined in
+    /// ViewManager.cpp.
+    struct SliceUpdate;
+    struct OverlayUpdate;
+
+    /// False if there is nothing left to render or upload (view hidden,
+    /// volume empty, or drawn on the GPU).  Otherwise @p u holds the cached
+    /// slice, or what is needed to render it when u.slice is null.
+    bool prepareSliceUpdate(int volumeIndex, int viewIndex, SliceUpdate& u);
+    void finishSliceUpdate(SliceUpdate& u);
+
+    /// Same for the overlay: false if it was drawn on the GPU or there is
+    /// nothing to draw.
+    bool prepareOverlayUpdate(int viewIndex, OverlayUpdate& u);
+    void finishOverlayUpdate(OverlayUpdate& u);
+
+    /// Append tasks blending @p u in bands of kOverlayBandRows rows.
+    static void addOverlayBandTasks(OverlayUpdate& u, std::vector<TaskPool::Task>& tasks);
+
+    /// Precomposed colour transfer for a volume's current view state;
+    /// rebuilt only when range, colour map, log, invert or clamp modes change.
+    const ColourTransfer& colourTransfer(int volumeIndex);
+
+    /// Dense label palette for a label volume; rebuilt when the volume's
+    /// content (Volume::contentVersion()) or the colour transfer changes.
+    const LabelPalette& labelPalette(int volumeIndex, const ColourTransfer& transfer);
+
+    /// Queue background renders of the slices around @p sliceIndex, ahead in
+    /// the direction the view was last scrolled.
+    void prefetchNeighbourSlices(int volumeIndex, int viewIndex, int sliceIndex,
+                                 uint64_t paramsHash);
+
+    /// GPU slicing (AppState::gpuSlicing_): the volume's 3D texture, uploaded
+    /// on first use and again whenever the volume's content version changes.
+    /// Returns nullptr when the backend cannot slice on the GPU.
+    const VolumeTexture* volumeTexture(int volumeIndex);
+
+    /// Render one slice of a volume in the backend's shader.  Returns false
+    /// (nothing rendered) when GPU slicing is off or unavailable.
+    bool renderSliceOnGpu(int volumeIndex, int viewIndex, int sliceIndex,
+                          const ColourTransfer& transfer);
+
+    /// Paletted slices (AppState::palettedSlices_): upload the slice's colour
+    /// indices only when the slice, value range, log mode or data changed,
+    /// then apply the transfer's palette on the GPU.  Returns false (nothing
+    /// rendered) when paletted slices are off or unavailable.
+    bool renderSlicePaletted(int volumeIndex, int viewIndex, int sliceIndex,
+                             const ColourTransfer& transfer);
+
+    /// Make @p tex a w x h texture, (re)creating it without pixel data.
+    void ensureRenderTarget(std::unique_ptr<Texture>& tex, int w, int h);
+
+    /// Release the GPU volumes and index textures and clear the slice cache
+    /// (everything destroyAllTextures() frees besides the view textures).
+    void releaseVolumeResources();
+
+    /// Drawn / stale flags of the three views of one column.
+    struct ViewVisibility {
+        std::array<bool, 3> drawn{{true, true, true}};
+        std::array<bool, 3> stale{{false, false, false}};
+    };
+
+    /// Visibility of a volume's views, growing the table on demand.
+    ViewVisibility& sliceVisibility(int volumeIndex);
+
+    /// Slices pre-rendered ahead of / behind the scroll direction.
+    static constexpr int kSlicePrefetchAhead = 6;
+    static constexpr int kSlicePrefetchBehind = 2;
+
+    /// Rows of the overlay blended per task.
+    static constexpr int kOverlayBandRows = 64;
+
     AppState& state_;
     GraphicsBackend& backend_;
 
-    /// Reusable pixel buffer to avoid per-call allocation.
-    std::vector<uint32_t> pixelBuf_;
+    /// Reusable overlay pixel buffers, one per view so that all three can
+    /// be blended at once.
+    std::array<std::vector<uint32_t>, 3> overlayPixels_;
+
+    /// Cache of label palettes, keyed by volume index.
+    struct CachedPalette {
+        VolumeRenderParams params;  ///< transfer parameters at build time
+        std::shared_ptr<const LabelPalette> palette;
+    };
+    std::unordered_map<int, CachedPalette> labelPaletteCache_;
+
+    /// Cache of colour transfers, keyed by volume index.
+    std::unordered_map<int, std::shared_ptr<const ColourTransfer>> transferCache_;
+
+    /// GPU-resident volumes, keyed by volume index.
+    struct GpuVolume {
+        uint64_t version = 0;                  ///< Volume::contentVersion() at upload
+        std::unique_ptr<VolumeTexture> texture;  ///< null if the upload failed
+    };
+    std::unordered_map<int, GpuVolume> gpuVolumes_;
+
+    /// Uploaded index texture of one view and what its indices encode.
+    struct IndexedView {
+        std::unique_ptr<IndexTexture> texture;
+        int sliceIndex = -1;
+        float rangeMin = 0.0f;
+        float rangeMax = 0.0f;
+        bool useLog = false;
+        uint64_t version = 0;   ///< Volume::contentVersion() at upload
+    };
+    /// Paletted slice views, keyed by volume index.
+    std::unordered_map<int, std::array<IndexedView, 3>> indexedViews_;
+
+    /// Last slice index per view, keyed by volume index (scroll direction).
+    struct SliceScroll {
+        std::array<int, 3> lastSlice{{-1, -1, -1}};
+    };
+    std::unordered_map<int, SliceScroll> sliceScroll_;
+
+    /// Per-volume view visibility (by volume index) and the overlay's.
+    std::vector<ViewVisibility> sliceVisibility_;
+    ViewVisibility overlayVisibility_;
+
+    /// View textures held by detachTextures() until reattachTextures().
+    std::vector<std::array<std::unique_ptr<Texture>, 3>> detachedSlices_;
+    std::array<std::unique_ptr<Texture>, 3> detachedOverlay_;
+
+    /// Threads that render slices and overlay bands for
+    /// initializeAllTextures() and overlay updates.
+    TaskPool taskPool_;
 
-    /// Cache for label-to-index mapping in label mode with colour map
-    /// Key: volume index, Value: map of labelId -> index in colour map
-    std::unordered_map<int, std::unordered_map<int, int>> labelToIndexCache_;
-    std::unordered_map<int, size_t> labelCacheSize_;
+    /// Rendered slices plus the background prefetch worker.  Declared last
+    /// so its worker thread is joined first on destruction.
+    SliceCache sliceCache_;
 };
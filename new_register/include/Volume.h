@@ -3,6 +3,8 @@
 #include <vector>
 #include <string>
 #include <array>
+#include <cstdint>
+#include <mutex>
 #include <unordered_map>
 #include <stdexcept>
 
@@ -16,6 +18,12 @@ struct LabelInfo {
     std::string name;
 };
 
+/// Serialises calls into libminc, which (with HDF5 underneath) is not
+/// thread-safe.  MINC volume loads, tag files and .xfm transforms hold it,
+/// so volumes can be read on background threads while the UI thread reads
+/// tags.  NIfTI loads do not take it.
+std::mutex& libmincMutex();
+
 class Volume {
 public:
     glm::ivec3 dimensions{0, 0, 0};  // X, Y, Z voxel counts
@@ -55,6 +63,12 @@ public:
     /// Load a MINC2 volume from disk.
     /// @throws std::runtime_error on any failure (file not found, bad format, etc.)
     void load(const std::string& filename);
+
+    /// Load only the middle slice along Z as a one-slice volume (for
+    /// thumbnails).  MINC files read just that slab, so libmincMutex() is
+    /// held for one slice rather than the whole volume.
+    /// @throws std::runtime_error as load()
+    void loadMidAxialSlice(const std::string& filename);
     float get(int x, int y, int z) const;
     float computeQuantile(double q) const;
 
@@ -98,17 +112,37 @@ public:
     TagWrapper tags;
 
     bool isLabelVolume() const { return isLabelVolume_; }
-    void setLabelVolume(bool val) { isLabelVolume_ = val; }
+    void setLabelVolume(bool val);
     void setLabelDescriptionFile(const std::string& path);
     const std::unordered_map<int, LabelInfo>& getLabelLUT() const { return labelLUT_; }
     const LabelInfo* getLabelInfo(int labelId) const;
+
+    /// Sorted unique non-zero label ids.  The full-volume scan runs once and
+    /// is cached until the voxel data or the label flag changes.
     std::vector<int> getUniqueLabelIds() const;
     std::string getLabelNameAtVoxel(int x, int y, int z) const;
 
+    /// Process-unique stamp, renewed whenever the voxel data or anything
+    /// affecting label colours (label LUT, label flag) changes, and for every
+    /// new or reassigned Volume.  Palette and slice caches compare it.
+    uint64_t contentVersion() const { return contentVersion_; }
+
 private:
+    /// Read a MINC2 file: the whole volume, or only the middle Z slice.
+    void loadMinc(const std::string& filename, bool midAxialSlice);
+
+    /// Drop the cached unique label ids and renew contentVersion_.
+    void contentChanged();
+    static uint64_t nextContentVersion();
+
     bool isLabelVolume_ = false;
     std::string labelDescriptionFile_;
     std::unordered_map<int, LabelInfo> labelLUT_;
+    uint64_t contentVersion_ = nextContentVersion();
+
+    mutable std::mutex labelIdsMutex_;
+    mutable std::vector<int> uniqueLabelIds_;
+    mutable bool uniqueLabelIdsValid_ = false;
 
 public:
     void loadLabelDescriptionFile(const std::string& path);
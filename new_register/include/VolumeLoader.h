@@ -0,0 +1,76 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Volume.h"
+
+/// Reads a list of volume files on background threads, so the window and
+/// graphics backend can start up while the data is still being decoded.
+///
+/// NIfTI files are read concurrently (up to one thread per hardware
+/// thread).  MINC files are read one after another on a single thread:
+/// libminc and HDF5 are not thread-safe, and each read holds
+/// libmincMutex(), which the main thread's tag and transform I/O would
+/// wait on until done() returns true.
+///
+/// Results are handed to the main thread through takeLoaded(), in
+/// completion order.  The destructor waits for loads already running.
+class VolumeLoader {
+public:
+    struct Result {
+        size_t index = 0;        ///< position in the path list
+        std::string path;
+        Volume volume;           ///< empty (no data) if loading failed
+        std::string error;       ///< failure message, empty on success
+    };
+
+    /// Start loading @p paths.  Empty paths finish immediately with an
+    /// error.
+    explicit VolumeLoader(std::vector<std::string> paths);
+    ~VolumeLoader();
+
+    // Not copyable or movable (owns the loader threads).
+    VolumeLoader(const VolumeLoader&) = delete;
+    VolumeLoader& operator=(const VolumeLoader&) = delete;
+
+    /// Call @p notify from the loader thread after each volume finishes
+    /// (e.g. to wake the main loop).  Called at once if results are
+    /// already waiting.
+    void setNotify(std::function<void()> notify);
+
+    /// Volumes finished since the last call.
+    std::vector<Result> takeLoaded();
+
+    /// True once every volume has finished and been taken.
+    bool done() const;
+
+    /// Block until every volume has finished loading.
+    void waitAll();
+
+    size_t total() const { return total_; }
+
+private:
+    void loadSequential(std::vector<size_t> indices);
+    void loadShared();
+    void load(size_t index);
+
+    const std::vector<std::string> paths_;
+    const size_t total_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable finishedCv_;
+    std::vector<Result> loaded_;       ///< finished, not yet taken
+    size_t finished_ = 0;
+    size_t taken_ = 0;
+    std::function<void()> notify_;
+
+    std::vector<size_t> sharedQueue_;  ///< NIfTI indices, any thread
+    size_t sharedNext_ = 0;
+    std::vector<std::thread> threads_;
+};
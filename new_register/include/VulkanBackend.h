@@ -1,6 +1,7 @@
 #pragma once
 
 #include "GraphicsBackend.h"
+#include "TextureAtlas.h"
 #include "VulkanHelpers.h"
 
 #define GLFW_INCLUDE_NONE
@@ -9,7 +10,13 @@
 #include <vulkan/vulkan.h>
 #include <backends/imgui_impl_vulkan.h>
 
+#include <deque>
+#include <functional>
 #include <map>
+#include <memory>
+#include <vector>
+
+class VulkanVolumeSlicer;
 
 /// Vulkan implementation of the GraphicsBackend interface.
 /// Owns all Vulkan handles (instance, device, pools, swapchain window data)
@@ -43,6 +50,10 @@ public:
     void setFontConfig(const std::string& fontPath, float fontSize) override;
 
     std::vector<uint8_t> captureScreenshot(int& width, int& height) override;
+    bool supportsAsyncCapture() const override;
+    uint64_t requestCapture() override;
+    bool takeCapture(std::vector<uint8_t>& pixels, int& width, int& height,
+                     uint64_t& id) override;
 
     // --- Texture management ---
     std::unique_ptr<Texture> createTexture(int w, int h, const void* data) override;
@@ -50,6 +61,17 @@ public:
     void destroyTexture(Texture* tex) override;
     void shutdownTextureSystem() override;
 
+    // --- GPU volume slicing ---
+    bool supportsVolumeSlicing() const override;
+    std::unique_ptr<VolumeTexture> createVolumeTexture(
+        int dimX, int dimY, int dimZ, const float* data) override;
+    void destroyVolumeTexture(VolumeTexture* vt) override;
+    bool renderVolumeSlice(Texture* tex, const VolumeSliceLayer* layers,
+                           int count, bool blend) override;
+
+    /// Texture upload counters of the last rendered frame.
+    const VulkanHelpers::UploadStats& lastFrameUploadStats() const { return uploadStats_; }
+
 private:
     // --- Vulkan handles ---
     VkAllocationCallbacks*   allocator_       = nullptr;
@@ -60,6 +82,8 @@ private:
     VkQueue                  queue_           = VK_NULL_HANDLE;
     VkDebugReportCallbackEXT debugReport_     = VK_NULL_HANDLE;
     VkPipelineCache          pipelineCache_   = VK_NULL_HANDLE;
+    std::string              pipelineCachePath_;      ///< empty = not persisted
+    std::vector<uint8_t>     pipelineCacheLoaded_;    ///< data restored at startup
     VkDescriptorPool         descriptorPool_  = VK_NULL_HANDLE;
     VkCommandPool            commandPool_     = VK_NULL_HANDLE;
     VkSurfaceKHR             surface_         = VK_NULL_HANDLE;
@@ -70,20 +94,125 @@ private:
     float                    contentScale_    = 1.0f;
     float                    framebufferScale_= 1.0f;
     bool                     manualScale_     = false;
+    VkImageUsageFlags        swapchainUsage_  = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
     GLFWwindow*              window_          = nullptr;
     std::string              fontPath_;
     float                    fontSize_        = 13.0f;
 
     /// Map from ImTextureID to internal VulkanTexture, for update/destroy.
+    /// Holds the textures too large for the atlas.
     std::map<ImTextureID, std::unique_ptr<VulkanTexture>> vulkanTextures_;
 
+    // --- Texture atlas ---
+    // Slice-sized textures are sub-allocated from a few large page images,
+    // so a column layout draws with one descriptor set per page instead of
+    // one per view, and creating a texture rarely allocates device memory.
+
+    static constexpr int kAtlasPageSize = 2048;
+    static constexpr int kMaxAtlasPages = 4;
+
+    TextureAtlas atlas_{kAtlasPageSize, kMaxAtlasPages};
+    std::vector<std::unique_ptr<VulkanTexture>> atlasPages_;   ///< by atlas page index
+    std::map<Texture*, TextureAtlas::Handle> atlasTextures_;
+
+    // --- Frame completion ---
+    // ImGui's per-frame fences are indexed by swapchain image, so they say
+    // nothing about frame order. Each submitted frame is followed by an
+    // empty submit signalling one of our own fences; once it has signalled,
+    // every frame up to and including that one has finished on the GPU.
+
+    struct FrameFence {
+        VkFence  fence = VK_NULL_HANDLE;
+        uint64_t frame = 0;   ///< frameCount_ after the submit
+    };
+    std::deque<FrameFence> frameFences_;     ///< in flight, oldest first
+    std::vector<VkFence>   freeFences_;
+    uint64_t frameCount_     = 0;   ///< frames submitted
+    uint64_t completedFrames_ = 0;  ///< frames known to have finished
+
+    /// Queue a fence behind the frame just submitted.
+    void signalFrameFence();
+    /// Advance completedFrames_ past every signalled fence; with idle set
+    /// the device has been waited on, so all submitted frames are complete.
+    void pollFrameFences(bool idle);
+    void destroyFrameFences();
+
+    // --- Deferred destruction ---
+    // Resources released while submitted frames (or draw data recorded
+    // earlier in the current frame) may still sample them are freed once
+    // the fence behind the next submitted frame has signalled, so releasing
+    // textures never waits for the GPU.
+
+    struct DeferredRelease {
+        uint64_t frame = 0;   ///< frameCount_ when queued
+        std::function<void()> release;
+    };
+    std::deque<DeferredRelease> deferredReleases_;
+
+    VulkanHelpers::UploadStats uploadStats_;
+
+    /// Compute-shader slicer, probed on first use (the pipeline is only
+    /// built when GPU slicing is requested).
+    VulkanVolumeSlicer* slicer() const;
+    mutable std::unique_ptr<VulkanVolumeSlicer> slicer_;
+    mutable bool slicerProbed_ = false;
+
+    // --- Asynchronous capture ---
+    // requestCapture() makes frameRender() append a copy of the swapchain
+    // image into one of a few persistently mapped host buffers.  The pixels
+    // are read out once the fence behind that frame has signalled, so
+    // capturing never waits for the GPU.
+
+    /// More than the frames in flight, so recording every frame keeps a
+    /// free slot; buffers are only allocated when first used.
+    static constexpr int kCaptureSlots = 6;
+
+    struct CaptureSlot {
+        VkBuffer       buffer   = VK_NULL_HANDLE;
+        VkDeviceMemory memory   = VK_NULL_HANDLE;
+        void*          mapped   = nullptr;
+        VkDeviceSize   capacity = 0;
+        int            width    = 0;
+        int            height   = 0;
+        bool           swizzle  = false;   ///< BGRA surface
+        bool           pending  = false;   ///< copy recorded, not yet taken
+        uint64_t       frame    = 0;       ///< frameCount_ when recorded
+        uint64_t       id       = 0;
+    };
+    CaptureSlot captureSlots_[kCaptureSlots];
+    std::deque<int> pendingCaptures_;      ///< slot indices, oldest first
+    uint64_t requestedCapture_ = 0;        ///< id to record this frame, 0 = none
+    uint64_t lastCaptureId_    = 0;
+
     // --- Private helpers ---
     void createInstance(const char** extensions, uint32_t extensionCount);
     void createDevice();
+    /// Create pipelineCache_, restoring it from the user cache directory
+    /// if the file there was written by the same device and driver.
+    void createPipelineCache();
+    /// Write pipelineCache_ back if pipelines were added, then destroy it.
+    void savePipelineCache();
     void createSwapchainWindow(int width, int height);
 
     void frameRender(ImDrawData* drawData);
+
+    /// Atlas region for a w x h texture, compacting a fragmented page or
+    /// opening a new one if needed.  0 if the texture goes standalone.
+    TextureAtlas::Handle allocateAtlasRegion(int w, int h);
+    void createAtlasPage(int page);
+    bool compactAtlasPage(int page);
+    /// Point @p tex at its atlas page and sub-rectangle.
+    void applyAtlasRegion(Texture* tex, TextureAtlas::Handle handle);
+    /// Queue @p release to run once no frame in flight can use the resource.
+    void deferRelease(std::function<void()> release);
+    /// Run the queued releases that are due (all of them if @p idle).
+    void runDeferredReleases(bool idle);
     void framePresent();
 
+    bool ensureCaptureBuffer(CaptureSlot& slot, VkDeviceSize size);
+    /// Record a copy of @p image (after the render pass) into a free slot.
+    void recordCapture(VkCommandBuffer cmd, VkImage image, uint64_t id);
+    void destroyCaptureSlots();
+
     static void checkVkResult(VkResult err);
 };
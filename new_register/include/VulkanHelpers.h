@@ -2,6 +2,7 @@
 #include <vulkan/vulkan.h>
 #include <imgui.h>
 #include <memory>
+#include <vector>
 
 class VulkanTexture {
 public:
@@ -19,15 +20,47 @@ public:
     /// VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL).
     bool uploaded = false;
 
+    /// Upload batch that last copied into this image (0 = none); destroying
+    /// the texture waits for that batch.
+    uint64_t uploadSerial = 0;
+
     ~VulkanTexture();
 
     void cleanup(VkDevice device);
 };
 
 namespace VulkanHelpers {
+    /// Texture upload counters, accumulated between TakeUploadStats() calls.
+    struct UploadStats {
+        uint32_t copies = 0;     ///< texture copies recorded
+        uint32_t submits = 0;    ///< vkQueueSubmit calls for uploads
+        uint32_t stalls = 0;     ///< ring slots that were still in flight when reused
+        VkDeviceSize bytes = 0;  ///< pixel bytes staged
+    };
+
     void Init(VkDevice device, VkPhysicalDevice physical_device, uint32_t queue_family, VkQueue queue, VkDescriptorPool pool, VkCommandPool command_pool);
     void Shutdown();
     std::unique_ptr<VulkanTexture> CreateTexture(int w, int h, const void* data);
+    /// Stage @p data and record its copy into the current upload batch.
+    /// Nothing is submitted until FlushUploads().
     void UpdateTexture(VulkanTexture* texture, const void* data);
+    /// As UpdateTexture(), for the w x h rectangle at (x, y) only (@p data
+    /// holds w*h*4 bytes).  A null @p data clears the rectangle to zero.
+    void UpdateTextureRegion(VulkanTexture* texture, int x, int y, int w, int h,
+                             const void* data);
+    /// Record image-to-image copies from @p src into @p dst (different
+    /// textures) into the current upload batch.
+    void CopyTextureRegions(VulkanTexture* src, VulkanTexture* dst,
+                            const std::vector<VkImageCopy>& regions);
+    /// Submit the recorded copies (if any) in one batch.  Call once per
+    /// frame before submitting the frame that samples the textures.
+    void FlushUploads();
+    /// Command buffer of the current upload batch, opened if needed, for
+    /// other work that writes textures (e.g. GPU slicing).  @p serial
+    /// receives the batch; see BatchComplete().
+    VkCommandBuffer BatchCommandBuffer(uint64_t& serial);
+    /// True once the batch @p serial has been submitted and has completed.
+    bool BatchComplete(uint64_t serial);
+    UploadStats TakeUploadStats();
     void DestroyTexture(VulkanTexture* texture);
 }
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "GraphicsBackend.h"
+
+class VulkanTexture;
+
+/// GPU volume slicing for the Vulkan backend.
+///
+/// The Vulkan counterpart of GLVolumeSlicer: volumes live in R32_SFLOAT 3D
+/// images and a compute shader (src/shaders/volume_slice.comp) extracts the
+/// slice, applies range/log/clamp colour mapping through per-layer colour
+/// slots and (for overlays) blends up to kMaxVolumeSliceLayers volumes,
+/// writing into a rectangle of an RGBA8 VulkanTexture (an atlas page or a
+/// standalone texture).
+///
+/// Dispatches are recorded into the current VulkanHelpers upload batch, so
+/// they are submitted with the frame's texture copies and ordered before
+/// the draw that samples them.  Descriptor sets and layer parameters come
+/// from per-batch arenas that are recycled once their batch has completed,
+/// and destroyed volumes are kept until the last batch reading them is done.
+///
+/// The SPIR-V is compiled by glslc at build time (HAS_VOLUME_SLICE_SPIRV);
+/// without it initialize() fails and callers keep using the CPU renderer.
+/// VulkanHelpers::Init() must have been called.  Not thread-safe.
+class VulkanVolumeSlicer
+{
+public:
+    VulkanVolumeSlicer() = default;
+    ~VulkanVolumeSlicer() = default;
+
+    VulkanVolumeSlicer(const VulkanVolumeSlicer&) = delete;
+    VulkanVolumeSlicer& operator=(const VulkanVolumeSlicer&) = delete;
+
+    /// Check capabilities and build the compute pipeline.  @p queue must be
+    /// the queue VulkanHelpers submits to.  Returns false if the build has
+    /// no shader, or the queue or formats lack what slicing needs.
+    bool initialize(VkPhysicalDevice physicalDevice, VkDevice device,
+                    uint32_t queueFamily, VkQueue queue,
+                    VkPipelineCache pipelineCache = VK_NULL_HANDLE);
+
+    /// Wait for the device and release all Vulkan objects.
+    void shutdown();
+
+    /// True if initialize() succeeded.
+    bool supported() const { return pipeline_ != VK_NULL_HANDLE; }
+
+    /// Upload a volume into a 3D image; waits for the copy to complete.
+    /// @return nullptr if unsupported or the volume does not fit.
+    std::unique_ptr<VolumeTexture> createVolumeTexture(int dimX, int dimY, int dimZ,
+                                                       const float* data);
+    void destroyVolumeTexture(VolumeTexture* vt);
+
+    /// Record the rendering of @p count layers into the w x h rectangle at
+    /// (x, y) of @p target.  See GraphicsBackend::renderVolumeSlice().
+    bool render(VulkanTexture* target, int x, int y, int w, int h,
+                const VolumeSliceLayer* layers, int count, bool blend);
+
+private:
+    /// A volume's 3D image; VolumeTexture::id points at it.
+    struct VolumeImage {
+        VkImage        image  = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkImageView    view   = VK_NULL_HANDLE;
+        uint64_t       serial = 0;   ///< last upload batch that read it
+    };
+
+    /// Descriptor sets and parameter buffer for the dispatches of one
+    /// upload batch.
+    struct Arena {
+        VkDescriptorPool pool   = VK_NULL_HANDLE;
+        VkBuffer         buffer = VK_NULL_HANDLE;
+        VkDeviceMemory   memory = VK_NULL_HANDLE;
+        void*            mapped = nullptr;
+        int              used   = 0;   ///< dispatches recorded
+        uint64_t         serial = 0;   ///< batch the dispatches are in
+    };
+
+    /// Dispatches per arena before another one is opened.
+    static constexpr int kArenaDispatches = 64;
+
+    /// Arena with room for a dispatch in batch @p serial (nullptr on failure).
+    Arena* arena(uint64_t serial);
+    bool createArena(Arena& a);
+    void destroyArena(Arena& a);
+    void destroyVolumeImage(VolumeImage& vi);
+    /// Free the destroyed volumes whose last batch has completed.
+    void collectRetired();
+    uint32_t findMemoryType(uint32_t typeBits, VkMemoryPropertyFlags properties) const;
+
+    VkPhysicalDevice      physicalDevice_ = VK_NULL_HANDLE;
+    VkDevice              device_         = VK_NULL_HANDLE;
+    VkQueue               queue_          = VK_NULL_HANDLE;
+    VkCommandPool         commandPool_    = VK_NULL_HANDLE;   ///< volume uploads
+    VkSampler             sampler_        = VK_NULL_HANDLE;
+    VkDescriptorSetLayout setLayout_      = VK_NULL_HANDLE;
+    VkPipelineLayout      pipelineLayout_ = VK_NULL_HANDLE;
+    VkPipeline            pipeline_       = VK_NULL_HANDLE;
+    uint32_t              max3DSize_      = 0;
+    VkDeviceSize          paramStride_    = 0;   ///< bytes per dispatch in an arena
+
+    std::vector<std::unique_ptr<Arena>> arenas_;
+    std::map<VolumeImage*, std::unique_ptr<VolumeImage>> volumes_;
+    std::vector<std::unique_ptr<VolumeImage>> retired_;
+};
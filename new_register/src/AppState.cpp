@@ -1,6 +1,7 @@
 #include "AppState.h"
 
 #include <algorithm>
+#include <chrono>
 #include <cstdio>
 #include <filesystem>
 #include <iostream>
@@ -13,14 +14,20 @@
 
 // --- VolumeCache implementation ---
 
-Volume* VolumeCache::get(const std::string& path) {
+bool VolumeCache::get(const std::string& path, Volume& out) {
     std::lock_guard<std::mutex> lk(mutex_);
     auto it = map_.find(path);
     if (it == map_.end())
-        return nullptr;
+        return false;
     // Move accessed entry to front of LRU list
     lru_.splice(lru_.begin(), lru_, it->second);
-    return &it->second->vol;
+    out = it->second->vol;
+    return true;
+}
+
+bool VolumeCache::contains(const std::string& path) const {
+    std::lock_guard<std::mutex> lk(mutex_);
+    return map_.count(path) != 0;
 }
 
 void VolumeCache::put(const std::string& path, Volume vol) {
@@ -28,24 +35,29 @@ void VolumeCache::put(const std::string& path, Volume vol) {
     // If already cached, update and move to front
     auto it = map_.find(path);
     if (it != map_.end()) {
+        bytes_ -= volumeBytes(it->second->vol);
         it->second->vol = std::move(vol);
+        bytes_ += volumeBytes(it->second->vol);
         lru_.splice(lru_.begin(), lru_, it->second);
-        return;
+    } else {
+        bytes_ += volumeBytes(vol);
+        lru_.push_front(Entry{path, std::move(vol)});
+        map_[path] = lru_.begin();
     }
-    // Evict LRU entry if at capacity
-    if (map_.size() >= maxEntries_ && !lru_.empty()) {
+    // Evict LRU entries while over either limit, keeping the newest
+    while (lru_.size() > 1 && (lru_.size() > maxEntries_ || bytes_ > maxBytes_)) {
         auto& back = lru_.back();
+        bytes_ -= volumeBytes(back.vol);
         map_.erase(back.path);
         lru_.pop_back();
     }
-    lru_.push_front(Entry{path, std::move(vol)});
-    map_[path] = lru_.begin();
 }
 
 void VolumeCache::clear() {
     std::lock_guard<std::mutex> lk(mutex_);
     map_.clear();
     lru_.clear();
+    bytes_ = 0;
 }
 
 // --- AppState implementation ---
@@ -59,6 +71,25 @@ void AppState::loadVolume(const std::string& path) {
         std::filesystem::path(path).filename().string());
 }
 
+void AppState::addPendingVolume(const std::string& path) {
+    volumes_.emplace_back();
+    volumePaths_.push_back(path);
+    volumeNames_.push_back(
+        std::filesystem::path(path).filename().string());
+    volumeLoading_.resize(volumes_.size(), false);
+    volumeLoading_.back() = true;
+    viewStates_.resize(volumes_.size());
+}
+
+void AppState::installVolume(int index, Volume vol) {
+    if (index < 0 || index >= static_cast<int>(volumes_.size()))
+        return;
+    if (index < static_cast<int>(volumeLoading_.size()))
+        volumeLoading_[index] = false;
+    volumes_[index] = std::move(vol);
+    initializeViewState(index);
+}
+
 void AppState::disambiguateVolumeNames()
 {
     const int n = static_cast<int>(volumeNames_.size());
@@ -256,27 +287,34 @@ void AppState::saveTags() {
 void AppState::initializeViewStates() {
     viewStates_.resize(volumes_.size());
 
-    for (int vi = 0; vi < static_cast<int>(volumes_.size()); ++vi) {
-        const Volume& vol = volumes_[vi];
-        if (vol.data.empty())
-            continue;
+    for (int vi = 0; vi < static_cast<int>(volumes_.size()); ++vi)
+        initializeViewState(vi);
+}
 
-        VolumeViewState& state = viewStates_[vi];
+void AppState::initializeViewState(int index) {
+    if (index < 0 || index >= static_cast<int>(volumes_.size()))
+        return;
+    viewStates_.resize(volumes_.size());
 
-        state.sliceIndices.x = vol.dimensions.x / 2;
-        state.sliceIndices.y = vol.dimensions.y / 2;
-        state.sliceIndices.z = vol.dimensions.z / 2;
+    const Volume& vol = volumes_[index];
+    if (vol.data.empty())
+        return;
 
-        state.valueRange[0] = vol.min_value;
-        state.valueRange[1] = vol.max_value;
-        state.useLogTransform = false;
-        state.invertColourMap = false;
+    VolumeViewState& state = viewStates_[index];
 
-        for (int v = 0; v < 3; ++v) {
-            state.zoom[v] = 1.0f;
-            state.panU[v] = 0.5f;
-            state.panV[v] = 0.5f;
-        }
+    state.sliceIndices.x = vol.dimensions.x / 2;
+    state.sliceIndices.y = vol.dimensions.y / 2;
+    state.sliceIndices.z = vol.dimensions.z / 2;
+
+    state.valueRange[0] = vol.min_value;
+    state.valueRange[1] = vol.max_value;
+    state.useLogTransform = false;
+    state.invertColourMap = false;
+
+    for (int v = 0; v < 3; ++v) {
+        state.zoom[v] = 1.0f;
+        state.panU[v] = 0.5f;
+        state.panV[v] = 0.5f;
     }
 }
 
@@ -294,52 +332,62 @@ void AppState::applyConfig(const AppConfig& cfg, int defaultWindowWidth, int def
     std::snprintf(fontPath_, sizeof(fontPath_), "%s", cfg.global.fontPath.c_str());
     fontSize_ = cfg.global.fontSize;
 
-    for (int vi = 0; vi < static_cast<int>(volumes_.size()); ++vi) {
-        VolumeViewState& state = viewStates_[vi];
-        const Volume& vol = volumes_[vi];
+    for (int vi = 0; vi < static_cast<int>(volumes_.size()); ++vi)
+        applyVolumeConfig(cfg, vi);
+}
 
-        const VolumeConfig* vc = nullptr;
-        for (const auto& v : cfg.volumes) {
-            if (v.path == volumePaths_[vi]) {
-                vc = &v;
-                break;
-            }
+void AppState::applyVolumeConfig(const AppConfig& cfg, int index) {
+    if (index < 0 || index >= static_cast<int>(volumes_.size()) ||
+        index >= static_cast<int>(viewStates_.size()))
+        return;
+
+    VolumeViewState& state = viewStates_[index];
+    const Volume& vol = volumes_[index];
+
+    const VolumeConfig* vc = nullptr;
+    for (const auto& v : cfg.volumes) {
+        if (v.path == volumePaths_[index]) {
+            vc = &v;
+            break;
         }
+    }
 
-        auto defaultCm = colourMapByName(cfg.global.defaultColourMap);
-        if (defaultCm.has_value())
-            state.colourMap = defaultCm.value();
+    auto defaultCm = colourMapByName(cfg.global.defaultColourMap);
+    if (defaultCm.has_value())
+        state.colourMap = defaultCm.value();
 
-        if (vc) {
-            auto cm = colourMapByName(vc->colourMap);
-            if (cm.has_value())
-                state.colourMap = cm.value();
+    if (vc) {
+        auto cm = colourMapByName(vc->colourMap);
+        if (cm.has_value())
+            state.colourMap = cm.value();
 
-            if (vc->valueMin.has_value())
-                state.valueRange[0] = vc->valueMin.value();
-            if (vc->valueMax.has_value())
-                state.valueRange[1] = vc->valueMax.value();
+        if (vc->valueMin.has_value())
+            state.valueRange[0] = vc->valueMin.value();
+        if (vc->valueMax.has_value())
+            state.valueRange[1] = vc->valueMax.value();
 
+        // Placeholders have no extent to clamp against
+        if (!vol.data.empty()) {
             if (vc->sliceIndices[0] >= 0)
                 state.sliceIndices.x = std::clamp(vc->sliceIndices[0], 0, vol.dimensions.x - 1);
             if (vc->sliceIndices[1] >= 0)
                 state.sliceIndices.y = std::clamp(vc->sliceIndices[1], 0, vol.dimensions.y - 1);
             if (vc->sliceIndices[2] >= 0)
                 state.sliceIndices.z = std::clamp(vc->sliceIndices[2], 0, vol.dimensions.z - 1);
-
-            state.zoom[0] = vc->zoom[0];
-            state.zoom[1] = vc->zoom[1];
-            state.zoom[2] = vc->zoom[2];
-            state.panU[0] = vc->panU[0];
-            state.panU[1] = vc->panU[1];
-            state.panU[2] = vc->panU[2];
-            state.panV[0] = vc->panV[0];
-            state.panV[1] = vc->panV[1];
-            state.panV[2] = vc->panV[2];
-
-            state.useLogTransform = vc->useLogTransform;
-            state.invertColourMap = vc->invertColourMap;
         }
+
+        state.zoom[0] = vc->zoom[0];
+        state.zoom[1] = vc->zoom[1];
+        state.zoom[2] = vc->zoom[2];
+        state.panU[0] = vc->panU[0];
+        state.panU[1] = vc->panU[1];
+        state.panU[2] = vc->panU[2];
+        state.panV[0] = vc->panV[0];
+        state.panV[1] = vc->panV[1];
+        state.panV[2] = vc->panV[2];
+
+        state.useLogTransform = vc->useLogTransform;
+        state.invertColourMap = vc->invertColourMap;
     }
 }
 
@@ -393,14 +441,30 @@ void AppState::clearAllVolumes() {
     volumePaths_.clear();
     volumeNames_.clear();
     viewStates_.clear();
+    volumeLoading_.clear();
     selectedTagIndex_ = -1;
 }
 
-void AppState::loadVolumeSet(const std::vector<std::string>& paths) {
+void AppState::loadVolumeSet(const std::vector<std::string>& paths,
+                             std::vector<double>* loadSeconds) {
     clearAllVolumes();
+    if (loadSeconds)
+        loadSeconds->clear();
 
     for (const auto& path : paths)
     {
+        // Times this path whichever way the iteration ends
+        struct Timer {
+            std::vector<double>* out;
+            std::chrono::steady_clock::time_point start;
+            ~Timer()
+            {
+                if (out)
+                    out->push_back(std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - start).count());
+            }
+        } timer{loadSeconds, std::chrono::steady_clock::now()};
+
         if (path.empty())
         {
             // Placeholder for missing/empty path
@@ -411,11 +475,10 @@ void AppState::loadVolumeSet(const std::vector<std::string>& paths) {
         }
 
         // Check LRU cache first
-        Volume* cached = volumeCache_.get(path);
-        if (cached)
+        Volume cached;
+        if (volumeCache_.get(path, cached))
         {
-            // Copy the cached volume (data vector is shared via copy)
-            volumes_.push_back(*cached);
+            volumes_.push_back(std::move(cached));
             volumePaths_.push_back(path);
             volumeNames_.push_back(
                 std::filesystem::path(path).filename().string());
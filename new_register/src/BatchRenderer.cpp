@@ -0,0 +1,282 @@
+#include "BatchRenderer.h"
+
+#include <imgui.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <new>
+#include <string>
+#include <thread>
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "AppState.h"
+#include "FrameRecorder.h"
+#include "Interface.h"
+#include "OffscreenBackend.h"
+#include "QCState.h"
+#include "ViewManager.h"
+
+namespace {
+
+/// Frames rendered per item.  ImGui needs a couple of frames after the
+/// volumes change to settle the dock layout and window sizes; only the last
+/// one is drawn and captured.
+constexpr int kSettleFrames = 3;
+
+/// Shared by the parent and the forked workers (anonymous shared mapping),
+/// so workers hand out items dynamically and the parent can report totals.
+struct BatchProgress
+{
+    std::atomic<int> next{0};      ///< next item to render
+    std::atomic<int> written{0};
+    std::atomic<int> failed{0};
+};
+static_assert(std::atomic<int>::is_always_lock_free,
+              "BatchProgress is shared between processes");
+
+/// Render items off the shared counter until none are left.
+/// @return 0 on success, 1 if the context could not be created.
+int renderItems(const std::vector<BatchItem>& items, const BatchOptions& options,
+                AppState& state, QCState& qcState, const BatchSetup& setup,
+                BatchProgress& progress)
+{
+    OffscreenBackend backend(options.width, options.height);
+    try
+    {
+        backend.initialize(nullptr);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "[batch] " << e.what() << "\n";
+        return 1;
+    }
+    if (options.scale)
+        backend.setContentScale(*options.scale);
+    backend.setFontConfig(options.fontPath, options.fontSize);
+    backend.initImGui(nullptr);
+
+    state.dpiScale_ = backend.imguiScale();
+    if (options.gpuSlicing)
+        state.gpuSlicing_ = backend.supportsVolumeSlicing();
+    if (options.palettedSlices)
+        state.palettedSlices_ = backend.supportsPalettedSlices();
+
+    {
+        ViewManager viewManager(state, backend);
+        Interface interface(state, viewManager, qcState);
+        // One encoder: the other cores run the other workers.  Two queued
+        // images let encoding overlap rendering of the next item.
+        constexpr size_t kMaxQueued = 2;
+        FrameRecorder recorder(1, kMaxQueued);
+        int captureFailed = 0;
+
+        const int count = static_cast<int>(items.size());
+        for (int i = progress.next.fetch_add(1); i < count; i = progress.next.fetch_add(1))
+        {
+            const BatchItem& item = items[i];
+            if (item.qcRow >= 0)
+                qcState.currentRowIndex = item.qcRow;
+
+            // Same-sized views reuse the previous item's textures
+            viewManager.detachTextures();
+            state.loadVolumeSet(item.paths);
+            if (setup)
+                setup(state, item);
+            viewManager.reattachTextures();
+            viewManager.initializeAllTextures();
+
+            for (int frame = 0; frame < kSettleFrames; ++frame)
+            {
+                backend.beginFrame();
+                backend.imguiNewFrame();
+                ImGui::NewFrame();
+                interface.render(backend, nullptr);
+                ImGui::Render();
+                if (frame + 1 == kSettleFrames)
+                    backend.endFrame();
+            }
+
+            int width = 0, height = 0;
+            std::vector<uint8_t> pixels = backend.captureScreenshot(width, height);
+            if (pixels.empty())
+            {
+                std::cerr << "[batch] " << item.name << ": failed to capture framebuffer\n";
+                ++captureFailed;
+                continue;
+            }
+            // Only this thread submits, so a drained queue takes the image
+            if (recorder.pending() >= kMaxQueued)
+                recorder.waitIdle();
+            std::string path =
+                (std::filesystem::path(options.outputDir) / (item.name + ".png")).string();
+            recorder.submit(std::move(path), std::move(pixels), width, height);
+
+            if (debugLoggingEnabled())
+                std::cerr << "[batch] " << getpid() << " rendered " << item.name << "\n";
+        }
+
+        recorder.waitIdle();
+        FrameRecorder::Stats stats = recorder.stats();
+        progress.written += static_cast<int>(stats.written);
+        progress.failed += static_cast<int>(stats.failed + stats.dropped) + captureFailed;
+
+        viewManager.destroyAllTextures();
+        backend.shutdownTextureSystem();
+    }
+
+    backend.shutdownImGui();
+    backend.shutdown();
+    return 0;
+}
+
+/// Give each worker's llvmpipe an equal share of the cores, unless the
+/// user chose a thread count.
+void shareRendererThreads(int jobs)
+{
+    if (std::getenv("LP_NUM_THREADS"))
+        return;
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    unsigned perJob = std::max(1u, cores / static_cast<unsigned>(jobs));
+    setenv("LP_NUM_THREADS", std::to_string(perJob).c_str(), 1);
+}
+
+} // namespace
+
+std::vector<BatchItem> batchItemsForQC(const QCState& qcState)
+{
+    std::vector<BatchItem> items;
+    items.reserve(qcState.rowCount());
+    for (int row = 0; row < qcState.rowCount(); ++row)
+    {
+        BatchItem item;
+        item.name = qcState.rowIds[row];
+        for (char& c : item.name)
+        {
+            if (c == '/' || c == '\\' || c == ':' || static_cast<unsigned char>(c) < 32)
+                c = '_';
+        }
+        if (item.name.empty() || item.name == "." || item.name == "..")
+            item.name = "row" + std::to_string(row + 1);
+        item.paths = qcState.pathsForRow(row);
+        item.qcRow = row;
+        items.push_back(std::move(item));
+    }
+    return items;
+}
+
+int runBatch(const std::vector<BatchItem>& items, const BatchOptions& options,
+             AppState& state, QCState& qcState, const BatchSetup& setup)
+{
+    if (items.empty())
+    {
+        std::cerr << "[batch] Nothing to render\n";
+        return 1;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(options.outputDir, ec);
+    if (ec)
+    {
+        std::cerr << "[batch] Cannot create " << options.outputDir << ": "
+                  << ec.message() << "\n";
+        return 1;
+    }
+
+    int jobs = options.jobs > 0
+        ? options.jobs
+        : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    jobs = std::min(jobs, static_cast<int>(items.size()));
+
+    void* shared = mmap(nullptr, sizeof(BatchProgress), PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shared == MAP_FAILED)
+    {
+        std::perror("[batch] mmap");
+        return 1;
+    }
+    BatchProgress* progress = new (shared) BatchProgress;
+
+    auto start = std::chrono::steady_clock::now();
+    bool workerFailed = false;
+
+    if (jobs == 1)
+    {
+        workerFailed = renderItems(items, options, state, qcState, setup, *progress) != 0;
+    }
+    else
+    {
+        shareRendererThreads(jobs);
+
+        // Buffered output would otherwise be written once per process
+        std::cout.flush();
+        std::cerr.flush();
+        std::fflush(nullptr);
+
+        std::vector<pid_t> workers;
+        for (int j = 0; j < jobs; ++j)
+        {
+            pid_t pid = fork();
+            if (pid == 0)
+            {
+                int rc = 1;
+                try
+                {
+                    rc = renderItems(items, options, state, qcState, setup, *progress);
+                }
+                catch (const std::exception& e)
+                {
+                    std::cerr << "[batch] Worker failed: " << e.what() << "\n";
+                }
+                std::cout.flush();
+                std::cerr.flush();
+                // Skip the parent's atexit handlers and static destructors
+                _exit(rc);
+            }
+            if (pid < 0)
+            {
+                std::perror("[batch] fork");
+                break;
+            }
+            workers.push_back(pid);
+        }
+
+        // Without any worker the items are rendered here
+        if (workers.empty())
+            workerFailed = renderItems(items, options, state, qcState, setup, *progress) != 0;
+
+        for (pid_t pid : workers)
+        {
+            int status = 0;
+            while (waitpid(pid, &status, 0) < 0 && errno == EINTR)
+                ;
+            if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+                workerFailed = true;
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    int written = progress->written.load();
+    int failed = progress->failed.load();
+    progress->~BatchProgress();
+    munmap(shared, sizeof(BatchProgress));
+
+    std::cout << "[batch] " << written << " of " << items.size() << " image(s) written to "
+              << options.outputDir << " in " << seconds << " s";
+    if (seconds > 0.0)
+        std::cout << " (" << written / seconds << " images/s, " << jobs << " job(s))";
+    std::cout << "\n";
+    if (failed > 0)
+        std::cerr << "[batch] " << failed << " image(s) failed\n";
+
+    return (workerFailed || failed > 0 || written < static_cast<int>(items.size())) ? 1 : 0;
+}
@@ -0,0 +1,188 @@
+#include "CsvFile.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ---------------------------------------------------------------------------
+// CsvField
+// ---------------------------------------------------------------------------
+
+std::string CsvField::str() const
+{
+    if (!escaped)
+        return std::string(text);
+
+    std::string out;
+    out.reserve(text.size());
+    for (size_t i = 0; i < text.size(); ++i)
+    {
+        out += text[i];
+        if (text[i] == '"' && i + 1 < text.size() && text[i + 1] == '"')
+            ++i; // skip the second quote
+    }
+    return out;
+}
+
+bool CsvField::operator==(std::string_view value) const
+{
+    return escaped ? str() == value : text == value;
+}
+
+// ---------------------------------------------------------------------------
+// CsvFile
+// ---------------------------------------------------------------------------
+
+CsvFile::CsvFile(const std::string& path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("Cannot open file: " + path);
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0)
+    {
+        ::close(fd);
+        throw std::runtime_error("Cannot read file: " + path);
+    }
+    size_ = static_cast<size_t>(st.st_size);
+
+    // An empty file cannot be mapped; it has no records either
+    if (size_ > 0)
+    {
+        void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED)
+        {
+            ::close(fd);
+            throw std::runtime_error("Cannot map file: " + path);
+        }
+        // Read once from start to end
+        ::madvise(p, size_, MADV_SEQUENTIAL);
+        data_ = static_cast<const char*>(p);
+    }
+    // The mapping keeps the file open
+    ::close(fd);
+}
+
+CsvFile::~CsvFile()
+{
+    if (data_)
+        ::munmap(const_cast<char*>(data_), size_);
+}
+
+size_t CsvFile::skipBlankLines(size_t offset) const
+{
+    while (offset < size_)
+    {
+        if (data_[offset] == '\n')
+            ++offset;
+        else if (data_[offset] == '\r' && offset + 1 < size_ && data_[offset + 1] == '\n')
+            offset += 2;
+        else
+            break;
+    }
+    return offset;
+}
+
+size_t CsvFile::readRecord(size_t offset, std::vector<CsvField>& fields) const
+{
+    fields.clear();
+    if (offset >= size_)
+        return size_;
+
+    const char* end = data_ + size_;
+    const char* p = data_ + offset;
+    for (;;)
+    {
+        CsvField field;
+        if (*p == '"')
+        {
+            // Quoted: runs to the next quote that is not doubled
+            const char* start = ++p;
+            for (;;)
+            {
+                p = static_cast<const char*>(std::memchr(p, '"', end - p));
+                if (!p)
+                {
+                    p = end; // unterminated: the rest of the file
+                    break;
+                }
+                if (p + 1 < end && p[1] == '"')
+                {
+                    field.escaped = true;
+                    p += 2;
+                    continue;
+                }
+                break;
+            }
+            field.text = std::string_view(start, p - start);
+            if (p < end)
+                ++p; // closing quote
+            // Anything between the closing quote and the delimiter is ignored
+            while (p < end && *p != ',' && *p != '\n')
+                ++p;
+        }
+        else
+        {
+            const char* start = p;
+            while (p < end && *p != ',' && *p != '\n')
+                ++p;
+            const char* stop = p;
+            if (stop > start && stop[-1] == '\r')
+                --stop;
+            field.text = std::string_view(start, stop - start);
+        }
+        fields.push_back(field);
+
+        if (p < end && *p == ',')
+        {
+            ++p;
+            // A trailing comma ends the record with an empty field
+            if (p == end)
+            {
+                fields.emplace_back();
+                return size_;
+            }
+            continue;
+        }
+        // Line break or end of file
+        return p < end ? skipBlankLines(static_cast<size_t>(p - data_) + 1) : size_;
+    }
+}
+
+size_t CsvFile::skipRecord(size_t offset, CsvField* firstField) const
+{
+    if (offset >= size_)
+        return size_;
+
+    const char* p = data_ + offset;
+    size_t left = size_ - offset;
+    const char* nl = static_cast<const char*>(std::memchr(p, '\n', left));
+    const char* lineEnd = nl ? nl : data_ + size_;
+
+    // Without quotes the record is the line; only quoted fields need a
+    // full parse (they may span lines)
+    if (!std::memchr(p, '"', static_cast<size_t>(lineEnd - p)))
+    {
+        if (firstField)
+        {
+            const char* comma = static_cast<const char*>(
+                std::memchr(p, ',', static_cast<size_t>(lineEnd - p)));
+            const char* stop = comma ? comma : lineEnd;
+            if (!comma && stop > p && stop[-1] == '\r')
+                --stop;
+            *firstField = CsvField{std::string_view(p, stop - p), false};
+        }
+        return nl ? skipBlankLines(static_cast<size_t>(nl - data_) + 1) : size_;
+    }
+
+    std::vector<CsvField> fields;
+    size_t next = readRecord(offset, fields);
+    if (firstField)
+        *firstField = fields.empty() ? CsvField{} : fields[0];
+    return next;
+}
@@ -0,0 +1,94 @@
+#include "DiskCache.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+#include <unistd.h>
+
+std::string userCacheDir()
+{
+    const char* xdg = std::getenv("XDG_CACHE_HOME");
+    if (xdg && xdg[0] == '/')
+        return std::string(xdg) + "/new_register";
+    const char* home = std::getenv("HOME");
+    if (home && home[0] != '\0')
+        return std::string(home) + "/.cache/new_register";
+    return {};
+}
+
+bool readCacheFile(const std::string& path, std::vector<uint8_t>& data)
+{
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs)
+        return false;
+    data.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+    return !ifs.bad();
+}
+
+bool writeCacheFile(const std::string& path, const std::vector<uint8_t>& data)
+{
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    fs::path dir = fs::path(path).parent_path();
+    if (!dir.empty())
+        fs::create_directories(dir, ec);
+    if (ec)
+        return false;
+
+    // Unique per process so two instances exiting together do not mix
+    std::string tmp = path + ".tmp" + std::to_string(::getpid());
+    {
+        std::ofstream ofs(tmp, std::ios::binary | std::ios::trunc);
+        if (!ofs)
+            return false;
+        ofs.write(reinterpret_cast<const char*>(data.data()),
+                  static_cast<std::streamsize>(data.size()));
+        if (!ofs)
+        {
+            ofs.close();
+            fs::remove(tmp, ec);
+            return false;
+        }
+    }
+    fs::rename(tmp, path, ec);
+    if (ec)
+    {
+        fs::remove(tmp, ec);
+        return false;
+    }
+    return true;
+}
+
+bool pipelineCacheHeaderMatches(const std::vector<uint8_t>& data,
+                                uint32_t vendorId, uint32_t deviceId,
+                                const uint8_t uuid[16])
+{
+    // uint32 headerSize, uint32 headerVersion, uint32 vendorID,
+    // uint32 deviceID, uint8 pipelineCacheUUID[16]; host byte order
+    constexpr size_t kHeaderSize = 4 * sizeof(uint32_t) + 16;
+    if (data.size() < kHeaderSize)
+        return false;
+
+    uint32_t fields[4];
+    std::memcpy(fields, data.data(), sizeof(fields));
+    return fields[0] >= kHeaderSize && fields[0] <= data.size() &&
+           fields[1] == 1 &&   // VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+           fields[2] == vendorId && fields[3] == deviceId &&
+           std::memcmp(data.data() + sizeof(fields), uuid, 16) == 0;
+}
+
+std::string hexString(const uint8_t* bytes, size_t size)
+{
+    static const char digits[] = "0123456789abcdef";
+    std::string out;
+    out.reserve(size * 2);
+    for (size_t i = 0; i < size; ++i)
+    {
+        out += digits[bytes[i] >> 4];
+        out += digits[bytes[i] & 0xF];
+    }
+    return out;
+}
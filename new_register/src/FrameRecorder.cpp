@@ -0,0 +1,144 @@
+#include "FrameRecorder.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+
+// Internal linkage: other targets linking nr_core carry their own copy
+#define STB_IMAGE_WRITE_STATIC
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "stb_image_write.h"
+
+namespace {
+
+int defaultThreads()
+{
+    return std::max(2, static_cast<int>(std::thread::hardware_concurrency() / 2));
+}
+
+} // namespace
+
+FrameRecorder::FrameRecorder(int threads, size_t maxQueued)
+    : maxQueued_(maxQueued > 0 ? maxQueued
+                               : 2 * static_cast<size_t>(threads > 0 ? threads : defaultThreads()))
+{
+    workers_.resize(threads > 0 ? threads : defaultThreads());
+}
+
+FrameRecorder::~FrameRecorder()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    workCv_.notify_all();
+    for (std::thread& t : workers_)
+        if (t.joinable())
+            t.join();
+}
+
+bool FrameRecorder::submit(std::string path, std::vector<uint8_t> pixels, int w, int h)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (queue_.size() + active_ >= maxQueued_)
+        {
+            ++stats_.dropped;
+            return false;
+        }
+        queue_.push_back(Frame{std::move(path), std::move(pixels), w, h});
+
+        // Threads start on first use; most sessions never save an image
+        for (std::thread& t : workers_)
+            if (!t.joinable())
+                t = std::thread(&FrameRecorder::workerLoop, this);
+    }
+    workCv_.notify_one();
+    return true;
+}
+
+void FrameRecorder::waitIdle()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    idleCv_.wait(lock, [this] { return queue_.empty() && active_ == 0; });
+}
+
+size_t FrameRecorder::pending() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queue_.size() + active_;
+}
+
+FrameRecorder::Stats FrameRecorder::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void FrameRecorder::workerLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;)
+    {
+        // Queued frames are still written when stopping
+        workCv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+        if (queue_.empty())
+            break;
+
+        Frame frame = std::move(queue_.front());
+        queue_.pop_front();
+        ++active_;
+        lock.unlock();
+
+        bool ok = frame.width > 0 && frame.height > 0 &&
+                  frame.pixels.size() >= static_cast<size_t>(frame.width) * frame.height * 4 &&
+                  stbi_write_png(frame.path.c_str(), frame.width, frame.height, 4,
+                                 frame.pixels.data(), frame.width * 4) != 0;
+        if (!ok)
+            std::cerr << "Screenshot: failed to write " << frame.path << "\n";
+
+        lock.lock();
+        --active_;
+        ++(ok ? stats_.written : stats_.failed);
+        idleCv_.notify_all();
+    }
+}
+
+// ---------------------------------------------------------------------------
+// File naming
+// ---------------------------------------------------------------------------
+
+int FrameRecorder::nextFreeIndex(const std::string& dir, const std::string& prefix,
+                                 const std::string& suffix)
+{
+    namespace fs = std::filesystem;
+    int next = 1;
+    std::error_code ec;
+    for (fs::directory_iterator it(dir.empty() ? "." : dir, ec), end; !ec && it != end;
+         it.increment(ec))
+    {
+        std::string name = it->path().filename().string();
+        if (name.size() <= prefix.size() + suffix.size() ||
+            name.compare(0, prefix.size(), prefix) != 0 ||
+            name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0)
+            continue;
+        std::string digits = name.substr(prefix.size(),
+                                         name.size() - prefix.size() - suffix.size());
+        if (digits.find_first_not_of("0123456789") != std::string::npos)
+            continue;
+        int index = std::atoi(digits.c_str());
+        if (index >= next)
+            next = index + 1;
+    }
+    return next;
+}
+
+std::string FrameRecorder::numberedName(const std::string& prefix, int index,
+                                        const std::string& suffix)
+{
+    char buf[16];
+    std::snprintf(buf, sizeof(buf), "%06d", index);
+    return prefix + buf + suffix;
+}
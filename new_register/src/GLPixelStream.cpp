@@ -0,0 +1,261 @@
+#include "GLPixelStream.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+#include <GL/gl.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "AppState.h"  // debugLoggingEnabled()
+
+#ifndef APIENTRY
+#define APIENTRY
+#endif
+
+// GL 1.5 / 2.1 tokens not guaranteed by <GL/gl.h> (notably on Windows)
+#ifndef GL_PIXEL_UNPACK_BUFFER
+#define GL_PIXEL_UNPACK_BUFFER    0x88EC
+#endif
+#ifndef GL_STREAM_DRAW
+#define GL_STREAM_DRAW            0x88E0
+#endif
+#ifndef GL_WRITE_ONLY
+#define GL_WRITE_ONLY             0x88B9
+#endif
+#ifndef GL_PIXEL_PACK_BUFFER
+#define GL_PIXEL_PACK_BUFFER      0x88EB
+#endif
+#ifndef GL_STREAM_READ
+#define GL_STREAM_READ            0x88E1
+#endif
+#ifndef GL_READ_ONLY
+#define GL_READ_ONLY              0x88B8
+#endif
+
+// ---------------------------------------------------------------------------
+// Entry points beyond GL 1.1
+// ---------------------------------------------------------------------------
+
+struct GLPixelStream::GLFunctions
+{
+    void      (APIENTRY* GenBuffers)(GLsizei, GLuint*) = nullptr;
+    void      (APIENTRY* DeleteBuffers)(GLsizei, const GLuint*) = nullptr;
+    void      (APIENTRY* BindBuffer)(GLenum, GLuint) = nullptr;
+    void      (APIENTRY* BufferData)(GLenum, ptrdiff_t, const void*, GLenum) = nullptr;
+    void      (APIENTRY* BufferSubData)(GLenum, ptrdiff_t, ptrdiff_t, const void*) = nullptr;
+    void*     (APIENTRY* MapBuffer)(GLenum, GLenum) = nullptr;
+    GLboolean (APIENTRY* UnmapBuffer)(GLenum) = nullptr;
+};
+
+namespace {
+
+template <typename Fn>
+bool loadProc(GLPixelStream::ProcLoader loader, Fn& fn, const char* name,
+              const char* fallbackName)
+{
+    GLPixelStream::GLProc p = loader(name);
+    if (!p)
+        p = loader(fallbackName);
+    fn = reinterpret_cast<Fn>(p);
+    return fn != nullptr;
+}
+
+bool hasExtension(const char* extensions, const char* name)
+{
+    if (!extensions)
+        return false;
+    size_t len = std::strlen(name);
+    for (const char* p = std::strstr(extensions, name); p; p = std::strstr(p + len, name))
+    {
+        bool startOk = (p == extensions || p[-1] == ' ');
+        bool endOk = (p[len] == '\0' || p[len] == ' ');
+        if (startOk && endOk)
+            return true;
+    }
+    return false;
+}
+
+/// Size class of an upload: the next power of two, at least 64 KB, so
+/// slices of similar size share buffers.
+size_t sizeClass(size_t bytes)
+{
+    size_t c = 64 * 1024;
+    while (c < bytes)
+        c <<= 1;
+    return c;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Lifecycle
+// ---------------------------------------------------------------------------
+
+GLPixelStream::GLPixelStream()
+    : gl_(std::make_unique<GLFunctions>())
+{
+}
+
+GLPixelStream::~GLPixelStream() = default;
+
+bool GLPixelStream::initialize(ProcLoader loader)
+{
+    supported_ = false;
+
+    // Pixel buffer objects: core in GL 2.1, else ARB_pixel_buffer_object
+    // (the ARB entry points are the GL 1.5 ones with an ARB suffix)
+    const char* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+    const char* extensions = reinterpret_cast<const char*>(glGetString(GL_EXTENSIONS));
+    int major = version ? std::atoi(version) : 0;
+    int minor = 0;
+    if (const char* dot = version ? std::strchr(version, '.') : nullptr)
+        minor = std::atoi(dot + 1);
+    bool core = (major > 2 || (major == 2 && minor >= 1));
+    if (!core && !hasExtension(extensions, "GL_ARB_pixel_buffer_object") &&
+        !hasExtension(extensions, "GL_EXT_pixel_buffer_object"))
+    {
+        if (debugLoggingEnabled())
+            std::cerr << "[opengl2] No pixel buffer objects ("
+                      << (version ? version : "unknown")
+                      << "), uploading textures from client memory\n";
+        return false;
+    }
+
+    GLFunctions& f = *gl_;
+    bool ok = loadProc(loader, f.GenBuffers, "glGenBuffers", "glGenBuffersARB") &&
+              loadProc(loader, f.DeleteBuffers, "glDeleteBuffers", "glDeleteBuffersARB") &&
+              loadProc(loader, f.BindBuffer, "glBindBuffer", "glBindBufferARB") &&
+              loadProc(loader, f.BufferData, "glBufferData", "glBufferDataARB") &&
+              loadProc(loader, f.BufferSubData, "glBufferSubData", "glBufferSubDataARB") &&
+              loadProc(loader, f.MapBuffer, "glMapBuffer", "glMapBufferARB") &&
+              loadProc(loader, f.UnmapBuffer, "glUnmapBuffer", "glUnmapBufferARB");
+    if (!ok)
+    {
+        if (debugLoggingEnabled())
+            std::cerr << "[opengl2] Missing buffer object entry points, "
+                      << "uploading textures from client memory\n";
+        return false;
+    }
+
+    supported_ = true;
+    if (debugLoggingEnabled())
+        std::cerr << "[opengl2] Streaming texture uploads through pixel buffer objects\n";
+    return true;
+}
+
+void GLPixelStream::shutdown()
+{
+    if (supported_)
+        for (auto& pair : pairs_)
+            for (unsigned int& buf : pair.second.buffers)
+                if (buf)
+                    gl_->DeleteBuffers(1, &buf);
+    if (supported_ && !packBuffers_.empty())
+        gl_->DeleteBuffers(static_cast<GLsizei>(packBuffers_.size()), packBuffers_.data());
+    pairs_.clear();
+    packBuffers_.clear();
+    packFree_.clear();
+    supported_ = false;
+}
+
+// ---------------------------------------------------------------------------
+// Uploads
+// ---------------------------------------------------------------------------
+
+void GLPixelStream::upload(unsigned int tex, int w, int h, const void* data)
+{
+    glBindTexture(GL_TEXTURE_2D, tex);
+    if (!supported_)
+    {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w, h, GL_RGBA, GL_UNSIGNED_BYTE, data);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        return;
+    }
+
+    GLFunctions& f = *gl_;
+    size_t bytes = static_cast<size_t>(w) * h * 4;
+    size_t capacity = sizeClass(bytes);
+    BufferPair& pair = pairs_[capacity];
+    unsigned int& buf = pair.buffers[pair.next];
+    pair.next ^= 1;
+    if (!buf)
+        f.GenBuffers(1, &buf);
+
+    // Orphan the buffer: the driver hands out fresh storage if the previous
+    // upload from it has not been consumed yet, instead of blocking.
+    f.BindBuffer(GL_PIXEL_UNPACK_BUFFER, buf);
+    f.BufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<ptrdiff_t>(capacity), nullptr,
+                 GL_STREAM_DRAW);
+    void* dst = f.MapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY);
+    if (dst)
+    {
+        std::memcpy(dst, data, bytes);
+        f.UnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    }
+    else
+    {
+        f.BufferSubData(GL_PIXEL_UNPACK_BUFFER, 0, static_cast<ptrdiff_t>(bytes), data);
+    }
+
+    // With an unpack buffer bound the pointer argument is a buffer offset
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w, h, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    f.BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+// ---------------------------------------------------------------------------
+// Readbacks
+// ---------------------------------------------------------------------------
+
+unsigned int GLPixelStream::beginReadback(int w, int h)
+{
+    if (!supported_ || w <= 0 || h <= 0)
+        return 0;
+
+    GLFunctions& f = *gl_;
+    unsigned int buf = 0;
+    if (!packFree_.empty())
+    {
+        buf = packFree_.back();
+        packFree_.pop_back();
+    }
+    else
+    {
+        f.GenBuffers(1, &buf);
+        packBuffers_.push_back(buf);
+    }
+
+    size_t bytes = static_cast<size_t>(w) * h * 4;
+    f.BindBuffer(GL_PIXEL_PACK_BUFFER, buf);
+    f.BufferData(GL_PIXEL_PACK_BUFFER, static_cast<ptrdiff_t>(bytes), nullptr, GL_STREAM_READ);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    // With a pack buffer bound the pointer argument is a buffer offset
+    glReadPixels(0, 0, w, h, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    f.BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    return buf;
+}
+
+bool GLPixelStream::endReadback(unsigned int readback, int w, int h,
+                                std::vector<uint8_t>& pixels)
+{
+    if (!supported_ || readback == 0)
+        return false;
+
+    GLFunctions& f = *gl_;
+    size_t bytes = static_cast<size_t>(w) * h * 4;
+    f.BindBuffer(GL_PIXEL_PACK_BUFFER, readback);
+    const void* src = f.MapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+    if (src)
+    {
+        pixels.resize(bytes);
+        std::memcpy(pixels.data(), src, bytes);
+        f.UnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    f.BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    packFree_.push_back(readback);
+    return src != nullptr;
+}
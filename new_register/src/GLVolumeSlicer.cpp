@@ -0,0 +1,788 @@
+#include "GLVolumeSlicer.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+#include <GL/gl.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "AppState.h"  // debugLoggingEnabled()
+
+#ifndef APIENTRY
+#define APIENTRY
+#endif
+
+// GL 1.2+ tokens not guaranteed by <GL/gl.h> (notably on Windows)
+#ifndef GL_TEXTURE_3D
+#define GL_TEXTURE_3D             0x806F
+#endif
+#ifndef GL_MAX_3D_TEXTURE_SIZE
+#define GL_MAX_3D_TEXTURE_SIZE    0x8073
+#endif
+#ifndef GL_TEXTURE_WRAP_R
+#define GL_TEXTURE_WRAP_R         0x8072
+#endif
+#ifndef GL_CLAMP_TO_EDGE
+#define GL_CLAMP_TO_EDGE          0x812F
+#endif
+#ifndef GL_TEXTURE0
+#define GL_TEXTURE0               0x84C0
+#endif
+#ifndef GL_ACTIVE_TEXTURE
+#define GL_ACTIVE_TEXTURE         0x84E0
+#endif
+#ifndef GL_MAX_TEXTURE_IMAGE_UNITS
+#define GL_MAX_TEXTURE_IMAGE_UNITS 0x8872
+#endif
+#ifndef GL_FRAGMENT_SHADER
+#define GL_FRAGMENT_SHADER        0x8B30
+#endif
+#ifndef GL_VERTEX_SHADER
+#define GL_VERTEX_SHADER          0x8B31
+#endif
+#ifndef GL_COMPILE_STATUS
+#define GL_COMPILE_STATUS         0x8B81
+#endif
+#ifndef GL_LINK_STATUS
+#define GL_LINK_STATUS            0x8B82
+#endif
+#ifndef GL_INFO_LOG_LENGTH
+#define GL_INFO_LOG_LENGTH        0x8B84
+#endif
+#ifndef GL_CURRENT_PROGRAM
+#define GL_CURRENT_PROGRAM        0x8B8D
+#endif
+#ifndef GL_R32F
+#define GL_R32F                   0x822E
+#endif
+#ifndef GL_RED
+#define GL_RED                    0x1903
+#endif
+#ifndef GL_LUMINANCE32F_ARB
+#define GL_LUMINANCE32F_ARB       0x8818
+#endif
+#ifndef GL_FRAMEBUFFER
+#define GL_FRAMEBUFFER            0x8D40
+#endif
+#ifndef GL_FRAMEBUFFER_BINDING
+#define GL_FRAMEBUFFER_BINDING    0x8CA6
+#endif
+#ifndef GL_COLOR_ATTACHMENT0
+#define GL_COLOR_ATTACHMENT0      0x8CE0
+#endif
+#ifndef GL_FRAMEBUFFER_COMPLETE
+#define GL_FRAMEBUFFER_COMPLETE   0x8CD5
+#endif
+
+// ---------------------------------------------------------------------------
+// Entry points beyond GL 1.1
+// ---------------------------------------------------------------------------
+
+struct GLVolumeSlicer::GLFunctions
+{
+    using GLcharT = char;
+
+    void   (APIENTRY* ActiveTexture)(GLenum) = nullptr;
+    void   (APIENTRY* TexImage3D)(GLenum, GLint, GLint, GLsizei, GLsizei, GLsizei,
+                                  GLint, GLenum, GLenum, const void*) = nullptr;
+    GLuint (APIENTRY* CreateShader)(GLenum) = nullptr;
+    void   (APIENTRY* ShaderSource)(GLuint, GLsizei, const GLcharT* const*, const GLint*) = nullptr;
+    void   (APIENTRY* CompileShader)(GLuint) = nullptr;
+    void   (APIENTRY* GetShaderiv)(GLuint, GLenum, GLint*) = nullptr;
+    void   (APIENTRY* GetShaderInfoLog)(GLuint, GLsizei, GLsizei*, GLcharT*) = nullptr;
+    void   (APIENTRY* DeleteShader)(GLuint) = nullptr;
+    GLuint (APIENTRY* CreateProgram)() = nullptr;
+    void   (APIENTRY* AttachShader)(GLuint, GLuint) = nullptr;
+    void   (APIENTRY* LinkProgram)(GLuint) = nullptr;
+    void   (APIENTRY* GetProgramiv)(GLuint, GLenum, GLint*) = nullptr;
+    void   (APIENTRY* GetProgramInfoLog)(GLuint, GLsizei, GLsizei*, GLcharT*) = nullptr;
+    void   (APIENTRY* DeleteProgram)(GLuint) = nullptr;
+    void   (APIENTRY* UseProgram)(GLuint) = nullptr;
+    GLint  (APIENTRY* GetUniformLocation)(GLuint, const GLcharT*) = nullptr;
+    void   (APIENTRY* Uniform1i)(GLint, GLint) = nullptr;
+    void   (APIENTRY* Uniform1f)(GLint, GLfloat) = nullptr;
+    void   (APIENTRY* Uniform2f)(GLint, GLfloat, GLfloat) = nullptr;
+    void   (APIENTRY* Uniform1fv)(GLint, GLsizei, const GLfloat*) = nullptr;
+    void   (APIENTRY* Uniform3fv)(GLint, GLsizei, const GLfloat*) = nullptr;
+    void   (APIENTRY* Uniform4fv)(GLint, GLsizei, const GLfloat*) = nullptr;
+    void   (APIENTRY* GenFramebuffers)(GLsizei, GLuint*) = nullptr;
+    void   (APIENTRY* DeleteFramebuffers)(GLsizei, const GLuint*) = nullptr;
+    void   (APIENTRY* BindFramebuffer)(GLenum, GLuint) = nullptr;
+    void   (APIENTRY* FramebufferTexture2D)(GLenum, GLenum, GLenum, GLuint, GLint) = nullptr;
+    GLenum (APIENTRY* CheckFramebufferStatus)(GLenum) = nullptr;
+};
+
+namespace {
+
+template <typename Fn>
+bool loadProc(GLVolumeSlicer::ProcLoader loader, Fn& fn, const char* name,
+              const char* fallbackName = nullptr)
+{
+    GLVolumeSlicer::GLProc p = loader(name);
+    if (!p && fallbackName)
+        p = loader(fallbackName);
+    fn = reinterpret_cast<Fn>(p);
+    return fn != nullptr;
+}
+
+bool hasExtension(const char* extensions, const char* name)
+{
+    if (!extensions)
+        return false;
+    size_t len = std::strlen(name);
+    for (const char* p = std::strstr(extensions, name); p; p = std::strstr(p + len, name))
+    {
+        bool startOk = (p == extensions || p[-1] == ' ');
+        bool endOk = (p[len] == '\0' || p[len] == ' ');
+        if (startOk && endOk)
+            return true;
+    }
+    return false;
+}
+
+const char* kVertexShader =
+    "#version 110\n"
+    "void main() { gl_Position = gl_Vertex; }\n";
+
+/// Paletted slices: the index texel under each fragment (same size as the
+/// target, so no flip) selects a LUT entry.
+const char* kPalettedFragmentShader =
+    "#version 110\n"
+    "uniform sampler2D uIndex;\n"
+    "uniform sampler1D uLut;\n"
+    "uniform vec2 uSize;\n"
+    "uniform float uIndexScale;\n"
+    "uniform float uLutSize;\n"
+    "void main() {\n"
+    "    vec2 uv = (floor(gl_FragCoord.xy) + 0.5) / uSize;\n"
+    "    float k = floor(texture2D(uIndex, uv).r * uIndexScale + 0.5);\n"
+    "    gl_FragColor = texture1D(uLut, (k + 0.5) / uLutSize);\n"
+    "}\n";
+
+/// Fragment shader for @p count layers.  Layers are unrolled because GLSL
+/// 1.10 only allows samplers to be indexed by constant expressions.
+std::string fragmentShaderSource(int count, bool blend)
+{
+    std::string n = std::to_string(count);
+    std::string src =
+        "#version 110\n"
+        "uniform sampler2D uSlots;\n"
+        "uniform float uSlotRows;\n"
+        "uniform float uHeight;\n"
+        "uniform vec3 uDims[" + n + "];\n"
+        "uniform vec3 uBase[" + n + "];\n"
+        "uniform vec3 uDpx[" + n + "];\n"
+        "uniform vec3 uDpy[" + n + "];\n"
+        "uniform vec4 uRange[" + n + "];\n"  // rangeMin, rangeMax, invSpan, useLog
+        "uniform float uAlpha[" + n + "];\n";
+    for (int i = 0; i < count; ++i)
+        src += "uniform sampler3D uVol" + std::to_string(i) + ";\n";
+
+    // Same operations and order as ColourTransfer::slotOf(); slot colours
+    // come from row @p row of the slot texture.
+    src +=
+        "vec4 slotColour(float slot, float row) {\n"
+        "    return texture2D(uSlots, vec2((slot + 0.5) / 258.0, (row + 0.5) / uSlotRows));\n"
+        "}\n"
+        "vec4 classify(float raw, vec4 range, float row) {\n"
+        "    float v = raw;\n"
+        "    if (range.w > 0.5) {\n"
+        "        if (raw <= 0.0) return slotColour(0.0, row);\n"
+        "        v = log2(raw) * 0.30102999566398120;\n"
+        "    }\n"
+        "    if (v < range.x) return slotColour(0.0, row);\n"
+        "    if (v > range.y) return slotColour(257.0, row);\n"
+        "    float idx = floor((v - range.x) * range.z * 255.0 + 0.5);\n"
+        "    return slotColour(1.0 + min(idx, 255.0), row);\n"
+        "}\n"
+        "void main() {\n"
+        "    float px = floor(gl_FragCoord.x);\n"
+        "    float py = uHeight - 1.0 - floor(gl_FragCoord.y);\n"
+        "    vec3 acc = vec3(0.0);\n"
+        "    float weight = 0.0;\n"
+        "    vec4 colour = vec4(0.0);\n";
+
+    for (int i = 0; i < count; ++i)
+    {
+        std::string k = std::to_string(i);
+        src +=
+            "    {\n"
+            "        vec3 tv = uBase[" + k + "] + px * uDpx[" + k + "] + py * uDpy[" + k + "];\n"
+            "        vec3 r = floor(tv + 0.5);\n"
+            "        if (all(greaterThanEqual(r, vec3(0.0))) && all(lessThan(r, uDims[" + k + "]))) {\n"
+            "            float raw = texture3D(uVol" + k + ", (r + 0.5) / uDims[" + k + "]).r;\n"
+            "            vec4 c = classify(raw, uRange[" + k + "], " + k + ".0);\n";
+        if (blend)
+            src +=
+                "            if (c.a > 0.0) {\n"
+                "                acc += c.rgb * uAlpha[" + k + "];\n"
+                "                weight += uAlpha[" + k + "];\n"
+                "            }\n";
+        else
+            src += "            colour = c;\n";
+        src += "        }\n"
+               "    }\n";
+    }
+
+    if (blend)
+        src +=
+            "    if (weight > 0.0) acc /= weight;\n"
+            "    gl_FragColor = vec4(acc, 1.0);\n";
+    else
+        src += "    gl_FragColor = colour;\n";
+    src += "}\n";
+    return src;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Lifecycle
+// ---------------------------------------------------------------------------
+
+GLVolumeSlicer::GLVolumeSlicer()
+    : gl_(std::make_unique<GLFunctions>())
+{
+}
+
+GLVolumeSlicer::~GLVolumeSlicer() = default;
+
+bool GLVolumeSlicer::initialize(ProcLoader loader)
+{
+    supported_ = false;
+    palettedSupported_ = false;
+
+    const char* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+    const char* extensions = reinterpret_cast<const char*>(glGetString(GL_EXTENSIONS));
+    int major = version ? std::atoi(version) : 0;
+    if (major < 2)
+    {
+        if (debugLoggingEnabled())
+            std::cerr << "[gpu-slicing] Needs OpenGL 2.0, context is "
+                      << (version ? version : "unknown") << "\n";
+        return false;
+    }
+
+    GLFunctions& f = *gl_;
+    bool ok = loadProc(loader, f.ActiveTexture, "glActiveTexture") &&
+              loadProc(loader, f.CreateShader, "glCreateShader") &&
+              loadProc(loader, f.ShaderSource, "glShaderSource") &&
+              loadProc(loader, f.CompileShader, "glCompileShader") &&
+              loadProc(loader, f.GetShaderiv, "glGetShaderiv") &&
+              loadProc(loader, f.GetShaderInfoLog, "glGetShaderInfoLog") &&
+              loadProc(loader, f.DeleteShader, "glDeleteShader") &&
+              loadProc(loader, f.CreateProgram, "glCreateProgram") &&
+              loadProc(loader, f.AttachShader, "glAttachShader") &&
+              loadProc(loader, f.LinkProgram, "glLinkProgram") &&
+              loadProc(loader, f.GetProgramiv, "glGetProgramiv") &&
+              loadProc(loader, f.GetProgramInfoLog, "glGetProgramInfoLog") &&
+              loadProc(loader, f.DeleteProgram, "glDeleteProgram") &&
+              loadProc(loader, f.UseProgram, "glUseProgram") &&
+              loadProc(loader, f.GetUniformLocation, "glGetUniformLocation") &&
+              loadProc(loader, f.Uniform1i, "glUniform1i") &&
+              loadProc(loader, f.Uniform1f, "glUniform1f") &&
+              loadProc(loader, f.Uniform2f, "glUniform2f") &&
+              loadProc(loader, f.Uniform1fv, "glUniform1fv") &&
+              loadProc(loader, f.Uniform3fv, "glUniform3fv") &&
+              loadProc(loader, f.Uniform4fv, "glUniform4fv") &&
+              loadProc(loader, f.GenFramebuffers, "glGenFramebuffers", "glGenFramebuffersEXT") &&
+              loadProc(loader, f.DeleteFramebuffers, "glDeleteFramebuffers", "glDeleteFramebuffersEXT") &&
+              loadProc(loader, f.BindFramebuffer, "glBindFramebuffer", "glBindFramebufferEXT") &&
+              loadProc(loader, f.FramebufferTexture2D, "glFramebufferTexture2D", "glFramebufferTexture2DEXT") &&
+              loadProc(loader, f.CheckFramebufferStatus, "glCheckFramebufferStatus", "glCheckFramebufferStatusEXT");
+    if (!ok || (major < 3 && !hasExtension(extensions, "GL_ARB_framebuffer_object") &&
+                !hasExtension(extensions, "GL_EXT_framebuffer_object")))
+    {
+        if (debugLoggingEnabled())
+            std::cerr << "[gpu-slicing] Missing shader or framebuffer object entry points\n";
+        return false;
+    }
+
+    f.GenFramebuffers(1, &fbo_);
+
+    // Paletted slices: plain 8/16-bit luminance textures and a 1D LUT
+    paletted_.program = buildProgram(kPalettedFragmentShader);
+    if (paletted_.program)
+    {
+        paletted_.uIndex = f.GetUniformLocation(paletted_.program, "uIndex");
+        paletted_.uLut = f.GetUniformLocation(paletted_.program, "uLut");
+        paletted_.uSize = f.GetUniformLocation(paletted_.program, "uSize");
+        paletted_.uIndexScale = f.GetUniformLocation(paletted_.program, "uIndexScale");
+        paletted_.uLutSize = f.GetUniformLocation(paletted_.program, "uLutSize");
+
+        glGenTextures(1, &lutTex_);
+        glBindTexture(GL_TEXTURE_1D, lutTex_);
+        glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexImage1D(GL_TEXTURE_1D, 0, GL_RGBA, kVolumeSliceSlots, 0,
+                     GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glBindTexture(GL_TEXTURE_1D, 0);
+
+        // Some drivers store LUMINANCE16 with fewer bits; 16-bit indices
+        // are then left to the CPU path.
+        GLuint probe = 0;
+        GLint bits = 0;
+        glGenTextures(1, &probe);
+        glBindTexture(GL_TEXTURE_2D, probe);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE16, 1, 1, 0,
+                     GL_LUMINANCE, GL_UNSIGNED_SHORT, nullptr);
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_LUMINANCE_SIZE, &bits);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glDeleteTextures(1, &probe);
+        index16Exact_ = (bits >= 16);
+        palettedSupported_ = true;
+    }
+
+    // Volume slicing: float volume textures, R32F (GL 3.0 / ARB_texture_rg)
+    // or luminance
+    if (major >= 3 || (hasExtension(extensions, "GL_ARB_texture_rg") &&
+                       hasExtension(extensions, "GL_ARB_texture_float")))
+        volumeFormat_ = GL_R32F;
+    else if (hasExtension(extensions, "GL_ARB_texture_float"))
+        volumeFormat_ = GL_LUMINANCE32F_ARB;
+    else
+        volumeFormat_ = 0;
+
+    GLint units = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &units);
+    maxLayers_ = std::min(kMaxVolumeSliceLayers, static_cast<int>(units) - 1);
+    glGetIntegerv(GL_MAX_3D_TEXTURE_SIZE, &max3DSize_);
+
+    if (!volumeFormat_)
+    {
+        if (debugLoggingEnabled())
+            std::cerr << "[gpu-slicing] No float texture support\n";
+    }
+    else if (loadProc(loader, f.TexImage3D, "glTexImage3D") &&
+             maxLayers_ >= 1 && max3DSize_ > 0)
+    {
+        // Colour slots: one row of kVolumeSliceSlots texels per layer
+        glGenTextures(1, &slotTex_);
+        glBindTexture(GL_TEXTURE_2D, slotTex_);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, kVolumeSliceSlots, kMaxVolumeSliceLayers, 0,
+                     GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        // A single-layer program must compile, otherwise nothing will work
+        supported_ = (program(1, false) != nullptr);
+        if (!supported_)
+        {
+            glDeleteTextures(1, &slotTex_);
+            slotTex_ = 0;
+        }
+    }
+
+    if (!supported_ && !palettedSupported_)
+    {
+        shutdown();
+        return false;
+    }
+
+    if (debugLoggingEnabled())
+    {
+        if (supported_)
+            std::cerr << "[gpu-slicing] Enabled: " << maxLayers_ << " overlay layers, "
+                      << "3D textures up to " << max3DSize_ << "^3, "
+                      << (volumeFormat_ == GL_R32F ? "R32F" : "LUMINANCE32F") << "\n";
+        if (palettedSupported_)
+            std::cerr << "[gpu-slicing] Paletted slices: 8-bit"
+                      << (index16Exact_ ? " and 16-bit" : "") << " indices\n";
+    }
+    return true;
+}
+
+void GLVolumeSlicer::shutdown()
+{
+    for (auto& pair : programs_)
+        if (pair.second.program)
+            gl_->DeleteProgram(pair.second.program);
+    programs_.clear();
+    if (paletted_.program)
+        gl_->DeleteProgram(paletted_.program);
+    paletted_ = PalettedProgram{};
+    if (fbo_)
+        gl_->DeleteFramebuffers(1, &fbo_);
+    fbo_ = 0;
+    if (slotTex_)
+        glDeleteTextures(1, &slotTex_);
+    slotTex_ = 0;
+    if (lutTex_)
+        glDeleteTextures(1, &lutTex_);
+    lutTex_ = 0;
+    supported_ = false;
+    palettedSupported_ = false;
+}
+
+// ---------------------------------------------------------------------------
+// Programs
+// ---------------------------------------------------------------------------
+
+unsigned int GLVolumeSlicer::buildProgram(const std::string& fragmentSrc)
+{
+    GLFunctions& f = *gl_;
+
+    auto compile = [&](GLenum type, const std::string& src) -> GLuint {
+        GLuint sh = f.CreateShader(type);
+        const char* text = src.c_str();
+        f.ShaderSource(sh, 1, &text, nullptr);
+        f.CompileShader(sh);
+        GLint status = 0;
+        f.GetShaderiv(sh, GL_COMPILE_STATUS, &status);
+        if (!status)
+        {
+            GLint len = 0;
+            f.GetShaderiv(sh, GL_INFO_LOG_LENGTH, &len);
+            std::string log(static_cast<size_t>(std::max(len, 1)), '\0');
+            f.GetShaderInfoLog(sh, len, nullptr, &log[0]);
+            std::cerr << "[gpu-slicing] Shader compile failed: " << log << "\n";
+            f.DeleteShader(sh);
+            return 0;
+        }
+        return sh;
+    };
+
+    GLuint vs = compile(GL_VERTEX_SHADER, kVertexShader);
+    GLuint fs = vs ? compile(GL_FRAGMENT_SHADER, fragmentSrc) : 0;
+    if (!vs || !fs)
+    {
+        if (vs)
+            f.DeleteShader(vs);
+        return 0;
+    }
+
+    GLuint prog = f.CreateProgram();
+    f.AttachShader(prog, vs);
+    f.AttachShader(prog, fs);
+    f.LinkProgram(prog);
+    f.DeleteShader(vs);
+    f.DeleteShader(fs);
+    GLint status = 0;
+    f.GetProgramiv(prog, GL_LINK_STATUS, &status);
+    if (!status)
+    {
+        GLint len = 0;
+        f.GetProgramiv(prog, GL_INFO_LOG_LENGTH, &len);
+        std::string log(static_cast<size_t>(std::max(len, 1)), '\0');
+        f.GetProgramInfoLog(prog, len, nullptr, &log[0]);
+        std::cerr << "[gpu-slicing] Program link failed: " << log << "\n";
+        f.DeleteProgram(prog);
+        return 0;
+    }
+    return prog;
+}
+
+const GLVolumeSlicer::Program* GLVolumeSlicer::program(int count, bool blend)
+{
+    int key = count * 2 + (blend ? 1 : 0);
+    auto it = programs_.find(key);
+    if (it != programs_.end())
+        return it->second.program ? &it->second : nullptr;
+
+    // A failed build is cached as program 0 so it is not retried every frame
+    Program& p = programs_[key];
+    GLFunctions& f = *gl_;
+
+    GLuint prog = buildProgram(fragmentShaderSource(count, blend));
+    if (!prog)
+        return nullptr;
+
+    p.program = prog;
+    p.uSlots = f.GetUniformLocation(prog, "uSlots");
+    p.uSlotRows = f.GetUniformLocation(prog, "uSlotRows");
+    p.uHeight = f.GetUniformLocation(prog, "uHeight");
+    p.uDims = f.GetUniformLocation(prog, "uDims");
+    p.uBase = f.GetUniformLocation(prog, "uBase");
+    p.uDpx = f.GetUniformLocation(prog, "uDpx");
+    p.uDpy = f.GetUniformLocation(prog, "uDpy");
+    p.uRange = f.GetUniformLocation(prog, "uRange");
+    p.uAlpha = f.GetUniformLocation(prog, "uAlpha");
+    for (int i = 0; i < count; ++i)
+        p.uVol[i] = f.GetUniformLocation(prog, ("uVol" + std::to_string(i)).c_str());
+    return &p;
+}
+
+// ---------------------------------------------------------------------------
+// Volumes
+// ---------------------------------------------------------------------------
+
+std::unique_ptr<VolumeTexture> GLVolumeSlicer::createVolumeTexture(
+    int dimX, int dimY, int dimZ, const float* data)
+{
+    if (!supported_ || !data || dimX <= 0 || dimY <= 0 || dimZ <= 0 ||
+        dimX > max3DSize_ || dimY > max3DSize_ || dimZ > max3DSize_)
+        return nullptr;
+
+    while (glGetError() != GL_NO_ERROR) {}
+
+    GLuint tex = 0;
+    glGenTextures(1, &tex);
+    glBindTexture(GL_TEXTURE_3D, tex);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    GLenum format = (volumeFormat_ == GL_R32F) ? GL_RED : GL_LUMINANCE;
+    gl_->TexImage3D(GL_TEXTURE_3D, 0, static_cast<GLint>(volumeFormat_),
+                    dimX, dimY, dimZ, 0, format, GL_FLOAT, data);
+    glBindTexture(GL_TEXTURE_3D, 0);
+
+    // Out of memory (large multi-volume sessions): leave it to the CPU path
+    if (glGetError() != GL_NO_ERROR)
+    {
+        glDeleteTextures(1, &tex);
+        if (debugLoggingEnabled())
+            std::cerr << "[gpu-slicing] Failed to upload " << dimX << "x" << dimY
+                      << "x" << dimZ << " volume texture\n";
+        return nullptr;
+    }
+
+    auto vt = std::make_unique<VolumeTexture>();
+    vt->id = tex;
+    vt->dimX = dimX;
+    vt->dimY = dimY;
+    vt->dimZ = dimZ;
+    return vt;
+}
+
+void GLVolumeSlicer::destroyVolumeTexture(VolumeTexture* vt)
+{
+    if (!vt || !vt->id)
+        return;
+    GLuint tex = static_cast<GLuint>(vt->id);
+    glDeleteTextures(1, &tex);
+    vt->id = 0;
+}
+
+// ---------------------------------------------------------------------------
+// Index textures
+// ---------------------------------------------------------------------------
+
+std::unique_ptr<IndexTexture> GLVolumeSlicer::createIndexTexture(int w, int h, int indexBytes)
+{
+    if (!palettedSupported_ || w <= 0 || h <= 0 || indexBytes < 1 || indexBytes > 2 ||
+        (indexBytes == 2 && !index16Exact_))
+        return nullptr;
+
+    GLuint tex = 0;
+    glGenTextures(1, &tex);
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    if (indexBytes == 1)
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE8, w, h, 0,
+                     GL_LUMINANCE, GL_UNSIGNED_BYTE, nullptr);
+    else
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE16, w, h, 0,
+                     GL_LUMINANCE, GL_UNSIGNED_SHORT, nullptr);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    auto it = std::make_unique<IndexTexture>();
+    it->id = tex;
+    it->width = w;
+    it->height = h;
+    it->indexBytes = indexBytes;
+    return it;
+}
+
+bool GLVolumeSlicer::updateIndexTexture(IndexTexture* it, const void* indices)
+{
+    if (!it || !it->id || !indices)
+        return false;
+    glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(it->id));
+    // Rows are tightly packed: w bytes (or shorts) each
+    glPixelStorei(GL_UNPACK_ALIGNMENT, it->indexBytes);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, it->width, it->height, GL_LUMINANCE,
+                    it->indexBytes == 1 ? GL_UNSIGNED_BYTE : GL_UNSIGNED_SHORT, indices);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return true;
+}
+
+void GLVolumeSlicer::destroyIndexTexture(IndexTexture* it)
+{
+    if (!it || !it->id)
+        return;
+    GLuint tex = static_cast<GLuint>(it->id);
+    glDeleteTextures(1, &tex);
+    it->id = 0;
+}
+
+// ---------------------------------------------------------------------------
+// Rendering
+// ---------------------------------------------------------------------------
+
+template <typename Bind, typename Unbind>
+bool GLVolumeSlicer::drawInto(unsigned int targetTex, int w, int h, unsigned int prog,
+                              Bind&& bind, Unbind&& unbind)
+{
+    GLFunctions& f = *gl_;
+
+    GLint prevFbo = 0, prevProgram = 0, prevActive = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &prevFbo);
+    glGetIntegerv(GL_CURRENT_PROGRAM, &prevProgram);
+    glGetIntegerv(GL_ACTIVE_TEXTURE, &prevActive);
+    glPushAttrib(GL_ALL_ATTRIB_BITS);
+
+    f.BindFramebuffer(GL_FRAMEBUFFER, fbo_);
+    f.FramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, targetTex, 0);
+    bool complete = (f.CheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+
+    if (complete)
+    {
+        f.UseProgram(prog);
+        bind();
+
+        glViewport(0, 0, w, h);
+        glDisable(GL_BLEND);
+        glDisable(GL_DEPTH_TEST);
+        glDisable(GL_SCISSOR_TEST);
+        glDisable(GL_CULL_FACE);
+        glBegin(GL_QUADS);
+        glVertex2f(-1.0f, -1.0f);
+        glVertex2f( 1.0f, -1.0f);
+        glVertex2f( 1.0f,  1.0f);
+        glVertex2f(-1.0f,  1.0f);
+        glEnd();
+
+        unbind();
+    }
+
+    f.FramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+    glPopAttrib();
+    f.UseProgram(static_cast<GLuint>(prevProgram));
+    f.ActiveTexture(static_cast<GLenum>(prevActive));
+    f.BindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(prevFbo));
+    return complete;
+}
+
+bool GLVolumeSlicer::render(unsigned int targetTex, int w, int h,
+                            const VolumeSliceLayer* layers, int count, bool blend)
+{
+    if (!supported_ || w <= 0 || h <= 0 || count < 1 || count > maxLayers_ ||
+        (!blend && count != 1))
+        return false;
+    for (int i = 0; i < count; ++i)
+        if (!layers[i].volume || !layers[i].volume->id || !layers[i].slots)
+            return false;
+
+    const Program* prog = program(count, blend);
+    if (!prog)
+        return false;
+
+    GLFunctions& f = *gl_;
+
+    auto bind = [&]() {
+        // Colour slot rows (under, LUT, over per layer): ~1 KB per layer
+        std::vector<uint32_t> slotRows(static_cast<size_t>(count) * kVolumeSliceSlots);
+        for (int i = 0; i < count; ++i)
+            std::memcpy(&slotRows[static_cast<size_t>(i) * kVolumeSliceSlots],
+                        layers[i].slots, kVolumeSliceSlots * sizeof(uint32_t));
+
+        f.ActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, slotTex_);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, kVolumeSliceSlots, count,
+                        GL_RGBA, GL_UNSIGNED_BYTE, slotRows.data());
+        for (int i = 0; i < count; ++i)
+        {
+            f.ActiveTexture(GL_TEXTURE0 + 1 + i);
+            glBindTexture(GL_TEXTURE_3D, static_cast<GLuint>(layers[i].volume->id));
+        }
+
+        std::vector<float> dims(3 * count), base(3 * count), dpx(3 * count),
+                           dpy(3 * count), range(4 * count), alpha(count);
+        for (int i = 0; i < count; ++i)
+        {
+            const VolumeSliceLayer& L = layers[i];
+            dims[3 * i + 0] = static_cast<float>(L.volume->dimX);
+            dims[3 * i + 1] = static_cast<float>(L.volume->dimY);
+            dims[3 * i + 2] = static_cast<float>(L.volume->dimZ);
+            for (int c = 0; c < 3; ++c)
+            {
+                base[3 * i + c] = L.base[c];
+                dpx[3 * i + c] = L.dpx[c];
+                dpy[3 * i + c] = L.dpy[c];
+            }
+            range[4 * i + 0] = L.rangeMin;
+            range[4 * i + 1] = L.rangeMax;
+            range[4 * i + 2] = L.invSpan;
+            range[4 * i + 3] = L.useLog ? 1.0f : 0.0f;
+            alpha[i] = L.alpha;
+        }
+
+        f.Uniform1i(prog->uSlots, 0);
+        f.Uniform1f(prog->uSlotRows, static_cast<float>(kMaxVolumeSliceLayers));
+        f.Uniform1f(prog->uHeight, static_cast<float>(h));
+        f.Uniform3fv(prog->uDims, count, dims.data());
+        f.Uniform3fv(prog->uBase, count, base.data());
+        f.Uniform3fv(prog->uDpx, count, dpx.data());
+        f.Uniform3fv(prog->uDpy, count, dpy.data());
+        f.Uniform4fv(prog->uRange, count, range.data());
+        if (prog->uAlpha >= 0)
+            f.Uniform1fv(prog->uAlpha, count, alpha.data());
+        for (int i = 0; i < count; ++i)
+            f.Uniform1i(prog->uVol[i], 1 + i);
+    };
+    auto unbind = [&]() {
+        for (int i = 0; i < count; ++i)
+        {
+            f.ActiveTexture(GL_TEXTURE0 + 1 + i);
+            glBindTexture(GL_TEXTURE_3D, 0);
+        }
+        f.ActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    };
+    return drawInto(targetTex, w, h, prog->program, bind, unbind);
+}
+
+bool GLVolumeSlicer::renderPaletted(unsigned int targetTex, const IndexTexture& indices,
+                                    const uint32_t* palette, int paletteSize)
+{
+    if (!palettedSupported_ || !indices.id || !palette || paletteSize < 1 ||
+        paletteSize > kVolumeSliceSlots)
+        return false;
+
+    GLFunctions& f = *gl_;
+    const PalettedProgram& prog = paletted_;
+
+    auto bind = [&]() {
+        // The whole colour change: paletteSize RGBA texels, ~1 KB
+        f.ActiveTexture(GL_TEXTURE0 + 1);
+        glBindTexture(GL_TEXTURE_1D, lutTex_);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexSubImage1D(GL_TEXTURE_1D, 0, 0, paletteSize, GL_RGBA, GL_UNSIGNED_BYTE, palette);
+        f.ActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(indices.id));
+
+        f.Uniform1i(prog.uIndex, 0);
+        f.Uniform1i(prog.uLut, 1);
+        f.Uniform2f(prog.uSize, static_cast<float>(indices.width),
+                    static_cast<float>(indices.height));
+        f.Uniform1f(prog.uIndexScale, indices.indexBytes == 1 ? 255.0f : 65535.0f);
+        f.Uniform1f(prog.uLutSize, static_cast<float>(kVolumeSliceSlots));
+    };
+    auto unbind = [&]() {
+        f.ActiveTexture(GL_TEXTURE0 + 1);
+        glBindTexture(GL_TEXTURE_1D, 0);
+        f.ActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    };
+    return drawInto(targetTex, indices.width, indices.height, prog.program, bind, unbind);
+}
@@ -1,14 +1,10 @@
-#define STB_IMAGE_WRITE_IMPLEMENTATION
-#include "stb_image_write.h"
-
-#include "OsPrefetch.h"
-
 #include <imgui.h>
 #include <imgui_internal.h>
 
 #include "Interface.h"
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <cstdio>
 #include <filesystem>
@@ -19,6 +15,7 @@
 
 #include "AppConfig.h"
 #include "ColourMap.h"
+#include "FrameRecorder.h"
 #include "GraphicsBackend.h"
 #include "Prefetcher.h"
 #include "QCState.h"
@@ -129,6 +126,41 @@ std::vector<uint8_t> generateCurrentIcon(int size)
     return pixels;
 }
 
+// ---------------------------------------------------------------------------
+// Slice image drawing
+// ---------------------------------------------------------------------------
+
+/// ImGui::Image() for a texture that may be a sub-image of an atlas page.
+/// Texture coordinates outside 0..1 (panned past the edge) show black, as
+/// the standalone textures' border colour does; for a sub-image the quad is
+/// clipped instead so neighbouring textures on the page never show.
+void sliceImage(const Texture& tex, const ImVec2& size, const ImVec2& uv0, const ImVec2& uv1)
+{
+    if (!tex.isSubImage())
+    {
+        ImGui::Image(tex.id, size, uv0, uv1);
+        return;
+    }
+
+    ImVec2 p0 = ImGui::GetCursorScreenPos();
+    ImGui::Dummy(size);
+    ImDrawList* dl = ImGui::GetWindowDrawList();
+    dl->AddRectFilled(p0, ImVec2(p0.x + size.x, p0.y + size.y), IM_COL32(0, 0, 0, 255));
+
+    float du = uv1.x - uv0.x;
+    float dv = uv1.y - uv0.y;
+    if (du <= 0.0f || dv <= 0.0f)
+        return;
+    float u0 = std::clamp(uv0.x, 0.0f, 1.0f), u1 = std::clamp(uv1.x, 0.0f, 1.0f);
+    float v0 = std::clamp(uv0.y, 0.0f, 1.0f), v1 = std::clamp(uv1.y, 0.0f, 1.0f);
+    if (u0 >= u1 || v0 >= v1)
+        return;
+
+    ImVec2 q0(p0.x + (u0 - uv0.x) / du * size.x, p0.y + (v0 - uv0.y) / dv * size.y);
+    ImVec2 q1(p0.x + (u1 - uv0.x) / du * size.x, p0.y + (v1 - uv0.y) / dv * size.y);
+    dl->AddImage(tex.id, q0, q1, tex.mapUV(ImVec2(u0, v0)), tex.mapUV(ImVec2(u1, v1)));
+}
+
 } // anonymous namespace
 
 Interface::Interface(AppState& state, ViewManager& viewManager, QCState& qcState)
@@ -138,6 +170,12 @@ Interface::~Interface() = default;
 
 void Interface::render(GraphicsBackend& backend, GLFWwindow* window) {
     interfaceWindow_ = window;
+
+    processCaptures(backend);
+    if (screenshotPending_)
+        saveScreenshot(backend);
+    if (recording_)
+        recordFrame(backend);
     
     // Initialize icon textures if not already done
     if (!transparentIcon_ || transparentIcon_->id == 0)
@@ -226,11 +264,11 @@ void Interface::render(GraphicsBackend& backend, GLFWwindow* window) {
             //
             // Ideal Tools height: count the fixed UI rows:
             //   Overlay/Sync checkboxes (~5), view checkboxes (3), Tags label (1),
-            //   Save/Load Config (2), Reset/Screenshot/Clean/Hotkeys/Quit (5),
-            //   Separators/Spacing (~4) → ~20 rows × (lineHeight + spacing)
+            //   Save/Load Config (2), Reset/Screenshot/Record/Clean/Hotkeys/Quit (6),
+            //   Separators/Spacing (~4) → ~21 rows × (lineHeight + spacing)
             float lineH   = ImGui::GetTextLineHeight() + ImGui::GetStyle().ItemSpacing.y;
             float padding = ImGui::GetStyle().WindowPadding.y * 2.0f;
-            float idealToolsH = lineH * 22.0f + padding;        // generous fixed height
+            float idealToolsH = lineH * 23.0f + padding;        // generous fixed height
             float minTagsH    = lineH * 6.0f  + padding;        // minimum for tag table
 
             // Clamp so Tags always has at least minTagsH pixels
@@ -326,15 +364,20 @@ void Interface::render(GraphicsBackend& backend, GLFWwindow* window) {
             state_.cleanMode_ = !state_.cleanMode_;
             state_.layoutInitialized_ = false;
         }
-        if (ImGui::IsKeyPressed(ImGuiKey_P)) {
-            saveScreenshot(backend);
+        if (ImGui::IsKeyPressed(ImGuiKey_P, false)) {
+            if (!ImGui::GetIO().KeyShift)
+                saveScreenshot(backend);
+            else if (recording_)
+                stopRecording();
+            else
+                startRecording("", recordEvery_);
         }
 
         if (qcState_.active) {
             if (ImGui::IsKeyPressed(ImGuiKey_RightBracket, false))
-                switchQCRow(qcState_.currentRowIndex + 1, backend);
+                switchQCRow(qcState_.stepRow(qcState_.currentRowIndex, 1));
             if (ImGui::IsKeyPressed(ImGuiKey_LeftBracket, false))
-                switchQCRow(qcState_.currentRowIndex - 1, backend);
+                switchQCRow(qcState_.stepRow(qcState_.currentRowIndex, -1));
 
             if (qcState_.singleVerdictMode && qcState_.currentRowIndex >= 0)
             {
@@ -347,9 +390,9 @@ void Interface::render(GraphicsBackend& backend, GLFWwindow* window) {
                 {
                     if (ImGui::IsKeyPressed(digitKeys[i], false))
                     {
-                        qcState_.results[qcState_.currentRowIndex].verdicts[0] = i;
-                        if (autosave_) qcState_.saveOutputCsv();
-                        switchQCRow(qcState_.currentRowIndex + 1, backend);
+                        qcState_.setVerdict(qcState_.currentRowIndex, 0, i);
+                        if (autosave_) qcState_.recordRow(qcState_.currentRowIndex);
+                        switchQCRow(qcState_.stepRow(qcState_.currentRowIndex, 1));
                         break;
                     }
                 }
@@ -403,7 +446,7 @@ void Interface::render(GraphicsBackend& backend, GLFWwindow* window) {
     }
 
     if (qcState_.active && qcState_.singleVerdictMode)
-        renderQCSingleVerdictPanel(backend);
+        renderQCSingleVerdictPanel();
 
     int overlayDirtyMask = 0;
     for (int vi = 0; vi < numVolumes; ++vi) {
@@ -424,8 +467,16 @@ void Interface::render(GraphicsBackend& backend, GLFWwindow* window) {
             showOverlayPanel = state_.showOverlay_;
         if (showOverlayPanel)
             renderOverlayPanel();
+        else
+            for (int v = 0; v < 3; ++v)
+                viewManager_.setOverlayViewDrawn(v, false);
     }
 
+    if (qcState_.active && thumbnails_ && thumbnailsVisible_)
+        renderThumbnailPanel(backend);
+    else if (!thumbnailTextures_.empty())
+        releaseThumbnails(backend);
+
     // Tags is a separate dock window in the left column below Tools.
     if (!qcState_.active && !state_.cleanMode_ && state_.volumeCount() > 0) {
         state_.tagListWindowVisible_ = true;
@@ -442,32 +493,150 @@ void Interface::render(GraphicsBackend& backend, GLFWwindow* window) {
     }
 }
 
+FrameRecorder& Interface::recorder() {
+    if (!recorder_)
+        recorder_ = std::make_unique<FrameRecorder>();
+    return *recorder_;
+}
+
+std::string Interface::nextScreenshotPath() {
+    // One directory scan per session instead of probing name after name
+    if (screenshotIndex_ == 0)
+        screenshotIndex_ = FrameRecorder::nextFreeIndex(".", "screenshot", ".png");
+    return FrameRecorder::numberedName("screenshot", screenshotIndex_++, ".png");
+}
+
 void Interface::saveScreenshot(GraphicsBackend& backend) {
+    if (!backend.supportsAsyncCapture()) {
+        captureNow(backend, CaptureTarget{nextScreenshotPath(), true});
+        return;
+    }
+    // Retried next frame while every readback buffer is in flight
+    uint64_t id = backend.requestCapture();
+    screenshotPending_ = (id == 0);
+    if (id != 0)
+        captureTargets_[id].push_back(CaptureTarget{nextScreenshotPath(), true});
+}
+
+void Interface::captureNow(GraphicsBackend& backend, const CaptureTarget& target) {
     int width = 0, height = 0;
     auto pixels = backend.captureScreenshot(width, height);
     if (pixels.empty() || width <= 0 || height <= 0) {
         std::cerr << "Screenshot: failed to capture framebuffer\n";
         return;
     }
+    submitCapture(target, std::move(pixels), width, height);
+}
+
+void Interface::submitCapture(const CaptureTarget& target, std::vector<uint8_t> pixels,
+                              int width, int height) {
+    bool queued = recorder().submit(target.path, std::move(pixels), width, height);
+    if (!target.announce)
+        return;   // recorded frames are summarised by stopRecording()
+    if (queued)
+        std::cout << "Screenshot saved: " << target.path << "\n";
+    else
+        std::cerr << "Screenshot: encoder queue full, dropped " << target.path << "\n";
+}
 
-    int index = 1;
-    std::string filename;
-    while (true) {
-        char fmtBuf[64];
-        std::snprintf(fmtBuf, sizeof(fmtBuf), "screenshot%06d.png", index);
-        filename = fmtBuf;
-        if (!std::filesystem::exists(filename))
-            break;
-        ++index;
+void Interface::processCaptures(GraphicsBackend& backend) {
+    std::vector<uint8_t> pixels;
+    int width = 0, height = 0;
+    uint64_t id = 0;
+    while (backend.takeCapture(pixels, width, height, id)) {
+        // Ids below this one were skipped by the backend
+        for (auto it = captureTargets_.begin(); it != captureTargets_.end() && it->first < id;
+             it = captureTargets_.erase(it))
+            std::cerr << "Screenshot: failed to capture framebuffer\n";
+
+        auto it = captureTargets_.find(id);
+        if (it == captureTargets_.end())
+            continue;
+        std::vector<CaptureTarget> targets = std::move(it->second);
+        captureTargets_.erase(it);
+        for (size_t i = 0; i < targets.size(); ++i) {
+            // The same frame may be both a screenshot and a recorded frame
+            if (i + 1 < targets.size())
+                submitCapture(targets[i], pixels, width, height);
+            else
+                submitCapture(targets[i], std::move(pixels), width, height);
+        }
+        pixels.clear();
     }
+}
 
-    int ok = stbi_write_png(filename.c_str(), width, height, 4, pixels.data(), width * 4);
-    if (!ok) {
-        std::cerr << "Screenshot: failed to write " << filename << "\n";
+void Interface::startRecording(const std::string& dir, int every) {
+    if (recording_)
+        stopRecording();
+
+    recordDir_ = dir;
+    if (recordDir_.empty()) {
+        int index = FrameRecorder::nextFreeIndex(".", "record", "");
+        recordDir_ = FrameRecorder::numberedName("record", index, "");
+    }
+    std::error_code ec;
+    std::filesystem::create_directories(recordDir_, ec);
+    if (ec) {
+        std::cerr << "Recording: cannot create " << recordDir_ << ": " << ec.message() << "\n";
         return;
     }
 
-    std::cout << "Screenshot saved: " << filename << "\n";
+    recording_ = true;
+    recordEvery_ = std::max(every, 1);
+    recordFrame_ = 0;
+    recordIndex_ = FrameRecorder::nextFreeIndex(recordDir_, "frame", ".png");
+    recordCaptured_ = 0;
+    recordDropped_ = 0;
+    recordEncoderDropped_ = recorder().stats().dropped;
+    std::cout << "Recording to " << recordDir_ << "/";
+    if (recordEvery_ > 1)
+        std::cout << " (every " << recordEvery_ << " frames)";
+    std::cout << "\n";
+}
+
+void Interface::stopRecording() {
+    if (!recording_)
+        return;
+    recording_ = false;
+    uint64_t dropped = recordDropped_ + recorder().stats().dropped - recordEncoderDropped_;
+    std::cout << "Recording stopped: " << recordCaptured_ << " frames to " << recordDir_ << "/";
+    if (dropped > 0)
+        std::cout << " (" << dropped << " dropped)";
+    std::cout << "\n";
+}
+
+void Interface::recordFrame(GraphicsBackend& backend) {
+    if (recordFrame_++ % static_cast<uint64_t>(recordEvery_) != 0)
+        return;
+
+    CaptureTarget target{(std::filesystem::path(recordDir_) /
+                          FrameRecorder::numberedName("frame", recordIndex_, ".png")).string(),
+                         false};
+    if (backend.supportsAsyncCapture()) {
+        uint64_t id = backend.requestCapture();
+        if (id == 0) {
+            ++recordDropped_;
+            return;
+        }
+        captureTargets_[id].push_back(std::move(target));
+    } else {
+        // Reads the previous frame and stalls; only backends without
+        // asynchronous readback get here
+        captureNow(backend, target);
+    }
+    ++recordIndex_;
+    ++recordCaptured_;
+}
+
+void Interface::finishCaptures(GraphicsBackend& backend) {
+    stopRecording();
+    processCaptures(backend);
+    for (const auto& entry : captureTargets_)
+        for (const CaptureTarget& target : entry.second)
+            std::cerr << "Screenshot: capture not completed for " << target.path << "\n";
+    captureTargets_.clear();
+    if (recorder_)
+        recorder_->waitIdle();
 }
 
 uint32_t Interface::resolveClampColour(int mode, ColourMapType currentMap, bool isOver) {
@@ -500,6 +669,18 @@ void Interface::renderToolsPanel(GraphicsBackend& backend, GLFWwindow* window) {
         if (qcState_.active) {
             ImGui::Text("QC Mode");
             ImGui::Text("%d / %d rated", qcState_.ratedCount(), qcState_.rowCount());
+            {
+                // Verdicts given so far (per column unless --qc1)
+                std::string counts;
+                for (int v = 0; v < static_cast<int>(qcState_.verdictOptions.size()); ++v)
+                {
+                    if (v > 0)
+                        counts += "  ";
+                    counts += qcState_.verdictOptions[v] + " " +
+                              std::to_string(qcState_.verdictCount(v));
+                }
+                ImGui::TextDisabled("%s", counts.c_str());
+            }
             if (qcState_.currentRowIndex >= 0)
                 ImGui::Text("ID: %s", qcState_.rowIds[qcState_.currentRowIndex].c_str());
             if (hasOverlay) {
@@ -608,6 +789,14 @@ void Interface::renderToolsPanel(GraphicsBackend& backend, GLFWwindow* window) {
             saveScreenshot(backend);
         }
 
+        if (ImGui::Button(recording_ ? "[Sh+P] Stop Recording" : "[Sh+P] Record",
+                          ImVec2(btnWidth, 0))) {
+            if (recording_)
+                stopRecording();
+            else
+                startRecording("", recordEvery_);
+        }
+
         ImGui::Separator();
 
         if (ImGui::Button("[C] Clean Mode", ImVec2(btnWidth, 0))) {
@@ -638,22 +827,76 @@ void Interface::renderToolsPanel(GraphicsBackend& backend, GLFWwindow* window) {
 
                 if (atFirst) ImGui::BeginDisabled();
                 if (ImGui::Button("<< Prev [", ImVec2(halfW, 0)))
-                    switchQCRow(qcState_.currentRowIndex - 1, backend);
+                    switchQCRow(qcState_.stepRow(qcState_.currentRowIndex, -1));
                 if (atFirst) ImGui::EndDisabled();
 
                 ImGui::SameLine();
 
                 if (atLast) ImGui::BeginDisabled();
                 if (ImGui::Button("] Next >>", ImVec2(halfW, 0)))
-                    switchQCRow(qcState_.currentRowIndex + 1, backend);
+                    switchQCRow(qcState_.stepRow(qcState_.currentRowIndex, 1));
                 if (atLast) ImGui::EndDisabled();
             }
 
             // --- Autosave checkbox + manual Save button ---
             ImGui::Checkbox("Autosave results", &autosave_);
+            if (thumbnails_)
+                ImGui::Checkbox("Thumbnails", &thumbnailsVisible_);
             if (ImGui::Button("Save Results", ImVec2(btnWidth, 0)))
                 qcState_.saveOutputCsv();
 
+            if (qcState_.workQueue)
+            {
+                const QCWorkQueue& queue = *qcState_.workQueue;
+                ImGui::TextDisabled("Queue: %s, %d block(s) of %d rows",
+                                    queue.rater().c_str(),
+                                    static_cast<int>(queue.heldBlocks().size()),
+                                    queue.blockRows());
+                if (ImGui::IsItemHovered())
+                    ImGui::SetTooltip("Shared work queue: %s\n"
+                                      "Next past the last held row claims another block",
+                                      queue.dir().c_str());
+            }
+            if (prefetcher_)
+            {
+                Prefetcher::Stats ps = prefetcher_->stats();
+                ImGui::TextDisabled("Prefetch: %d/%d hits, %.1f s stalled",
+                                    ps.hits, ps.switches, ps.stallSeconds);
+                if (ImGui::IsItemHovered())
+                    ImGui::SetTooltip("Window: %d ahead, %d behind\n"
+                                      "%.2f s per row, %.2f s to read a row",
+                                      ps.ahead, ps.behind, ps.secondsPerRow,
+                                      ps.rowLoadSeconds);
+            }
+            // Session timing: latency until the new row is on screen
+            const QCTimingSummary& ts = qcState_.timingSummary();
+            if (ts.visits > 0)
+            {
+                ImGui::TextDisabled("Row switch: p50 %.0f ms, p95 %.0f ms",
+                                    ts.firstImageP50 * 1000.0, ts.firstImageP95 * 1000.0);
+                if (ImGui::IsItemHovered())
+                    ImGui::SetTooltip("Until the first image, over %d row(s)\n"
+                                      "Switch work: p50 %.0f ms, p95 %.0f ms\n"
+                                      "Volumes: %d cached (%.1f s), %d read (%.1f s)\n"
+                                      "Verdict %.1f s after the image, %.1f s per row (p50)\n"
+                                      "%.0f rows per hour\n"
+                                      "Log: %s",
+                                      ts.visits, ts.switchP50 * 1000.0, ts.switchP95 * 1000.0,
+                                      ts.cacheHits, ts.hitLoad, ts.cacheMisses, ts.missLoad,
+                                      ts.verdictP50, ts.dwellP50, ts.rowsPerHour,
+                                      qcState_.outputCsvPath.empty()
+                                          ? "(none)" : qcState_.timingPath().c_str());
+            }
+            if (debugLoggingEnabled() && qcState_.rowVisitOpen())
+            {
+                const QCRowVisit& last = qcState_.rowVisits().back();
+                ImGui::TextDisabled("Last switch: %.0f ms", last.switchSeconds() * 1000.0);
+                if (ImGui::IsItemHovered())
+                    ImGui::SetTooltip("Read %.0f ms, load %.0f ms, textures %.0f ms",
+                                      last.read * 1000.0, last.load * 1000.0,
+                                      last.textures * 1000.0);
+            }
+
             // Fill remaining vertical space with a scrollable child
             ImVec2 remaining = ImGui::GetContentRegionAvail();
             ImGui::BeginChild("##qc_list_embed", remaining, ImGuiChildFlags_Borders);
@@ -679,98 +922,111 @@ void Interface::renderToolsPanel(GraphicsBackend& backend, GLFWwindow* window) {
                     ImGui::TableSetupScrollFreeze(0, 1);
                     ImGui::TableHeadersRow();
 
-                    for (int ri = 0; ri < qcState_.rowCount(); ++ri)
+                    // Only the visible rows are submitted, so the list costs
+                    // the same for any study size
+                    ImGuiListClipper clipper;
+                    clipper.Begin(qcState_.rowCount());
+                    if (scrollToCurrentRow_ && qcState_.currentRowIndex >= 0)
+                        clipper.IncludeItemByIndex(qcState_.currentRowIndex);
+                    while (clipper.Step())
                     {
-                        ImGui::TableNextRow();
-
-                        const auto& result = qcState_.results[ri];
-                        int nOpts = static_cast<int>(qcState_.verdictOptions.size());
-                        // worstVerdict: highest index seen (worst = last option).
-                        // allBest: all verdicts are index 0.
-                        int worstVerdict = QC_UNKNOWN;
-                        bool allBest = true;
-                        if (qcState_.singleVerdictMode)
-                        {
-                            int v = result.verdicts.empty() ? QC_UNKNOWN : result.verdicts[0];
-                            worstVerdict = v;
-                            allBest = (v == 0);
-                        }
-                        else
+                        for (int ri = clipper.DisplayStart; ri < clipper.DisplayEnd; ++ri)
                         {
-                            for (int ci = 0; ci < numCols; ++ci)
+                            ImGui::TableNextRow();
+
+                            const auto& result = qcState_.results[ri];
+                            int nOpts = static_cast<int>(qcState_.verdictOptions.size());
+                            // worstVerdict: highest index seen (worst = last option).
+                            // allBest: all verdicts are index 0.
+                            int worstVerdict = QC_UNKNOWN;
+                            bool allBest = true;
+                            if (qcState_.singleVerdictMode)
                             {
-                                int v = result.verdicts[ci];
-                                if (v > worstVerdict) worstVerdict = v;
-                                if (v != 0) allBest = false;
+                                int v = result.verdicts.empty() ? QC_UNKNOWN : result.verdicts[0];
+                                worstVerdict = v;
+                                allBest = (v == 0);
+                            }
+                            else
+                            {
+                                for (int ci = 0; ci < numCols; ++ci)
+                                {
+                                    int v = result.verdicts[ci];
+                                    if (v > worstVerdict) worstVerdict = v;
+                                    if (v != 0) allBest = false;
+                                }
+                                if (numCols == 0) allBest = false;
                             }
-                            if (numCols == 0) allBest = false;
-                        }
-
-                        if (worstVerdict == nOpts - 1)
-                            ImGui::TableSetBgColor(ImGuiTableBgTarget_RowBg0,
-                                IM_COL32(180, 40, 40, 60));
-                        else if (worstVerdict > 0)
-                            ImGui::TableSetBgColor(ImGuiTableBgTarget_RowBg0,
-                                IM_COL32(180, 140, 40, 60));
-                        else if (allBest && worstVerdict == 0)
-                            ImGui::TableSetBgColor(ImGuiTableBgTarget_RowBg0,
-                                IM_COL32(40, 180, 40, 60));
-
-                        ImGui::TableSetColumnIndex(0);
-
-                        bool isCurrent = (ri == qcState_.currentRowIndex);
-                        char selectId[64];
-                        std::snprintf(selectId, sizeof(selectId), "##qc_%d", ri);
-                        ImGuiSelectableFlags selFlags = ImGuiSelectableFlags_SpanAllColumns
-                                                      | ImGuiSelectableFlags_AllowOverlap;
-                        if (ImGui::Selectable(selectId, isCurrent, selFlags))
-                            switchQCRow(ri, backend);
-
-                        if (isCurrent && scrollToCurrentRow_)
-                        {
-                            ImGui::SetScrollHereY();
-                            scrollToCurrentRow_ = false;
-                        }
 
-                        ImGui::SameLine();
-                        ImGui::Text("%d", ri);
+                            if (worstVerdict == nOpts - 1)
+                                ImGui::TableSetBgColor(ImGuiTableBgTarget_RowBg0,
+                                    IM_COL32(180, 40, 40, 60));
+                            else if (worstVerdict > 0)
+                                ImGui::TableSetBgColor(ImGuiTableBgTarget_RowBg0,
+                                    IM_COL32(180, 140, 40, 60));
+                            else if (allBest && worstVerdict == 0)
+                                ImGui::TableSetBgColor(ImGuiTableBgTarget_RowBg0,
+                                    IM_COL32(40, 180, 40, 60));
+
+                            ImGui::TableSetColumnIndex(0);
+
+                            bool isCurrent = (ri == qcState_.currentRowIndex);
+                            char selectId[64];
+                            std::snprintf(selectId, sizeof(selectId), "##qc_%d", ri);
+                            ImGuiSelectableFlags selFlags = ImGuiSelectableFlags_SpanAllColumns
+                                                          | ImGuiSelectableFlags_AllowOverlap;
+                            // Rows another rater of the work queue may hold
+                            bool available = qcState_.rowAvailable(ri);
+                            if (!available) ImGui::BeginDisabled();
+                            if (ImGui::Selectable(selectId, isCurrent, selFlags))
+                                switchQCRow(ri);
+                            if (!available) ImGui::EndDisabled();
+
+                            if (isCurrent && scrollToCurrentRow_)
+                            {
+                                ImGui::SetScrollHereY();
+                                scrollToCurrentRow_ = false;
+                            }
 
-                        ImGui::TableSetColumnIndex(1);
-                        ImGui::Text("%s", qcState_.rowIds[ri].c_str());
+                            ImGui::SameLine();
+                            ImGui::Text("%d", ri);
+
+                            ImGui::TableSetColumnIndex(1);
+                            ImGui::Text("%s", qcState_.rowIds[ri].c_str());
+
+                            // Helper: colour-code a single verdict cell by index.
+                            // Index 0 = best (green), N-1 = worst (red), middle = amber.
+                            auto renderVerdictCell = [&](QCVerdict v) {
+                                if (v == QC_UNKNOWN)
+                                {
+                                    ImGui::TextDisabled("-");
+                                    return;
+                                }
+                                std::string label = (v >= 0 && v < nOpts)
+                                    ? qcState_.verdictOptions[v].substr(0, 1)
+                                    : "?";
+                                ImVec4 col;
+                                if (v == 0)
+                                    col = ImVec4(0.2f, 0.9f, 0.2f, 1.0f);           // green
+                                else if (v == nOpts - 1)
+                                    col = ImVec4(0.9f, 0.2f, 0.2f, 1.0f);           // red
+                                else
+                                    col = ImVec4(0.9f, 0.75f, 0.1f, 1.0f);          // amber
+                                ImGui::TextColored(col, "%s", label.c_str());
+                            };
 
-                        // Helper: colour-code a single verdict cell by index.
-                        // Index 0 = best (green), N-1 = worst (red), middle = amber.
-                        auto renderVerdictCell = [&](QCVerdict v) {
-                            if (v == QC_UNKNOWN)
+                            if (qcState_.singleVerdictMode)
                             {
-                                ImGui::TextDisabled("-");
-                                return;
+                                ImGui::TableSetColumnIndex(2);
+                                QCVerdict v = result.verdicts.empty() ? QC_UNKNOWN : result.verdicts[0];
+                                renderVerdictCell(v);
                             }
-                            std::string label = (v >= 0 && v < nOpts)
-                                ? qcState_.verdictOptions[v].substr(0, 1)
-                                : "?";
-                            ImVec4 col;
-                            if (v == 0)
-                                col = ImVec4(0.2f, 0.9f, 0.2f, 1.0f);           // green
-                            else if (v == nOpts - 1)
-                                col = ImVec4(0.9f, 0.2f, 0.2f, 1.0f);           // red
                             else
-                                col = ImVec4(0.9f, 0.75f, 0.1f, 1.0f);          // amber
-                            ImGui::TextColored(col, "%s", label.c_str());
-                        };
-
-                        if (qcState_.singleVerdictMode)
-                        {
-                            ImGui::TableSetColumnIndex(2);
-                            QCVerdict v = result.verdicts.empty() ? QC_UNKNOWN : result.verdicts[0];
-                            renderVerdictCell(v);
-                        }
-                        else
-                        {
-                            for (int ci = 0; ci < numCols; ++ci)
                             {
-                                ImGui::TableSetColumnIndex(2 + ci);
-                                renderVerdictCell(result.verdicts[ci]);
+                                for (int ci = 0; ci < numCols; ++ci)
+                                {
+                                    ImGui::TableSetColumnIndex(2 + ci);
+                                    renderVerdictCell(result.verdicts[ci]);
+                                }
                             }
                         }
                     }
@@ -806,6 +1062,7 @@ void Interface::renderToolsPanel(GraphicsBackend& backend, GLFWwindow* window) {
             row("R",         "Reset views");
             row("C",         "Clean mode");
             row("P",         "Screenshot");
+            row("Shift+P",   "Start/stop recording frames");
             row("Q",         "Quit");
             row("H / ?",     "Toggle this window");
             if (qcState_.active)
@@ -851,6 +1108,7 @@ void Interface::renderHotkeyPanel() {
             row("R",         "Reset views");
             row("C",         "Clean mode");
             row("P",         "Screenshot");
+            row("Shift+P",   "Start/stop recording frames");
             row("Q",         "Quit");
             if (qcState_.active)
             {
@@ -887,7 +1145,10 @@ int Interface::renderVolumeColumn(int vi) {
     {
         // Handle missing/failed volumes (placeholders have empty data)
         if (vol.data.empty()) {
-            ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "Volume not loaded");
+            if (state_.isVolumeLoading(vi))
+                ImGui::TextDisabled("Loading...");
+            else
+                ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "Volume not loaded");
             if (!state_.volumePaths_[vi].empty())
                 ImGui::TextWrapped("File: %s", state_.volumePaths_[vi].c_str());
             float viewWidth = ImGui::GetContentRegionAvail().x;
@@ -954,12 +1215,15 @@ int Interface::renderVolumeColumn(int vi) {
                 viewHeights[v] = 40.0f * state_.dpiScale_;
         }
 
-        // Collect indices of visible views for rendering and splitters
+        // Collect indices of visible views for rendering and splitters;
+        // hidden planes defer their texture updates until shown again
         std::vector<int> visibleViews;
         for (int v = 0; v < 3; ++v)
         {
             if (state_.viewVisible[v])
                 visibleViews.push_back(v);
+            else
+                viewManager_.setViewDrawn(vi, v, false);
         }
 
         for (size_t i = 0; i < visibleViews.size(); ++i)
@@ -1545,6 +1809,8 @@ void Interface::renderOverlayPanel() {
         {
             if (state_.viewVisible[v])
                 visibleViews.push_back(v);
+            else
+                viewManager_.setOverlayViewDrawn(v, false);
         }
 
         int overlayDirtyMask = 0;
@@ -1869,9 +2135,12 @@ int Interface::renderSliceView(int vi, int viewIndex, const ImVec2& childSize) {
     const Volume& vol = state_.volumes_[vi];
 
     ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0, 0));
-    ImGui::BeginChild(childId, childSize, ImGuiChildFlags_None,
+    // False when the column is collapsed, a hidden tab, or the view is
+    // clipped; a view that comes back is regenerated here before drawing.
+    bool drawn = ImGui::BeginChild(childId, childSize, ImGuiChildFlags_None,
         ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoScrollWithMouse);
     ImGui::PopStyleVar();
+    viewManager_.setViewDrawn(vi, viewIndex, drawn);
     {
         if (state.sliceTextures[viewIndex]) {
             Texture* tex = state.sliceTextures[viewIndex].get();
@@ -1938,9 +2207,7 @@ int Interface::renderSliceView(int vi, int viewIndex, const ImVec2& childSize) {
                 ImVec2 uv0(centerU - halfU, centerV - halfV);
                 ImVec2 uv1(centerU + halfU, centerV + halfV);
 
-                ImGui::Image(
-                    tex->id,
-                    imgSize, uv0, uv1);
+                sliceImage(*tex, imgSize, uv0, uv1);
 
                 if (state_.showCrosshairs_) {
                     ImDrawList* dl = ImGui::GetWindowDrawList();
@@ -2211,9 +2478,10 @@ int Interface::renderOverlayView(int viewIndex, const ImVec2& childSize) {
     std::snprintf(childId, sizeof(childId), "##overlay_%d", viewIndex);
 
     ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0, 0));
-    ImGui::BeginChild(childId, childSize, ImGuiChildFlags_None,
+    bool drawn = ImGui::BeginChild(childId, childSize, ImGuiChildFlags_None,
         ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoScrollWithMouse);
     ImGui::PopStyleVar();
+    viewManager_.setOverlayViewDrawn(viewIndex, drawn);
     {
         if (state_.overlay_.textures[viewIndex]) {
             Texture* tex = state_.overlay_.textures[viewIndex].get();
@@ -2275,9 +2543,7 @@ int Interface::renderOverlayView(int viewIndex, const ImVec2& childSize) {
                 ImVec2 uv0(centerU - halfU, centerV - halfV);
                 ImVec2 uv1(centerU + halfU, centerV + halfV);
 
-                ImGui::Image(
-                    tex->id,
-                    imgSize, uv0, uv1);
+                sliceImage(*tex, imgSize, uv0, uv1);
 
                 if (state_.showCrosshairs_) {
                     ImDrawList* dl = ImGui::GetWindowDrawList();
@@ -2539,8 +2805,8 @@ bool Interface::drawTagsOnSlice(int viewIndex, const ImVec2& imgPos,
     return drawn;
 }
 
-void Interface::switchQCRow(int newRow, GraphicsBackend& backend) {
-    if (newRow < 0 || newRow >= qcState_.rowCount())
+void Interface::switchQCRow(int newRow) {
+    if (!qcState_.rowAvailable(newRow))
         return;
     if (newRow == qcState_.currentRowIndex)
         return;
@@ -2566,14 +2832,35 @@ void Interface::switchQCRow(int newRow, GraphicsBackend& backend) {
                          vs.underColourMode, vs.overColourMode, vs.overlayAlpha});
     }
 
+    using Clock = std::chrono::steady_clock;
+    auto seconds = [](Clock::time_point a, Clock::time_point b) {
+        return std::chrono::duration<double>(b - a).count();
+    };
+    const Clock::time_point start = Clock::now();
+
+    const int fromRow = qcState_.currentRowIndex;
     qcState_.currentRowIndex = newRow;
 
-    // Wait for the GPU to finish before destroying old textures
-    backend.waitIdle();
-    viewManager_.destroyAllTextures();
+    // Keep the old row's textures for the new volumes: same-sized views are
+    // updated in place, and the backend defers freeing the rest until no
+    // in-flight frame uses them, so switching rows never waits for the GPU.
+    viewManager_.detachTextures();
 
     const auto& paths = qcState_.pathsForRow(newRow);
-    state_.loadVolumeSet(paths);
+    // Which volumes the switch finds cached, before the prefetcher reads more
+    std::vector<bool> cached;
+    for (const std::string& path : paths)
+        cached.push_back(!path.empty() && state_.volumeCache_.contains(path));
+    if (prefetcher_)
+    {
+        // Moves the prefetch window; the row itself is read first
+        prefetcher_->rowChanged(newRow, qcState_);
+        prefetcher_->awaitRow(paths);
+    }
+    const Clock::time_point read = Clock::now();
+    std::vector<double> loadSeconds;
+    state_.loadVolumeSet(paths, &loadSeconds);
+    const Clock::time_point loaded = Clock::now();
 
     // Restore per-column display settings from previous row
     for (int ci = 0; ci < state_.volumeCount() && ci < static_cast<int>(saved.size()); ++ci)
@@ -2595,41 +2882,219 @@ void Interface::switchQCRow(int newRow, GraphicsBackend& backend) {
         vs.overlayAlpha = saved[ci].overlayAlpha;
     }
 
+    viewManager_.reattachTextures();
     viewManager_.initializeAllTextures();
 
+    const Clock::time_point done = Clock::now();
+    QCRowVisit visit;
+    visit.row = newRow;
+    visit.fromRow = fromRow;
+    visit.read = seconds(start, read);
+    visit.load = seconds(read, loaded);
+    visit.textures = seconds(loaded, done);
+    // Waiting for the prefetcher is spent on the volumes it had not read
+    visit.missLoad = visit.read;
+    for (size_t i = 0; i < cached.size() && i < loadSeconds.size(); ++i)
+    {
+        if (paths[i].empty())
+            continue;
+        if (cached[i])
+        {
+            ++visit.cacheHits;
+            visit.hitLoad += loadSeconds[i];
+        }
+        else
+        {
+            ++visit.cacheMisses;
+            visit.missLoad += loadSeconds[i];
+        }
+    }
+    qcState_.beginRowVisit(visit, start);
+    if (debugLoggingEnabled())
+        std::cerr << "[qc] row " << newRow << ": " << visit.switchSeconds() * 1000.0
+                  << " ms (read " << visit.read * 1000.0
+                  << ", load " << visit.load * 1000.0
+                  << ", textures " << visit.textures * 1000.0 << "; "
+                  << visit.cacheHits << " cached, " << visit.cacheMisses << " read)\n";
+
     // Rebuild column display names from QC headers
     columnNames_.clear();
     for (int ci = 0; ci < qcState_.columnCount(); ++ci)
         columnNames_.push_back(qcState_.columnNames[ci]);
 
     scrollToCurrentRow_ = true;
+}
 
-    // Queue adjacent rows for prefetching (loaded on main thread).
-    if (prefetcher_)
+ThumbnailCache::Request Interface::thumbnailRequest(int column, const std::string& path) const {
+    ThumbnailCache::Request r;
+    r.path = path;
+    if (column < static_cast<int>(qcState_.columnNames.size()))
     {
-        std::vector<std::string> prefetchPaths;
-        // Collect paths for the previous row
-        if (newRow > 0)
+        auto it = qcState_.columnConfigs.find(qcState_.columnNames[column]);
+        if (it != qcState_.columnConfigs.end())
         {
-            const auto& prev = qcState_.pathsForRow(newRow - 1);
-            prefetchPaths.insert(prefetchPaths.end(), prev.begin(), prev.end());
+            if (auto cm = colourMapByName(it->second.colourMap))
+                r.params.colourMap = *cm;
+            if (it->second.valueMin && it->second.valueMax)
+            {
+                r.params.valueMin = *it->second.valueMin;
+                r.params.valueMax = *it->second.valueMax;
+                r.autoRange = false;
+            }
         }
-        // Collect paths for the next row
-        if (newRow + 1 < qcState_.rowCount())
+    }
+    return r;
+}
+
+void Interface::renderThumbnailPanel(GraphicsBackend& backend) {
+    const float cell = static_cast<float>(thumbnails_->size()) * state_.dpiScale_;
+    const int numCols = qcState_.columnCount();
+    ImGui::SetNextWindowSize(ImVec2(cell * (numCols + 1), cell * 6), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Thumbnails", &thumbnailsVisible_))
+    {
+        ImGui::End();
+        return;
+    }
+    ++thumbnailFrame_;
+
+    ThumbnailCache::Stats ts = thumbnails_->stats();
+    ImGui::TextDisabled("%d rendered, %d from cache file", ts.rendered, ts.fromFile);
+
+    std::vector<ThumbnailCache::Request> requests;
+    ImGuiListClipper clipper;
+    clipper.Begin(qcState_.rowCount(), cell + ImGui::GetStyle().ItemSpacing.y);
+    int first = -1, last = -1;
+    while (clipper.Step())
+    {
+        if (first < 0)
+            first = clipper.DisplayStart;
+        last = clipper.DisplayEnd;
+        for (int ri = clipper.DisplayStart; ri < clipper.DisplayEnd; ++ri)
         {
-            const auto& next = qcState_.pathsForRow(newRow + 1);
-            prefetchPaths.insert(prefetchPaths.end(), next.begin(), next.end());
+            ImGui::PushID(ri);
+            bool isCurrent = (ri == qcState_.currentRowIndex);
+            if (isCurrent)
+                ImGui::TextColored(ImVec4(1.0f, 0.85f, 0.2f, 1.0f), "%d", ri);
+            else
+                ImGui::Text("%d", ri);
+
+            const auto& paths = qcState_.pathsForRow(ri);
+            for (int ci = 0; ci < numCols && ci < static_cast<int>(paths.size()); ++ci)
+            {
+                ImGui::SameLine();
+                ThumbnailCache::Request r = thumbnailRequest(ci, paths[ci]);
+                ThumbnailCache::ThumbnailPtr thumb = thumbnails_->find(r);
+                if (!r.path.empty() && qcState_.rowAvailable(ri))
+                    requests.push_back(r);
+
+                ImGui::PushID(ci);
+                ImVec2 p0 = ImGui::GetCursorScreenPos();
+                if (ImGui::InvisibleButton("##thumb", ImVec2(cell, cell)))
+                    switchQCRow(ri);
+                if (ImGui::IsItemHovered())
+                    ImGui::SetTooltip("%s", r.path.c_str());
+                ImGui::PopID();
+
+                ImDrawList* dl = ImGui::GetWindowDrawList();
+                ImVec2 p1(p0.x + cell, p0.y + cell);
+                dl->AddRectFilled(p0, p1, IM_COL32(0, 0, 0, 255));
+                if (thumb && thumb->width > 0)
+                {
+                    ThumbnailTexture& tt = thumbnailTextures_[r.path];
+                    if (tt.source != thumb)
+                    {
+                        if (tt.texture && (tt.texture->width != thumb->width ||
+                                           tt.texture->height != thumb->height))
+                        {
+                            backend.destroyTexture(tt.texture.get());
+                            tt.texture.reset();
+                        }
+                        if (tt.texture)
+                            backend.updateTexture(tt.texture.get(), thumb->pixels.data());
+                        else
+                            tt.texture = backend.createTexture(thumb->width, thumb->height,
+                                                               thumb->pixels.data());
+                        tt.source = thumb;
+                    }
+                    tt.lastFrame = thumbnailFrame_;
+
+                    // Centred in the cell, at the thumbnail's aspect
+                    float scale = cell / static_cast<float>(std::max(thumb->width, thumb->height));
+                    float w = thumb->width * scale;
+                    float h = thumb->height * scale;
+                    ImVec2 q0(p0.x + (cell - w) * 0.5f, p0.y + (cell - h) * 0.5f);
+                    const Texture& tex = *tt.texture;
+                    dl->AddImage(tex.id, q0, ImVec2(q0.x + w, q0.y + h), tex.uv0, tex.uv1);
+                }
+                else
+                {
+                    const char* label = thumb ? "x" : (r.path.empty() ? "-" : "...");
+                    ImVec2 ts2 = ImGui::CalcTextSize(label);
+                    dl->AddText(ImVec2(p0.x + (cell - ts2.x) * 0.5f, p0.y + (cell - ts2.y) * 0.5f),
+                                IM_COL32(128, 128, 128, 255), label);
+                }
+                if (isCurrent)
+                    dl->AddRect(p0, p1, IM_COL32(255, 215, 50, 255), 0.0f, 0, 2.0f);
+            }
+            ImGui::PopID();
         }
-        if (!prefetchPaths.empty())
+    }
+
+    // Queue the visible rows, then one screenful below them, whenever the
+    // rows on screen or their colours change
+    int lookahead = last - first;
+    for (int ri = last; ri < std::min(last + lookahead, qcState_.rowCount()); ++ri)
+    {
+        if (!qcState_.rowAvailable(ri))
+            continue;
+        const auto& paths = qcState_.pathsForRow(ri);
+        for (int ci = 0; ci < numCols && ci < static_cast<int>(paths.size()); ++ci)
         {
-            // OS hint: warm page cache for adjacent rows' files
-            os_prefetch_files(prefetchPaths);
+            if (!paths[ci].empty())
+                requests.push_back(thumbnailRequest(ci, paths[ci]));
+        }
+    }
+    uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(first)) << 32) ^
+                   static_cast<uint32_t>(last);
+    for (int ci = 0; ci < numCols; ++ci)
+        key = key * 0x100000001B3ull ^ ThumbnailCache::requestHash(thumbnailRequest(ci, ""));
+    // Work queue blocks are claimed and handed in as the current row moves
+    if (qcState_.workQueue)
+        key = key * 0x100000001B3ull ^ static_cast<uint32_t>(qcState_.currentRowIndex);
+    if (key != thumbnailRequestKey_)
+    {
+        thumbnails_->request(requests);
+        thumbnailRequestKey_ = key;
+    }
+
+    ImGui::End();
 
-            prefetcher_->requestPrefetch(prefetchPaths);
+    // Textures of rows scrolled out of view
+    for (auto it = thumbnailTextures_.begin(); it != thumbnailTextures_.end();)
+    {
+        if (it->second.lastFrame != thumbnailFrame_)
+        {
+            if (it->second.texture)
+                backend.destroyTexture(it->second.texture.get());
+            it = thumbnailTextures_.erase(it);
+        }
+        else
+        {
+            ++it;
         }
     }
 }
 
+void Interface::releaseThumbnails(GraphicsBackend& backend) {
+    for (auto& kv : thumbnailTextures_)
+    {
+        if (kv.second.texture)
+            backend.destroyTexture(kv.second.texture.get());
+    }
+    thumbnailTextures_.clear();
+    thumbnailRequestKey_ = 0;
+}
+
 void Interface::renderQCVerdictPanel(int volumeIndex) {
     if (qcState_.currentRowIndex < 0
         || qcState_.currentRowIndex >= qcState_.rowCount()
@@ -2637,7 +3102,7 @@ void Interface::renderQCVerdictPanel(int volumeIndex) {
         return;
 
     auto& result = qcState_.results[qcState_.currentRowIndex];
-    auto& verdict = result.verdicts[volumeIndex];
+    QCVerdict verdict = result.verdicts[volumeIndex];
     auto& comment = result.comments[volumeIndex];
 
     ImGui::PushID(volumeIndex + 5000);
@@ -2651,14 +3116,14 @@ void Interface::renderQCVerdictPanel(int volumeIndex) {
         if (i > 0) ImGui::SameLine();
         if (ImGui::RadioButton(qcState_.verdictOptions[i].c_str(), &vInt, i))
         {
-            verdict = i;
+            qcState_.setVerdict(qcState_.currentRowIndex, volumeIndex, i);
             changed = true;
         }
     }
     ImGui::SameLine();
     if (ImGui::RadioButton("---", &vInt, QC_UNKNOWN))
     {
-        verdict = QC_UNKNOWN;
+        qcState_.setVerdict(qcState_.currentRowIndex, volumeIndex, QC_UNKNOWN);
         changed = true;
     }
 
@@ -2674,17 +3139,17 @@ void Interface::renderQCVerdictPanel(int volumeIndex) {
         changed = true;
 
     if (changed && autosave_)
-        qcState_.saveOutputCsv();
+        qcState_.recordRow(qcState_.currentRowIndex);
 
     ImGui::PopID();
 }
 
-void Interface::renderQCSingleVerdictPanel(GraphicsBackend& backend) {
+void Interface::renderQCSingleVerdictPanel() {
     ImGui::Begin("QC Verdict");
     if (qcState_.currentRowIndex >= 0 && qcState_.rowCount() > 0)
     {
         auto& result  = qcState_.results[qcState_.currentRowIndex];
-        auto& verdict = result.verdicts[0];
+        QCVerdict verdict = result.verdicts[0];
         auto& comment = result.comments[0];
 
         const int nOpts = static_cast<int>(qcState_.verdictOptions.size());
@@ -2725,10 +3190,10 @@ void Interface::renderQCSingleVerdictPanel(GraphicsBackend& backend) {
 
             if (ImGui::Button(label.c_str(), ImVec2(btnWidth, 0)))
             {
-                verdict = i;
-                changed = true;
-                if (autosave_) qcState_.saveOutputCsv();
-                switchQCRow(qcState_.currentRowIndex + 1, backend);
+                qcState_.setVerdict(qcState_.currentRowIndex, 0, i);
+                // Recorded here: the current row changes below
+                if (autosave_) qcState_.recordRow(qcState_.currentRowIndex);
+                switchQCRow(qcState_.stepRow(qcState_.currentRowIndex, 1));
             }
             ImGui::PopStyleColor();
         }
@@ -2737,7 +3202,7 @@ void Interface::renderQCSingleVerdictPanel(GraphicsBackend& backend) {
         ImGui::SameLine();
         if (ImGui::Button("---", ImVec2(btnWidth, 0)))
         {
-            verdict = QC_UNKNOWN;
+            qcState_.setVerdict(qcState_.currentRowIndex, 0, QC_UNKNOWN);
             changed = true;
         }
 
@@ -2751,7 +3216,7 @@ void Interface::renderQCSingleVerdictPanel(GraphicsBackend& backend) {
             changed = true;
 
         if (changed && autosave_)
-            qcState_.saveOutputCsv();
+            qcState_.recordRow(qcState_.currentRowIndex);
     }
     ImGui::End();
 }
@@ -2927,6 +3392,7 @@ void Interface::renderConfigFileDialog() {
                             state_.localConfigPath_ = fullPath;
                             if (qcState_.rowCount() > 0) {
                                 const auto& paths = qcState_.pathsForRow(qcState_.currentRowIndex);
+                                viewManager_.destroyAllTextures();
                                 state_.loadVolumeSet(paths);
                                 for (int ci = 0; ci < qcState_.columnCount() && ci < state_.volumeCount(); ++ci) {
                                     auto it = qcState_.columnConfigs.find(qcState_.columnNames[ci]);
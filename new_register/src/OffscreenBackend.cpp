@@ -0,0 +1,160 @@
+#include "OffscreenBackend.h"
+
+#include <imgui.h>
+#include <backends/imgui_impl_opengl2.h>
+
+#include <GL/osmesa.h>
+#include <GL/gl.h>
+
+#include <stdexcept>
+
+OffscreenBackend::OffscreenBackend(int width, int height)
+    : width_(width > 0 ? width : 1)
+    , height_(height > 0 ? height : 1)
+{
+}
+
+OffscreenBackend::~OffscreenBackend()
+{
+    shutdown();
+}
+
+// ---------------------------------------------------------------------------
+// Lifecycle
+// ---------------------------------------------------------------------------
+
+void OffscreenBackend::setWindowHints()
+{
+    // No window.
+}
+
+void OffscreenBackend::initialize(GLFWwindow* /*window*/)
+{
+    // No depth, stencil or accumulation buffer: ImGui and the slicer only
+    // draw into the colour buffer (the slicer's passes use their own FBOs).
+    OSMesaContext ctx = OSMesaCreateContextExt(OSMESA_RGBA, 0, 0, 0, nullptr);
+    if (!ctx)
+        throw std::runtime_error("OffscreenBackend: OSMesaCreateContextExt failed");
+    context_ = ctx;
+
+    if (!makeCurrent())
+    {
+        shutdown();
+        throw std::runtime_error("OffscreenBackend: OSMesaMakeCurrent failed");
+    }
+
+    initializeGL(reinterpret_cast<ProcLoader>(OSMesaGetProcAddress), "offscreen");
+}
+
+void OffscreenBackend::shutdown()
+{
+    if (context_)
+    {
+        OSMesaDestroyContext(static_cast<OSMesaContext>(context_));
+        context_ = nullptr;
+    }
+    buffer_.clear();
+    buffer_.shrink_to_fit();
+}
+
+bool OffscreenBackend::makeCurrent()
+{
+    buffer_.assign(static_cast<size_t>(width_) * height_ * 4, 0);
+    if (!OSMesaMakeCurrent(static_cast<OSMesaContext>(context_), buffer_.data(),
+                           GL_UNSIGNED_BYTE, width_, height_))
+        return false;
+    // Row 0 at the top, as PNG files and captureScreenshot() expect
+    OSMesaPixelStore(OSMESA_Y_UP, 0);
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Frame cycle
+// ---------------------------------------------------------------------------
+
+bool OffscreenBackend::needsSwapchainRebuild() const
+{
+    return false;
+}
+
+void OffscreenBackend::rebuildSwapchain(int width, int height)
+{
+    if (width <= 0 || height <= 0 || (width == width_ && height == height_))
+        return;
+    width_ = width;
+    height_ = height;
+    // Binding a new colour buffer keeps the context and all its objects
+    if (context_ && !makeCurrent())
+        throw std::runtime_error("OffscreenBackend: failed to resize the framebuffer");
+}
+
+void OffscreenBackend::beginFrame()
+{
+    glViewport(0, 0, width_, height_);
+}
+
+void OffscreenBackend::endFrame()
+{
+    ImDrawData* drawData = ImGui::GetDrawData();
+    if (!drawData) return;
+
+    renderDrawData(drawData);
+    // Nothing to swap: the frame is complete once the renderer is done
+    glFinish();
+}
+
+// ---------------------------------------------------------------------------
+// ImGui integration
+// ---------------------------------------------------------------------------
+
+void OffscreenBackend::initImGui(GLFWwindow* /*window*/)
+{
+    createImGuiContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.BackendPlatformName = "offscreen";
+    io.DisplaySize = ImVec2(static_cast<float>(width_), static_cast<float>(height_));
+    ImGui_ImplOpenGL2_Init();
+}
+
+void OffscreenBackend::shutdownImGui()
+{
+    ImGui_ImplOpenGL2_Shutdown();
+    ImGui::GetIO().BackendPlatformName = nullptr;
+    ImGui::DestroyContext();
+}
+
+void OffscreenBackend::imguiNewFrame()
+{
+    ImGui_ImplOpenGL2_NewFrame();
+    // There is no platform backend: size and clock are ours to set
+    ImGuiIO& io = ImGui::GetIO();
+    io.DisplaySize = ImVec2(static_cast<float>(width_), static_cast<float>(height_));
+    io.DisplayFramebufferScale = ImVec2(1.0f, 1.0f);
+    io.DeltaTime = 1.0f / 60.0f;
+}
+
+void OffscreenBackend::imguiRenderDrawData()
+{
+    endFrame();
+}
+
+// ---------------------------------------------------------------------------
+// Screenshot
+// ---------------------------------------------------------------------------
+
+std::vector<uint8_t> OffscreenBackend::captureScreenshot(int& width, int& height)
+{
+    // endFrame() has finished the frame; the colour buffer is plain memory
+    width = width_;
+    height = height_;
+    std::vector<uint8_t> pixels = buffer_;
+    // ImGui blends into alpha as well; a window would ignore it, a PNG not
+    for (size_t i = 3; i < pixels.size(); i += 4)
+        pixels[i] = 255;
+    return pixels;
+}
+
+bool OffscreenBackend::supportsAsyncCapture() const
+{
+    return false;
+}
@@ -21,6 +21,8 @@
 #include <cstring>
 
 #include "AppState.h"
+#include "GLPixelStream.h"
+#include "GLVolumeSlicer.h"
 
 // ---------------------------------------------------------------------------
 // OpenGL error checking
@@ -49,6 +51,24 @@ static void checkGLError(const char* operation, const char* file, int line)
 
 #define GL_CHECK(op) do { op; checkGLError(#op, __FILE__, __LINE__); } while (0)
 
+/// OpenGL reads bottom-to-top; flip vertically for top-to-bottom RGBA.
+static void flipRows(std::vector<uint8_t>& pixels, int width, int height)
+{
+    int rowBytes = width * 4;
+    std::vector<uint8_t> rowBuf(rowBytes);
+    for (int y = 0; y < height / 2; ++y)
+    {
+        uint8_t* top = pixels.data() + y * rowBytes;
+        uint8_t* bot = pixels.data() + (height - 1 - y) * rowBytes;
+        std::memcpy(rowBuf.data(), top, rowBytes);
+        std::memcpy(top, bot, rowBytes);
+        std::memcpy(bot, rowBuf.data(), rowBytes);
+    }
+}
+
+OpenGL2Backend::OpenGL2Backend() = default;
+OpenGL2Backend::~OpenGL2Backend() = default;
+
 // ---------------------------------------------------------------------------
 // GLFW hints
 // ---------------------------------------------------------------------------
@@ -100,11 +120,23 @@ void OpenGL2Backend::initialize(GLFWwindow* window)
     // Store initial framebuffer size
     glfwGetFramebufferSize(window, &fbWidth_, &fbHeight_);
 
+    initializeGL(glfwGetProcAddress, "opengl2");
+}
+
+void OpenGL2Backend::initializeGL(ProcLoader loader, const char* contextName)
+{
+    procLoader_ = loader;
+
+    // Texture updates stream through PBOs where available; the stream falls
+    // back to client-memory uploads by itself.
+    pixelStream_ = std::make_unique<GLPixelStream>();
+    pixelStream_->initialize(loader);
+
     if (debugLoggingEnabled())
     {
         const char* renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
         const char* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
-        std::cerr << "[opengl2] Initialized: " << (renderer ? renderer : "unknown")
+        std::cerr << "[" << contextName << "] Initialized: " << (renderer ? renderer : "unknown")
                   << " (" << (version ? version : "unknown") << ")\n";
     }
 }
@@ -118,6 +150,7 @@ void OpenGL2Backend::shutdown()
 void OpenGL2Backend::waitIdle()
 {
     GL_CHECK(glFinish());
+    capturesIdle_ = true;
 }
 
 // ---------------------------------------------------------------------------
@@ -150,6 +183,30 @@ void OpenGL2Backend::endFrame()
     ImDrawData* drawData = ImGui::GetDrawData();
     if (!drawData) return;
 
+    renderDrawData(drawData);
+
+    if (requestedCapture_ != 0)
+    {
+        // Read the back buffer before the swap leaves its contents undefined
+        int w = 0, h = 0;
+        glfwGetFramebufferSize(window_, &w, &h);
+        unsigned int readback = 0;
+        GL_CHECK(readback = pixelStream_->beginReadback(w, h));
+        if (readback)
+        {
+            pendingCaptures_.push_back(
+                PendingCapture{readback, w, h, frameCount_, requestedCapture_});
+            capturesIdle_ = false;
+        }
+        requestedCapture_ = 0;
+    }
+
+    GL_CHECK(glfwSwapBuffers(window_));
+    ++frameCount_;
+}
+
+void OpenGL2Backend::renderDrawData(ImDrawData* drawData)
+{
     GL_CHECK(glViewport(0, 0,
         static_cast<int>(drawData->DisplaySize.x),
         static_cast<int>(drawData->DisplaySize.y)));
@@ -157,8 +214,6 @@ void OpenGL2Backend::endFrame()
     GL_CHECK(glClear(GL_COLOR_BUFFER_BIT));
 
     ImGui_ImplOpenGL2_RenderDrawData(drawData);
-
-    GL_CHECK(glfwSwapBuffers(window_));
 }
 
 // ---------------------------------------------------------------------------
@@ -166,6 +221,13 @@ void OpenGL2Backend::endFrame()
 // ---------------------------------------------------------------------------
 
 void OpenGL2Backend::initImGui(GLFWwindow* window)
+{
+    createImGuiContext();
+    ImGui_ImplGlfw_InitForOpenGL(window, true);
+    ImGui_ImplOpenGL2_Init();
+}
+
+void OpenGL2Backend::createImGuiContext()
 {
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
@@ -203,9 +265,6 @@ void OpenGL2Backend::initImGui(GLFWwindow* window)
         if (!loaded)
             io.Fonts->AddFontDefaultVector(&fontCfg);
     }
-
-    ImGui_ImplGlfw_InitForOpenGL(window, true);
-    ImGui_ImplOpenGL2_Init();
 }
 
 void OpenGL2Backend::shutdownImGui()
@@ -274,19 +333,46 @@ std::vector<uint8_t> OpenGL2Backend::captureScreenshot(int& width, int& height)
     // Restore default read buffer
     GL_CHECK(glReadBuffer(GL_BACK));
 
-    // OpenGL reads bottom-to-top; flip vertically for top-to-bottom RGBA.
-    int rowBytes = width * 4;
-    std::vector<uint8_t> rowBuf(rowBytes);
-    for (int y = 0; y < height / 2; ++y)
+    flipRows(pixels, width, height);
+    return pixels;
+}
+
+bool OpenGL2Backend::supportsAsyncCapture() const
+{
+    return pixelStream_ && pixelStream_->supported();
+}
+
+uint64_t OpenGL2Backend::requestCapture()
+{
+    if (!supportsAsyncCapture())
+        return 0;
+    if (requestedCapture_ != 0)
+        return requestedCapture_;
+    if (pendingCaptures_.size() >= static_cast<size_t>(kMaxPendingCaptures))
+        return 0;
+    requestedCapture_ = ++lastCaptureId_;
+    return requestedCapture_;
+}
+
+bool OpenGL2Backend::takeCapture(std::vector<uint8_t>& pixels, int& width, int& height,
+                                 uint64_t& id)
+{
+    while (!pendingCaptures_.empty())
     {
-        uint8_t* top = pixels.data() + y * rowBytes;
-        uint8_t* bot = pixels.data() + (height - 1 - y) * rowBytes;
-        std::memcpy(rowBuf.data(), top, rowBytes);
-        std::memcpy(top, bot, rowBytes);
-        std::memcpy(bot, rowBuf.data(), rowBytes);
+        const PendingCapture pc = pendingCaptures_.front();
+        if (!capturesIdle_ && frameCount_ < pc.frame + kCaptureLatency)
+            return false;
+        pendingCaptures_.pop_front();
+        if (!pixelStream_->endReadback(pc.readback, pc.width, pc.height, pixels))
+            continue;   // mapping failed: the id is skipped
+
+        flipRows(pixels, pc.width, pc.height);
+        width = pc.width;
+        height = pc.height;
+        id = pc.id;
+        return true;
     }
-
-    return pixels;
+    return false;
 }
 
 // ---------------------------------------------------------------------------
@@ -328,10 +414,7 @@ void OpenGL2Backend::updateTexture(Texture* tex, const void* data)
     auto it = glTextures_.find(tex->id);
     if (it == glTextures_.end()) return;
 
-    GL_CHECK(glBindTexture(GL_TEXTURE_2D, it->second));
-    GL_CHECK(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, tex->width, tex->height,
-                    GL_RGBA, GL_UNSIGNED_BYTE, data));
-    GL_CHECK(glBindTexture(GL_TEXTURE_2D, 0));
+    GL_CHECK(pixelStream_->upload(it->second, tex->width, tex->height, data));
 }
 
 void OpenGL2Backend::destroyTexture(Texture* tex)
@@ -353,4 +436,103 @@ void OpenGL2Backend::shutdownTextureSystem()
         GL_CHECK(glDeleteTextures(1, &pair.second));
     }
     glTextures_.clear();
+
+    // Captures not taken by now are dropped with their buffers
+    pendingCaptures_.clear();
+    requestedCapture_ = 0;
+    if (pixelStream_)
+        pixelStream_->shutdown();
+    pixelStream_.reset();
+
+    if (slicer_)
+        slicer_->shutdown();
+    slicer_.reset();
+}
+
+// ---------------------------------------------------------------------------
+// GPU volume slicing
+// ---------------------------------------------------------------------------
+
+GLVolumeSlicer* OpenGL2Backend::slicer() const
+{
+    if (!slicerProbed_ && procLoader_)
+    {
+        slicerProbed_ = true;
+        slicer_ = std::make_unique<GLVolumeSlicer>();
+        if (!slicer_->initialize(procLoader_))
+            slicer_.reset();
+    }
+    return slicer_.get();
+}
+
+bool OpenGL2Backend::supportsVolumeSlicing() const
+{
+    return slicer() && slicer_->supported();
+}
+
+std::unique_ptr<VolumeTexture> OpenGL2Backend::createVolumeTexture(
+    int dimX, int dimY, int dimZ, const float* data)
+{
+    if (!supportsVolumeSlicing())
+        return nullptr;
+    return slicer_->createVolumeTexture(dimX, dimY, dimZ, data);
+}
+
+void OpenGL2Backend::destroyVolumeTexture(VolumeTexture* vt)
+{
+    if (slicer_)
+        slicer_->destroyVolumeTexture(vt);
+}
+
+bool OpenGL2Backend::renderVolumeSlice(Texture* tex, const VolumeSliceLayer* layers,
+                                       int count, bool blend)
+{
+    if (!tex || !supportsVolumeSlicing())
+        return false;
+    auto it = glTextures_.find(tex->id);
+    if (it == glTextures_.end())
+        return false;
+    return slicer_->render(it->second, tex->width, tex->height, layers, count, blend);
+}
+
+// ---------------------------------------------------------------------------
+// Paletted slices
+// ---------------------------------------------------------------------------
+
+bool OpenGL2Backend::supportsPalettedSlices() const
+{
+    return slicer() && slicer_->palettedSupported();
+}
+
+std::unique_ptr<IndexTexture> OpenGL2Backend::createIndexTexture(int w, int h, int indexBytes)
+{
+    if (!supportsPalettedSlices())
+        return nullptr;
+    return slicer_->createIndexTexture(w, h, indexBytes);
+}
+
+bool OpenGL2Backend::updateIndexTexture(IndexTexture* it, const void* indices)
+{
+    if (!slicer_)
+        return false;
+    return slicer_->updateIndexTexture(it, indices);
+}
+
+void OpenGL2Backend::destroyIndexTexture(IndexTexture* it)
+{
+    if (slicer_)
+        slicer_->destroyIndexTexture(it);
+}
+
+bool OpenGL2Backend::renderPalettedSlice(Texture* tex, const IndexTexture* indices,
+                                         const uint32_t* palette, int paletteSize)
+{
+    if (!tex || !indices || !supportsPalettedSlices())
+        return false;
+    if (tex->width != indices->width || tex->height != indices->height)
+        return false;
+    auto it = glTextures_.find(tex->id);
+    if (it == glTextures_.end())
+        return false;
+    return slicer_->renderPaletted(it->second, *indices, palette, paletteSize);
 }
@@ -1,46 +1,159 @@
 #include "Prefetcher.h"
 
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 
 #include "AppState.h"  // VolumeCache, Volume
+#include "OsPrefetch.h"
+#include "QCState.h"
 #include "Volume.h"
 
 Prefetcher::Prefetcher(VolumeCache& cache)
     : cache_(cache)
+    , worker_([this] { run(); })
 {
 }
 
-void Prefetcher::requestPrefetch(const std::vector<std::string>& paths)
+Prefetcher::~Prefetcher()
 {
-    pendingPaths_ = paths;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+        queue_.clear();
+    }
+    workCv_.notify_all();
+    // Waits for a read already running
+    worker_.join();
+}
+
+void Prefetcher::rowChanged(int row, const QCState& qcState)
+{
+    if (row < 0 || row >= qcState.rowCount())
+        return;
+
+    const std::vector<std::string>& current = qcState.pathsForRow(row);
+    bool cached = std::all_of(current.begin(), current.end(), [this](const std::string& p) {
+        return p.empty() || cache_.contains(p);
+    });
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        window_.setCacheLimits(cache_.maxBytes(), cache_.capacity(), qcState.columnCount());
+        window_.rowChanged(row, PrefetchWindow::Clock::now());
+        rowWasCached_ = cached;
+
+        queue_.clear();
+        auto enqueue = [this](const std::vector<std::string>& paths) {
+            for (const std::string& p : paths)
+            {
+                if (!p.empty() && p != inFlight_ &&
+                    std::find(queue_.begin(), queue_.end(), p) == queue_.end())
+                    queue_.push_back(p);
+            }
+        };
+        enqueue(current);
+        for (int r : window_.plan(row, qcState.rowCount()))
+        {
+            // Other raters' rows of a shared work queue are theirs to read
+            if (qcState.rowAvailable(r))
+                enqueue(qcState.pathsForRow(r));
+        }
+        hintPending_ = true;
+    }
+    workCv_.notify_one();
+}
+
+bool Prefetcher::isPending(const std::vector<std::string>& paths) const
+{
+    for (const std::string& p : paths)
+    {
+        if (p.empty())
+            continue;
+        if (p == inFlight_ || std::find(queue_.begin(), queue_.end(), p) != queue_.end())
+            return true;
+    }
+    return false;
+}
+
+void Prefetcher::awaitRow(const std::vector<std::string>& paths)
+{
+    auto start = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(mutex_);
+    doneCv_.wait(lock, [&] { return !isPending(paths); });
+    double stalled = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // The first row is read at startup, before there is anything to prefetch
+    if (rowsSeen_++ == 0)
+        return;
+    ++stats_.switches;
+    if (rowWasCached_)
+        ++stats_.hits;
+    stats_.stallSeconds += stalled;
+    stats_.maxStallSeconds = std::max(stats_.maxStallSeconds, stalled);
 }
 
 void Prefetcher::cancelPending()
 {
-    pendingPaths_.clear();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.clear();
+    }
+    doneCv_.notify_all();
+}
+
+Prefetcher::Stats Prefetcher::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats s = stats_;
+    s.rowLoadSeconds = window_.rowLoadSeconds();
+    s.secondsPerRow = window_.secondsPerRow();
+    s.ahead = window_.ahead();
+    s.behind = window_.behind();
+    return s;
 }
 
-bool Prefetcher::loadPending()
+void Prefetcher::run()
 {
-    while (!pendingPaths_.empty())
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;)
     {
-        std::string path = std::move(pendingPaths_.back());
-        pendingPaths_.pop_back();
+        workCv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+        if (stop_)
+            return;
 
-        // Skip empty paths.
-        if (path.empty())
+        if (hintPending_)
+        {
+            // Let the OS read the whole window into the page cache while
+            // the volumes are decoded one by one
+            hintPending_ = false;
+            std::vector<std::string> paths(queue_.begin(), queue_.end());
+            lock.unlock();
+            os_prefetch_files(paths);
+            lock.lock();
             continue;
+        }
 
-        // Skip if already cached.
-        if (cache_.get(path) != nullptr)
+        std::string path = std::move(queue_.front());
+        queue_.pop_front();
+        if (cache_.contains(path))
+        {
+            doneCv_.notify_all();
             continue;
+        }
+        inFlight_ = path;
+        lock.unlock();
 
-        // Load the volume from disk (synchronously on the main thread).
+        auto start = std::chrono::steady_clock::now();
+        bool ok = false;
+        size_t bytes = 0;
         try
         {
             Volume vol;
             vol.load(path);
-            cache_.put(path, vol);
+            bytes = VolumeCache::volumeBytes(vol);
+            cache_.put(path, std::move(vol));
+            ok = true;
             if (debugLoggingEnabled())
                 std::cerr << "[prefetch] cached: " << path << "\n";
         }
@@ -50,10 +163,19 @@ bool Prefetcher::loadPending()
                 std::cerr << "[prefetch] failed: " << path
                           << " (" << e.what() << ")\n";
         }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
 
-        // Loaded (or failed) one volume — return to avoid stalling the UI.
-        return true;
+        lock.lock();
+        inFlight_.clear();
+        if (ok)
+        {
+            ++stats_.loaded;
+            window_.volumeLoaded(seconds, bytes);
+        }
+        else
+        {
+            ++stats_.failed;
+        }
+        doneCv_.notify_all();
     }
-
-    return false;
 }
@@ -1,71 +1,25 @@
 #include "QCState.h"
 
 #include <algorithm>
+#include <cmath>
+#include <cstdio>
 #include <filesystem>
 #include <fstream>
 #include <sstream>
 #include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <unistd.h>
 
 // ---------------------------------------------------------------------------
-// Internal helpers — lightweight RFC 4180 CSV parser/writer
+// Internal helpers — RFC 4180 CSV writer (reading is done by CsvFile)
 // ---------------------------------------------------------------------------
 
 namespace
 {
 
-/// Parse a single CSV line into fields, respecting double-quote escaping.
-/// RFC 4180: fields may be enclosed in double quotes; a literal double quote
-/// inside a quoted field is represented as two consecutive double quotes.
-std::vector<std::string> parseCsvLine(const std::string& line)
-{
-    std::vector<std::string> fields;
-    std::string field;
-    bool inQuotes = false;
-
-    for (size_t i = 0; i < line.size(); ++i)
-    {
-        char c = line[i];
-        if (inQuotes)
-        {
-            if (c == '"')
-            {
-                // Peek ahead: doubled quote is an escaped literal quote
-                if (i + 1 < line.size() && line[i + 1] == '"')
-                {
-                    field += '"';
-                    ++i; // skip the second quote
-                }
-                else
-                {
-                    inQuotes = false; // closing quote
-                }
-            }
-            else
-            {
-                field += c;
-            }
-        }
-        else
-        {
-            if (c == '"')
-            {
-                inQuotes = true;
-            }
-            else if (c == ',')
-            {
-                fields.push_back(std::move(field));
-                field.clear();
-            }
-            else
-            {
-                field += c;
-            }
-        }
-    }
-    fields.push_back(std::move(field));
-    return fields;
-}
-
 /// Quote a CSV field if it contains commas, quotes, or newlines.
 std::string quoteCsvField(const std::string& field)
 {
@@ -97,24 +51,44 @@ void writeCsvRow(std::ostream& os, const std::vector<std::string>& fields)
     os << '\n';
 }
 
-/// Read all non-empty lines from a file, stripping trailing \r.
-std::vector<std::string> readLines(const std::string& path)
+/// Write @p data to @p path and wait until it is on disk.
+bool writeSynced(const std::string& path, const std::string& data, bool append)
 {
-    std::ifstream ifs(path);
-    if (!ifs)
-        throw std::runtime_error("Cannot open file: " + path);
-
-    std::vector<std::string> lines;
-    std::string line;
-    while (std::getline(ifs, line))
+    int flags = O_WRONLY | O_CREAT | (append ? O_APPEND : O_TRUNC);
+    int fd = ::open(path.c_str(), flags, 0644);
+    if (fd < 0)
+        return false;
+    const char* p = data.data();
+    size_t left = data.size();
+    while (left > 0)
     {
-        // Strip trailing \r (Windows line endings)
-        if (!line.empty() && line.back() == '\r')
-            line.pop_back();
-        if (!line.empty())
-            lines.push_back(std::move(line));
+        ssize_t n = ::write(fd, p, left);
+        if (n < 0)
+        {
+            ::close(fd);
+            return false;
+        }
+        p += n;
+        left -= static_cast<size_t>(n);
     }
-    return lines;
+    bool ok = ::fsync(fd) == 0;
+    return ::close(fd) == 0 && ok;
+}
+
+/// Seconds from @p a to @p b.
+double secondsBetween(QCState::Clock::time_point a, QCState::Clock::time_point b)
+{
+    return std::chrono::duration<double>(b - a).count();
+}
+
+/// @p seconds as milliseconds for the timing sidecar; empty if negative.
+std::string formatMs(double seconds)
+{
+    if (seconds < 0.0)
+        return std::string();
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.1f", seconds * 1000.0);
+    return buf;
 }
 
 } // anonymous namespace
@@ -125,269 +99,520 @@ std::vector<std::string> readLines(const std::string& path)
 
 void QCState::loadInputCsv(const std::string& path)
 {
-    auto lines = readLines(path);
-    if (lines.empty())
-        throw std::runtime_error("QC input CSV is empty: " + path);
+    auto csv = std::make_shared<const CsvFile>(path);
 
     // Parse header
-    auto header = parseCsvLine(lines[0]);
+    std::vector<CsvField> header;
+    size_t offset = csv->readRecord(csv->begin(), header);
     if (header.empty())
         throw std::runtime_error("QC input CSV is empty: " + path);
 
     // First column must be "ID" (case-insensitive)
-    std::string firstCol = header[0];
+    std::string firstCol = header[0].str();
     std::transform(firstCol.begin(), firstCol.end(), firstCol.begin(), ::toupper);
     if (firstCol != "ID")
         throw std::runtime_error("QC input CSV first column must be 'ID', got: " +
-                                 header[0]);
+                                 header[0].str());
 
     columnNames.clear();
     for (size_t i = 1; i < header.size(); ++i)
-        columnNames.push_back(header[i]);
+        columnNames.push_back(header[i].str());
 
     if (columnNames.empty())
         throw std::runtime_error("QC input CSV has no data columns: " + path);
 
-    // Read data rows
+    // Index the data rows: only the ID is copied out; the paths are parsed
+    // by pathsForRow() when a row is first shown
     rowIds.clear();
-    rowPaths.clear();
+    rowOffsets_.clear();
     results.clear();
 
-    for (size_t li = 1; li < lines.size(); ++li)
+    size_t columns = singleVerdictMode ? 1 : columnNames.size();
+    while (offset < csv->size())
     {
-        auto fields = parseCsvLine(lines[li]);
-        if (fields.empty())
-            continue;
-
-        rowIds.push_back(fields[0]);
-
-        std::vector<std::string> paths;
-        for (size_t ci = 0; ci < columnNames.size(); ++ci)
-        {
-            if (ci + 1 < fields.size())
-                paths.push_back(fields[ci + 1]);
-            else
-                paths.push_back(""); // missing field
-        }
-        rowPaths.push_back(std::move(paths));
+        CsvField id;
+        rowOffsets_.push_back(offset);
+        offset = csv->skipRecord(offset, &id);
+        rowIds.push_back(id.str());
 
         // Initialise result to unknown
         QCRowResult result;
-        result.id = rowIds.back();
-        if (singleVerdictMode)
-        {
-            result.verdicts.assign(1, QC_UNKNOWN);
-            result.comments.assign(1, "");
-        }
-        else
-        {
-            result.verdicts.resize(columnNames.size(), QC_UNKNOWN);
-            result.comments.resize(columnNames.size());
-        }
+        result.verdicts.assign(columns, QC_UNKNOWN);
+        result.comments.resize(columns);
         results.push_back(std::move(result));
     }
+
+    rowPaths_.assign(rowIds.size(), {});
+    inputCsv_ = std::move(csv);
+    recountVerdicts();
 }
 
 void QCState::loadOutputCsv(const std::string& path)
 {
-    if (!std::filesystem::exists(path))
-        return;
-
-    std::vector<std::string> lines;
-    try
+    std::vector<std::string> files = {path};
+    if (workQueue)
     {
-        lines = readLines(path);
+        for (const std::string& journal : workQueue->journalPaths())
+            files.push_back(journal);
     }
-    catch (...)
+    else
     {
-        return; // Can't read output file — treat as absent
+        files.push_back(path + ".journal");
     }
-    if (lines.empty())
-        return;
-
-    // Parse header
-    auto outCols = parseCsvLine(lines[0]);
-    if (outCols.empty())
-        return;
-
-    // Single-verdict mode: expect ID,verdict,comment
-    if (singleVerdictMode)
+    for (const std::string& file : files)
     {
-        // Build row ID -> index map for fast lookup
-        std::map<std::string, int> idMap;
-        for (size_t i = 0; i < rowIds.size(); ++i)
-            idMap[rowIds[i]] = static_cast<int>(i);
-
-        // Find column indices
-        std::map<std::string, size_t> hdrIdx;
-        for (size_t i = 0; i < outCols.size(); ++i)
-            hdrIdx[outCols[i]] = i;
-
-        auto verdictIt = hdrIdx.find("verdict");
-        auto commentIt = hdrIdx.find("comment");
-        if (verdictIt == hdrIdx.end())
-            return; // unrecognised format, skip
-
-        size_t vIdx = verdictIt->second;
-        size_t cIdx = commentIt != hdrIdx.end() ? commentIt->second : SIZE_MAX;
-
-        for (size_t li = 1; li < lines.size(); ++li)
+        if (!std::filesystem::exists(file))
+            continue;
+        try
         {
-            auto fields = parseCsvLine(lines[li]);
-            if (fields.empty())
-                continue;
-
-            std::string id = fields[0];
-            auto it = idMap.find(id);
-            if (it == idMap.end())
-                continue;
-
-            int rowIdx = it->second;
-            auto& result = results[rowIdx];
-
-            if (vIdx < fields.size())
-            {
-                const auto& v = fields[vIdx];
-                auto it = std::find(verdictOptions.begin(), verdictOptions.end(), v);
-                result.verdicts[0] = (it != verdictOptions.end())
-                    ? static_cast<int>(it - verdictOptions.begin())
-                    : QC_UNKNOWN;
-            }
-            if (cIdx != SIZE_MAX && cIdx < fields.size())
-                result.comments[0] = fields[cIdx];
+            // A journal may end in a partly written entry
+            applyOutput(CsvFile(file), file != path);
+        }
+        catch (...)
+        {
+            // Can't read the file — treat as absent
         }
-        return;
     }
+    recountVerdicts();
+}
+
+void QCState::applyOutput(const CsvFile& csv, bool completeRecordsOnly, bool skipHeldRows)
+{
+    // Parse header
+    std::vector<CsvField> fields;
+    size_t offset = csv.readRecord(csv.begin(), fields);
+    if (fields.empty())
+        return;
 
     // Build header-name -> column-index map for the output CSV
     std::map<std::string, size_t> outColIndex;
-    for (size_t i = 0; i < outCols.size(); ++i)
-        outColIndex[outCols[i]] = i;
+    for (size_t i = 0; i < fields.size(); ++i)
+        outColIndex[fields[i].str()] = i;
 
-    // Build map: input column name -> (verdict col idx, comment col idx) in output
-    struct ColIndices { size_t verdictIdx; size_t commentIdx; bool hasComment; };
-    std::map<std::string, ColIndices> colMap;
-    for (const auto& colName : columnNames)
-    {
-        std::string vh = colName + "_verdict";
-        auto vit = outColIndex.find(vh);
+    // Output column indices of each result column's verdict and comment.
+    // Single-verdict mode: expect ID,verdict,comment
+    struct ColIndices { size_t resultIdx; size_t verdictIdx; size_t commentIdx; };
+    std::vector<ColIndices> colMap;
+    auto addColumn = [&](size_t resultIdx, const std::string& verdictName,
+                         const std::string& commentName) {
+        auto vit = outColIndex.find(verdictName);
         if (vit == outColIndex.end())
-            continue;
-
-        std::string ch = colName + "_comment";
-        auto cit = outColIndex.find(ch);
-        colMap[colName] = {vit->second,
-                           cit != outColIndex.end() ? cit->second : 0,
-                           cit != outColIndex.end()};
+            return;
+        auto cit = outColIndex.find(commentName);
+        colMap.push_back({resultIdx, vit->second,
+                          cit != outColIndex.end() ? cit->second : SIZE_MAX});
+    };
+    if (singleVerdictMode)
+    {
+        addColumn(0, "verdict", "comment");
+    }
+    else
+    {
+        for (size_t ci = 0; ci < columnNames.size(); ++ci)
+            addColumn(ci, columnNames[ci] + "_verdict", columnNames[ci] + "_comment");
     }
+    if (colMap.empty())
+        return; // unrecognised format, skip
 
-    // Build row ID -> index map for fast lookup
-    std::map<std::string, int> idMap;
+    // Row ID -> index map for fast lookup; views into rowIds
+    std::unordered_map<std::string_view, int> idMap;
+    idMap.reserve(rowIds.size());
     for (size_t i = 0; i < rowIds.size(); ++i)
-        idMap[rowIds[i]] = static_cast<int>(i);
+        idMap.emplace(rowIds[i], static_cast<int>(i));
 
     // Parse data rows
-    for (size_t li = 1; li < lines.size(); ++li)
+    std::string scratch;
+    while (offset < csv.size())
     {
-        auto fields = parseCsvLine(lines[li]);
+        size_t next = csv.readRecord(offset, fields);
+        if (completeRecordsOnly && next == csv.size() && !csv.endsWithNewline())
+            break; // torn last record
+        offset = next;
         if (fields.empty())
             continue;
 
-        std::string id = fields[0];
+        std::string_view id = fields[0].text;
+        if (fields[0].escaped)
+        {
+            scratch = fields[0].str();
+            id = scratch;
+        }
         auto it = idMap.find(id);
         if (it == idMap.end())
             continue; // Unknown ID, skip
+        if (skipHeldRows && workQueue && workQueue->owns(it->second))
+            continue; // this rater's verdicts are current
 
-        int rowIdx = it->second;
-        auto& result = results[rowIdx];
-
-        for (size_t ci = 0; ci < columnNames.size(); ++ci)
+        auto& result = results[it->second];
+        for (const ColIndices& idx : colMap)
         {
-            auto mapIt = colMap.find(columnNames[ci]);
-            if (mapIt == colMap.end())
-                continue;
-
-            const auto& idx = mapIt->second;
-
             if (idx.verdictIdx < fields.size())
             {
-                const auto& v = fields[idx.verdictIdx];
-                auto it = std::find(verdictOptions.begin(), verdictOptions.end(), v);
-                result.verdicts[ci] = (it != verdictOptions.end())
-                    ? static_cast<int>(it - verdictOptions.begin())
+                const CsvField& v = fields[idx.verdictIdx];
+                auto opt = std::find_if(verdictOptions.begin(), verdictOptions.end(),
+                                        [&v](const std::string& o) { return v == o; });
+                result.verdicts[idx.resultIdx] = (opt != verdictOptions.end())
+                    ? static_cast<int>(opt - verdictOptions.begin())
                     : QC_UNKNOWN;
             }
 
-            if (idx.hasComment && idx.commentIdx < fields.size())
-                result.comments[ci] = fields[idx.commentIdx];
+            if (idx.commentIdx < fields.size())
+                result.comments[idx.resultIdx] = fields[idx.commentIdx].str();
         }
     }
 }
 
-void QCState::saveOutputCsv() const
+std::vector<std::string> QCState::outputHeader() const
+{
+    // Simplified output: ID,verdict,comment
+    if (singleVerdictMode)
+        return {"ID", "verdict", "comment"};
+
+    // ID, col1_verdict, col1_comment, ...
+    std::vector<std::string> header;
+    header.push_back("ID");
+    for (const auto& col : columnNames)
+    {
+        header.push_back(col + "_verdict");
+        header.push_back(col + "_comment");
+    }
+    return header;
+}
+
+std::vector<std::string> QCState::outputRow(int row) const
+{
+    const QCRowResult& result = results[row];
+    size_t columns = singleVerdictMode ? 1 : columnNames.size();
+
+    std::vector<std::string> fields;
+    fields.push_back(rowIds[row]);
+    for (size_t ci = 0; ci < columns; ++ci)
+    {
+        const char* verdictStr = "";
+        if (ci < result.verdicts.size())
+        {
+            int v = result.verdicts[ci];
+            if (v >= 0 && v < static_cast<int>(verdictOptions.size()))
+                verdictStr = verdictOptions[v].c_str();
+        }
+        fields.push_back(verdictStr);
+        fields.push_back(ci < result.comments.size() ? result.comments[ci] : std::string());
+    }
+    return fields;
+}
+
+void QCState::saveOutputCsv()
 {
     if (outputCsvPath.empty())
         return;
+    if (workQueue)
+        mergeWorkQueueJournals();
+
+    std::ostringstream os;
+    writeCsvRow(os, outputHeader());
+    for (int i = 0; i < rowCount(); ++i)
+        writeCsvRow(os, outputRow(i));
+
+    // Replace the file only once the new contents are on disk
+    // Raters sharing the file on other machines may have the same pid
+    std::string tmp = outputCsvPath + ".tmp" + std::to_string(::getpid());
+    if (workQueue)
+        tmp += "." + workQueue->rater();
+    std::error_code ec;
+    if (!writeSynced(tmp, os.str(), false))
+    {
+        std::filesystem::remove(tmp, ec);
+        return;
+    }
+    std::filesystem::rename(tmp, outputCsvPath, ec);
+    if (ec)
+    {
+        std::filesystem::remove(tmp, ec);
+        return;
+    }
+
+    // Every journal entry is in the CSV now
+    if (!workQueue)
+        std::filesystem::remove(journalPath(), ec);
+    journalEntries_ = 0;
+}
 
-    std::ofstream ofs(outputCsvPath, std::ios::trunc);
-    if (!ofs)
+std::string QCState::journalPath() const
+{
+    return workQueue ? workQueue->journalPath() : outputCsvPath + ".journal";
+}
+
+void QCState::recordRow(int row)
+{
+    if (outputCsvPath.empty() || row < 0 || row >= rowCount())
         return;
 
-    if (singleVerdictMode)
+    std::string path = journalPath();
+    std::error_code ec;
+    bool header = journalEntries_ == 0;
+    if (workQueue)
     {
-        // Simplified output: ID,verdict,comment
-        writeCsvRow(ofs, {"ID", "verdict", "comment"});
-        for (size_t i = 0; i < results.size(); ++i)
-        {
-            const char* verdictStr = "";
-            if (!results[i].verdicts.empty())
-            {
-                int v = results[i].verdicts[0];
-                if (v >= 0 && v < static_cast<int>(verdictOptions.size()))
-                    verdictStr = verdictOptions[v].c_str();
-            }
-            std::string comment = results[i].comments.empty() ? "" : results[i].comments[0];
-            writeCsvRow(ofs, {rowIds[i], verdictStr, comment});
-        }
-        ofs.flush();
+        // The rater's journal is kept across sessions
+        header = !std::filesystem::exists(path, ec) || std::filesystem::file_size(path, ec) == 0;
+        workQueue->renew();
+    }
+    else if (journalEntries_ == 0 && std::filesystem::exists(path, ec))
+    {
+        // Left by a session that did not exit cleanly (and replayed by
+        // loadOutputCsv()): fold it in so this session's entries start a
+        // journal with the current header.
+        saveOutputCsv();
+    }
+
+    std::ostringstream os;
+    if (header)
+        writeCsvRow(os, outputHeader());
+    writeCsvRow(os, outputRow(row));
+
+    if (!writeSynced(path, os.str(), true) || ++journalEntries_ >= kJournalCompactEntries)
+        saveOutputCsv();
+}
+
+// ---------------------------------------------------------------------------
+// Navigation and the work queue
+// ---------------------------------------------------------------------------
+
+bool QCState::rowAvailable(int row) const
+{
+    return row >= 0 && row < rowCount() && (!workQueue || workQueue->owns(row));
+}
+
+int QCState::stepRow(int row, int step)
+{
+    if (!workQueue)
+    {
+        int next = row + step;
+        return next >= 0 && next < rowCount() ? next : -1;
+    }
+
+    workQueue->renew();
+    int next = workQueue->nextHeldRow(row, step);
+    if (next >= 0 || step < 0)
+        return next;
+
+    // Past the held rows: hand in the finished blocks and claim another,
+    // with the other raters' latest verdicts so their rows are skipped
+    for (int block : std::vector<int>(workQueue->heldBlocks()))
+    {
+        if (blockRated(block))
+            workQueue->finish(block);
+    }
+    mergeWorkQueueJournals();
+    int block = workQueue->claim([this](int r) { return !rowRated(r); });
+    if (block < 0)
+        return -1;
+    int first = block * workQueue->blockRows();
+    int last = std::min(first + workQueue->blockRows(), rowCount());
+    for (int r = first; r < last; ++r)
+    {
+        if (!rowRated(r))
+            return r;
+    }
+    return first;
+}
+
+void QCState::closeWorkQueue()
+{
+    if (!workQueue)
         return;
+    for (int block : std::vector<int>(workQueue->heldBlocks()))
+    {
+        if (blockRated(block))
+            workQueue->finish(block);
+        else
+            workQueue->release(block);
     }
+}
 
-    // Write header: ID, col1_verdict, col1_comment, ...
-    std::vector<std::string> header;
-    header.push_back("ID");
-    for (const auto& col : columnNames)
+bool QCState::blockRated(int block) const
+{
+    int first = block * workQueue->blockRows();
+    int last = std::min(first + workQueue->blockRows(), rowCount());
+    for (int r = first; r < last; ++r)
     {
-        header.push_back(col + "_verdict");
-        header.push_back(col + "_comment");
+        if (!rowRated(r))
+            return false;
     }
-    writeCsvRow(ofs, header);
+    return true;
+}
 
-    // Write rows
-    for (size_t i = 0; i < results.size(); ++i)
+void QCState::mergeWorkQueueJournals()
+{
+    const std::string own = workQueue->journalPath();
+    for (const std::string& journal : workQueue->journalPaths())
     {
-        std::vector<std::string> row;
-        row.push_back(rowIds[i]);
-        for (size_t ci = 0; ci < columnNames.size(); ++ci)
+        if (journal == own)
+            continue;
+        try
         {
-            const char* verdictStr = "";
-            if (ci < results[i].verdicts.size())
-            {
-                int v = results[i].verdicts[ci];
-                if (v >= 0 && v < static_cast<int>(verdictOptions.size()))
-                    verdictStr = verdictOptions[v].c_str();
-            }
-            row.push_back(verdictStr);
+            applyOutput(CsvFile(journal), true, true);
+        }
+        catch (...)
+        {
+            // Unreadable (e.g. being created): merged next time
+        }
+    }
+    recountVerdicts();
+}
 
-            std::string comment;
-            if (ci < results[i].comments.size())
-                comment = results[i].comments[ci];
-            row.push_back(comment);
+// ---------------------------------------------------------------------------
+// Session timing
+// ---------------------------------------------------------------------------
+
+std::string QCState::timingPath() const
+{
+    return workQueue ? workQueue->timingPath() : outputCsvPath + ".timing.csv";
+}
+
+void QCState::beginRowVisit(QCRowVisit visit, Clock::time_point switchStart)
+{
+    endRowVisit(switchStart);
+    if (visits_.empty())
+    {
+        sessionStart_ = switchStart;
+        sessionId_ = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    visit.start = secondsBetween(sessionStart_, switchStart);
+    visit.firstImage = -1.0;
+    visit.verdict = -1.0;
+    visit.dwell = 0.0;
+    visit.verdictChanges = 0;
+    visitStart_ = switchStart;
+    // Verdicts given before the first frame count from the switch's end
+    visitShown_ = switchStart + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(visit.switchSeconds()));
+    visits_.push_back(visit);
+    visitOpen_ = true;
+}
+
+void QCState::frameShown(Clock::time_point when)
+{
+    if (!visitOpen_ || visits_.back().firstImage >= 0.0)
+        return;
+    visits_.back().firstImage = secondsBetween(visitStart_, when);
+    visitShown_ = when;
+}
+
+void QCState::endRowVisit(Clock::time_point when)
+{
+    if (!visitOpen_)
+        return;
+    visitOpen_ = false;
+    visits_.back().dwell = secondsBetween(visitStart_, when);
+    writeRowVisit(visits_.back());
+}
+
+void QCState::writeRowVisit(const QCRowVisit& visit) const
+{
+    if (outputCsvPath.empty())
+        return;
+
+    static const std::vector<std::string> header = {
+        "session", "rater", "row", "ID", "nav", "from_row", "start_s",
+        "read_ms", "load_ms", "textures_ms", "switch_ms", "first_image_ms",
+        "cache_hits", "cache_misses", "hit_load_ms", "miss_load_ms",
+        "verdict_ms", "dwell_ms", "verdict_changes"};
+
+    // Not synced: losing the last lines in a crash only loses statistics
+    std::string path = timingPath();
+    std::error_code ec;
+    bool fresh = !std::filesystem::exists(path, ec) || std::filesystem::file_size(path, ec) == 0;
+    if (!fresh)
+    {
+        // A file from a version with other columns is moved aside
+        std::ostringstream expected;
+        writeCsvRow(expected, header);
+        std::string first;
+        std::getline(std::ifstream(path), first);
+        if (first + "\n" != expected.str())
+        {
+            std::filesystem::rename(path, path + ".old", ec);
+            fresh = true;
         }
-        writeCsvRow(ofs, row);
     }
+    std::ofstream out(path, std::ios::app);
+    if (!out)
+        return;
+    if (fresh)
+        writeCsvRow(out, header);
+
+    const char* nav = visit.fromRow < 0                ? "first"
+                    : visit.row == visit.fromRow + 1   ? "next"
+                    : visit.row == visit.fromRow - 1   ? "prev"
+                                                       : "jump";
+    char start[32];
+    std::snprintf(start, sizeof(start), "%.3f", visit.start);
+    // Sessions are told apart by start second and rater
+    writeCsvRow(out, {std::to_string(sessionId_), workQueue ? workQueue->rater() : std::string(),
+                      std::to_string(visit.row),
+                      visit.row >= 0 && visit.row < rowCount() ? rowIds[visit.row] : std::string(),
+                      nav, std::to_string(visit.fromRow), start,
+                      formatMs(visit.read), formatMs(visit.load), formatMs(visit.textures),
+                      formatMs(visit.switchSeconds()), formatMs(visit.firstImage),
+                      std::to_string(visit.cacheHits), std::to_string(visit.cacheMisses),
+                      formatMs(visit.hitLoad), formatMs(visit.missLoad),
+                      formatMs(visit.verdict), formatMs(visit.dwell),
+                      std::to_string(visit.verdictChanges)});
+}
+
+const QCTimingSummary& QCState::timingSummary() const
+{
+    size_t finished = visits_.size() - (visitOpen_ ? 1 : 0);
+    if (finished == summaryVisits_)
+        return summary_;
+
+    QCTimingSummary s;
+    std::vector<double> switches, firstImages, verdicts, dwells;
+    switches.reserve(finished);
+    dwells.reserve(finished);
+    double dwellTotal = 0.0;
+    for (size_t i = 0; i < finished; ++i)
+    {
+        const QCRowVisit& v = visits_[i];
+        switches.push_back(v.switchSeconds());
+        if (v.firstImage >= 0.0)
+            firstImages.push_back(v.firstImage);
+        if (v.verdict >= 0.0)
+            verdicts.push_back(v.verdict);
+        dwells.push_back(v.dwell);
+        dwellTotal += v.dwell;
+        s.cacheHits += v.cacheHits;
+        s.cacheMisses += v.cacheMisses;
+        s.hitLoad += v.hitLoad;
+        s.missLoad += v.missLoad;
+    }
+    s.visits = static_cast<int>(finished);
+    s.switchP50 = percentile(switches, 0.50);
+    s.switchP95 = percentile(std::move(switches), 0.95);
+    s.firstImageP50 = percentile(firstImages, 0.50);
+    s.firstImageP95 = percentile(std::move(firstImages), 0.95);
+    s.verdictP50 = percentile(std::move(verdicts), 0.50);
+    s.dwellP50 = percentile(std::move(dwells), 0.50);
+    if (dwellTotal > 0.0)
+        s.rowsPerHour = finished * 3600.0 / dwellTotal;
+
+    summary_ = s;
+    summaryVisits_ = finished;
+    return summary_;
+}
 
-    ofs.flush();
+double QCState::percentile(std::vector<double> values, double p)
+{
+    if (values.empty())
+        return 0.0;
+    // Nearest rank: the smallest value with at least p of the values at
+    // or below it
+    size_t rank = static_cast<size_t>(std::ceil(p * values.size()));
+    size_t k = std::min(rank > 0 ? rank - 1 : 0, values.size() - 1);
+    std::nth_element(values.begin(), values.begin() + k, values.end());
+    return values[k];
 }
 
 // ---------------------------------------------------------------------------
@@ -404,33 +629,88 @@ int QCState::rowCount() const
     return static_cast<int>(rowIds.size());
 }
 
-int QCState::ratedCount() const
+bool QCState::rowRated(int row) const
+{
+    const auto& verdicts = results[row].verdicts;
+    return std::any_of(verdicts.begin(), verdicts.end(),
+        [](QCVerdict v) { return v != QC_UNKNOWN; });
+}
+
+void QCState::setVerdict(int row, int column, QCVerdict verdict)
 {
-    int count = 0;
+    QCVerdict& cell = results[row].verdicts[column];
+    if (cell == verdict)
+        return;
+
+    bool wasRated = rowRated(row);
+    if (cell >= 0 && cell < static_cast<int>(verdictCounts_.size()))
+        --verdictCounts_[cell];
+    cell = verdict;
+    if (cell >= 0 && cell < static_cast<int>(verdictCounts_.size()))
+        ++verdictCounts_[cell];
+
+    bool isRated = rowRated(row);
+    ratedRows_ += static_cast<int>(isRated) - static_cast<int>(wasRated);
+    if (!isRated && row < firstUnratedHint_)
+        firstUnratedHint_ = row;
+
+    if (visitOpen_ && visits_.back().row == row)
+    {
+        QCRowVisit& visit = visits_.back();
+        ++visit.verdictChanges;
+        if (verdict != QC_UNKNOWN && visit.verdict < 0.0)
+            visit.verdict = std::max(0.0, secondsBetween(visitShown_, Clock::now()));
+    }
+}
+
+void QCState::recountVerdicts()
+{
+    ratedRows_ = 0;
+    verdictCounts_.assign(verdictOptions.size(), 0);
     for (const auto& r : results)
     {
-        bool anyRated = std::any_of(r.verdicts.begin(), r.verdicts.end(),
-            [](QCVerdict v) { return v != QC_UNKNOWN; });
+        bool anyRated = false;
+        for (QCVerdict v : r.verdicts)
+        {
+            if (v >= 0 && v < static_cast<int>(verdictCounts_.size()))
+                ++verdictCounts_[v];
+            anyRated = anyRated || v != QC_UNKNOWN;
+        }
         if (anyRated)
-            ++count;
+            ++ratedRows_;
     }
-    return count;
+    firstUnratedHint_ = 0;
+}
+
+int QCState::verdictCount(QCVerdict verdict) const
+{
+    if (verdict < 0 || verdict >= static_cast<int>(verdictCounts_.size()))
+        return 0;
+    return verdictCounts_[verdict];
 }
 
 int QCState::firstUnratedRow() const
 {
-    for (size_t i = 0; i < results.size(); ++i)
-    {
-        bool allUnrated = std::all_of(results[i].verdicts.begin(),
-            results[i].verdicts.end(),
-            [](QCVerdict v) { return v == QC_UNKNOWN; });
-        if (allUnrated)
-            return static_cast<int>(i);
-    }
-    return -1;
+    // Rows before the hint are rated; rows only become unrated through
+    // setVerdict(), which moves the hint back
+    while (firstUnratedHint_ < rowCount() && rowRated(firstUnratedHint_))
+        ++firstUnratedHint_;
+    return firstUnratedHint_ < rowCount() ? firstUnratedHint_ : -1;
 }
 
 const std::vector<std::string>& QCState::pathsForRow(int row) const
 {
-    return rowPaths[row];
+    std::vector<std::string>& paths = rowPaths_[row];
+    if (paths.empty() && inputCsv_)
+    {
+        std::vector<CsvField> fields;
+        inputCsv_->readRecord(rowOffsets_[row], fields);
+        paths.reserve(columnNames.size());
+        for (size_t ci = 0; ci < columnNames.size(); ++ci)
+        {
+            // A missing field is an empty path
+            paths.push_back(ci + 1 < fields.size() ? fields[ci + 1].str() : std::string());
+        }
+    }
+    return paths;
 }
@@ -0,0 +1,337 @@
+#include "QCWorkQueue.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+/// File names are built from the rater name: keep it to a safe alphabet.
+std::string sanitizeRater(const std::string& rater)
+{
+    std::string out;
+    for (char c : rater)
+    {
+        bool safe = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                    (c >= '0' && c <= '9') || c == '.' || c == '-' || c == '_' || c == '@';
+        out += safe ? c : '_';
+    }
+    if (out.empty() || out[0] == '.')
+        out.insert(out.begin(), '_');
+    return out;
+}
+
+/// Modification time of @p path in seconds since the epoch, or -1.
+double fileTime(const std::string& path)
+{
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0)
+        return -1.0;
+    return static_cast<double>(st.st_mtim.tv_sec) + st.st_mtim.tv_nsec * 1e-9;
+}
+
+/// Set the modification time of @p path to now, on the server's clock
+/// when it is on NFS.
+bool touch(const std::string& path)
+{
+    return ::utimensat(AT_FDCWD, path.c_str(), nullptr, 0) == 0;
+}
+
+} // anonymous namespace
+
+QCWorkQueue::QCWorkQueue(const std::string& dir, const std::string& rater, int rowCount,
+                         int blockRows, int leaseSeconds)
+    : dir_(dir)
+    , rater_(sanitizeRater(rater))
+    , rowCount_(rowCount)
+    , blockRows_(std::max(blockRows, 1))
+    , leaseSeconds_(leaseSeconds)
+{
+    std::error_code ec;
+    for (const char* sub : {"leases", "raters", "journals", "timing"})
+    {
+        fs::create_directories(fs::path(dir_) / sub, ec);
+        if (ec)
+            throw std::runtime_error("Cannot create QC queue directory " +
+                                     (fs::path(dir_) / sub).string() + ": " + ec.message());
+    }
+
+    // The first rater fixes the block size; the others check they rate the
+    // same study
+    const std::string queueFile = (fs::path(dir_) / "queue").string();
+    std::ostringstream desc;
+    desc << "rows " << rowCount_ << " block " << blockRows_ << "\n";
+    if (!createExclusive(queueFile, desc.str()))
+    {
+        std::string word;
+        int rows = -1;
+        int block = 0;
+        // Its creator may not have written it yet
+        for (int attempt = 0; attempt < 50 && block <= 0; ++attempt)
+        {
+            if (attempt > 0)
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            std::ifstream in(queueFile);
+            in >> word >> rows >> word >> block;
+        }
+        if (block <= 0)
+            throw std::runtime_error("Cannot read QC queue file " + queueFile);
+        if (rows != rowCount_)
+            throw std::runtime_error("QC queue " + dir_ + " is for a study of " +
+                                     std::to_string(rows) + " rows, not " +
+                                     std::to_string(rowCount_));
+        blockRows_ = block;
+    }
+}
+
+std::string QCWorkQueue::defaultRater()
+{
+    const char* user = std::getenv("USER");
+    if (!user || !*user)
+        user = std::getenv("LOGNAME");
+    char host[256] = {};
+    if (::gethostname(host, sizeof(host) - 1) != 0)
+        host[0] = '\0';
+    return std::string(user && *user ? user : "rater") + "@" + (host[0] ? host : "localhost");
+}
+
+std::string QCWorkQueue::leasePath(int block) const
+{
+    return (fs::path(dir_) / "leases" / (std::to_string(block * blockRows_) + ".lease")).string();
+}
+
+std::string QCWorkQueue::donePath(int block) const
+{
+    return (fs::path(dir_) / "leases" / (std::to_string(block * blockRows_) + ".done")).string();
+}
+
+bool QCWorkQueue::isDone(int block) const
+{
+    return ::access(donePath(block).c_str(), F_OK) == 0;
+}
+
+std::string QCWorkQueue::journalPath() const
+{
+    return (fs::path(dir_) / "journals" / (rater_ + ".csv")).string();
+}
+
+std::string QCWorkQueue::timingPath() const
+{
+    return (fs::path(dir_) / "timing" / (rater_ + ".csv")).string();
+}
+
+std::vector<std::string> QCWorkQueue::journalPaths() const
+{
+    std::vector<std::string> paths;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(fs::path(dir_) / "journals", ec))
+    {
+        if (entry.path().extension() == ".csv" && entry.is_regular_file(ec))
+            paths.push_back(entry.path().string());
+    }
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
+
+std::string QCWorkQueue::readLease(const std::string& path)
+{
+    std::ifstream in(path);
+    std::string line;
+    std::getline(in, line);
+    return line;
+}
+
+bool QCWorkQueue::createExclusive(const std::string& path, const std::string& content)
+{
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0644);
+    if (fd < 0)
+        return false;
+    bool ok = ::write(fd, content.data(), content.size()) == static_cast<ssize_t>(content.size());
+    ok = ::close(fd) == 0 && ok;
+    if (!ok)
+        ::unlink(path.c_str());
+    return ok;
+}
+
+double QCWorkQueue::serverTime() const
+{
+    const std::string heartbeat = (fs::path(dir_) / "raters" / rater_).string();
+    if (!touch(heartbeat))
+        createExclusive(heartbeat, rater_ + "\n");
+    double t = fileTime(heartbeat);
+    if (t < 0.0)
+    {
+        // Unreadable: fall back to this machine's clock
+        t = std::chrono::duration<double>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+    return t;
+}
+
+bool QCWorkQueue::tryLease(int block, double now)
+{
+    if (isDone(block))
+        return false;
+    const std::string path = leasePath(block);
+    const std::string claimed = "claimed " + rater_;
+    if (createExclusive(path, claimed + "\n"))
+    {
+        // Finished by its previous holder just before we claimed it
+        if (!isDone(block))
+            return true;
+        ::unlink(path.c_str());
+        return false;
+    }
+
+    // Leased before: only a claim left to expire can be taken over (queues
+    // of older versions also wrote "done <rater>" into the lease)
+    const std::string lease = readLease(path);
+    if (lease.rfind("claimed ", 0) != 0)
+        return false;
+    double mtime = fileTime(path);
+    if (mtime < 0.0 || now - mtime < leaseSeconds_)
+        return false;
+
+    // Rename it out of the way; of several raters doing this, one wins.
+    const std::string stale = path + ".stale." + rater_ + "." + std::to_string(::getpid());
+    if (::rename(path.c_str(), stale.c_str()) != 0)
+        return false;
+    if (takeOverHook_)
+        takeOverHook_();
+
+    // Its holder may have renewed or replaced it after we read it: put it
+    // back then.  link() fails if another rater made a new lease in the
+    // meantime; both now believe they hold the block, so keep the renewed
+    // lease beside the new one and report it.  The holder drops the block
+    // at its next renew().
+    double staleTime = fileTime(stale);
+    if (readLease(stale) != lease || (staleTime >= 0.0 && now - staleTime < leaseSeconds_))
+    {
+        if (::link(stale.c_str(), path.c_str()) == 0)
+            ::unlink(stale.c_str());
+        else if (errno != EEXIST)
+            ::rename(stale.c_str(), path.c_str());
+        else
+            std::cerr << "[qc-queue] " << path << " was renewed while being taken over and "
+                      << "claimed again meanwhile (" << readLease(path)
+                      << "); the renewed lease is kept as " << stale << "\n";
+        return false;
+    }
+    ::unlink(stale.c_str());
+    return createExclusive(path, claimed + "\n");
+}
+
+int QCWorkQueue::claim(const std::function<bool(int row)>& needsRating)
+{
+    const int blocks = blockCount();
+    if (blocks == 0)
+        return -1;
+    const double now = serverTime();
+    for (int i = 0; i < blocks; ++i)
+    {
+        int block = (nextBlock_ + i) % blocks;
+        if (std::binary_search(held_.begin(), held_.end(), block))
+            continue;
+        int first = block * blockRows_;
+        int last = std::min(first + blockRows_, rowCount_);
+        bool open = false;
+        for (int row = first; row < last && !open; ++row)
+            open = needsRating(row);
+        if (!open || !tryLease(block, now))
+            continue;
+
+        held_.insert(std::upper_bound(held_.begin(), held_.end(), block), block);
+        nextBlock_ = (block + 1) % blocks;
+        renewed_ = std::chrono::steady_clock::now();
+        return block;
+    }
+    return -1;
+}
+
+bool QCWorkQueue::owns(int row) const
+{
+    return row >= 0 && row < rowCount_ &&
+           std::binary_search(held_.begin(), held_.end(), blockOf(row));
+}
+
+int QCWorkQueue::nextHeldRow(int row, int step) const
+{
+    if (step > 0)
+    {
+        for (int block : held_)
+        {
+            int first = block * blockRows_;
+            int last = std::min(first + blockRows_, rowCount_) - 1;
+            if (last > row)
+                return std::max(first, row + 1);
+        }
+    }
+    else
+    {
+        for (auto it = held_.rbegin(); it != held_.rend(); ++it)
+        {
+            int first = *it * blockRows_;
+            int last = std::min(first + blockRows_, rowCount_) - 1;
+            if (first < row)
+                return std::min(last, row - 1);
+        }
+    }
+    return -1;
+}
+
+void QCWorkQueue::renew(bool force)
+{
+    auto now = std::chrono::steady_clock::now();
+    if (held_.empty() ||
+        (!force && now - renewed_ < std::chrono::seconds(leaseSeconds_ / 4)))
+        return;
+    renewed_ = now;
+
+    const std::string claimed = "claimed " + rater_;
+    held_.erase(std::remove_if(held_.begin(), held_.end(), [&](int block) {
+                    const std::string path = leasePath(block);
+                    return isDone(block) || readLease(path) != claimed || !touch(path);
+                }),
+                held_.end());
+}
+
+void QCWorkQueue::finish(int block)
+{
+    auto it = std::lower_bound(held_.begin(), held_.end(), block);
+    if (it == held_.end() || *it != block)
+        return;
+    held_.erase(it);
+
+    // The rows are rated whoever holds the lease now.  The done file is
+    // made once and never replaced, so a lease taken over since our last
+    // renew() is left alone (its holder drops it at its next renew()).
+    createExclusive(donePath(block), "done " + rater_ + "\n");
+    const std::string path = leasePath(block);
+    if (readLease(path) == "claimed " + rater_)
+        ::unlink(path.c_str());
+}
+
+void QCWorkQueue::release(int block)
+{
+    auto it = std::lower_bound(held_.begin(), held_.end(), block);
+    if (it == held_.end() || *it != block)
+        return;
+    held_.erase(it);
+
+    const std::string path = leasePath(block);
+    if (readLease(path) == "claimed " + rater_)
+        ::unlink(path.c_str());
+}
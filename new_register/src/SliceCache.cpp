@@ -0,0 +1,205 @@
+#include "SliceCache.h"
+
+#include <algorithm>
+#include <cstring>
+
+uint64_t sliceParamsHash(const VolumeRenderParams& params, uint64_t contentVersion)
+{
+    // FNV-1a over the colour-relevant fields
+    uint64_t h = 0xCBF29CE484222325ull;
+    auto mix = [&h](const void* p, size_t n) {
+        const unsigned char* b = static_cast<const unsigned char*>(p);
+        for (size_t i = 0; i < n; ++i)
+        {
+            h ^= b[i];
+            h *= 0x100000001B3ull;
+        }
+    };
+    auto mixValue = [&mix](auto v) { mix(&v, sizeof(v)); };
+
+    mixValue(params.valueMin);
+    mixValue(params.valueMax);
+    mixValue(static_cast<int>(params.colourMap));
+    mixValue(params.underColourMode);
+    mixValue(params.overColourMode);
+    mixValue(static_cast<uint8_t>(params.useLogTransform));
+    mixValue(static_cast<uint8_t>(params.invertColourMap));
+    mixValue(contentVersion);
+    return h;
+}
+
+SliceCache::SliceCache(size_t budgetBytes)
+    : budgetBytes_(budgetBytes)
+{
+}
+
+SliceCache::~SliceCache()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+        pending_.clear();
+    }
+    workCv_.notify_all();
+    if (worker_.joinable())
+        worker_.join();
+}
+
+SliceCache::SlicePtr SliceCache::find(const SliceKey& key)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it == entries_.end())
+    {
+        ++stats_.misses;
+        return nullptr;
+    }
+    ++stats_.hits;
+    lru_.splice(lru_.begin(), lru_, it->second.lruPos);
+    return it->second.slice;
+}
+
+SliceCache::SlicePtr SliceCache::insert(const SliceKey& key, RenderedSlice slice)
+{
+    auto ptr = std::make_shared<const RenderedSlice>(std::move(slice));
+    std::lock_guard<std::mutex> lock(mutex_);
+    return insertLocked(key, std::move(ptr));
+}
+
+SliceCache::SlicePtr SliceCache::insertLocked(const SliceKey& key, SlicePtr slice)
+{
+    auto it = entries_.find(key);
+    if (it != entries_.end())
+    {
+        lru_.splice(lru_.begin(), lru_, it->second.lruPos);
+        return it->second.slice;
+    }
+
+    lru_.push_front(key);
+    bytes_ += sliceBytes(*slice);
+    entries_.emplace(key, Entry{slice, lru_.begin()});
+
+    // Evict from the cold end, always keeping the slice just inserted
+    while (bytes_ > budgetBytes_ && lru_.size() > 1)
+    {
+        auto victim = entries_.find(lru_.back());
+        bytes_ -= sliceBytes(*victim->second.slice);
+        entries_.erase(victim);
+        lru_.pop_back();
+        ++stats_.evictions;
+    }
+    return slice;
+}
+
+void SliceCache::prefetch(int volume, int view, std::vector<Job> jobs)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stop_)
+            return;
+
+        pending_.erase(std::remove_if(pending_.begin(), pending_.end(),
+                                      [&](const Job& j) {
+                                          return j.key.volume == volume &&
+                                                 j.key.view == view;
+                                      }),
+                       pending_.end());
+        for (Job& job : jobs)
+            if (entries_.find(job.key) == entries_.end())
+                pending_.push_back(std::move(job));
+        if (pending_.empty())
+            return;
+
+        if (!worker_.joinable())
+            worker_ = std::thread(&SliceCache::workerLoop, this);
+    }
+    workCv_.notify_one();
+}
+
+void SliceCache::cancelPending()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    pending_.clear();
+    ++generation_;
+    waitForWorkerLocked(lock);
+}
+
+void SliceCache::clear()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    pending_.clear();
+    ++generation_;
+    waitForWorkerLocked(lock);
+    entries_.clear();
+    lru_.clear();
+    bytes_ = 0;
+}
+
+void SliceCache::waitIdle()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    idleCv_.wait(lock, [this] { return pending_.empty() && !busy_; });
+}
+
+void SliceCache::waitForWorkerLocked(std::unique_lock<std::mutex>& lock)
+{
+    idleCv_.wait(lock, [this] { return !busy_; });
+}
+
+SliceCache::Stats SliceCache::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats s = stats_;
+    s.bytes = bytes_;
+    s.entries = entries_.size();
+    return s;
+}
+
+void SliceCache::workerLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;)
+    {
+        workCv_.wait(lock, [this] { return stop_ || !pending_.empty(); });
+        if (stop_)
+            break;
+
+        Job job = std::move(pending_.front());
+        pending_.pop_front();
+
+        // The slice may have been rendered on the UI thread meanwhile
+        if (entries_.find(job.key) != entries_.end())
+        {
+            if (pending_.empty())
+                idleCv_.notify_all();
+            continue;
+        }
+
+        busy_ = true;
+        uint64_t gen = generation_;
+        lock.unlock();
+
+        // A speculative render that fails (e.g. out of memory on a large
+        // volume) is dropped; the UI thread renders the slice if it is shown
+        std::shared_ptr<const RenderedSlice> slice;
+        try
+        {
+            slice = std::make_shared<const RenderedSlice>(job.render());
+        }
+        catch (const std::exception&)
+        {
+        }
+
+        lock.lock();
+        busy_ = false;
+        // Drop the result if the cache was cancelled or cleared meanwhile
+        if (slice && gen == generation_ && !slice->pixels.empty())
+        {
+            insertLocked(job.key, std::move(slice));
+            ++stats_.prefetched;
+        }
+        idleCv_.notify_all();
+    }
+    busy_ = false;
+    idleCv_.notify_all();
+}
@@ -5,269 +5,383 @@
 #include <cstdio>
 
 // ---------------------------------------------------------------------------
-// renderSlice — single-volume 2D slice (port of ViewManager::updateSliceTexture
-//               CPU portion, lines 15-183)
+// buildColourTransfer — precompose range / log / invert / clamp into tables
 // ---------------------------------------------------------------------------
 
-RenderedSlice renderSlice(
-    const Volume& vol,
-    const VolumeRenderParams& params,
-    int viewIndex,
-    int sliceIndex)
+namespace
 {
-    RenderedSlice result;
 
-    if (vol.data.empty())
-        return result;
+/// Resolve an under/over clamp mode to a packed colour (0 when transparent).
+uint32_t resolveSliceClampColour(int mode, ColourMapType currentMap,
+                                 bool isOver, bool invert)
+{
+    if (mode == kSliceClampTransparent)
+        return 0x00000000;
+    if (mode == kSliceClampBlack)
+        return 0xFF000000;
+    if (mode == kSliceClampRed)
+        return 0xFF0000FF;
+    if (mode == kSliceClampGreen)
+        return 0xFF00FF00;
+    if (mode == kSliceClampBlue)
+        return 0xFFFF0000;
+    if (mode == kSliceClampYellow)
+        return 0xFF00FFFF;
+    if (mode == kSliceClampWhite)
+        return 0xFFFFFFFF;
+
+    ColourMapType mapToUse = currentMap;
+    if (mode >= 0 && mode < colourMapCount())
+        mapToUse = static_cast<ColourMapType>(mode);
+    const ColourLut& lut = colourMapLut(mapToUse);
+    if (isOver)
+        return invert ? lut.table[0] : lut.table[kLutSize - 1];
+    return invert ? lut.table[kLutSize - 1] : lut.table[0];
+}
 
-    // Hoist LUT pointer and colour count
-    // Use inverted LUT if invert flag is enabled
-    const ColourLut& baseLut = colourMapLut(params.colourMap);
-    ColourLut invertedLut;
-    const uint32_t* mainLut;
-    
-    if (params.invertColourMap)
-    {
-        invertedLut = invertColourLut(baseLut);
-        mainLut = invertedLut.table.data();
-    }
-    else
-    {
-        mainLut = baseLut.table.data();
-    }
-    
-    int numMaps = colourMapCount();
+} // namespace
 
-    int dimX = vol.dimensions.x;
-    int dimY = vol.dimensions.y;
-    int dimZ = vol.dimensions.z;
+ColourTransfer buildColourTransfer(const VolumeRenderParams& params)
+{
+    ColourTransfer t;
+    t.params = params;
+    t.useLog = params.useLogTransform;
 
     float rangeMin = static_cast<float>(params.valueMin);
     float rangeMax = static_cast<float>(params.valueMax);
 
-    // Log-transform the range if log transform is enabled
-    float logRangeMin = rangeMin;
-    float logRangeMax = rangeMax;
-    
-    if (params.useLogTransform)
+    if (t.useLog)
     {
-        // Prevent crash when rangeMin <= 0.0 (log10 undefined for non-positive values)
-        // Set lower threshold to -10 (corresponds to log10(1e-10))
+        // log10 is undefined for non-positive bounds; clamp the lower
+        // threshold to -10 (corresponds to log10(1e-10))
         float logLowerThreshold = -10.0f;
-        if (rangeMin <= 0.0f)
-            logRangeMin = logLowerThreshold;
-        else
-            logRangeMin = std::log10(rangeMin);
-        
-        if (rangeMax <= 0.0f)
-            logRangeMax = logLowerThreshold;
-        else
-            logRangeMax = std::log10(rangeMax);
+        rangeMin = (rangeMin <= 0.0f) ? logLowerThreshold : std::log10(rangeMin);
+        rangeMax = (rangeMax <= 0.0f) ? logLowerThreshold : std::log10(rangeMax);
     }
 
-    float rangeSpan = logRangeMax - logRangeMin;
+    float rangeSpan = rangeMax - rangeMin;
     if (rangeSpan < 1e-12f)
         rangeSpan = 1e-12f;
-    float invSpan = 1.0f / rangeSpan;
+    t.rangeMin = rangeMin;
+    t.rangeMax = rangeMax;
+    t.invSpan = 1.0f / rangeSpan;
 
-    // Pre-resolve under/over LUT pointers
-    int underMode = params.underColourMode;
-    bool underTransparent = (underMode == kSliceClampTransparent);
-    uint32_t underColour = 0x00000000;
-    if (!underTransparent)
+    const ColourLut& baseLut = colourMapLut(params.colourMap);
+    for (int i = 0; i < kLutSize; ++i)
     {
-        if (underMode == kSliceClampBlack)
-            underColour = 0xFF000000;
-        else if (underMode == kSliceClampRed)
-            underColour = 0xFF0000FF;
-        else if (underMode == kSliceClampGreen)
-            underColour = 0xFF00FF00;
-        else if (underMode == kSliceClampBlue)
-            underColour = 0xFFFF0000;
-        else if (underMode == kSliceClampYellow)
-            underColour = 0xFF00FFFF;
-        else if (underMode == kSliceClampWhite)
-            underColour = 0xFFFFFFFF;
-        else
-        {
-            ColourMapType underMap = params.colourMap;
-            if (underMode >= 0 && underMode < numMaps)
-                underMap = static_cast<ColourMapType>(underMode);
-            const ColourLut& underLut = colourMapLut(underMap);
-            underColour = params.invertColourMap ? underLut.table[kLutSize - 1] : underLut.table[0];
-        }
+        int src = params.invertColourMap ? (kLutSize - 1 - i) : i;
+        t.slots[1 + i] = baseLut.table[src];
     }
+    t.slots[ColourTransfer::kUnderSlot] = resolveSliceClampColour(
+        params.underColourMode, params.colourMap, false, params.invertColourMap);
+    t.slots[ColourTransfer::kOverSlot] = resolveSliceClampColour(
+        params.overColourMode, params.colourMap, true, params.invertColourMap);
 
-    int overMode = params.overColourMode;
-    bool overTransparent = (overMode == kSliceClampTransparent);
-    uint32_t overColour = 0x00000000;
-    if (!overTransparent)
+    if (t.useLog)
     {
-        if (overMode == kSliceClampBlack)
-            overColour = 0xFF000000;
-        else if (overMode == kSliceClampRed)
-            overColour = 0xFF0000FF;
-        else if (overMode == kSliceClampGreen)
-            overColour = 0xFF00FF00;
-        else if (overMode == kSliceClampBlue)
-            overColour = 0xFFFF0000;
-        else if (overMode == kSliceClampYellow)
-            overColour = 0xFF00FFFF;
-        else if (overMode == kSliceClampWhite)
-            overColour = 0xFFFFFFFF;
-        else
+        // slotOf() is monotone in the value, so a key whose first and last
+        // float land in the same slot maps every value in between there too.
+        t.logSlots.resize(1u << 16);
+        for (uint32_t key = 0; key < (1u << 16); ++key)
         {
-            ColourMapType overMap = params.colourMap;
-            if (overMode >= 0 && overMode < numMaps)
-                overMap = static_cast<ColourMapType>(overMode);
-            const ColourLut& overLut = colourMapLut(overMap);
-            overColour = params.invertColourMap ? overLut.table[0] : overLut.table[255];
+            uint32_t loBits = key << 16;
+            uint32_t hiBits = loBits | 0xFFFFu;
+            float lo, hi;
+            std::memcpy(&lo, &loBits, sizeof(lo));
+            std::memcpy(&hi, &hiBits, sizeof(hi));
+            if (std::isnan(lo) || std::isnan(hi))
+            {
+                t.logSlots[key] = ColourTransfer::kMixedKey;
+                continue;
+            }
+            int a = t.slotOf(lo);
+            int b = t.slotOf(hi);
+            t.logSlots[key] = (a == b) ? static_cast<uint16_t>(a)
+                                       : ColourTransfer::kMixedKey;
         }
     }
 
-    // For label volumes: build label-to-index mapping if a non-default colour
-    // map is selected, so labels are rendered via the colour map LUT instead
-    // of per-label RGBA.
-    bool useColourMapForLabel = vol.isLabelVolume();
-    std::unordered_map<int, int> labelToIndex;
-    size_t labelCount = 0;
-    if (useColourMapForLabel)
+    return t;
+}
+
+// ---------------------------------------------------------------------------
+// buildLabelPalette — dense id -> colour table for label volumes
+// ---------------------------------------------------------------------------
+
+LabelPalette buildLabelPalette(const Volume& vol, const ColourTransfer& transfer,
+                               bool useColourMap)
+{
+    LabelPalette palette;
+    palette.contentVersion = vol.contentVersion();
+
+    std::vector<int> ids = vol.getUniqueLabelIds();
+    int labelCount = static_cast<int>(ids.size());
+    const auto& labelLUT = vol.getLabelLUT();
+    if (!useColourMap)
     {
-        std::vector<int> uniqueLabels = vol.getUniqueLabelIds();
-        for (size_t i = 0; i < uniqueLabels.size(); ++i)
-            labelToIndex[uniqueLabels[i]] = static_cast<int>(i);
-        labelCount = uniqueLabels.size();
+        for (const auto& entry : labelLUT)
+            if (entry.first != 0)
+                ids.push_back(entry.first);
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
     }
+    if (ids.empty())
+        return palette;
 
-    // Lambda: map a raw voxel value to a packed 0xAABBGGRR colour.
-    auto voxelToColour = [&](float val) -> uint32_t {
-        float displayVal = val;
-
-        // Log transform (applied before colour mapping)
-        if (params.useLogTransform)
+    // Colour for the label at sorted position `rank` of the volume's ids
+    auto colourFor = [&](int labelId, int rank) -> uint32_t {
+        if (useColourMap)
         {
-            // Values <= 0 use under-colour setting
-            if (val <= 0.0f)
-            {
-                if (underTransparent)
-                    return 0x00000000;
-                return underColour;
-            }
-            displayVal = std::log10(val);
+            int idx = (rank + 1) * 255 / labelCount;
+            return transfer.lutColour(idx);
         }
-
-        // Label volumes
-        if (vol.isLabelVolume())
+        auto it = labelLUT.find(labelId);
+        if (it != labelLUT.end())
         {
-            int labelId = static_cast<int>(displayVal + 0.5f);
-            if (labelId == 0)
-                return 0x00000000;  // transparent background
+            const LabelInfo& info = it->second;
+            if (!info.visible)
+                return 0x00000000;
+            return static_cast<uint32_t>(info.r) |
+                   (static_cast<uint32_t>(info.g) << 8) |
+                   (static_cast<uint32_t>(info.b) << 16) |
+                   (static_cast<uint32_t>(info.a) << 24);
+        }
+        // Label not in LUT: deterministic grayscale
+        int gray = (labelId * 17) % 256;
+        return static_cast<uint32_t>(gray) |
+               (static_cast<uint32_t>(gray) << 8) |
+               (static_cast<uint32_t>(gray) << 16) |
+               0xFF000000;
+    };
 
-            if (useColourMapForLabel)
-            {
-                auto it = labelToIndex.find(labelId);
-                if (it != labelToIndex.end() && labelCount > 0)
-                {
-                    int idx = (it->second + 1) * 255 / static_cast<int>(labelCount);
-                    if (idx < 0)   return underColour;
-                    if (idx > 255) return overColour;
-                    return mainLut[idx];
-                }
-                return 0x00000000;  // unknown label
-            }
+    int64_t span = static_cast<int64_t>(ids.back()) - ids.front() + 1;
+    if (span <= LabelPalette::kMaxDenseSpan)
+    {
+        palette.minId = ids.front();
+        palette.colours.assign(static_cast<size_t>(span), 0x00000000);
+        for (size_t i = 0; i < ids.size(); ++i)
+            palette.colours[ids[i] - palette.minId] = colourFor(ids[i], static_cast<int>(i));
+    }
+    else
+    {
+        for (size_t i = 0; i < ids.size(); ++i)
+            palette.sparse[ids[i]] = colourFor(ids[i], static_cast<int>(i));
+    }
+    return palette;
+}
 
-            // Default: use per-label LUT
-            const auto& labelLUT = vol.getLabelLUT();
-            auto it = labelLUT.find(labelId);
-            if (it != labelLUT.end())
-            {
-                const LabelInfo& info = it->second;
-                if (!info.visible)
-                    return 0x00000000;
-                return static_cast<uint32_t>(info.r) |
-                       (static_cast<uint32_t>(info.g) << 8) |
-                       (static_cast<uint32_t>(info.b) << 16) |
-                       (static_cast<uint32_t>(info.a) << 24);
-            }
+// ---------------------------------------------------------------------------
+// renderSlice — single-volume 2D slice (port of ViewManager::updateSliceTexture
+//               CPU portion, lines 15-183)
+// ---------------------------------------------------------------------------
 
-            // Label not in LUT: deterministic grayscale
-            int gray = (labelId * 17) % 256;
-            return static_cast<uint32_t>(gray) |
-                   (static_cast<uint32_t>(gray) << 8) |
-                   (static_cast<uint32_t>(gray) << 16) |
-                   0xFF000000;
-        }
+namespace
+{
 
-        // Regular volume: colour map with under/over clamping
-        if (displayVal < logRangeMin)
-            return underTransparent ? 0x00000000 : underColour;
-        if (displayVal > logRangeMax)
-            return overTransparent ? 0x00000000 : overColour;
-        int idx = static_cast<int>((displayVal - logRangeMin) * invSpan * 255.0f + 0.5f);
-        if (idx > 255)
-            idx = 255;
-        return mainLut[idx];
-    };
+/// Output size of a slice: axial X*Y, sagittal Y*Z, coronal X*Z.
+void sliceDimensions(const Volume& vol, int viewIndex, int& w, int& h)
+{
+    if (viewIndex == 0)
+    {
+        w = vol.dimensions.x;
+        h = vol.dimensions.y;
+    }
+    else if (viewIndex == 1)
+    {
+        w = vol.dimensions.y;
+        h = vol.dimensions.z;
+    }
+    else
+    {
+        w = vol.dimensions.x;
+        h = vol.dimensions.z;
+    }
+}
 
+/// Call fn(dst, value) for every voxel of a slice, dst being the output
+/// pixel index (rows top to bottom, so the volume's y/z axis points up).
+template <typename Fn>
+void forEachSliceVoxel(const Volume& vol, int viewIndex, int sliceIndex, Fn&& fn)
+{
+    int dimX = vol.dimensions.x;
+    int dimY = vol.dimensions.y;
+    int dimZ = vol.dimensions.z;
     const float* vdata = vol.data.data();
-    int w, h;
 
     if (viewIndex == 0)
     {
         // Axial (Z): px=X, py=Y
-        w = dimX;
-        h = dimY;
+        int w = dimX;
+        int h = dimY;
         int z = std::clamp(sliceIndex, 0, dimZ - 1);
 
-        result.pixels.resize(w * h);
         int zOff = z * dimY * dimX;
         for (int y = 0; y < h; ++y)
         {
             int rowOff = zOff + y * dimX;
             int dstOff = (h - 1 - y) * w;
             for (int x = 0; x < w; ++x)
-                result.pixels[dstOff + x] = voxelToColour(vdata[rowOff + x]);
+                fn(dstOff + x, vdata[rowOff + x]);
         }
     }
     else if (viewIndex == 1)
     {
         // Sagittal (X): px=Y, py=Z
-        w = dimY;
-        h = dimZ;
+        int w = dimY;
+        int h = dimZ;
         int x = std::clamp(sliceIndex, 0, dimX - 1);
 
-        result.pixels.resize(w * h);
         for (int z = 0; z < h; ++z)
         {
             int zOff = z * dimY * dimX + x;
             int dstOff = (h - 1 - z) * w;
             for (int y = 0; y < w; ++y)
-                result.pixels[dstOff + y] = voxelToColour(vdata[zOff + y * dimX]);
+                fn(dstOff + y, vdata[zOff + y * dimX]);
         }
     }
     else
     {
         // Coronal (Y): px=X, py=Z
-        w = dimX;
-        h = dimZ;
+        int w = dimX;
+        int h = dimZ;
         int y = std::clamp(sliceIndex, 0, dimY - 1);
 
-        result.pixels.resize(w * h);
         int yOff = y * dimX;
         for (int z = 0; z < h; ++z)
         {
             int zOff = z * dimY * dimX + yOff;
             int dstOff = (h - 1 - z) * w;
             for (int x = 0; x < w; ++x)
-                result.pixels[dstOff + x] = voxelToColour(vdata[zOff + x]);
+                fn(dstOff + x, vdata[zOff + x]);
         }
     }
+}
 
-    result.width = w;
-    result.height = h;
+} // namespace
+
+RenderedSlice renderSlice(
+    const Volume& vol,
+    const VolumeRenderParams& params,
+    int viewIndex,
+    int sliceIndex)
+{
+    if (vol.data.empty())
+        return RenderedSlice{};
+    return renderSlice(vol, buildColourTransfer(params), viewIndex, sliceIndex);
+}
+
+RenderedSlice renderSlice(
+    const Volume& vol,
+    const ColourTransfer& transfer,
+    int viewIndex,
+    int sliceIndex)
+{
+    if (vol.data.empty())
+        return RenderedSlice{};
+
+    // Label volumes are coloured through a dense id -> colour palette
+    if (!vol.isLabelVolume())
+        return renderSlice(vol, transfer, nullptr, viewIndex, sliceIndex);
+    LabelPalette palette = buildLabelPalette(vol, transfer);
+    return renderSlice(vol, transfer, &palette, viewIndex, sliceIndex);
+}
+
+RenderedSlice renderSlice(
+    const Volume& vol,
+    const ColourTransfer& transfer,
+    const LabelPalette* palette,
+    int viewIndex,
+    int sliceIndex)
+{
+    RenderedSlice result;
+
+    if (vol.data.empty())
+        return result;
+
+    sliceDimensions(vol, viewIndex, result.width, result.height);
+    result.pixels.resize(static_cast<size_t>(result.width) * result.height);
+    uint32_t* out = result.pixels.data();
+
+    if (!palette)
+    {
+        forEachSliceVoxel(vol, viewIndex, sliceIndex,
+                          [&](int dst, float val) { out[dst] = transfer.map(val); });
+        return result;
+    }
+
+    // Label voxels: log transform (if any) first, then the palette lookup
+    forEachSliceVoxel(vol, viewIndex, sliceIndex, [&](int dst, float val) {
+        float displayVal = val;
+        if (transfer.useLog)
+        {
+            // Values <= 0 use under-colour setting
+            if (val <= 0.0f)
+            {
+                out[dst] = transfer.slots[ColourTransfer::kUnderSlot];
+                return;
+            }
+            displayVal = std::log10(val);
+        }
+
+        // Label 0 and unknown labels are transparent
+        out[dst] = palette->colour(static_cast<int>(displayVal + 0.5f));
+    });
     return result;
 }
 
+// ---------------------------------------------------------------------------
+// renderSliceIndices — colour indices for paletted slice textures
+// ---------------------------------------------------------------------------
+
+IndexedSlice renderSliceIndices(
+    const Volume& vol,
+    const ColourTransfer& transfer,
+    int indexBytes,
+    int viewIndex,
+    int sliceIndex)
+{
+    IndexedSlice result;
+    if (vol.data.empty() || vol.isLabelVolume())
+        return result;
+
+    sliceDimensions(vol, viewIndex, result.width, result.height);
+    size_t count = static_cast<size_t>(result.width) * result.height;
+
+    if (indexBytes == 1)
+    {
+        // Under -> entry 0, over -> entry 255 (same colours, see indexBytes())
+        result.indexBytes = 1;
+        result.indices.resize(count);
+        uint8_t* out = result.indices.data();
+        forEachSliceVoxel(vol, viewIndex, sliceIndex, [&](int dst, float val) {
+            int s = transfer.slot(val);
+            out[dst] = static_cast<uint8_t>(std::clamp(s - 1, 0, kLutSize - 1));
+        });
+    }
+    else
+    {
+        result.indexBytes = 2;
+        result.indices.resize(count * sizeof(uint16_t));
+        uint16_t* out = reinterpret_cast<uint16_t*>(result.indices.data());
+        forEachSliceVoxel(vol, viewIndex, sliceIndex, [&](int dst, float val) {
+            out[dst] = static_cast<uint16_t>(transfer.slot(val));
+        });
+    }
+    return result;
+}
+
+int slicePalette(const ColourTransfer& transfer, int indexBytes,
+                 uint32_t out[kLutSize + 2])
+{
+    if (indexBytes == 1)
+    {
+        std::copy(transfer.slots.begin() + 1, transfer.slots.begin() + 1 + kLutSize, out);
+        return kLutSize;
+    }
+    std::copy(transfer.slots.begin(), transfer.slots.end(), out);
+    return kLutSize + 2;
+}
+
 // ---------------------------------------------------------------------------
 // renderOverlaySlice — multi-volume composite (port of
 //                      ViewManager::updateOverlayTexture CPU portion,
@@ -280,6 +394,36 @@ RenderedSlice renderOverlaySlice(
     int viewIndex,
     int sliceIndex,
     const TransformResult* transform)
+{
+    int numVols = static_cast<int>(volumes.size());
+    if (numVols < 2 || volumes[0]->data.empty())
+        return RenderedSlice{};
+
+    std::vector<ColourTransfer> transfers;
+    std::vector<LabelPalette> labelPalettes(numVols);
+    std::vector<const LabelPalette*> palettes(numVols, nullptr);
+    transfers.reserve(numVols);
+    for (int vi = 0; vi < numVols; ++vi)
+    {
+        transfers.push_back(buildColourTransfer(params[vi]));
+        if (volumes[vi]->isLabelVolume())
+        {
+            labelPalettes[vi] = buildLabelPalette(*volumes[vi], transfers[vi]);
+            palettes[vi] = &labelPalettes[vi];
+        }
+    }
+    return renderOverlaySlice(volumes, params, transfers, palettes,
+                              viewIndex, sliceIndex, transform);
+}
+
+RenderedSlice renderOverlaySlice(
+    const std::vector<const Volume*>& volumes,
+    const std::vector<VolumeRenderParams>& params,
+    const std::vector<ColourTransfer>& transfers,
+    const std::vector<const LabelPalette*>& palettes,
+    int viewIndex,
+    int sliceIndex,
+    const TransformResult* transform)
 {
     RenderedSlice result;
 
@@ -315,25 +459,14 @@ RenderedSlice renderOverlaySlice(
         const float* vdata;
         glm::ivec3 dims;
         int dimXY;
-        float rangeMin, rangeMax, invSpan;
-        float logRangeMin, logRangeMax;  // Log-transformed range values
-        const uint32_t* mainLut;
-        std::array<uint32_t, 256> ownedLut{};  // storage when invertColourMap (prevents dangling ptr)
-        uint32_t underColour, overColour;
-        bool underTransparent, overTransparent;
+        const ColourTransfer* transfer;  // range/log/invert/clamp folded into tables
         float alpha;
         bool isRef    = false;  // vi==0: sample at (rx,ry,rz) directly
         bool useTPS   = false;  // vi==1 with TPS transform
         int  volIndex = 0;      // original vi, for transform dispatch
-        bool isLabelVolume = false;
-        const std::unordered_map<int, LabelInfo>* labelLUT = nullptr;
-        bool useColourMapForLabel = false;
-        std::unordered_map<int, int> labelToIndex;
-        size_t labelCacheSize = 0;
-        bool useLogTransform = false;
+        const LabelPalette* palette = nullptr;  // dense label id -> colour
     };
 
-    int numMaps = colourMapCount();
     std::vector<PerVolInfo> infos;
     infos.reserve(numVols);
 
@@ -363,110 +496,9 @@ RenderedSlice renderOverlaySlice(
         info.vdata = vol.data.data();
         info.dims = vol.dimensions;
         info.dimXY = vol.dimensions.x * vol.dimensions.y;
-        info.rangeMin = static_cast<float>(p.valueMin);
-        info.rangeMax = static_cast<float>(p.valueMax);
-
-        // Log-transform the range if log transform is enabled
-        float logRangeMin = info.rangeMin;
-        float logRangeMax = info.rangeMax;
-        if (p.useLogTransform)
-        {
-            float logLowerThreshold = -10.0f;
-            logRangeMin = (info.rangeMin <= 0.0f) ? logLowerThreshold : std::log10(info.rangeMin);
-            logRangeMax = (info.rangeMax <= 0.0f) ? logLowerThreshold : std::log10(info.rangeMax);
-        }
-
-        float span = logRangeMax - logRangeMin;
-        if (span < 1e-12f)
-            span = 1e-12f;
-        info.invSpan = 1.0f / span;
-        info.logRangeMin = logRangeMin;
-        info.logRangeMax = logRangeMax;
-        // Use inverted LUT if invert flag is enabled
-        const ColourLut& baseLut = colourMapLut(p.colourMap);
-        if (p.invertColourMap)
-        {
-            ColourLut invertedLut = invertColourLut(baseLut);
-            info.ownedLut = invertedLut.table;  // own the storage
-            info.mainLut  = info.ownedLut.data();
-        }
-        else
-        {
-            info.mainLut = baseLut.table.data();
-        }
+        info.transfer = &transfers[vi];
         info.alpha = p.overlayAlpha;
-
-        // Pre-resolve under/over colours
-        int underMode = p.underColourMode;
-        info.underTransparent = (underMode == kSliceClampTransparent);
-        info.underColour = 0x00000000;
-        if (!info.underTransparent)
-        {
-            if (underMode == kSliceClampBlack)
-                info.underColour = 0xFF000000;
-            else if (underMode == kSliceClampRed)
-                info.underColour = 0xFF0000FF;
-            else if (underMode == kSliceClampGreen)
-                info.underColour = 0xFF00FF00;
-            else if (underMode == kSliceClampBlue)
-                info.underColour = 0xFFFF0000;
-            else if (underMode == kSliceClampYellow)
-                info.underColour = 0xFF00FFFF;
-            else if (underMode == kSliceClampWhite)
-                info.underColour = 0xFFFFFFFF;
-            else
-            {
-                ColourMapType underMap = p.colourMap;
-                if (underMode >= 0 && underMode < numMaps)
-                    underMap = static_cast<ColourMapType>(underMode);
-                const ColourLut& underLut = colourMapLut(underMap);
-                info.underColour = p.invertColourMap ? underLut.table[kLutSize - 1] : underLut.table[0];
-            }
-        }
-
-        int overMode = p.overColourMode;
-        info.overTransparent = (overMode == kSliceClampTransparent);
-        info.overColour = 0x00000000;
-        if (!info.overTransparent)
-        {
-            if (overMode == kSliceClampBlack)
-                info.overColour = 0xFF000000;
-            else if (overMode == kSliceClampRed)
-                info.overColour = 0xFF0000FF;
-            else if (overMode == kSliceClampGreen)
-                info.overColour = 0xFF00FF00;
-            else if (overMode == kSliceClampBlue)
-                info.overColour = 0xFFFF0000;
-            else if (overMode == kSliceClampYellow)
-                info.overColour = 0xFF00FFFF;
-            else if (overMode == kSliceClampWhite)
-                info.overColour = 0xFFFFFFFF;
-            else
-            {
-                ColourMapType overMap = p.colourMap;
-                if (overMode >= 0 && overMode < numMaps)
-                    overMap = static_cast<ColourMapType>(overMode);
-                const ColourLut& overLut = colourMapLut(overMap);
-                info.overColour = p.invertColourMap ? overLut.table[0] : overLut.table[255];
-            }
-        }
-
-        // Label volume support
-        info.isLabelVolume = vol.isLabelVolume();
-        if (info.isLabelVolume)
-        {
-            info.labelLUT = &vol.getLabelLUT();
-            {
-                info.useColourMapForLabel = true;
-                std::vector<int> uniqueLabels = vol.getUniqueLabelIds();
-                for (size_t i = 0; i < uniqueLabels.size(); ++i)
-                    info.labelToIndex[uniqueLabels[i]] = static_cast<int>(i);
-                info.labelCacheSize = uniqueLabels.size();
-            }
-        }
-
-        // Log transform setting
-        info.useLogTransform = p.useLogTransform;
+        info.palette = palettes[vi];
 
         infos.push_back(std::move(info));
     }
@@ -538,109 +570,19 @@ RenderedSlice renderOverlaySlice(
                 }
 
                 uint32_t packed;
+                if (info.palette && !info.transfer->useLog)
                 {
-                // Apply log transform if enabled
-                float displayVal = raw;
-                bool logSkipPixel = false;
-                uint32_t logSkipColour = 0;
-
-                if (info.useLogTransform)
-                {
-                    if (displayVal <= 0.0f)
-                    {
-                        // Non-positive values use under-colour setting
-                        if (info.underTransparent)
-                            continue;
-                        logSkipColour = info.underColour;
-                        logSkipPixel = true;
-                    }
-                    else
-                    {
-                        displayVal = std::log10(displayVal);
-                    }
-                }
-
-                if (logSkipPixel)
-                {
-                    packed = logSkipColour;
-                }
-                else if (info.isLabelVolume && !info.useLogTransform)
-                {
-                    int labelId = static_cast<int>(displayVal + 0.5f);
-                    if (labelId == 0)
-                        continue;
-
-                    if (info.useColourMapForLabel)
-                    {
-                        auto it = info.labelToIndex.find(labelId);
-                        if (it != info.labelToIndex.end() && info.labelCacheSize > 0)
-                        {
-                            int idx = (it->second + 1) * 255 / static_cast<int>(info.labelCacheSize);
-                            if (idx < 0)        packed = info.underColour;
-                            else if (idx > 255) packed = info.overColour;
-                            else                packed = info.mainLut[idx];
-                        }
-                        else
-                        {
-                            continue;  // unknown label
-                        }
-                    }
-                    else if (info.labelLUT)
-                    {
-                        auto it = info.labelLUT->find(labelId);
-                        if (it != info.labelLUT->end())
-                        {
-                            const LabelInfo& lbl = it->second;
-                            if (!lbl.visible)
-                                continue;
-                            packed = static_cast<uint32_t>(lbl.r) |
-                                     (static_cast<uint32_t>(lbl.g) << 8) |
-                                     (static_cast<uint32_t>(lbl.b) << 16) |
-                                     (static_cast<uint32_t>(lbl.a) << 24);
-                            if (lbl.a == 0)
-                                continue;
-                        }
-                        else
-                        {
-                            int gray = (labelId * 17) % 256;
-                            packed = static_cast<uint32_t>(gray) |
-                                     (static_cast<uint32_t>(gray) << 8) |
-                                     (static_cast<uint32_t>(gray) << 16) |
-                                     0xFF000000;
-                        }
-                    }
-                    else
-                    {
-                        int gray = (labelId * 17) % 256;
-                        packed = static_cast<uint32_t>(gray) |
-                                 (static_cast<uint32_t>(gray) << 8) |
-                                 (static_cast<uint32_t>(gray) << 16) |
-                                 0xFF000000;
-                    }
-                }
-                else if (displayVal < info.logRangeMin)
-                {
-                    if (info.underTransparent)
-                        continue;
-                    packed = info.underColour;
-                }
-                else if (displayVal > info.logRangeMax)
-                {
-                    if (info.overTransparent)
-                        continue;
-                    packed = info.overColour;
+                    // Label 0, unknown and invisible labels are transparent
+                    // and skipped below.
+                    packed = info.palette->colour(static_cast<int>(raw + 0.5f));
                 }
                 else
                 {
-                    int lutIdx = static_cast<int>(
-                        (displayVal - info.logRangeMin) * info.invSpan * 255.0f + 0.5f);
-                    if (lutIdx > 255)
-                        lutIdx = 255;
-                    packed = info.mainLut[lutIdx];
+                    // Transparent under/over clamps map to alpha 0 and are
+                    // skipped below.
+                    packed = info.transfer->map(raw);
                 }
 
-                } // end inBounds else
-
                 if ((packed >> 24) == 0)
                     continue;
 
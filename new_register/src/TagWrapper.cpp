@@ -1,6 +1,7 @@
 // TagWrapper.cpp - implementation of TagWrapper using minc2_simple API
 
 #include "TagWrapper.hpp"
+#include "Volume.h" // libmincMutex()
 
 // Include the minc2_simple header that declares the C API.
 extern "C" {
@@ -8,6 +9,7 @@ extern "C" {
 }
 
 #include <cstring> // for strdup if needed
+#include <mutex>
 #include <stdexcept> // for exceptions
 
 TagWrapper::TagWrapper() : tags_(nullptr), n_volumes_(0) {}
@@ -85,6 +87,8 @@ TagWrapper& TagWrapper::operator=(const TagWrapper& other) {
 void TagWrapper::load(const std::string& path) {
     clear();
 
+    std::lock_guard<std::mutex> mincLock(libmincMutex());
+
     // Allocate the tags structure (zeroed)
     tags_ = minc2_tags_allocate0();
     if (!tags_) {
@@ -142,6 +146,8 @@ void TagWrapper::save(const std::string& path) {
         throw std::runtime_error("No tags to save");
     }
 
+    std::lock_guard<std::mutex> mincLock(libmincMutex());
+
     if (!tags_) {
         tags_ = minc2_tags_allocate0();
         if (!tags_) {
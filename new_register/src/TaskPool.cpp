@@ -0,0 +1,91 @@
+#include "TaskPool.h"
+
+#include <algorithm>
+
+TaskPool::TaskPool(unsigned threads)
+    : threadCount_(threads > 0 ? threads
+                               : std::max(1u, std::thread::hardware_concurrency()) - 1)
+{
+}
+
+TaskPool::~TaskPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    workCv_.notify_all();
+    for (std::thread& t : threads_)
+        t.join();
+}
+
+void TaskPool::run(std::vector<Task>& tasks)
+{
+    if (tasks.empty())
+        return;
+    if (tasks.size() == 1 || threadCount_ == 0)
+    {
+        for (Task& task : tasks)
+            task();
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (threads_.empty())
+    {
+        for (unsigned i = 0; i < threadCount_; ++i)
+            threads_.emplace_back(&TaskPool::workerLoop, this);
+    }
+    batch_ = &tasks;
+    next_ = 0;
+    done_ = 0;
+    error_ = nullptr;
+    workCv_.notify_all();
+
+    // The calling thread takes tasks too, then waits for those still running
+    work(lock);
+    doneCv_.wait(lock, [&] { return done_ == tasks.size(); });
+    batch_ = nullptr;
+
+    if (error_)
+    {
+        std::exception_ptr error = error_;
+        error_ = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+void TaskPool::work(std::unique_lock<std::mutex>& lock)
+{
+    while (batch_ && next_ < batch_->size())
+    {
+        Task& task = (*batch_)[next_++];
+        lock.unlock();
+        std::exception_ptr error;
+        try
+        {
+            task();
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+        lock.lock();
+        if (error && !error_)
+            error_ = error;
+        if (++done_ == batch_->size())
+            doneCv_.notify_all();
+    }
+}
+
+void TaskPool::workerLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;)
+    {
+        workCv_.wait(lock, [this] { return stop_ || (batch_ && next_ < batch_->size()); });
+        if (stop_)
+            return;
+        work(lock);
+    }
+}
@@ -0,0 +1,382 @@
+#include "TextureAtlas.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+TextureAtlas::TextureAtlas(int pageSize, int maxPages, int gutter)
+    : pageSize_(pageSize), maxPages_(maxPages), gutter_(gutter)
+{
+}
+
+bool TextureAtlas::accepts(int w, int h) const
+{
+    int limit = pageSize_ / 2;
+    return w > 0 && h > 0 && w + 2 * gutter_ <= limit && h + 2 * gutter_ <= limit;
+}
+
+// ---------------------------------------------------------------------------
+// Shelf bookkeeping
+// ---------------------------------------------------------------------------
+
+bool TextureAtlas::findSpot(const Page& p, int pw, int ph,
+                            int& shelf, int& span, int& waste) const
+{
+    // Shelves no more than 50% taller than the allocation are a good fit;
+    // otherwise prefer opening a new shelf while the page has rows left.
+    const int goodWaste = ph / 2;
+    int bestShelf = -1, bestSpan = -1;
+    int bestWaste = std::numeric_limits<int>::max();
+    for (size_t s = 0; s < p.shelves.size(); ++s)
+    {
+        const Shelf& sh = p.shelves[s];
+        int w = sh.height - ph;
+        if (w < 0 || w >= bestWaste)
+            continue;
+        for (size_t i = 0; i < sh.free.size(); ++i)
+        {
+            if (sh.free[i].width >= pw)
+            {
+                bestShelf = static_cast<int>(s);
+                bestSpan = static_cast<int>(i);
+                bestWaste = w;
+                break;
+            }
+        }
+    }
+
+    if (bestShelf >= 0 && bestWaste <= goodWaste)
+    {
+        shelf = bestShelf;
+        span = bestSpan;
+        waste = bestWaste;
+        return true;
+    }
+    if (p.top + ph <= pageSize_ && pw <= pageSize_)
+    {
+        shelf = -1;
+        span = 0;
+        waste = 0;
+        return true;
+    }
+    if (bestShelf >= 0)
+    {
+        shelf = bestShelf;
+        span = bestSpan;
+        waste = bestWaste;
+        return true;
+    }
+    return false;
+}
+
+int TextureAtlas::place(Page& p, int shelf, int span, int pw, int ph, int& x, int& y) const
+{
+    if (shelf < 0)
+    {
+        Shelf sh;
+        sh.y = p.top;
+        sh.height = ph;
+        sh.free.push_back(Span{0, pageSize_});
+        p.shelves.push_back(std::move(sh));
+        p.top += ph;
+        shelf = static_cast<int>(p.shelves.size()) - 1;
+        span = 0;
+    }
+
+    Shelf& sh = p.shelves[shelf];
+    Span& s = sh.free[span];
+    x = s.x;
+    y = sh.y;
+    s.x += pw;
+    s.width -= pw;
+    if (s.width == 0)
+        sh.free.erase(sh.free.begin() + span);
+
+    ++sh.live;
+    ++p.live;
+    p.usedArea += static_cast<int64_t>(pw) * ph;
+    return shelf;
+}
+
+void TextureAtlas::unplace(Page& p, int shelf, int x, int pw, int ph) const
+{
+    Shelf& sh = p.shelves[shelf];
+    --sh.live;
+    --p.live;
+    p.usedArea -= static_cast<int64_t>(pw) * ph;
+
+    if (sh.live == 0)
+    {
+        sh.free.assign(1, Span{0, pageSize_});
+        // Empty shelves at the bottom go back to the page, so a later
+        // allocation of another height can use the rows.
+        while (!p.shelves.empty() && p.shelves.back().live == 0)
+        {
+            p.top = p.shelves.back().y;
+            p.shelves.pop_back();
+        }
+        return;
+    }
+
+    auto it = std::lower_bound(sh.free.begin(), sh.free.end(), x,
+        [](const Span& s, int v) { return s.x < v; });
+    it = sh.free.insert(it, Span{x, pw});
+    // Merge with the following and preceding spans
+    auto next = it + 1;
+    if (next != sh.free.end() && it->x + it->width == next->x)
+    {
+        it->width += next->width;
+        sh.free.erase(next);
+    }
+    if (it != sh.free.begin())
+    {
+        auto prev = it - 1;
+        if (prev->x + prev->width == it->x)
+        {
+            prev->width += it->width;
+            sh.free.erase(it);
+        }
+    }
+}
+
+bool TextureAtlas::packs(const std::vector<std::pair<int, int>>& sizes) const
+{
+    Page tmp;
+    tmp.open = true;
+    for (const auto& wh : sizes)
+    {
+        int shelf, span, waste, x, y;
+        if (!findSpot(tmp, wh.first, wh.second, shelf, span, waste))
+            return false;
+        place(tmp, shelf, span, wh.first, wh.second, x, y);
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Allocations
+// ---------------------------------------------------------------------------
+
+TextureAtlas::Handle TextureAtlas::newHandle()
+{
+    if (!freeHandles_.empty())
+    {
+        Handle h = freeHandles_.back();
+        freeHandles_.pop_back();
+        return h;
+    }
+    entries_.emplace_back();
+    return static_cast<Handle>(entries_.size());
+}
+
+TextureAtlas::Handle TextureAtlas::allocate(int w, int h)
+{
+    if (!accepts(w, h))
+        return 0;
+
+    const int pw = w + 2 * gutter_;
+    const int ph = h + 2 * gutter_;
+
+    // First page with a good fit wins; otherwise the least wasteful spot.
+    int bestPage = -1, bestShelf = -1, bestSpan = -1;
+    int bestWaste = std::numeric_limits<int>::max();
+    for (size_t i = 0; i < pages_.size(); ++i)
+    {
+        if (!pages_[i].open)
+            continue;
+        int shelf, span, waste;
+        if (!findSpot(pages_[i], pw, ph, shelf, span, waste) || waste >= bestWaste)
+            continue;
+        bestPage = static_cast<int>(i);
+        bestShelf = shelf;
+        bestSpan = span;
+        bestWaste = waste;
+        if (waste <= ph / 2)
+            break;
+    }
+    if (bestPage < 0)
+        return 0;
+
+    int x, y;
+    int shelf = place(pages_[bestPage], bestShelf, bestSpan, pw, ph, x, y);
+
+    Handle handle = newHandle();
+    Entry& e = entries_[handle - 1];
+    e.region = AtlasRegion{bestPage, x + gutter_, y + gutter_, w, h};
+    e.shelf = shelf;
+    e.live = true;
+    return handle;
+}
+
+void TextureAtlas::release(Handle handle)
+{
+    if (handle == 0 || handle > entries_.size() || !entries_[handle - 1].live)
+        return;
+    Entry& e = entries_[handle - 1];
+    unplace(pages_[e.region.page], e.shelf, e.region.x - gutter_,
+            e.region.width + 2 * gutter_, e.region.height + 2 * gutter_);
+    e = Entry{};
+    freeHandles_.push_back(handle);
+}
+
+const AtlasRegion& TextureAtlas::region(Handle handle) const
+{
+    if (handle == 0 || handle > entries_.size() || !entries_[handle - 1].live)
+        throw std::out_of_range("TextureAtlas::region: invalid handle");
+    return entries_[handle - 1].region;
+}
+
+AtlasRegion TextureAtlas::paddedRegion(Handle handle) const
+{
+    AtlasRegion r = region(handle);
+    r.x -= gutter_;
+    r.y -= gutter_;
+    r.width += 2 * gutter_;
+    r.height += 2 * gutter_;
+    return r;
+}
+
+// ---------------------------------------------------------------------------
+// Pages
+// ---------------------------------------------------------------------------
+
+int TextureAtlas::addPage()
+{
+    int open = 0;
+    for (const Page& p : pages_)
+        open += p.open ? 1 : 0;
+    if (open >= maxPages_)
+        return -1;
+
+    for (size_t i = 0; i < pages_.size(); ++i)
+    {
+        if (!pages_[i].open)
+        {
+            pages_[i] = Page{};
+            pages_[i].open = true;
+            return static_cast<int>(i);
+        }
+    }
+    pages_.emplace_back();
+    pages_.back().open = true;
+    return static_cast<int>(pages_.size()) - 1;
+}
+
+bool TextureAtlas::pageOpen(int page) const
+{
+    return page >= 0 && page < pageSlots() && pages_[page].open;
+}
+
+int TextureAtlas::pageAllocations(int page) const
+{
+    return pageOpen(page) ? pages_[page].live : 0;
+}
+
+double TextureAtlas::pageOccupancy(int page) const
+{
+    if (!pageOpen(page))
+        return 0.0;
+    return static_cast<double>(pages_[page].usedArea) /
+           (static_cast<double>(pageSize_) * pageSize_);
+}
+
+// ---------------------------------------------------------------------------
+// Compaction
+// ---------------------------------------------------------------------------
+
+namespace {
+
+/// Order for repacking: tallest first, then widest, so shelves fill evenly.
+bool tallerFirst(const std::pair<int, int>& a, const std::pair<int, int>& b)
+{
+    return a.second != b.second ? a.second > b.second : a.first > b.first;
+}
+
+} // namespace
+
+int TextureAtlas::compactionCandidate(int w, int h) const
+{
+    if (!accepts(w, h))
+        return -1;
+
+    int best = -1;
+    double bestOccupancy = 2.0;
+    for (int i = 0; i < pageSlots(); ++i)
+    {
+        if (!pages_[i].open || pages_[i].live == 0)
+            continue;
+        double occ = pageOccupancy(i);
+        if (occ >= bestOccupancy)
+            continue;
+
+        std::vector<std::pair<int, int>> sizes;
+        sizes.emplace_back(w + 2 * gutter_, h + 2 * gutter_);
+        for (const Entry& e : entries_)
+            if (e.live && e.region.page == i)
+                sizes.emplace_back(e.region.width + 2 * gutter_,
+                                   e.region.height + 2 * gutter_);
+        std::sort(sizes.begin(), sizes.end(), tallerFirst);
+        if (packs(sizes))
+        {
+            best = i;
+            bestOccupancy = occ;
+        }
+    }
+    return best;
+}
+
+std::vector<TextureAtlas::Move> TextureAtlas::compact(int page)
+{
+    std::vector<Move> moves;
+    if (!pageOpen(page))
+        return moves;
+
+    std::vector<Handle> handles;
+    std::vector<std::pair<int, int>> sizes;
+    for (size_t i = 0; i < entries_.size(); ++i)
+    {
+        const Entry& e = entries_[i];
+        if (e.live && e.region.page == page)
+        {
+            handles.push_back(static_cast<Handle>(i + 1));
+            sizes.emplace_back(e.region.width + 2 * gutter_,
+                               e.region.height + 2 * gutter_);
+        }
+    }
+    std::sort(handles.begin(), handles.end(), [this](Handle a, Handle b) {
+        const AtlasRegion& ra = entries_[a - 1].region;
+        const AtlasRegion& rb = entries_[b - 1].region;
+        return tallerFirst({ra.width, ra.height}, {rb.width, rb.height});
+    });
+    std::sort(sizes.begin(), sizes.end(), tallerFirst);
+    if (!packs(sizes))
+        return moves;
+
+    int target = addPage();
+    if (target < 0)
+        return moves;
+
+    Page& dst = pages_[target];
+    for (Handle handle : handles)
+    {
+        Entry& e = entries_[handle - 1];
+        int pw = e.region.width + 2 * gutter_;
+        int ph = e.region.height + 2 * gutter_;
+        int shelf, span, waste, x, y;
+        findSpot(dst, pw, ph, shelf, span, waste);
+        shelf = place(dst, shelf, span, pw, ph, x, y);
+
+        Move m;
+        m.handle = handle;
+        m.from = e.region;
+        e.region.page = target;
+        e.region.x = x + gutter_;
+        e.region.y = y + gutter_;
+        e.shelf = shelf;
+        m.to = e.region;
+        moves.push_back(m);
+    }
+
+    pages_[page] = Page{};
+    return moves;
+}
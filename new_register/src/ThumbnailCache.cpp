@@ -0,0 +1,406 @@
+#include "ThumbnailCache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include <sys/stat.h>
+
+#include "DiskCache.h"
+#include "SliceCache.h"
+#include "Volume.h"
+
+namespace {
+
+/// Cache file: this magic, the thumbnail size and the entry count, then
+/// per entry the path, request hash, file time and size, and the pixels.
+/// Native byte order: the file is a cache of this machine only.
+constexpr char kMagic[8] = {'N', 'R', 'T', 'H', 'U', 'M', 'B', '1'};
+
+/// Modification time and size of @p path; false if it cannot be read.
+bool fileStamp(const std::string& path, int64_t& time, uint64_t& size)
+{
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0)
+        return false;
+    time = static_cast<int64_t>(st.st_mtime);
+    size = static_cast<uint64_t>(st.st_size);
+    return true;
+}
+
+/// Bounds-checked reads from the cache file.
+struct Reader
+{
+    const uint8_t* p;
+    size_t left;
+
+    bool read(void* out, size_t n)
+    {
+        if (n > left)
+            return false;
+        std::memcpy(out, p, n);
+        p += n;
+        left -= n;
+        return true;
+    }
+
+    template <typename T>
+    bool read(T& value) { return read(&value, sizeof(value)); }
+};
+
+template <typename T>
+void append(std::vector<uint8_t>& out, const T& value)
+{
+    const uint8_t* b = reinterpret_cast<const uint8_t*>(&value);
+    out.insert(out.end(), b, b + sizeof(value));
+}
+
+} // namespace
+
+ThumbnailCache::ThumbnailCache(LoadFn load, int size)
+    : load_(std::move(load)), size_(std::max(1, size))
+{
+}
+
+ThumbnailCache::~ThumbnailCache()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+        queue_.clear();
+    }
+    workCv_.notify_all();
+    if (worker_.joinable())
+        worker_.join();
+}
+
+bool ThumbnailCache::open(const std::string& path)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cachePath_ = path;
+    }
+
+    std::vector<uint8_t> data;
+    if (!readCacheFile(path, data))
+        return false;
+
+    Reader in{data.data(), data.size()};
+    char magic[sizeof(kMagic)];
+    uint32_t size = 0, count = 0;
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0 ||
+        !in.read(size) || size != static_cast<uint32_t>(size_) || !in.read(count))
+        return false;
+
+    std::unordered_map<std::string, Entry> loaded;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        uint32_t pathLen = 0, w = 0, h = 0;
+        Entry e;
+        if (!in.read(pathLen) || pathLen > in.left)
+            return false;
+        std::string volumePath(pathLen, '\0');
+        in.read(&volumePath[0], pathLen);
+        if (!in.read(e.hash) || !in.read(e.fileTime) || !in.read(e.fileSize) ||
+            !in.read(w) || !in.read(h) || w == 0 || h == 0 ||
+            w > size || h > size)
+            return false;
+        auto t = std::make_shared<Thumbnail>();
+        t->width = static_cast<int>(w);
+        t->height = static_cast<int>(h);
+        t->pixels.resize(static_cast<size_t>(w) * h);
+        if (!in.read(t->pixels.data(), t->pixels.size() * sizeof(uint32_t)))
+            return false;
+        e.thumbnail = std::move(t);
+        loaded[std::move(volumePath)] = std::move(e);
+    }
+
+    // Thumbnails rendered in the meantime are newer
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& kv : loaded)
+    {
+        if (entries_.emplace(kv.first, std::move(kv.second)).second)
+            ++stats_.fromFile;
+    }
+    return true;
+}
+
+bool ThumbnailCache::save()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (cachePath_.empty() || unsaved_ == 0)
+            return true;
+    }
+    return writeFile();
+}
+
+bool ThumbnailCache::writeFile()
+{
+    std::lock_guard<std::mutex> saveLock(saveMutex_);
+    std::vector<uint8_t> data;
+    std::string path;
+    int unsaved = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        data = serialize();
+        path = cachePath_;
+        unsaved = unsaved_;
+        unsaved_ = 0;
+    }
+    if (writeCacheFile(path, data))
+        return true;
+    // Try again on the next save
+    std::lock_guard<std::mutex> lock(mutex_);
+    unsaved_ += unsaved;
+    return false;
+}
+
+std::vector<uint8_t> ThumbnailCache::serialize() const
+{
+    std::vector<uint8_t> out(kMagic, kMagic + sizeof(kMagic));
+    append(out, static_cast<uint32_t>(size_));
+    size_t countAt = out.size();
+    append(out, uint32_t(0));
+
+    uint32_t count = 0;
+    for (const auto& kv : entries_)
+    {
+        const Entry& e = kv.second;
+        // Failures are retried next session
+        if (e.thumbnail->width == 0)
+            continue;
+        append(out, static_cast<uint32_t>(kv.first.size()));
+        out.insert(out.end(), kv.first.begin(), kv.first.end());
+        append(out, e.hash);
+        append(out, e.fileTime);
+        append(out, e.fileSize);
+        append(out, static_cast<uint32_t>(e.thumbnail->width));
+        append(out, static_cast<uint32_t>(e.thumbnail->height));
+        const uint8_t* px = reinterpret_cast<const uint8_t*>(e.thumbnail->pixels.data());
+        out.insert(out.end(), px, px + e.thumbnail->pixels.size() * sizeof(uint32_t));
+        ++count;
+    }
+    std::memcpy(out.data() + countAt, &count, sizeof(count));
+    return out;
+}
+
+void ThumbnailCache::request(const std::vector<Request>& requests)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.clear();
+        for (const Request& r : requests)
+        {
+            if (r.path.empty())
+                continue;
+            auto it = entries_.find(r.path);
+            if (it == entries_.end() || !current(it->second, r))
+                queue_.push_back(r);
+        }
+        if (queue_.empty())
+            return;
+        if (!worker_.joinable())
+            worker_ = std::thread(&ThumbnailCache::run, this);
+    }
+    workCv_.notify_one();
+}
+
+ThumbnailCache::ThumbnailPtr ThumbnailCache::find(const Request& request) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(request.path);
+    if (it == entries_.end() || !current(it->second, request))
+        return nullptr;
+    return it->second.thumbnail;
+}
+
+bool ThumbnailCache::current(const Entry& e, const Request& r) const
+{
+    return e.checked && e.hash == requestHash(r);
+}
+
+void ThumbnailCache::setNotify(std::function<void()> notify)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    notify_ = std::move(notify);
+}
+
+void ThumbnailCache::notify()
+{
+    std::function<void()> fn;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        fn = notify_;
+    }
+    if (fn)
+        fn();
+}
+
+ThumbnailCache::Stats ThumbnailCache::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+uint64_t ThumbnailCache::requestHash(const Request& request)
+{
+    VolumeRenderParams params = request.params;
+    if (request.autoRange)
+    {
+        params.valueMin = 0.0;
+        params.valueMax = 0.0;
+    }
+    // The content version slot distinguishes the automatic range
+    return sliceParamsHash(params, request.autoRange ? 1 : 0);
+}
+
+// ---------------------------------------------------------------------------
+// Rendering
+// ---------------------------------------------------------------------------
+
+ThumbnailCache::Thumbnail ThumbnailCache::render(const Volume& vol, const Request& request,
+                                                 int size)
+{
+    if (vol.data.empty())
+        return Thumbnail{};
+
+    VolumeRenderParams params = request.params;
+    if (request.autoRange)
+    {
+        params.valueMin = vol.min_value;
+        params.valueMax = vol.max_value;
+    }
+    ColourTransfer transfer = buildColourTransfer(params);
+    RenderedSlice slice = renderSlice(vol, transfer, 0, vol.dimensions.z / 2);
+    return downsample(slice, vol.slicePixelAspect(0, 1), size);
+}
+
+ThumbnailCache::Thumbnail ThumbnailCache::downsample(const RenderedSlice& slice, double aspect,
+                                                     int size)
+{
+    Thumbnail t;
+    if (slice.width <= 0 || slice.height <= 0 || !(aspect > 0.0))
+        return t;
+
+    const double physW = slice.width * aspect;
+    const double physH = slice.height;
+    const double scale = std::min(1.0, size / std::max(physW, physH));
+    t.width = std::clamp(static_cast<int>(std::lround(physW * scale)), 1, size);
+    t.height = std::clamp(static_cast<int>(std::lround(physH * scale)), 1, size);
+    t.pixels.resize(static_cast<size_t>(t.width) * t.height);
+
+    // Source span of output column/row i: [i*n/m, (i+1)*n/m), at least one
+    auto span = [](int i, int n, int m, int& first, int& last) {
+        first = static_cast<int>(static_cast<int64_t>(i) * n / m);
+        last = std::max(first + 1, static_cast<int>(static_cast<int64_t>(i + 1) * n / m));
+    };
+    std::vector<int> x0(t.width), x1(t.width);
+    for (int ox = 0; ox < t.width; ++ox)
+        span(ox, slice.width, t.width, x0[ox], x1[ox]);
+
+    for (int oy = 0; oy < t.height; ++oy)
+    {
+        int y0, y1;
+        span(oy, slice.height, t.height, y0, y1);
+        for (int ox = 0; ox < t.width; ++ox)
+        {
+            uint32_t sum[4] = {0, 0, 0, 0};
+            for (int y = y0; y < y1; ++y)
+            {
+                const uint32_t* row = slice.pixels.data() + static_cast<size_t>(y) * slice.width;
+                for (int x = x0[ox]; x < x1[ox]; ++x)
+                {
+                    uint32_t p = row[x];
+                    for (int c = 0; c < 4; ++c)
+                        sum[c] += (p >> (8 * c)) & 0xFF;
+                }
+            }
+            uint32_t n = static_cast<uint32_t>((y1 - y0) * (x1[ox] - x0[ox]));
+            uint32_t out = 0;
+            for (int c = 0; c < 4; ++c)
+                out |= ((sum[c] + n / 2) / n) << (8 * c);
+            t.pixels[static_cast<size_t>(oy) * t.width + ox] = out;
+        }
+    }
+    return t;
+}
+
+// ---------------------------------------------------------------------------
+// Worker
+// ---------------------------------------------------------------------------
+
+void ThumbnailCache::run()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;)
+    {
+        workCv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+        if (stop_)
+            return;
+
+        Request r = std::move(queue_.front());
+        queue_.pop_front();
+        const uint64_t hash = requestHash(r);
+        auto it = entries_.find(r.path);
+        bool fromFile = it != entries_.end() && it->second.hash == hash;
+        if (fromFile && it->second.checked)
+            continue;
+        int64_t expectTime = fromFile ? it->second.fileTime : 0;
+        uint64_t expectSize = fromFile ? it->second.fileSize : 0;
+        lock.unlock();
+
+        // An entry from the cache file is current if the volume is unchanged
+        int64_t fileTime = 0;
+        uint64_t fileSize = 0;
+        bool stamped = fileStamp(r.path, fileTime, fileSize);
+        if (fromFile && stamped && fileTime == expectTime && fileSize == expectSize)
+        {
+            lock.lock();
+            it = entries_.find(r.path);
+            if (it != entries_.end())
+                it->second.checked = true;
+            lock.unlock();
+            notify();
+            lock.lock();
+            continue;
+        }
+
+        Thumbnail t;
+        if (stamped)
+        {
+            try
+            {
+                t = render(load_(r.path), r, size_);
+            }
+            catch (const std::exception&)
+            {
+                t = Thumbnail{};
+            }
+        }
+
+        lock.lock();
+        Entry& e = entries_[r.path];
+        e.thumbnail = std::make_shared<const Thumbnail>(std::move(t));
+        e.hash = hash;
+        e.fileTime = fileTime;
+        e.fileSize = fileSize;
+        e.checked = true;
+        bool saveNow = false;
+        if (e.thumbnail->width > 0)
+        {
+            ++stats_.rendered;
+            saveNow = !cachePath_.empty() && ++unsaved_ >= kSaveEvery;
+        }
+        else
+        {
+            ++stats_.failed;
+        }
+        lock.unlock();
+
+        if (saveNow)
+            writeFile();
+        notify();
+        lock.lock();
+    }
+}
@@ -10,6 +10,7 @@
 //   - Levenberg-Marquardt: Moré (1978), Eigen unsupported module
 
 #include "Transform.h"
+#include "Volume.h" // libmincMutex()
 
 #include <algorithm>
 #include <cmath>
@@ -18,6 +19,7 @@
 #include <functional>
 #include <iostream>
 #include <limits>
+#include <mutex>
 #include <numeric>
 #include <sstream>
 #include <stdexcept>
@@ -1057,6 +1059,7 @@ bool writeXfmFile(const std::string& path, const TransformResult& result)
         return out.good();
     }
 
+    std::lock_guard<std::mutex> mincLock(libmincMutex());
     minc2_xfm_file_handle xfm = minc2_xfm_allocate0();
     if (!xfm)
         return false;
@@ -1084,6 +1087,7 @@ bool writeXfmFile(const std::string& path, const TransformResult& result)
 
 bool readXfmFile(const std::string& path, glm::dmat4& matrix)
 {
+    std::lock_guard<std::mutex> mincLock(libmincMutex());
     minc2_xfm_file_handle xfm = minc2_xfm_allocate0();
     if (!xfm)
         return false;
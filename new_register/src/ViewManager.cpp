@@ -9,241 +9,308 @@
 #include "Transform.h"
 #include "Volume.h"
 
+namespace {
+
+static_assert(ColourTransfer::kOverSlot + 1 == kVolumeSliceSlots,
+              "GPU colour slots must mirror ColourTransfer::slots");
+
+/// GPU layer sampling @p vt with the colours of @p transfer (geometry and
+/// alpha are filled in by the caller).
+VolumeSliceLayer sliceLayer(const VolumeTexture& vt, const ColourTransfer& transfer) {
+    VolumeSliceLayer layer;
+    layer.volume = &vt;
+    layer.slots = transfer.slots.data();
+    layer.rangeMin = transfer.rangeMin;
+    layer.rangeMax = transfer.rangeMax;
+    layer.invSpan = transfer.invSpan;
+    layer.useLog = transfer.useLog;
+    return layer;
+}
+
+void setVec3(float out[3], const glm::dvec3& v) {
+    out[0] = static_cast<float>(v.x);
+    out[1] = static_cast<float>(v.y);
+    out[2] = static_cast<float>(v.z);
+}
+
+/// One volume blended into the overlay, precomputed per update:
+///   combined = vol.worldToVoxel * ref.voxelToWorld  (ref-voxel -> target-voxel)
+///   LUT pointer, range params, under/over colours, overlay alpha
+///
+/// When a valid tag-based transform exists for volume 1 (the second volume),
+/// the transform is inserted into the chain:
+///   Linear: combined = vol1.worldToVoxel * T^{-1} * ref.voxelToWorld
+///   TPS:    per-pixel world-space inversion (no scanline optimization)
+struct OverlayLayer {
+    glm::dmat4 combined;         // ref-voxel -> target-voxel transform
+    const float* vdata;          // pointer to volume data
+    glm::ivec3 dims;             // target volume dimensions
+    int dimXY;                   // dims.x * dims.y
+    const ColourTransfer* transfer;  // range/log/invert/clamp tables
+    float alpha;
+    bool useTPSInverse = false;  // true if TPS per-pixel inversion needed
+    glm::dmat4 targetWorldToVox; // for TPS path: target vol worldToVoxel
+    bool isLabelVolume = false;  // true if this is a label/segmentation volume
+    const LabelPalette* palette = nullptr;  // dense label id -> colour
+    int volumeIndex = 0;
+};
+
+/// Scanline parameters of one overlay layer (unused for TPS layers).
+struct OverlayScan {
+    glm::dvec3 base;   // target-voxel at (px=0, py=0)
+    glm::dvec3 dpx;    // target-voxel delta per px++
+    glm::dvec3 dpy;    // target-voxel delta per py++
+};
+
+} // namespace
+
 ViewManager::ViewManager(AppState& state, GraphicsBackend& backend)
     : state_(state), backend_(backend) {}
 
-void ViewManager::updateSliceTexture(int volumeIndex, int viewIndex) {
-    if (volumeIndex < 0 ||
-        volumeIndex >= state_.volumeCount())
-        return;
-    if (volumeIndex >= static_cast<int>(state_.viewStates_.size()))
-        return;
+ViewManager::~ViewManager() = default;
 
-    const Volume& vol = state_.volumes_[volumeIndex];
-    if (vol.data.empty())
-        return;
+struct ViewManager::SliceUpdate {
+    int volumeIndex = 0;
+    int viewIndex = 0;
+    SliceKey key;
+    SliceCache::SlicePtr slice;   ///< null until rendered
 
-    VolumeViewState& state = state_.viewStates_[volumeIndex];
+    /// renderSlice() inputs, for a slice that was not cached
+    const Volume* volume = nullptr;
+    const ColourTransfer* transfer = nullptr;
+    const LabelPalette* palette = nullptr;
+    RenderedSlice rendered;
 
-    // Hoist LUT pointers and colour count outside the pixel loop
-    // Use inverted LUT if invert flag is enabled
-    const ColourLut& baseLut = colourMapLut(state.colourMap);
-    ColourLut invertedLut;
-    const uint32_t* mainLut;
-    
-    if (state.invertColourMap)
-    {
-        invertedLut = invertColourLut(baseLut);
-        mainLut = invertedLut.table.data();
-    }
-    else
-    {
-        mainLut = baseLut.table.data();
+    void render() {
+        rendered = renderSlice(*volume, *transfer, palette, viewIndex, key.slice);
     }
-    
-    int numMaps = colourMapCount();
+};
+
+struct ViewManager::OverlayUpdate {
+    int viewIndex = 0;
+    int width = 0;
+    int height = 0;
+    std::vector<OverlayLayer> layers;
+    std::vector<OverlayScan> scans;
+
+    /// TPS warp of volume 1, with the ref-voxel -> world scanline
+    /// parameters of the TPS per-pixel path
+    const TransformResult* transform = nullptr;
+    glm::dvec3 worldBase{0.0};
+    glm::dvec3 worldDpx{0.0};
+    glm::dvec3 worldDpy{0.0};
+
+    uint32_t* pixels = nullptr;   ///< width * height, bottom row first
+
+    /// Blend rows [rowBegin, rowEnd).  Only reads shared state, so bands
+    /// can be blended in parallel.
+    void blendRows(int rowBegin, int rowEnd) const;
+};
+
+void ViewManager::OverlayUpdate::blendRows(int rowBegin, int rowEnd) const {
+    const int w = width;
+    for (int py = rowBegin; py < rowEnd; ++py) {
+        int dstRowOff = (height - 1 - py) * w;
 
-    int w, h;
+        for (int px = 0; px < w; ++px) {
+            float accR = 0.0f, accG = 0.0f, accB = 0.0f;
+            float totalWeight = 0.0f;
 
-    int dimX = vol.dimensions.x;
-    int dimY = vol.dimensions.y;
-    int dimZ = vol.dimensions.z;
+            for (size_t vi = 0; vi < layers.size(); ++vi) {
+                const auto& info = layers[vi];
 
-    float rangeMin = static_cast<float>(state.valueRange[0]);
-    float rangeMax = static_cast<float>(state.valueRange[1]);
+                glm::dvec3 tv;
+                if (info.useTPSInverse)
+                {
+                    // TPS per-pixel path: ref-voxel -> world -> TPS inverse -> target-world -> target-voxel
+                    glm::dvec3 worldPt = worldBase + static_cast<double>(px) * worldDpx
+                                                   + static_cast<double>(py) * worldDpy;
+                    glm::dvec3 vol1World = transform->inverseTransformPoint(worldPt);
+                    glm::dvec4 vox = info.targetWorldToVox * glm::dvec4(vol1World, 1.0);
+                    tv = glm::dvec3(vox);
+                }
+                else
+                {
+                    // Scanline-optimized path (linear or identity)
+                    const auto& sc = scans[vi];
+                    tv = sc.base + static_cast<double>(px) * sc.dpx
+                                 + static_cast<double>(py) * sc.dpy;
+                }
 
-    // Log-transform the range if log transform is enabled
-    float logRangeMin = rangeMin;
-    float logRangeMax = rangeMax;
-    
-    if (state.useLogTransform)
-    {
-        // Prevent crash when rangeMin <= 0.0 (log10 undefined for non-positive values)
-        // Set lower threshold to -10 (corresponds to log10(1e-10))
-        float logLowerThreshold = -10.0f;
-        if (rangeMin <= 0.0f)
-            logRangeMin = logLowerThreshold;
-        else
-            logRangeMin = std::log10(rangeMin);
-        
-        if (rangeMax <= 0.0f)
-            logRangeMax = logLowerThreshold;
-        else
-            logRangeMax = std::log10(rangeMax);
-    }
-
-    float rangeSpan = logRangeMax - logRangeMin;
-    if (rangeSpan < 1e-12f)
-        rangeSpan = 1e-12f;
-    float invSpan = 1.0f / rangeSpan;
-
-    // Pre-resolve under/over LUT pointers to avoid per-pixel lookups
-    int underMode = state.underColourMode;
-    bool underTransparent = (underMode == kClampTransparent);
-    uint32_t underColour = underTransparent ? 0x00000000
-        : resolveClampColour(underMode, state.colourMap, false, state.invertColourMap);
-
-    int overMode = state.overColourMode;
-    bool overTransparent = (overMode == kClampTransparent);
-    uint32_t overColour = overTransparent ? 0x00000000
-        : resolveClampColour(overMode, state.colourMap, true, state.invertColourMap);
-
-    // For label volumes: check if we should use colour map instead of label LUT
-    bool useColourMapForLabel = vol.isLabelVolume();
-    const std::unordered_map<int, int>* labelToIndexPtr = nullptr;
-    size_t labelCount = 0;
-    if (useColourMapForLabel) {
-        auto cacheIt = labelToIndexCache_.find(volumeIndex);
-        if (cacheIt == labelToIndexCache_.end()) {
-            std::vector<int> uniqueLabels = vol.getUniqueLabelIds();
-            std::unordered_map<int, int> mapping;
-            for (size_t i = 0; i < uniqueLabels.size(); ++i) {
-                mapping[uniqueLabels[i]] = static_cast<int>(i);
-            }
-            labelCount = uniqueLabels.size();
-            labelToIndexCache_[volumeIndex] = std::move(mapping);
-            labelCacheSize_[volumeIndex] = labelCount;
-            cacheIt = labelToIndexCache_.find(volumeIndex);
-        } else {
-            labelCount = labelCacheSize_[volumeIndex];
-        }
-        labelToIndexPtr = &cacheIt->second;
-    }
+                int tx = static_cast<int>(std::round(tv.x));
+                int ty = static_cast<int>(std::round(tv.y));
+                int tz = static_cast<int>(std::round(tv.z));
 
-    auto voxelToColour = [&](float val) -> uint32_t {
-        float displayVal = val;
+                // Bounds check
+                if (tx < 0 || tx >= info.dims.x ||
+                    ty < 0 || ty >= info.dims.y ||
+                    tz < 0 || tz >= info.dims.z)
+                    continue;
 
-        // Apply log transform if enabled
-        if (state.useLogTransform)
-        {
-            // Values <= 0 use under-colour setting
-            if (val <= 0.0f)
-            {
-                if (underTransparent)
-                    return 0x00000000;
-                return underColour;
-            }
-            displayVal = std::log10(val);
-        }
+                float raw = info.vdata[tz * info.dimXY + ty * info.dims.x + tx];
 
-        // Handle label volumes: use colour map if selected, otherwise use label LUT
-        if (vol.isLabelVolume()) {
-            int labelId = static_cast<int>(displayVal + 0.5f);
-            if (labelId == 0) {
-                return 0x00000000;  // transparent background
-            }
-            // Use colour map if a non-default one is selected
-            if (useColourMapForLabel && labelToIndexPtr) {
-                auto it = labelToIndexPtr->find(labelId);
-                if (it != labelToIndexPtr->end()) {
-                    int idx = (it->second + 1) * 255 / static_cast<int>(labelCount);
-                    if (idx < 0)   return underColour;
-                    if (idx > 255) return overColour;
-                    return mainLut[idx];
-                }
-                return 0x00000000;  // unknown label
-            }
-            // Default: use label LUT
-            const auto& labelLUT = vol.getLabelLUT();
-            auto it = labelLUT.find(labelId);
-            if (it != labelLUT.end()) {
-                const LabelInfo& info = it->second;
-                if (!info.visible) {
-                    return 0x00000000;  // invisible label
+                uint32_t packed;
+                if (info.isLabelVolume) {
+                    // Label 0, unknown and invisible labels are transparent
+                    // and skipped below.
+                    packed = info.palette->colour(static_cast<int>(raw + 0.5f));
+                } else {
+                    // Transparent under/over clamps map to alpha 0 and are
+                    // skipped below.
+                    packed = info.transfer->map(raw);
                 }
-                // Pack RGBA: R in bits 0-7, G in 8-15, B in 16-23, A in 24-31
-                return static_cast<uint32_t>(info.r) |
-                       (static_cast<uint32_t>(info.g) << 8) |
-                       (static_cast<uint32_t>(info.b) << 16) |
-                       (static_cast<uint32_t>(info.a) << 24);
-            }
-            // Label not in LUT: use grayscale based on label ID
-            int gray = (labelId * 17) % 256;
-            return static_cast<uint32_t>(gray) |
-                   (static_cast<uint32_t>(gray) << 8) |
-                   (static_cast<uint32_t>(gray) << 16) |
-                   0xFF000000;  // fully opaque
-        }
 
-        // Regular volume: use colour map
-        if (displayVal < logRangeMin)
-            return underTransparent ? 0x00000000 : underColour;
-        if (displayVal > logRangeMax)
-            return overTransparent ? 0x00000000 : overColour;
-        int idx = static_cast<int>((displayVal - logRangeMin) * invSpan * 255.0f + 0.5f);
-        if (idx > 255)
-            idx = 255;
-        return mainLut[idx];
-    };
+                if ((packed >> 24) == 0)
+                    continue;
 
-    // Direct pointer to volume data for unchecked linear indexing
-    const float* vdata = vol.data.data();
+                float srcR = static_cast<float>((packed >> 0) & 0xFF) * (1.0f / 255.0f);
+                float srcG = static_cast<float>((packed >> 8) & 0xFF) * (1.0f / 255.0f);
+                float srcB = static_cast<float>((packed >> 16) & 0xFF) * (1.0f / 255.0f);
 
-    if (viewIndex == 0) {
-        w = dimX;
-        h = dimY;
-        int z = std::clamp(state.sliceIndices.z, 0, dimZ - 1);
-
-        pixelBuf_.resize(w * h);
-        int zOff = z * dimY * dimX;
-        for (int y = 0; y < h; ++y) {
-            int rowOff = zOff + y * dimX;
-            int dstOff = (h - 1 - y) * w;
-            for (int x = 0; x < w; ++x) {
-                pixelBuf_[dstOff + x] = voxelToColour(vdata[rowOff + x]);
-            }
-        }
-    } else if (viewIndex == 1) {
-        w = dimY;
-        h = dimZ;
-        int x = std::clamp(state.sliceIndices.x, 0, dimX - 1);
-
-        pixelBuf_.resize(w * h);
-        for (int z = 0; z < h; ++z) {
-            int zOff = z * dimY * dimX + x;
-            int dstOff = (h - 1 - z) * w;
-            for (int y = 0; y < w; ++y) {
-                pixelBuf_[dstOff + y] = voxelToColour(vdata[zOff + y * dimX]);
+                accR += srcR * info.alpha;
+                accG += srcG * info.alpha;
+                accB += srcB * info.alpha;
+                totalWeight += info.alpha;
             }
-        }
-    } else {
-        w = dimX;
-        h = dimZ;
-        int y = std::clamp(state.sliceIndices.y, 0, dimY - 1);
-
-        pixelBuf_.resize(w * h);
-        int yOff = y * dimX;
-        for (int z = 0; z < h; ++z) {
-            int zOff = z * dimY * dimX + yOff;
-            int dstOff = (h - 1 - z) * w;
-            for (int x = 0; x < w; ++x) {
-                pixelBuf_[dstOff + x] = voxelToColour(vdata[zOff + x]);
+
+            if (totalWeight > 0.0f) {
+                float inv = 1.0f / totalWeight;
+                accR *= inv;
+                accG *= inv;
+                accB *= inv;
             }
+
+            auto toByte = [](float v) -> uint32_t {
+                int c = static_cast<int>(v * 255.0f + 0.5f);
+                return static_cast<uint32_t>(c < 0 ? 0 : (c > 255 ? 255 : c));
+            };
+
+            pixels[dstRowOff + px] = toByte(accR)
+                                   | (toByte(accG) << 8)
+                                   | (toByte(accB) << 16)
+                                   | (0xFFu << 24);
         }
     }
+}
+
+void ViewManager::updateSliceTexture(int volumeIndex, int viewIndex) {
+    SliceUpdate u;
+    if (!prepareSliceUpdate(volumeIndex, viewIndex, u))
+        return;
+    if (!u.slice) {
+        u.render();
+        u.slice = sliceCache_.insert(u.key, std::move(u.rendered));
+    }
+    finishSliceUpdate(u);
+}
+
+bool ViewManager::prepareSliceUpdate(int volumeIndex, int viewIndex, SliceUpdate& u) {
+    if (volumeIndex < 0 ||
+        volumeIndex >= state_.volumeCount())
+        return false;
+    if (volumeIndex >= static_cast<int>(state_.viewStates_.size()))
+        return false;
+
+    const Volume& vol = state_.volumes_[volumeIndex];
+    if (vol.data.empty())
+        return false;
+
+    // Not on screen: regenerate when it is drawn again
+    ViewVisibility& vis = sliceVisibility(volumeIndex);
+    if (!vis.drawn[viewIndex]) {
+        vis.stale[viewIndex] = true;
+        return false;
+    }
+    vis.stale[viewIndex] = false;
+
+    VolumeViewState& state = state_.viewStates_[volumeIndex];
+
+    // Range, log, invert and clamp modes are folded into one precomposed
+    // transfer, rebuilt only when the colour-relevant view state changes.
+    const ColourTransfer& transfer = colourTransfer(volumeIndex);
+
+    // Label volumes: dense id -> colour palette, cached across calls
+    const LabelPalette* palette =
+        vol.isLabelVolume() ? &labelPalette(volumeIndex, transfer) : nullptr;
+
+    int axis = (viewIndex == 0) ? 2 : (viewIndex == 1) ? 0 : 1;
+    int sliceIdx = std::clamp(state.sliceIndices[axis], 0, vol.dimensions[axis] - 1);
+
+    // GPU slicing: the shader samples the resident 3D texture directly, so
+    // there is no CPU pixel work and no upload.  Labels stay on the CPU.
+    if (!palette && renderSliceOnGpu(volumeIndex, viewIndex, sliceIdx, transfer))
+        return false;
+
+    // Paletted slices: indices are uploaded only when they change, colour
+    // changes just replace the LUT.  Labels stay RGBA.
+    if (!palette && renderSlicePaletted(volumeIndex, viewIndex, sliceIdx, transfer))
+        return false;
+
+    // Rendered slices are cached; stepping back and forth or toggling
+    // between volumes is then a lookup plus an upload.
+    u.volumeIndex = volumeIndex;
+    u.viewIndex = viewIndex;
+    u.key = SliceKey{volumeIndex, viewIndex, sliceIdx,
+                     sliceParamsHash(transfer.params, vol.contentVersion())};
+    u.slice = sliceCache_.find(u.key);
+    u.volume = &vol;
+    u.transfer = &transfer;
+    u.palette = palette;
+    return true;
+}
+
+void ViewManager::finishSliceUpdate(SliceUpdate& u) {
+    prefetchNeighbourSlices(u.volumeIndex, u.viewIndex, u.key.slice, u.key.paramsHash);
+
+    int w = u.slice->width;
+    int h = u.slice->height;
+    const uint32_t* pixels = u.slice->pixels.data();
 
-    std::unique_ptr<Texture>& tex = state.sliceTextures[viewIndex];
+    std::unique_ptr<Texture>& tex = state_.viewStates_[u.volumeIndex].sliceTextures[u.viewIndex];
     if (!tex) {
-        tex = backend_.createTexture(w, h, pixelBuf_.data());
+        tex = backend_.createTexture(w, h, pixels);
     } else {
         if (tex->width != w || tex->height != h) {
             backend_.destroyTexture(tex.get());
-            tex = backend_.createTexture(w, h, pixelBuf_.data());
+            tex = backend_.createTexture(w, h, pixels);
         } else {
-            backend_.updateTexture(tex.get(), pixelBuf_.data());
+            backend_.updateTexture(tex.get(), pixels);
         }
     }
 }
 
 void ViewManager::updateOverlayTexture(int viewIndex) {
+    OverlayUpdate u;
+    if (!prepareOverlayUpdate(viewIndex, u))
+        return;
+    std::vector<TaskPool::Task> tasks;
+    addOverlayBandTasks(u, tasks);
+    taskPool_.run(tasks);
+    finishOverlayUpdate(u);
+}
+
+void ViewManager::addOverlayBandTasks(OverlayUpdate& u, std::vector<TaskPool::Task>& tasks) {
+    for (int y = 0; y < u.height; y += kOverlayBandRows) {
+        int end = std::min(y + kOverlayBandRows, u.height);
+        tasks.push_back([&u, y, end] { u.blendRows(y, end); });
+    }
+}
+
+bool ViewManager::prepareOverlayUpdate(int viewIndex, OverlayUpdate& u) {
     int numVols = state_.volumeCount();
     if (numVols < 2)
-        return;
+        return false;
 
     const Volume& ref = state_.volumes_[0];
     const VolumeViewState& refState = state_.viewStates_[0];
     if (ref.data.empty())
-        return;
+        return false;
+
+    if (!overlayVisibility_.drawn[viewIndex]) {
+        overlayVisibility_.stale[viewIndex] = true;
+        return false;
+    }
+    overlayVisibility_.stale[viewIndex] = false;
 
     int w, h;
     if (viewIndex == 0) {
@@ -265,38 +332,8 @@ void ViewManager::updateOverlayTexture(int viewIndex) {
     else
         sliceIdx = refState.sliceIndices.y;
 
-    // --- Per-volume precomputed data ---
-    // For each volume we precompute:
-    //   combined = vol.worldToVoxel * ref.voxelToWorld  (ref-voxel -> target-voxel)
-    //   LUT pointer, range params, under/over colours, overlay alpha
-    //
-    // When a valid tag-based transform exists for volume 1 (the second volume),
-    // the transform is inserted into the chain:
-    //   Linear: combined = vol1.worldToVoxel * T^{-1} * ref.voxelToWorld
-    //   TPS:    per-pixel world-space inversion (no scanline optimization)
-    struct PerVolInfo {
-        glm::dmat4 combined;         // ref-voxel -> target-voxel transform
-        const float* vdata;          // pointer to volume data
-        glm::ivec3 dims;             // target volume dimensions
-        int dimXY;                   // dims.x * dims.y
-        float rangeMin, rangeMax, invSpan;
-        float logRangeMin, logRangeMax;  // Log-transformed range values
-        const uint32_t* mainLut;
-        uint32_t underColour, overColour;
-        bool underTransparent, overTransparent;
-        float alpha;
-        bool useTPSInverse = false;  // true if TPS per-pixel inversion needed
-        glm::dmat4 targetWorldToVox; // for TPS path: target vol worldToVoxel
-        bool isLabelVolume = false;  // true if this is a label/segmentation volume
-        bool useLogTransform = false;  // Apply log10 transform before colour mapping
-        const std::unordered_map<int, LabelInfo>* labelLUT = nullptr;  // label colour lookup
-        bool useColourMapForLabel = false;  // use colour map instead of label LUT
-        std::unordered_map<int, int> labelToIndex;  // label ID to colour map index
-        size_t labelCacheSize = 0;  // number of unique labels
-    };
-
-    int numMaps = colourMapCount();
-    std::vector<PerVolInfo> infos;
+    // --- Per-volume precomputed data (see OverlayLayer) ---
+    std::vector<OverlayLayer>& infos = u.layers;
     infos.reserve(numVols);
 
     // Check if a valid tag-based transform is available for volume 1
@@ -316,7 +353,8 @@ void ViewManager::updateOverlayTexture(int viewIndex) {
         if (vol.data.empty() || st.overlayAlpha <= 0.0f)
             continue;
 
-        PerVolInfo info;
+        OverlayLayer info;
+        info.volumeIndex = vi;
 
         if (vi == 1 && hasLinearTransform)
         {
@@ -340,70 +378,17 @@ void ViewManager::updateOverlayTexture(int viewIndex) {
         info.vdata = vol.data.data();
         info.dims = vol.dimensions;
         info.dimXY = vol.dimensions.x * vol.dimensions.y;
-        info.rangeMin = static_cast<float>(st.valueRange[0]);
-        info.rangeMax = static_cast<float>(st.valueRange[1]);
-
-        // Log-transform the range if log transform is enabled
-        float logRangeMin = info.rangeMin;
-        float logRangeMax = info.rangeMax;
-        
-        if (st.useLogTransform)
-        {
-            float logLowerThreshold = -10.0f;
-            logRangeMin = (info.rangeMin <= 0.0f) ? logLowerThreshold : std::log10(info.rangeMin);
-            logRangeMax = (info.rangeMax <= 0.0f) ? logLowerThreshold : std::log10(info.rangeMax);
-        }
-
-        float span = logRangeMax - logRangeMin;
-        if (span < 1e-12f) span = 1e-12f;
-        info.invSpan = 1.0f / span;
-        info.logRangeMin = logRangeMin;
-        info.logRangeMax = logRangeMax;
-        info.useLogTransform = st.useLogTransform;
-
-        info.mainLut = colourMapLut(st.colourMap).table.data();
+        info.transfer = &colourTransfer(vi);
         info.alpha = st.overlayAlpha;
 
-        // Pre-resolve under/over colours
-        // Pre-resolve under/over colours
-        int underMode = st.underColourMode;
-        info.underTransparent = (underMode == kClampTransparent);
-        info.underColour = info.underTransparent ? 0x00000000
-            : resolveClampColour(underMode, st.colourMap, false, st.invertColourMap);
-
-        int overMode = st.overColourMode;
-        info.overTransparent = (overMode == kClampTransparent);
-        info.overColour = info.overTransparent ? 0x00000000
-            : resolveClampColour(overMode, st.colourMap, true, st.invertColourMap);
-
         // Label volume support
         info.isLabelVolume = vol.isLabelVolume();
-        if (info.isLabelVolume) {
-            info.labelLUT = &vol.getLabelLUT();
-            // Check if we should use colour map instead of label LUT
-            {
-                info.useColourMapForLabel = true;
-                auto cacheIt = labelToIndexCache_.find(vi);
-                if (cacheIt == labelToIndexCache_.end()) {
-                    std::vector<int> uniqueLabels = vol.getUniqueLabelIds();
-                    std::unordered_map<int, int> mapping;
-                    for (size_t i = 0; i < uniqueLabels.size(); ++i) {
-                        mapping[uniqueLabels[i]] = static_cast<int>(i);
-                    }
-                    labelCacheSize_[vi] = uniqueLabels.size();
-                    labelToIndexCache_[vi] = std::move(mapping);
-                    cacheIt = labelToIndexCache_.find(vi);
-                }
-                info.labelToIndex = cacheIt->second;
-                info.labelCacheSize = labelCacheSize_[vi];
-            }
-        }
+        if (info.isLabelVolume)
+            info.palette = &labelPalette(vi, *info.transfer);
 
         infos.push_back(info);
     }
 
-    pixelBuf_.resize(w * h);
-
     // Precompute the ref-voxel base and row/col deltas for the 2D scan.
     // This avoids a full 4x4 matrix multiply per pixel per volume.
     // ref-voxel as doubles: base is the corner of the slice, dPx/dPy are deltas.
@@ -433,12 +418,8 @@ void ViewManager::updateOverlayTexture(int viewIndex) {
     //   targetDpx   = combined * (refDpx, 0)  (direction, no translation)
     //   targetDpy   = combined * (refDpy, 0)
     // For TPS volumes these are unused; we compute world coords per-pixel.
-    struct ScanInfo {
-        glm::dvec3 base;   // target-voxel at (px=0, py=0)
-        glm::dvec3 dpx;    // target-voxel delta per px++
-        glm::dvec3 dpy;    // target-voxel delta per py++
-    };
-    std::vector<ScanInfo> scans(infos.size());
+    std::vector<OverlayScan>& scans = u.scans;
+    scans.resize(infos.size());
     for (size_t i = 0; i < infos.size(); ++i) {
         if (infos[i].useTPSInverse)
             continue;  // scanline not used for TPS volumes
@@ -453,7 +434,6 @@ void ViewManager::updateOverlayTexture(int viewIndex) {
 
     // For TPS per-pixel path: precompute ref-voxel -> world scanline params
     // so we can efficiently compute the world coordinate for each pixel.
-    glm::dvec3 worldBase(0.0), worldDpx(0.0), worldDpy(0.0);
     bool anyTPS = false;
     for (const auto& info : infos)
     {
@@ -469,177 +449,78 @@ void ViewManager::updateOverlayTexture(int viewIndex) {
         glm::dvec4 bH  = V2W * glm::dvec4(refBase, 1.0);
         glm::dvec4 dxH = V2W * glm::dvec4(refDpx, 0.0);
         glm::dvec4 dyH = V2W * glm::dvec4(refDpy, 0.0);
-        worldBase = glm::dvec3(bH);
-        worldDpx  = glm::dvec3(dxH);
-        worldDpy  = glm::dvec3(dyH);
+        u.worldBase = glm::dvec3(bH);
+        u.worldDpx  = glm::dvec3(dxH);
+        u.worldDpy  = glm::dvec3(dyH);
+        u.transform = &xfmResult;
     }
 
-    for (int py = 0; py < h; ++py) {
-        int dstRowOff = (h - 1 - py) * w;
-
-        for (int px = 0; px < w; ++px) {
-            float accR = 0.0f, accG = 0.0f, accB = 0.0f;
-            float totalWeight = 0.0f;
-
-            for (size_t vi = 0; vi < infos.size(); ++vi) {
-                const auto& info = infos[vi];
-
-                glm::dvec3 tv;
-                if (info.useTPSInverse)
-                {
-                    // TPS per-pixel path: ref-voxel -> world -> TPS inverse -> target-world -> target-voxel
-                    glm::dvec3 worldPt = worldBase + static_cast<double>(px) * worldDpx
-                                                   + static_cast<double>(py) * worldDpy;
-                    glm::dvec3 vol1World = xfmResult.inverseTransformPoint(worldPt);
-                    glm::dvec4 vox = info.targetWorldToVox * glm::dvec4(vol1World, 1.0);
-                    tv = glm::dvec3(vox);
-                }
-                else
-                {
-                    // Scanline-optimized path (linear or identity)
-                    const auto& sc = scans[vi];
-                    tv = sc.base + static_cast<double>(px) * sc.dpx
-                                 + static_cast<double>(py) * sc.dpy;
-                }
-
-                int tx = static_cast<int>(std::round(tv.x));
-                int ty = static_cast<int>(std::round(tv.y));
-                int tz = static_cast<int>(std::round(tv.z));
-
-                // Bounds check
-                if (tx < 0 || tx >= info.dims.x ||
-                    ty < 0 || ty >= info.dims.y ||
-                    tz < 0 || tz >= info.dims.z)
-                    continue;
-
-                float raw = info.vdata[tz * info.dimXY + ty * info.dims.x + tx];
-
-                uint32_t packed;
-                if (info.isLabelVolume) {
-                    int labelId = static_cast<int>(raw + 0.5f);
-                    if (labelId == 0) {
-                        continue;  // transparent background
-                    }
-                    // Use colour map if selected
-                    if (info.useColourMapForLabel) {
-                        auto it = info.labelToIndex.find(labelId);
-                        if (it != info.labelToIndex.end() && info.labelCacheSize > 0) {
-                            int idx = (it->second + 1) * 255 / static_cast<int>(info.labelCacheSize);
-                            packed = info.mainLut[idx];
-                        } else {
-                            continue;  // unknown label
-                        }
-                    } else if (info.labelLUT) {
-                        // Use label LUT
-                        auto it = info.labelLUT->find(labelId);
-                        if (it != info.labelLUT->end()) {
-                            const LabelInfo& lbl = it->second;
-                            if (!lbl.visible) {
-                                continue;  // invisible label
-                            }
-                            packed = static_cast<uint32_t>(lbl.r) |
-                                     (static_cast<uint32_t>(lbl.g) << 8) |
-                                     (static_cast<uint32_t>(lbl.b) << 16) |
-                                     (static_cast<uint32_t>(lbl.a) << 24);
-                            if (lbl.a == 0) continue;
-                        } else {
-                            // Label not in LUT: use grayscale based on label ID
-                            int gray = (labelId * 17) % 256;
-                            packed = static_cast<uint32_t>(gray) |
-                                     (static_cast<uint32_t>(gray) << 8) |
-                                     (static_cast<uint32_t>(gray) << 16) |
-                                     0xFF000000;
-                        }
-                    } else {
-                        // No label LUT: use grayscale based on label ID
-                        int gray = (labelId * 17) % 256;
-                        packed = static_cast<uint32_t>(gray) |
-                                 (static_cast<uint32_t>(gray) << 8) |
-                                 (static_cast<uint32_t>(gray) << 16) |
-                                 0xFF000000;
-                    }
-                } else {
-                    float displayVal = raw;
-
-                    // Apply log transform if enabled
-                    if (info.useLogTransform)
-                    {
-                        // Values <= 0 use under-colour setting
-                        if (raw <= 0.0f)
-                        {
-                            if (info.underTransparent)
-                                continue;
-                            packed = info.underColour;
-                            goto skip_lut_lookup;
-                        }
-                        displayVal = std::log10(raw);
-                    }
-
-                    if (displayVal < info.logRangeMin) {
-                        if (info.underTransparent) continue;
-                        packed = info.underColour;
-                    } else if (displayVal > info.logRangeMax) {
-                        if (info.overTransparent) continue;
-                        packed = info.overColour;
-                    } else {
-                        int lutIdx = static_cast<int>(
-                            (displayVal - info.logRangeMin) * info.invSpan * 255.0f + 0.5f);
-                        if (lutIdx > 255) lutIdx = 255;
-                        packed = info.mainLut[lutIdx];
-                    }
-
-skip_lut_lookup:
-                    ;
-                }
-
-                if ((packed >> 24) == 0)
-                    continue;
-
-                float srcR = static_cast<float>((packed >> 0) & 0xFF) * (1.0f / 255.0f);
-                float srcG = static_cast<float>((packed >> 8) & 0xFF) * (1.0f / 255.0f);
-                float srcB = static_cast<float>((packed >> 16) & 0xFF) * (1.0f / 255.0f);
-
-                accR += srcR * info.alpha;
-                accG += srcG * info.alpha;
-                accB += srcB * info.alpha;
-                totalWeight += info.alpha;
-            }
-
-            if (totalWeight > 0.0f) {
-                float inv = 1.0f / totalWeight;
-                accR *= inv;
-                accG *= inv;
-                accB *= inv;
-            }
-
-            auto toByte = [](float v) -> uint32_t {
-                int c = static_cast<int>(v * 255.0f + 0.5f);
-                return static_cast<uint32_t>(c < 0 ? 0 : (c > 255 ? 255 : c));
-            };
-
-            pixelBuf_[dstRowOff + px] = toByte(accR)
-                                       | (toByte(accG) << 8)
-                                       | (toByte(accB) << 16)
-                                       | (0xFFu << 24);
+    // GPU slicing: blend every layer in one shader pass.  TPS warps and
+    // label volumes are only implemented on the CPU.
+    if (state_.gpuSlicing_ && !anyTPS && !infos.empty() &&
+        infos.size() <= static_cast<size_t>(kMaxVolumeSliceLayers)) {
+        std::vector<VolumeSliceLayer> layers;
+        for (size_t i = 0; i < infos.size(); ++i) {
+            const VolumeTexture* vt = infos[i].isLabelVolume
+                ? nullptr : volumeTexture(infos[i].volumeIndex);
+            if (!vt)
+                break;
+            VolumeSliceLayer layer = sliceLayer(*vt, *infos[i].transfer);
+            setVec3(layer.base, scans[i].base);
+            setVec3(layer.dpx, scans[i].dpx);
+            setVec3(layer.dpy, scans[i].dpy);
+            layer.alpha = infos[i].alpha;
+            layers.push_back(layer);
+        }
+        if (layers.size() == infos.size()) {
+            std::unique_ptr<Texture>& tex = state_.overlay_.textures[viewIndex];
+            ensureRenderTarget(tex, w, h);
+            if (backend_.renderVolumeSlice(tex.get(), layers.data(),
+                                           static_cast<int>(layers.size()), true))
+                return false;
         }
     }
 
-    std::unique_ptr<Texture>& tex = state_.overlay_.textures[viewIndex];
+    std::vector<uint32_t>& buf = overlayPixels_[viewIndex];
+    buf.resize(w * h);
+    u.viewIndex = viewIndex;
+    u.width = w;
+    u.height = h;
+    u.pixels = buf.data();
+    return true;
+}
+
+void ViewManager::finishOverlayUpdate(OverlayUpdate& u) {
+    int w = u.width;
+    int h = u.height;
+    std::unique_ptr<Texture>& tex = state_.overlay_.textures[u.viewIndex];
     if (!tex) {
-        tex = backend_.createTexture(w, h, pixelBuf_.data());
+        tex = backend_.createTexture(w, h, u.pixels);
     } else {
         if (tex->width != w || tex->height != h) {
             backend_.destroyTexture(tex.get());
-            tex = backend_.createTexture(w, h, pixelBuf_.data());
+            tex = backend_.createTexture(w, h, u.pixels);
         } else {
-            backend_.updateTexture(tex.get(), pixelBuf_.data());
+            backend_.updateTexture(tex.get(), u.pixels);
         }
     }
 }
 
 void ViewManager::updateAllOverlayTextures() {
-    for (int v = 0; v < 3; ++v)
-        updateOverlayTexture(v);
+    // All three views' bands in one batch
+    std::array<OverlayUpdate, 3> updates;
+    std::array<bool, 3> pending{};
+    std::vector<TaskPool::Task> tasks;
+    for (int v = 0; v < 3; ++v) {
+        pending[v] = prepareOverlayUpdate(v, updates[v]);
+        if (pending[v])
+            addOverlayBandTasks(updates[v], tasks);
+    }
+    taskPool_.run(tasks);
+    for (int v = 0; v < 3; ++v) {
+        if (pending[v])
+            finishOverlayUpdate(updates[v]);
+    }
 }
 
 void ViewManager::syncCursors() {
@@ -754,26 +635,158 @@ void ViewManager::resetViews() {
 }
 
 void ViewManager::initializeAllTextures() {
+    // Everything that touches shared state (colour transfers, palettes, the
+    // GPU paths) runs here; only the CPU pixel work fans out to the pool:
+    // one task per uncached (column, view) slice and per overlay band.
+    std::vector<SliceUpdate> slices;
+    slices.reserve(static_cast<size_t>(state_.volumeCount()) * 3);
     for (int vi = 0; vi < state_.volumeCount(); ++vi) {
         if (state_.volumes_[vi].data.empty())
             continue;
-        updateSliceTexture(vi, 0);
-        updateSliceTexture(vi, 1);
-        updateSliceTexture(vi, 2);
+        for (int v = 0; v < 3; ++v) {
+            SliceUpdate u;
+            if (prepareSliceUpdate(vi, v, u))
+                slices.push_back(std::move(u));
+        }
+    }
+
+    std::array<OverlayUpdate, 3> overlays;
+    std::array<bool, 3> overlayPending{};
+    if (state_.hasOverlay()) {
+        for (int v = 0; v < 3; ++v)
+            overlayPending[v] = prepareOverlayUpdate(v, overlays[v]);
+    }
+
+    std::vector<TaskPool::Task> tasks;
+    for (SliceUpdate& u : slices) {
+        if (!u.slice)
+            tasks.push_back([&u] { u.render(); });
+    }
+    for (int v = 0; v < 3; ++v) {
+        if (overlayPending[v])
+            addOverlayBandTasks(overlays[v], tasks);
     }
+    taskPool_.run(tasks);
+
+    // Uploads, in one batch after all the rendering
+    for (SliceUpdate& u : slices) {
+        if (!u.slice)
+            u.slice = sliceCache_.insert(u.key, std::move(u.rendered));
+        finishSliceUpdate(u);
+    }
+    for (int v = 0; v < 3; ++v) {
+        if (overlayPending[v])
+            finishOverlayUpdate(overlays[v]);
+    }
+}
 
-    if (state_.hasOverlay())
-        updateAllOverlayTextures();
+ViewManager::ViewVisibility& ViewManager::sliceVisibility(int volumeIndex) {
+    if (volumeIndex >= static_cast<int>(sliceVisibility_.size()))
+        sliceVisibility_.resize(volumeIndex + 1);
+    return sliceVisibility_[volumeIndex];
+}
+
+void ViewManager::setViewDrawn(int volumeIndex, int viewIndex, bool drawn) {
+    if (volumeIndex < 0 || viewIndex < 0 || viewIndex > 2)
+        return;
+    ViewVisibility& vis = sliceVisibility(volumeIndex);
+    vis.drawn[viewIndex] = drawn;
+    if (drawn && vis.stale[viewIndex])
+        updateSliceTexture(volumeIndex, viewIndex);
+}
+
+void ViewManager::setOverlayViewDrawn(int viewIndex, bool drawn) {
+    if (viewIndex < 0 || viewIndex > 2)
+        return;
+    overlayVisibility_.drawn[viewIndex] = drawn;
+    if (drawn && overlayVisibility_.stale[viewIndex])
+        updateOverlayTexture(viewIndex);
+}
+
+bool ViewManager::isViewStale(int volumeIndex, int viewIndex) const {
+    if (volumeIndex < 0 || volumeIndex >= static_cast<int>(sliceVisibility_.size()) ||
+        viewIndex < 0 || viewIndex > 2)
+        return false;
+    return sliceVisibility_[volumeIndex].stale[viewIndex];
+}
+
+bool ViewManager::isOverlayViewStale(int viewIndex) const {
+    return viewIndex >= 0 && viewIndex <= 2 && overlayVisibility_.stale[viewIndex];
+}
+
+void ViewManager::clearSliceCache() {
+    sliceCache_.clear();
+    sliceScroll_.clear();
+}
+
+void ViewManager::releaseVolumeResources() {
+    // Volumes are about to be replaced: stop background renders that read them
+    clearSliceCache();
+
+    for (auto& pair : gpuVolumes_)
+        if (pair.second.texture)
+            backend_.destroyVolumeTexture(pair.second.texture.get());
+    gpuVolumes_.clear();
+
+    for (auto& pair : indexedViews_)
+        for (IndexedView& iv : pair.second)
+            if (iv.texture)
+                backend_.destroyIndexTexture(iv.texture.get());
+    indexedViews_.clear();
 }
 
 void ViewManager::destroyAllTextures() {
+    releaseVolumeResources();
+
+    auto destroy = [this](std::unique_ptr<Texture>& tex) {
+        if (tex)
+            backend_.destroyTexture(tex.get());
+        tex.reset();
+    };
     for (auto& vs : state_.viewStates_) {
         for (int i = 0; i < 3; ++i)
-            vs.sliceTextures[i].reset();
+            destroy(vs.sliceTextures[i]);
     }
 
     for (int i = 0; i < 3; ++i)
-        state_.overlay_.textures[i].reset();
+        destroy(state_.overlay_.textures[i]);
+}
+
+void ViewManager::detachTextures() {
+    releaseVolumeResources();
+
+    detachedSlices_.resize(state_.viewStates_.size());
+    for (size_t vi = 0; vi < state_.viewStates_.size(); ++vi) {
+        for (int i = 0; i < 3; ++i)
+            detachedSlices_[vi][i] = std::move(state_.viewStates_[vi].sliceTextures[i]);
+    }
+    for (int i = 0; i < 3; ++i)
+        detachedOverlay_[i] = std::move(state_.overlay_.textures[i]);
+}
+
+void ViewManager::reattachTextures() {
+    auto reattach = [this](std::unique_ptr<Texture>& from, std::unique_ptr<Texture>* to) {
+        if (!from)
+            return;
+        if (to && !*to)
+            *to = std::move(from);
+        else
+            backend_.destroyTexture(from.get());
+        from.reset();
+    };
+
+    for (size_t vi = 0; vi < detachedSlices_.size(); ++vi) {
+        bool keep = vi < state_.viewStates_.size() && vi < state_.volumes_.size() &&
+                    !state_.volumes_[vi].data.empty();
+        for (int i = 0; i < 3; ++i)
+            reattach(detachedSlices_[vi][i],
+                     keep ? &state_.viewStates_[vi].sliceTextures[i] : nullptr);
+    }
+    detachedSlices_.clear();
+
+    for (int i = 0; i < 3; ++i)
+        reattach(detachedOverlay_[i],
+                 state_.hasOverlay() ? &state_.overlay_.textures[i] : nullptr);
 }
 
 void ViewManager::sliceIndicesToWorld(const Volume& vol, const int indices[3], double world[3]) {
@@ -798,7 +811,193 @@ void ViewManager::worldToSliceIndices(const Volume& vol, const double world[3],
     indices[2] = std::clamp(indices[2], 0, vol.dimensions.z - 1);
 }
 
+const ColourTransfer& ViewManager::colourTransfer(int volumeIndex) {
+    const VolumeViewState& st = state_.viewStates_[volumeIndex];
+    VolumeRenderParams params;
+    params.valueMin = st.valueRange[0];
+    params.valueMax = st.valueRange[1];
+    params.colourMap = st.colourMap;
+    params.overlayAlpha = st.overlayAlpha;
+    params.underColourMode = st.underColourMode;
+    params.overColourMode = st.overColourMode;
+    params.useLogTransform = st.useLogTransform;
+    params.invertColourMap = st.invertColourMap;
+
+    // Transfers are shared with queued prefetch jobs, so a rebuild swaps in
+    // a new object instead of overwriting the one a job may be reading.
+    auto it = transferCache_.find(volumeIndex);
+    if (it == transferCache_.end())
+        it = transferCache_.emplace(volumeIndex,
+                 std::make_shared<const ColourTransfer>(buildColourTransfer(params))).first;
+    else if (!it->second->matches(params))
+        it->second = std::make_shared<const ColourTransfer>(buildColourTransfer(params));
+    return *it->second;
+}
+
+const LabelPalette& ViewManager::labelPalette(int volumeIndex, const ColourTransfer& transfer) {
+    const Volume& vol = state_.volumes_[volumeIndex];
+    auto it = labelPaletteCache_.find(volumeIndex);
+    if (it == labelPaletteCache_.end()) {
+        it = labelPaletteCache_.emplace(volumeIndex, CachedPalette{}).first;
+        it->second.palette = std::make_shared<const LabelPalette>(buildLabelPalette(vol, transfer));
+        it->second.params = transfer.params;
+    } else if (it->second.palette->contentVersion != vol.contentVersion() ||
+               !transfer.matches(it->second.params)) {
+        it->second.palette = std::make_shared<const LabelPalette>(buildLabelPalette(vol, transfer));
+        it->second.params = transfer.params;
+    }
+    return *it->second.palette;
+}
+
+const VolumeTexture* ViewManager::volumeTexture(int volumeIndex) {
+    if (!state_.gpuSlicing_ || !backend_.supportsVolumeSlicing())
+        return nullptr;
+
+    // contentVersion() is renewed whenever the volume's data is replaced
+    const Volume& vol = state_.volumes_[volumeIndex];
+    GpuVolume& gv = gpuVolumes_[volumeIndex];
+    if (gv.version != vol.contentVersion()) {
+        if (gv.texture)
+            backend_.destroyVolumeTexture(gv.texture.get());
+        gv.texture = backend_.createVolumeTexture(vol.dimensions.x, vol.dimensions.y,
+                                                  vol.dimensions.z, vol.data.data());
+        gv.version = vol.contentVersion();
+    }
+    return gv.texture.get();
+}
+
+bool ViewManager::renderSliceOnGpu(int volumeIndex, int viewIndex, int sliceIndex,
+                                   const ColourTransfer& transfer) {
+    const VolumeTexture* vt = volumeTexture(volumeIndex);
+    if (!vt)
+        return false;
+
+    // Same pixel -> voxel mapping as renderSlice(): px/py run along the
+    // view's in-plane axes, the slice index fixes the third.
+    const Volume& vol = state_.volumes_[volumeIndex];
+    VolumeSliceLayer layer = sliceLayer(*vt, transfer);
+    int w, h;
+    if (viewIndex == 0) {
+        w = vol.dimensions.x;
+        h = vol.dimensions.y;
+        setVec3(layer.base, glm::dvec3(0.0, 0.0, sliceIndex));
+        setVec3(layer.dpx, glm::dvec3(1.0, 0.0, 0.0));
+        setVec3(layer.dpy, glm::dvec3(0.0, 1.0, 0.0));
+    } else if (viewIndex == 1) {
+        w = vol.dimensions.y;
+        h = vol.dimensions.z;
+        setVec3(layer.base, glm::dvec3(sliceIndex, 0.0, 0.0));
+        setVec3(layer.dpx, glm::dvec3(0.0, 1.0, 0.0));
+        setVec3(layer.dpy, glm::dvec3(0.0, 0.0, 1.0));
+    } else {
+        w = vol.dimensions.x;
+        h = vol.dimensions.z;
+        setVec3(layer.base, glm::dvec3(0.0, sliceIndex, 0.0));
+        setVec3(layer.dpx, glm::dvec3(1.0, 0.0, 0.0));
+        setVec3(layer.dpy, glm::dvec3(0.0, 0.0, 1.0));
+    }
+
+    std::unique_ptr<Texture>& tex = state_.viewStates_[volumeIndex].sliceTextures[viewIndex];
+    ensureRenderTarget(tex, w, h);
+    return backend_.renderVolumeSlice(tex.get(), &layer, 1, false);
+}
+
+bool ViewManager::renderSlicePaletted(int volumeIndex, int viewIndex, int sliceIndex,
+                                      const ColourTransfer& transfer) {
+    if (!state_.palettedSlices_ || !backend_.supportsPalettedSlices())
+        return false;
+
+    const Volume& vol = state_.volumes_[volumeIndex];
+    IndexedView& iv = indexedViews_[volumeIndex][viewIndex];
+    int indexBytes = transfer.indexBytes();
+
+    bool stale = !iv.texture || iv.texture->indexBytes != indexBytes ||
+                 iv.sliceIndex != sliceIndex || iv.rangeMin != transfer.rangeMin ||
+                 iv.rangeMax != transfer.rangeMax || iv.useLog != transfer.useLog ||
+                 iv.version != vol.contentVersion();
+    if (stale) {
+        IndexedSlice slice = renderSliceIndices(vol, transfer, indexBytes,
+                                                viewIndex, sliceIndex);
+        if (slice.indices.empty())
+            return false;
+        if (!iv.texture || iv.texture->indexBytes != indexBytes ||
+            iv.texture->width != slice.width || iv.texture->height != slice.height) {
+            if (iv.texture)
+                backend_.destroyIndexTexture(iv.texture.get());
+            iv.texture = backend_.createIndexTexture(slice.width, slice.height, indexBytes);
+        }
+        if (!iv.texture || !backend_.updateIndexTexture(iv.texture.get(),
+                                                        slice.indices.data())) {
+            iv.sliceIndex = -1;
+            return false;
+        }
+        iv.sliceIndex = sliceIndex;
+        iv.rangeMin = transfer.rangeMin;
+        iv.rangeMax = transfer.rangeMax;
+        iv.useLog = transfer.useLog;
+        iv.version = vol.contentVersion();
+    }
+
+    uint32_t lut[kLutSize + 2];
+    int lutSize = slicePalette(transfer, indexBytes, lut);
+
+    std::unique_ptr<Texture>& tex = state_.viewStates_[volumeIndex].sliceTextures[viewIndex];
+    ensureRenderTarget(tex, iv.texture->width, iv.texture->height);
+    return backend_.renderPalettedSlice(tex.get(), iv.texture.get(), lut, lutSize);
+}
+
+void ViewManager::ensureRenderTarget(std::unique_ptr<Texture>& tex, int w, int h) {
+    if (tex && tex->width == w && tex->height == h)
+        return;
+    if (tex)
+        backend_.destroyTexture(tex.get());
+    tex = backend_.createTexture(w, h, nullptr);
+}
+
+void ViewManager::prefetchNeighbourSlices(int volumeIndex, int viewIndex,
+                                          int sliceIndex, uint64_t paramsHash) {
+    // Track the scroll direction per (volume, view); only a view whose slice
+    // just moved is being scrolled, so only that one queues neighbours.
+    SliceScroll& scroll = sliceScroll_[volumeIndex];
+    int last = scroll.lastSlice[viewIndex];
+    scroll.lastSlice[viewIndex] = sliceIndex;
+    if (last < 0 || last == sliceIndex)
+        return;
+    int dir = (sliceIndex > last) ? 1 : -1;
+
+    const Volume& vol = state_.volumes_[volumeIndex];
+    int axis = (viewIndex == 0) ? 2 : (viewIndex == 1) ? 0 : 1;
+    int count = vol.dimensions[axis];
+
+    // Snapshot the shared transfer/palette: later rebuilds on the UI thread
+    // swap the cached pointers and leave these untouched.
+    std::shared_ptr<const ColourTransfer> transfer = transferCache_.at(volumeIndex);
+    std::shared_ptr<const LabelPalette> palette;
+    if (vol.isLabelVolume())
+        palette = labelPaletteCache_.at(volumeIndex).palette;
+    const Volume* volPtr = &vol;
+
+    std::vector<SliceCache::Job> jobs;
+    jobs.reserve(kSlicePrefetchAhead + kSlicePrefetchBehind);
+    auto addJob = [&](int s) {
+        if (s < 0 || s >= count)
+            return;
+        SliceCache::Job job;
+        job.key = SliceKey{volumeIndex, viewIndex, s, paramsHash};
+        job.render = [volPtr, transfer, palette, viewIndex, s]() {
+            return renderSlice(*volPtr, *transfer, palette.get(), viewIndex, s);
+        };
+        jobs.push_back(std::move(job));
+    };
+    // Nearest first: interleave the look-ahead with a shorter look-behind
+    for (int k = 1; k <= kSlicePrefetchAhead; ++k) {
+        addJob(sliceIndex + dir * k);
+        if (k <= kSlicePrefetchBehind)
+            addJob(sliceIndex - dir * k);
+    }
+    sliceCache_.prefetch(volumeIndex, viewIndex, std::move(jobs));
+}
+
 void ViewManager::invalidateLabelCache(int volumeIndex) {
-    labelToIndexCache_.erase(volumeIndex);
-    labelCacheSize_.erase(volumeIndex);
+    labelPaletteCache_.erase(volumeIndex);
 }
@@ -9,6 +9,7 @@
 #include <iostream>
 #include <fstream>
 #include <unordered_set>
+#include <atomic>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_inverse.hpp>
@@ -96,6 +97,7 @@ Volume& Volume::operator=(const Volume& other) {
         voxelToWorld = other.voxelToWorld;
         worldToVoxel = other.worldToVoxel;
         tags = other.tags;
+        contentChanged();
     }
     return *this;
 }
@@ -112,6 +114,7 @@ Volume::Volume(Volume&& other) noexcept
       worldToVoxel(other.worldToVoxel),
       tags(std::move(other.tags))
 {
+    other.contentChanged();
     other.dimensions = glm::ivec3(0, 0, 0);
     other.min_value = 0.0f;
     other.max_value = 1.0f;
@@ -129,6 +132,8 @@ Volume& Volume::operator=(Volume&& other) noexcept {
         voxelToWorld = other.voxelToWorld;
         worldToVoxel = other.worldToVoxel;
         tags = std::move(other.tags);
+        contentChanged();
+        other.contentChanged();
         
         other.dimensions = glm::ivec3(0, 0, 0);
         other.min_value = 0.0f;
@@ -150,6 +155,7 @@ void Volume::generate_test_data()
                         0.0, 0.0, 1.0);
 
     data.resize(256 * 256 * 256);
+    contentChanged();
 
     min_value = 0.0f;
     max_value = 1.0f;
@@ -179,17 +185,56 @@ void Volume::generate_test_data()
 
 }
 
+std::mutex& libmincMutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
 void Volume::load(const std::string& filename)
 {
     if (filename.empty())
         throw std::runtime_error("Empty filename provided");
 
+    contentChanged();
+
     // Detect NIfTI files by extension
     if (isNiftiFile(filename)) {
         loadNiftiFile(filename, *this);
         return;
     }
 
+    loadMinc(filename, false);
+}
+
+void Volume::loadMidAxialSlice(const std::string& filename)
+{
+    if (filename.empty())
+        throw std::runtime_error("Empty filename provided");
+
+    contentChanged();
+
+    if (!isNiftiFile(filename)) {
+        loadMinc(filename, true);
+        return;
+    }
+
+    // NIfTI reads do not take libmincMutex(); crop the whole volume
+    loadNiftiFile(filename, *this);
+    const int z = dimensions.z / 2;
+    const size_t sliceSize = static_cast<size_t>(dimensions.x) * dimensions.y;
+    std::vector<float> slice(data.begin() + z * sliceSize, data.begin() + (z + 1) * sliceSize);
+    data = std::move(slice);
+    start.z += step.z * z;
+    dimensions.z = 1;
+    voxelToWorld[3] = voxelToWorld[3] + voxelToWorld[2] * static_cast<double>(z);
+    worldToVoxel = glm::inverse(voxelToWorld);
+}
+
+void Volume::loadMinc(const std::string& filename, bool midAxialSlice)
+{
+    // Held until the handle is closed
+    std::lock_guard<std::mutex> mincLock(libmincMutex());
     Minc2Handle h;
     h.open(filename);
 
@@ -240,6 +285,15 @@ void Volume::load(const std::string& filename)
         }
     }
 
+    // The slice is read as a one-slice volume starting at its own position
+    int sliceZ = 0;
+    if (midAxialSlice)
+    {
+        sliceZ = dimensions.z / 2;
+        start.z += step.z * sliceZ;
+        dimensions.z = 1;
+    }
+
     // Build voxel-to-world transformation matrix.
     // MINC: world = dirCos * diag(step) * voxel + dirCos * start
     // start[i] is along dimension i's axis, so the world translation = dirCos * start.
@@ -272,19 +326,39 @@ void Volume::load(const std::string& filename)
     // voxel = affine^-1 * (world - start)
     worldToVoxel = glm::inverse(voxelToWorld);
 
-    size_t total_voxels = 1;
-    for (int i = 0; i < ndim; ++i)
+    if (midAxialSlice)
     {
-        total_voxels *= dims[i].length;
+        // One Z index and the first index of any non-spatial dimension, in
+        // the same (representation) order as dims
+        std::vector<int> hStart(ndim, 0), hCount(ndim, 1);
+        hCount[dim_indices[0]] = dimensions.x;
+        hCount[dim_indices[1]] = dimensions.y;
+        hStart[dim_indices[2]] = sliceZ;
+
+        const size_t sliceVoxels = static_cast<size_t>(dimensions.x) * dimensions.y;
+        if (sliceVoxels == 0)
+            throw std::runtime_error("Volume has 0 voxels: " + filename);
+        data.resize(sliceVoxels);
+        if (minc2_read_hyperslab(h.get(), hStart.data(), hCount.data(), data.data(),
+                                 MINC2_FLOAT) != MINC2_SUCCESS)
+            throw std::runtime_error("Failed to read slice data: " + filename);
     }
+    else
+    {
+        size_t total_voxels = 1;
+        for (int i = 0; i < ndim; ++i)
+        {
+            total_voxels *= dims[i].length;
+        }
 
-    if (total_voxels == 0)
-        throw std::runtime_error("Volume has 0 voxels: " + filename);
+        if (total_voxels == 0)
+            throw std::runtime_error("Volume has 0 voxels: " + filename);
 
-    data.resize(total_voxels);  // std::bad_alloc propagates naturally
+        data.resize(total_voxels);  // std::bad_alloc propagates naturally
 
-    if (minc2_load_complete_volume(h.get(), data.data(), MINC2_FLOAT) != MINC2_SUCCESS)
-        throw std::runtime_error("Failed to load volume data: " + filename);
+        if (minc2_load_complete_volume(h.get(), data.data(), MINC2_FLOAT) != MINC2_SUCCESS)
+            throw std::runtime_error("Failed to load volume data: " + filename);
+    }
 
     // Calculate min/max for visualization
     min_value = std::numeric_limits<float>::max();
@@ -435,6 +509,7 @@ void Volume::loadLabelDescriptionFile(const std::string& path) {
     }
 
     file.close();
+    contentChanged();
     std::cout << "Loaded " << labelLUT_.size() << " label definitions from " << path << "\n";
 }
 
@@ -473,14 +548,37 @@ std::vector<int> Volume::getUniqueLabelIds() const {
     if (!isLabelVolume_ || data.empty()) {
         return {};
     }
-    std::unordered_set<int> uniqueIds;
-    for (float val : data) {
-        int labelId = static_cast<int>(val + 0.5f);
-        if (labelId != 0) {
-            uniqueIds.insert(labelId);
+    std::lock_guard<std::mutex> lock(labelIdsMutex_);
+    if (!uniqueLabelIdsValid_) {
+        std::unordered_set<int> uniqueIds;
+        for (float val : data) {
+            int labelId = static_cast<int>(val + 0.5f);
+            if (labelId != 0) {
+                uniqueIds.insert(labelId);
+            }
         }
+        uniqueLabelIds_.assign(uniqueIds.begin(), uniqueIds.end());
+        std::sort(uniqueLabelIds_.begin(), uniqueLabelIds_.end());
+        uniqueLabelIdsValid_ = true;
+    }
+    return uniqueLabelIds_;
+}
+
+void Volume::setLabelVolume(bool val) {
+    if (isLabelVolume_ != val) {
+        isLabelVolume_ = val;
+        contentChanged();
     }
-    std::vector<int> result(uniqueIds.begin(), uniqueIds.end());
-    std::sort(result.begin(), result.end());
-    return result;
+}
+
+void Volume::contentChanged() {
+    std::lock_guard<std::mutex> lock(labelIdsMutex_);
+    uniqueLabelIdsValid_ = false;
+    uniqueLabelIds_.clear();
+    contentVersion_ = nextContentVersion();
+}
+
+uint64_t Volume::nextContentVersion() {
+    static std::atomic<uint64_t> counter{0};
+    return ++counter;
 }
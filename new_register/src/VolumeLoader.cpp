@@ -0,0 +1,123 @@
+#include "VolumeLoader.h"
+
+#include <algorithm>
+#include <exception>
+#include <iostream>
+
+#include "AppState.h"  // debugLoggingEnabled
+#include "NiftiVolume.h"
+
+VolumeLoader::VolumeLoader(std::vector<std::string> paths)
+    : paths_(std::move(paths))
+    , total_(paths_.size())
+{
+    std::vector<size_t> minc;
+    for (size_t i = 0; i < paths_.size(); ++i)
+    {
+        if (isNiftiFile(paths_[i]))
+            sharedQueue_.push_back(i);
+        else
+            minc.push_back(i);
+    }
+
+    // The MINC thread counts towards the limit
+    size_t hw = std::max(1u, std::thread::hardware_concurrency());
+    size_t niftiThreads = std::min(sharedQueue_.size(),
+                                   std::max<size_t>(1, hw - (minc.empty() ? 0 : 1)));
+
+    if (!minc.empty())
+        threads_.emplace_back(&VolumeLoader::loadSequential, this, std::move(minc));
+    for (size_t t = 0; t < niftiThreads; ++t)
+        threads_.emplace_back(&VolumeLoader::loadShared, this);
+}
+
+VolumeLoader::~VolumeLoader()
+{
+    // A half-read volume cannot be abandoned; finish and discard
+    for (std::thread& t : threads_)
+        if (t.joinable())
+            t.join();
+}
+
+void VolumeLoader::setNotify(std::function<void()> notify)
+{
+    bool pending = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        notify_ = notify;
+        pending = !loaded_.empty();
+    }
+    if (pending && notify)
+        notify();
+}
+
+std::vector<VolumeLoader::Result> VolumeLoader::takeLoaded()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<Result> out;
+    out.swap(loaded_);
+    taken_ += out.size();
+    return out;
+}
+
+bool VolumeLoader::done() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return taken_ == total_;
+}
+
+void VolumeLoader::waitAll()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    finishedCv_.wait(lock, [this] { return finished_ == total_; });
+}
+
+void VolumeLoader::loadSequential(std::vector<size_t> indices)
+{
+    for (size_t index : indices)
+        load(index);
+}
+
+void VolumeLoader::loadShared()
+{
+    for (;;)
+    {
+        size_t index;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (sharedNext_ >= sharedQueue_.size())
+                return;
+            index = sharedQueue_[sharedNext_++];
+        }
+        load(index);
+    }
+}
+
+void VolumeLoader::load(size_t index)
+{
+    Result result;
+    result.index = index;
+    result.path = paths_[index];
+    try
+    {
+        result.volume.load(result.path);
+        if (debugLoggingEnabled())
+            std::cerr << "[loader] loaded: " << result.path << "\n";
+    }
+    catch (const std::exception& e)
+    {
+        result.volume = Volume();
+        result.error = e.what();
+    }
+
+    std::function<void()> notify;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        loaded_.push_back(std::move(result));
+        ++finished_;
+        notify = notify_;
+    }
+    finishedCv_.notify_all();
+    if (notify)
+        notify();
+}
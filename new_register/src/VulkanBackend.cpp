@@ -1,5 +1,6 @@
 #include "VulkanBackend.h"
 #include "VulkanHelpers.h"
+#include "VulkanVolumeSlicer.h"
 
 #include <imgui.h>
 #include <imgui_internal.h>
@@ -18,6 +19,7 @@
 #include <csetjmp>
 
 #include "AppState.h"
+#include "DiskCache.h"
 
 // ---------------------------------------------------------------------------
 // Vulkan validation layer debug callback
@@ -307,6 +309,8 @@ found:
         vkGetDeviceQueue(device_, queueFamily_, 0, &queue_);
     }
 
+    createPipelineCache();
+
     // Create descriptor pool
     {
         VkDescriptorPoolSize poolSizes[] =
@@ -379,10 +383,17 @@ void VulkanBackend::createSwapchainWindow(int width, int height)
     windowData_.PresentMode = ImGui_ImplVulkanH_SelectPresentMode(
         physicalDevice_, surface_, requestModes, IM_ARRAYSIZE(requestModes));
 
+    // Screenshots and recordings copy straight out of the swapchain images
+    swapchainUsage_ = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    VkSurfaceCapabilitiesKHR caps;
+    if (vkGetPhysicalDeviceSurfaceCapabilitiesKHR(physicalDevice_, surface_, &caps) == VK_SUCCESS &&
+        (caps.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT))
+        swapchainUsage_ |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+
     ImGui_ImplVulkanH_CreateOrResizeWindow(
         instance_, physicalDevice_, device_, &windowData_,
         queueFamily_, allocator_, width, height,
-        minImageCount_, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT);
+        minImageCount_, swapchainUsage_);
 }
 
 // ---------------------------------------------------------------------------
@@ -394,6 +405,91 @@ void VulkanBackend::setWindowHints()
     glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
 }
 
+// ---------------------------------------------------------------------------
+// Pipeline cache
+// ---------------------------------------------------------------------------
+// ImGui's pipelines are compiled at every launch otherwise, which is a
+// noticeable part of startup for short scripted runs.
+
+void VulkanBackend::createPipelineCache()
+{
+    VkPhysicalDeviceProperties props;
+    vkGetPhysicalDeviceProperties(physicalDevice_, &props);
+
+    // One file per driver build: a different GPU or driver update gets a
+    // new UUID and starts from an empty cache without evicting the others
+    std::string dir = userCacheDir();
+    pipelineCachePath_.clear();
+    if (!dir.empty())
+        pipelineCachePath_ = dir + "/vulkan_pipelines_" +
+                             hexString(props.pipelineCacheUUID, VK_UUID_SIZE) + ".bin";
+
+    pipelineCacheLoaded_.clear();
+    if (!pipelineCachePath_.empty() &&
+        readCacheFile(pipelineCachePath_, pipelineCacheLoaded_) &&
+        !pipelineCacheHeaderMatches(pipelineCacheLoaded_, props.vendorID,
+                                    props.deviceID, props.pipelineCacheUUID))
+    {
+        if (debugLoggingEnabled())
+            std::cerr << "[vulkan] Ignoring pipeline cache from another device: "
+                      << pipelineCachePath_ << "\n";
+        pipelineCacheLoaded_.clear();
+    }
+
+    VkPipelineCacheCreateInfo info = {};
+    info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    info.initialDataSize = pipelineCacheLoaded_.size();
+    info.pInitialData = pipelineCacheLoaded_.empty() ? nullptr : pipelineCacheLoaded_.data();
+    VkResult err = vkCreatePipelineCache(device_, &info, allocator_, &pipelineCache_);
+    if (err != VK_SUCCESS && !pipelineCacheLoaded_.empty())
+    {
+        // Rejected data; start empty
+        pipelineCacheLoaded_.clear();
+        info.initialDataSize = 0;
+        info.pInitialData = nullptr;
+        err = vkCreatePipelineCache(device_, &info, allocator_, &pipelineCache_);
+    }
+    checkVkResult(err);
+
+    if (debugLoggingEnabled())
+        std::cerr << "[vulkan] Pipeline cache: "
+                  << (pipelineCacheLoaded_.empty() ? "empty" : "restored")
+                  << " (" << pipelineCacheLoaded_.size() << " bytes"
+                  << (pipelineCachePath_.empty() ? ", not persisted" : "") << ")\n";
+}
+
+void VulkanBackend::savePipelineCache()
+{
+    if (pipelineCache_ == VK_NULL_HANDLE)
+        return;
+
+    size_t size = 0;
+    std::vector<uint8_t> data;
+    if (!pipelineCachePath_.empty() &&
+        vkGetPipelineCacheData(device_, pipelineCache_, &size, nullptr) == VK_SUCCESS &&
+        size > 0)
+    {
+        data.resize(size);
+        if (vkGetPipelineCacheData(device_, pipelineCache_, &size, data.data()) != VK_SUCCESS)
+            size = 0;
+        data.resize(size);
+    }
+
+    // Most runs compile nothing new; don't rewrite an identical file
+    if (!data.empty() && data != pipelineCacheLoaded_)
+    {
+        bool ok = writeCacheFile(pipelineCachePath_, data);
+        if (debugLoggingEnabled())
+            std::cerr << "[vulkan] Pipeline cache " << (ok ? "saved" : "could not be saved")
+                      << ": " << pipelineCachePath_ << " (" << data.size() << " bytes)\n";
+    }
+
+    vkDestroyPipelineCache(device_, pipelineCache_, allocator_);
+    pipelineCache_ = VK_NULL_HANDLE;
+    pipelineCacheLoaded_.clear();
+    pipelineCacheLoaded_.shrink_to_fit();
+}
+
 // ---------------------------------------------------------------------------
 // Public lifecycle
 // ---------------------------------------------------------------------------
@@ -517,6 +613,9 @@ void VulkanBackend::shutdown()
     VkResult err = vkDeviceWaitIdle(device_);
     checkVkResult(err);
 
+    destroyCaptureSlots();
+    destroyFrameFences();
+
     // Destroy swapchain window resources
     ImGui_ImplVulkanH_DestroyWindow(instance_, device_, &windowData_, allocator_);
 
@@ -527,6 +626,8 @@ void VulkanBackend::shutdown()
     vkDestroyDescriptorPool(device_, descriptorPool_, allocator_);
     descriptorPool_ = VK_NULL_HANDLE;
 
+    savePipelineCache();
+
     // Destroy device
     vkDestroyDevice(device_, allocator_);
     device_ = VK_NULL_HANDLE;
@@ -547,8 +648,10 @@ void VulkanBackend::waitIdle()
 {
     if (device_ != VK_NULL_HANDLE)
     {
+        VulkanHelpers::FlushUploads();
         VkResult err = vkDeviceWaitIdle(device_);
         checkVkResult(err);
+        runDeferredReleases(true);
     }
 }
 
@@ -594,7 +697,7 @@ void VulkanBackend::rebuildSwapchain(int width, int height)
             ImGui_ImplVulkanH_CreateOrResizeWindow(
                 instance_, physicalDevice_, device_, &windowData_,
                 queueFamily_, allocator_, width, height,
-                minImageCount_, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT);
+                minImageCount_, swapchainUsage_);
         }
         else
         {
@@ -611,6 +714,8 @@ void VulkanBackend::rebuildSwapchain(int width, int height)
 
     windowData_.FrameIndex = 0;
     swapChainRebuild_ = false;
+    // The rebuild waited for the device: every submitted frame is done
+    pollFrameFences(true);
 }
 
 // ---------------------------------------------------------------------------
@@ -643,6 +748,16 @@ void VulkanBackend::frameRender(ImDrawData* drawData)
     ImGui_ImplVulkanH_Window* wd = &windowData_;
     VkResult err;
 
+    // All texture updates made since the last frame go out in one submit,
+    // ahead of (and ordered before) this frame's draw.
+    VulkanHelpers::FlushUploads();
+    uploadStats_ = VulkanHelpers::TakeUploadStats();
+    if (debugLoggingEnabled() && uploadStats_.copies > 0)
+        std::cerr << "[vulkan] Texture uploads: " << uploadStats_.copies << " copies, "
+                  << (uploadStats_.bytes + 1023) / 1024 << " KB, "
+                  << uploadStats_.submits << " submit(s), "
+                  << uploadStats_.stalls << " stall(s)\n";
+
     VkSemaphore imageAcquired  = wd->FrameSemaphores[wd->SemaphoreIndex].ImageAcquiredSemaphore;
     VkSemaphore renderComplete = wd->FrameSemaphores[wd->SemaphoreIndex].RenderCompleteSemaphore;
 
@@ -692,6 +807,12 @@ void VulkanBackend::frameRender(ImDrawData* drawData)
 
     vkCmdEndRenderPass(fd->CommandBuffer);
 
+    if (requestedCapture_ != 0)
+    {
+        recordCapture(fd->CommandBuffer, fd->Backbuffer, requestedCapture_);
+        requestedCapture_ = 0;
+    }
+
     {
         VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
         VkSubmitInfo submitInfo = {};
@@ -709,6 +830,10 @@ void VulkanBackend::frameRender(ImDrawData* drawData)
         err = vkQueueSubmit(queue_, 1, &submitInfo, fd->Fence);
         checkVkResult(err);
     }
+
+    ++frameCount_;
+    signalFrameFence();
+    runDeferredReleases(false);
 }
 
 void VulkanBackend::framePresent()
@@ -1049,12 +1174,241 @@ std::vector<uint8_t> VulkanBackend::captureScreenshot(int& width, int& height)
     return pixels;
 }
 
+// ---------------------------------------------------------------------------
+// Asynchronous capture
+// ---------------------------------------------------------------------------
+
+bool VulkanBackend::supportsAsyncCapture() const
+{
+    return (swapchainUsage_ & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) != 0;
+}
+
+uint64_t VulkanBackend::requestCapture()
+{
+    if (!supportsAsyncCapture())
+        return 0;
+    if (requestedCapture_ != 0)
+        return requestedCapture_;
+    if (pendingCaptures_.size() >= static_cast<size_t>(kCaptureSlots))
+        return 0;
+    requestedCapture_ = ++lastCaptureId_;
+    return requestedCapture_;
+}
+
+bool VulkanBackend::ensureCaptureBuffer(CaptureSlot& slot, VkDeviceSize size)
+{
+    if (slot.buffer != VK_NULL_HANDLE && slot.capacity >= size)
+        return true;
+    if (slot.buffer != VK_NULL_HANDLE)
+    {
+        vkUnmapMemory(device_, slot.memory);
+        vkDestroyBuffer(device_, slot.buffer, allocator_);
+        vkFreeMemory(device_, slot.memory, allocator_);
+        slot = CaptureSlot{};
+    }
+
+    VkBufferCreateInfo bufInfo = {};
+    bufInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufInfo.size  = size;
+    bufInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    bufInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    if (vkCreateBuffer(device_, &bufInfo, allocator_, &slot.buffer) != VK_SUCCESS)
+    {
+        slot.buffer = VK_NULL_HANDLE;
+        return false;
+    }
+
+    VkMemoryRequirements memReqs;
+    vkGetBufferMemoryRequirements(device_, slot.buffer, &memReqs);
+
+    // Cached memory makes the CPU-side copy fast; coherent avoids
+    // invalidating mapped ranges.
+    VkPhysicalDeviceMemoryProperties memProps;
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice_, &memProps);
+    const VkMemoryPropertyFlags wanted[] = {
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT |
+            VK_MEMORY_PROPERTY_HOST_CACHED_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+    };
+    uint32_t memTypeIndex = UINT32_MAX;
+    for (VkMemoryPropertyFlags flags : wanted)
+    {
+        for (uint32_t i = 0; i < memProps.memoryTypeCount && memTypeIndex == UINT32_MAX; ++i)
+            if ((memReqs.memoryTypeBits & (1u << i)) &&
+                (memProps.memoryTypes[i].propertyFlags & flags) == flags)
+                memTypeIndex = i;
+        if (memTypeIndex != UINT32_MAX)
+            break;
+    }
+
+    VkMemoryAllocateInfo allocInfo = {};
+    allocInfo.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize  = memReqs.size;
+    allocInfo.memoryTypeIndex = memTypeIndex;
+    if (memTypeIndex == UINT32_MAX ||
+        vkAllocateMemory(device_, &allocInfo, allocator_, &slot.memory) != VK_SUCCESS)
+    {
+        vkDestroyBuffer(device_, slot.buffer, allocator_);
+        slot = CaptureSlot{};
+        return false;
+    }
+    if (vkBindBufferMemory(device_, slot.buffer, slot.memory, 0) != VK_SUCCESS ||
+        vkMapMemory(device_, slot.memory, 0, VK_WHOLE_SIZE, 0, &slot.mapped) != VK_SUCCESS)
+    {
+        vkDestroyBuffer(device_, slot.buffer, allocator_);
+        vkFreeMemory(device_, slot.memory, allocator_);
+        slot = CaptureSlot{};
+        return false;
+    }
+    slot.capacity = size;
+    return true;
+}
+
+void VulkanBackend::recordCapture(VkCommandBuffer cmd, VkImage image, uint64_t id)
+{
+    int index = -1;
+    for (int i = 0; i < kCaptureSlots && index < 0; ++i)
+        if (!captureSlots_[i].pending)
+            index = i;
+    if (index < 0)
+        return;
+
+    CaptureSlot& slot = captureSlots_[index];
+    const int width  = static_cast<int>(windowData_.Width);
+    const int height = static_cast<int>(windowData_.Height);
+    if (width <= 0 || height <= 0 ||
+        !ensureCaptureBuffer(slot, static_cast<VkDeviceSize>(width) * height * 4))
+    {
+        std::cerr << "[vulkan] Screenshot: failed to allocate readback buffer\n";
+        return;
+    }
+
+    // The render pass leaves the image in PRESENT_SRC
+    VkImageMemoryBarrier barrier = {};
+    barrier.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout           = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    barrier.newLayout           = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image               = image;
+    barrier.subresourceRange    = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+    barrier.srcAccessMask       = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    barrier.dstAccessMask       = VK_ACCESS_TRANSFER_READ_BIT;
+    vkCmdPipelineBarrier(cmd,
+        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    VkBufferImageCopy region = {};
+    region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+    region.imageExtent      = { static_cast<uint32_t>(width),
+                                static_cast<uint32_t>(height), 1 };
+    vkCmdCopyImageToBuffer(cmd, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                           slot.buffer, 1, &region);
+
+    barrier.oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.newLayout     = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barrier.dstAccessMask = 0;
+
+    VkBufferMemoryBarrier hostBarrier = {};
+    hostBarrier.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    hostBarrier.srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT;
+    hostBarrier.dstAccessMask       = VK_ACCESS_HOST_READ_BIT;
+    hostBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    hostBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    hostBarrier.buffer              = slot.buffer;
+    hostBarrier.size                = VK_WHOLE_SIZE;
+    vkCmdPipelineBarrier(cmd,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT | VK_PIPELINE_STAGE_HOST_BIT,
+        0, 0, nullptr, 1, &hostBarrier, 1, &barrier);
+
+    const VkFormat format = windowData_.SurfaceFormat.format;
+    slot.width   = width;
+    slot.height  = height;
+    slot.swizzle = (format == VK_FORMAT_B8G8R8A8_UNORM || format == VK_FORMAT_B8G8R8A8_SRGB);
+    slot.frame   = frameCount_;
+    slot.id      = id;
+    slot.pending = true;
+    pendingCaptures_.push_back(index);
+}
+
+bool VulkanBackend::takeCapture(std::vector<uint8_t>& pixels, int& width, int& height,
+                                uint64_t& id)
+{
+    if (pendingCaptures_.empty())
+        return false;
+    CaptureSlot& slot = captureSlots_[pendingCaptures_.front()];
+
+    // The copy was recorded into frame slot.frame + 1; map it only once
+    // that frame's fence has signalled.
+    pollFrameFences(false);
+    if (completedFrames_ <= slot.frame)
+        return false;
+
+    id     = slot.id;
+    width  = slot.width;
+    height = slot.height;
+    const size_t bytes = static_cast<size_t>(width) * height * 4;
+    pixels.resize(bytes);
+    std::memcpy(pixels.data(), slot.mapped, bytes);
+    if (slot.swizzle)
+    {
+        for (size_t i = 0; i < bytes; i += 4)
+            std::swap(pixels[i], pixels[i + 2]);
+    }
+
+    slot.pending = false;
+    pendingCaptures_.pop_front();
+    return true;
+}
+
+void VulkanBackend::destroyCaptureSlots()
+{
+    for (CaptureSlot& slot : captureSlots_)
+    {
+        if (slot.buffer == VK_NULL_HANDLE)
+            continue;
+        vkUnmapMemory(device_, slot.memory);
+        vkDestroyBuffer(device_, slot.buffer, allocator_);
+        vkFreeMemory(device_, slot.memory, allocator_);
+        slot = CaptureSlot{};
+    }
+    pendingCaptures_.clear();
+    requestedCapture_ = 0;
+}
+
 // ---------------------------------------------------------------------------
 // Texture management (wraps VulkanHelpers)
 // ---------------------------------------------------------------------------
 
 std::unique_ptr<Texture> VulkanBackend::createTexture(int w, int h, const void* data)
 {
+    if (TextureAtlas::Handle handle = allocateAtlasRegion(w, h))
+    {
+        auto tex = std::make_unique<Texture>();
+        tex->width  = w;
+        tex->height = h;
+
+        // Clear the region and its gutter: a previous occupant may have
+        // left pixels there, and the gutter must stay black so filtering
+        // at the edges matches the standalone textures' black border.
+        AtlasRegion padded = atlas_.paddedRegion(handle);
+        VulkanTexture* page = atlasPages_[padded.page].get();
+        VulkanHelpers::UpdateTextureRegion(page, padded.x, padded.y,
+                                           padded.width, padded.height, nullptr);
+        if (data)
+        {
+            const AtlasRegion& r = atlas_.region(handle);
+            VulkanHelpers::UpdateTextureRegion(page, r.x, r.y, w, h, data);
+        }
+
+        applyAtlasRegion(tex.get(), handle);
+        atlasTextures_[tex.get()] = handle;
+        return tex;
+    }
+
     auto vkTex = VulkanHelpers::CreateTexture(w, h, data);
     if (!vkTex)
         return nullptr;
@@ -1072,6 +1426,16 @@ std::unique_ptr<Texture> VulkanBackend::createTexture(int w, int h, const void*
 void VulkanBackend::updateTexture(Texture* tex, const void* data)
 {
     if (!tex) return;
+    auto at = atlasTextures_.find(tex);
+    if (at != atlasTextures_.end())
+    {
+        if (!data)
+            throw std::runtime_error("updateTexture: null data pointer");
+        const AtlasRegion& r = atlas_.region(at->second);
+        VulkanHelpers::UpdateTextureRegion(atlasPages_[r.page].get(), r.x, r.y,
+                                           r.width, r.height, data);
+        return;
+    }
     auto it = vulkanTextures_.find(tex->id);
     if (it != vulkanTextures_.end())
         VulkanHelpers::UpdateTexture(it->second.get(), data);
@@ -1080,17 +1444,257 @@ void VulkanBackend::updateTexture(Texture* tex, const void* data)
 void VulkanBackend::destroyTexture(Texture* tex)
 {
     if (!tex) return;
+    auto at = atlasTextures_.find(tex);
+    if (at != atlasTextures_.end())
+    {
+        // The page stays; the region is cleared when it is handed out again,
+        // which must not happen while in-flight frames still show it
+        TextureAtlas::Handle handle = at->second;
+        atlasTextures_.erase(at);
+        deferRelease([this, handle]() { atlas_.release(handle); });
+        tex->id  = 0;
+        tex->uv0 = ImVec2(0.0f, 0.0f);
+        tex->uv1 = ImVec2(1.0f, 1.0f);
+        return;
+    }
     auto it = vulkanTextures_.find(tex->id);
     if (it != vulkanTextures_.end())
     {
-        VulkanHelpers::DestroyTexture(it->second.get());
+        std::shared_ptr<VulkanTexture> retired(std::move(it->second));
         vulkanTextures_.erase(it);
+        deferRelease([retired]() mutable { retired.reset(); });
     }
     tex->id = 0;
 }
 
+TextureAtlas::Handle VulkanBackend::allocateAtlasRegion(int w, int h)
+{
+    if (!atlas_.accepts(w, h))
+        return 0;
+
+    TextureAtlas::Handle handle = atlas_.allocate(w, h);
+    if (handle)
+        return handle;
+
+    // Holes left by textures of other sizes (e.g. after a QC row with
+    // different volume dimensions) are recovered before the atlas grows.
+    int victim = atlas_.compactionCandidate(w, h);
+    if (victim >= 0 && compactAtlasPage(victim))
+        handle = atlas_.allocate(w, h);
+    if (handle)
+        return handle;
+
+    int page = atlas_.addPage();
+    if (page < 0)
+        return 0;
+    createAtlasPage(page);
+    return atlas_.allocate(w, h);
+}
+
+void VulkanBackend::createAtlasPage(int page)
+{
+    if (static_cast<int>(atlasPages_.size()) <= page)
+        atlasPages_.resize(page + 1);
+    atlasPages_[page] = VulkanHelpers::CreateTexture(kAtlasPageSize, kAtlasPageSize, nullptr);
+    if (debugLoggingEnabled())
+        std::cerr << "[vulkan] Opened texture atlas page " << page << " ("
+                  << kAtlasPageSize << "x" << kAtlasPageSize << ")\n";
+}
+
+bool VulkanBackend::compactAtlasPage(int page)
+{
+    std::vector<TextureAtlas::Move> moves = atlas_.compact(page);
+    if (moves.empty())
+        return false;
+
+    int target = moves.front().to.page;
+    createAtlasPage(target);
+
+    // Copy each texture with its gutter, so the new page needs no clear
+    const int g = atlas_.gutter();
+    std::vector<VkImageCopy> copies;
+    copies.reserve(moves.size());
+    for (const TextureAtlas::Move& m : moves)
+    {
+        VkImageCopy c = {};
+        c.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        c.srcSubresource.layerCount = 1;
+        c.dstSubresource = c.srcSubresource;
+        c.srcOffset = {m.from.x - g, m.from.y - g, 0};
+        c.dstOffset = {m.to.x - g, m.to.y - g, 0};
+        c.extent = {static_cast<uint32_t>(m.from.width + 2 * g),
+                    static_cast<uint32_t>(m.from.height + 2 * g), 1};
+        copies.push_back(c);
+    }
+    VulkanHelpers::CopyTextureRegions(atlasPages_[page].get(), atlasPages_[target].get(),
+                                      copies);
+
+    for (auto& entry : atlasTextures_)
+        if (atlas_.region(entry.second).page == target)
+            applyAtlasRegion(entry.first, entry.second);
+
+    std::shared_ptr<VulkanTexture> retired(std::move(atlasPages_[page]));
+    deferRelease([retired]() mutable { retired.reset(); });
+
+    if (debugLoggingEnabled())
+        std::cerr << "[vulkan] Compacted texture atlas page " << page << " into page "
+                  << target << " (" << moves.size() << " textures moved)\n";
+    return true;
+}
+
+void VulkanBackend::applyAtlasRegion(Texture* tex, TextureAtlas::Handle handle)
+{
+    const AtlasRegion& r = atlas_.region(handle);
+    const float scale = 1.0f / static_cast<float>(kAtlasPageSize);
+    tex->id  = reinterpret_cast<ImTextureID>(atlasPages_[r.page]->descriptor_set);
+    tex->uv0 = ImVec2(r.x * scale, r.y * scale);
+    tex->uv1 = ImVec2((r.x + r.width) * scale, (r.y + r.height) * scale);
+}
+
+void VulkanBackend::signalFrameFence()
+{
+    VkFence fence = VK_NULL_HANDLE;
+    if (!freeFences_.empty())
+    {
+        fence = freeFences_.back();
+        freeFences_.pop_back();
+    }
+    else
+    {
+        VkFenceCreateInfo info = {};
+        info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        VkResult err = vkCreateFence(device_, &info, allocator_, &fence);
+        checkVkResult(err);
+    }
+
+    // An empty submit signals its fence once all earlier work on the queue
+    // has completed.
+    VkResult err = vkQueueSubmit(queue_, 0, nullptr, fence);
+    checkVkResult(err);
+    frameFences_.push_back(FrameFence{fence, frameCount_});
+}
+
+void VulkanBackend::pollFrameFences(bool idle)
+{
+    while (!frameFences_.empty())
+    {
+        const FrameFence& front = frameFences_.front();
+        if (!idle && vkGetFenceStatus(device_, front.fence) != VK_SUCCESS)
+            break;
+        VkResult err = vkResetFences(device_, 1, &front.fence);
+        checkVkResult(err);
+        completedFrames_ = front.frame;
+        freeFences_.push_back(front.fence);
+        frameFences_.pop_front();
+    }
+    if (idle)
+        completedFrames_ = frameCount_;
+}
+
+void VulkanBackend::destroyFrameFences()
+{
+    for (const FrameFence& f : frameFences_)
+        vkDestroyFence(device_, f.fence, allocator_);
+    for (VkFence fence : freeFences_)
+        vkDestroyFence(device_, fence, allocator_);
+    frameFences_.clear();
+    freeFences_.clear();
+}
+
+void VulkanBackend::deferRelease(std::function<void()> release)
+{
+    deferredReleases_.push_back(DeferredRelease{frameCount_, std::move(release)});
+}
+
+void VulkanBackend::runDeferredReleases(bool idle)
+{
+    // A release queued after frame N may still be referenced by frame N+1
+    // (draw data recorded before the release), so it waits for that frame.
+    pollFrameFences(idle);
+    while (!deferredReleases_.empty() &&
+           (idle || completedFrames_ > deferredReleases_.front().frame))
+    {
+        // Pop first: a release may queue further releases
+        std::function<void()> release = std::move(deferredReleases_.front().release);
+        deferredReleases_.pop_front();
+        release();
+    }
+}
+
 void VulkanBackend::shutdownTextureSystem()
 {
+    // Submit slices still recorded into the upload batch before their
+    // descriptor sets go away
+    VulkanHelpers::FlushUploads();
+    if (slicer_)
+        slicer_->shutdown();
+    slicer_.reset();
+
+    // Frames still in flight sample the textures freed below
+    VkResult err = vkDeviceWaitIdle(device_);
+    checkVkResult(err);
+
     vulkanTextures_.clear();  // ~VulkanTexture() cleans up GPU resources
+    runDeferredReleases(true);
+    atlasTextures_.clear();
+    atlasPages_.clear();
+    atlas_ = TextureAtlas(kAtlasPageSize, kMaxAtlasPages);
     VulkanHelpers::Shutdown();
 }
+
+// ---------------------------------------------------------------------------
+// GPU volume slicing
+// ---------------------------------------------------------------------------
+
+VulkanVolumeSlicer* VulkanBackend::slicer() const
+{
+    if (!slicerProbed_ && device_ != VK_NULL_HANDLE)
+    {
+        slicerProbed_ = true;
+        slicer_ = std::make_unique<VulkanVolumeSlicer>();
+        if (!slicer_->initialize(physicalDevice_, device_, queueFamily_, queue_, pipelineCache_))
+            slicer_.reset();
+    }
+    return slicer_.get();
+}
+
+bool VulkanBackend::supportsVolumeSlicing() const
+{
+    return slicer() && slicer_->supported();
+}
+
+std::unique_ptr<VolumeTexture> VulkanBackend::createVolumeTexture(
+    int dimX, int dimY, int dimZ, const float* data)
+{
+    if (!supportsVolumeSlicing())
+        return nullptr;
+    return slicer_->createVolumeTexture(dimX, dimY, dimZ, data);
+}
+
+void VulkanBackend::destroyVolumeTexture(VolumeTexture* vt)
+{
+    if (slicer_)
+        slicer_->destroyVolumeTexture(vt);
+}
+
+bool VulkanBackend::renderVolumeSlice(Texture* tex, const VolumeSliceLayer* layers,
+                                      int count, bool blend)
+{
+    if (!tex || !supportsVolumeSlicing())
+        return false;
+
+    // Atlas textures are a rectangle of their page; the dispatch writes
+    // only that rectangle, so the gutter stays black
+    auto at = atlasTextures_.find(tex);
+    if (at != atlasTextures_.end())
+    {
+        const AtlasRegion& r = atlas_.region(at->second);
+        return slicer_->render(atlasPages_[r.page].get(), r.x, r.y, r.width, r.height,
+                               layers, count, blend);
+    }
+    auto it = vulkanTextures_.find(tex->id);
+    if (it == vulkanTextures_.end())
+        return false;
+    return slicer_->render(it->second.get(), 0, 0, tex->width, tex->height,
+                           layers, count, blend);
+}
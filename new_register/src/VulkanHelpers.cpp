@@ -1,10 +1,12 @@
 #include "VulkanHelpers.h"
 #include <backends/imgui_impl_vulkan.h>
+#include <algorithm>
 #include <cstdio>
 #include <cstring>
 #include <stdexcept>
 #include <string>
 #include <memory>
+#include <vector>
 
 static VkDevice g_Device = VK_NULL_HANDLE;
 static VkPhysicalDevice g_PhysicalDevice = VK_NULL_HANDLE;
@@ -13,31 +15,50 @@ static VkQueue g_Queue = VK_NULL_HANDLE;
 static VkDescriptorPool g_DescriptorPool = VK_NULL_HANDLE;
 static VkCommandPool g_CommandPool = VK_NULL_HANDLE;
 
-/// Persistent staging resources reused across all UpdateTexture calls.
-/// The buffer grows to accommodate the largest texture and is never shrunk.
-/// The command buffer is allocated once and reset before each use.
-/// uploadFence is signaled when the previous upload completes; waited on
-/// at the *start* of the next upload so the GPU can process the previous
-/// upload in parallel with CPU-side pixel generation.
-struct StagingResources {
+/// One slot of the upload ring: a persistently mapped staging buffer used as
+/// a linear allocator, plus the command buffer all of a frame's texture
+/// copies are recorded into and the fence signalled when they complete.
+/// Slots are used round-robin, one per frame, so a slot's fence has normally
+/// long been signalled by the time it is reused and the host never stalls.
+struct UploadFrame {
     VkBuffer buffer = VK_NULL_HANDLE;
     VkDeviceMemory memory = VK_NULL_HANDLE;
-    VkCommandPool commandPool = VK_NULL_HANDLE;  ///< Dedicated pool, independent of frame render pool.
     VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
-    VkFence uploadFence = VK_NULL_HANDLE;        ///< Signaled when the previous upload completes.
+    VkFence fence = VK_NULL_HANDLE;              ///< Signaled when the slot's copies complete.
     void* mappedPtr = nullptr;
     VkDeviceSize capacity = 0;
+    VkDeviceSize used = 0;                       ///< Bytes allocated in the current batch.
+    uint64_t serial = 0;                         ///< Batch recorded in this slot (0 = never).
+    bool recording = false;                      ///< Command buffer is open.
 
     /// Ensure the staging buffer can hold at least `requiredSize` bytes.
     /// Re-allocates (rounding up to the next power of 2) only when the
-    /// current capacity is insufficient.
+    /// current capacity is insufficient.  The slot must be idle.
     void ensureCapacity(VkDeviceSize requiredSize);
 
     /// Release all Vulkan resources.  Called once at application shutdown.
-    void destroy();
+    void destroy(VkCommandPool pool);
+};
+
+/// Staging slots: one more than the usual two frames in flight, so the
+/// slot being reused is at least two frames old.
+static constexpr int kUploadFrames = 3;
+
+/// Offset alignment inside a staging buffer (covers texel size and
+/// optimalBufferCopyOffsetAlignment on all common devices).
+static constexpr VkDeviceSize kStagingAlignment = 256;
+
+/// Per-frame-in-flight texture upload ring.
+struct UploadRing {
+    VkCommandPool commandPool = VK_NULL_HANDLE;  ///< Dedicated pool, independent of frame render pool.
+    UploadFrame frames[kUploadFrames];
+    int current = 0;                             ///< Slot receiving this frame's copies.
+    uint64_t nextSerial = 1;
+    VkDeviceSize batchHint = 0;                  ///< Largest batch seen; new slots grow to it.
+    VulkanHelpers::UploadStats stats;            ///< Accumulated since TakeUploadStats().
 };
 
-static StagingResources g_Staging;
+static UploadRing g_Uploads;
 
 static uint32_t findMemoryType(uint32_t type_filter, VkMemoryPropertyFlags properties) {
     VkPhysicalDeviceMemoryProperties mem_properties;
@@ -60,7 +81,7 @@ static VkDeviceSize nextPow2(VkDeviceSize v)
     return v + 1;
 }
 
-void StagingResources::ensureCapacity(VkDeviceSize requiredSize)
+void UploadFrame::ensureCapacity(VkDeviceSize requiredSize)
 {
     if (requiredSize <= capacity)
         return;
@@ -92,7 +113,7 @@ void StagingResources::ensureCapacity(VkDeviceSize requiredSize)
     bufInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
     VkResult err = vkCreateBuffer(g_Device, &bufInfo, nullptr, &buffer);
     if (err != VK_SUCCESS)
-        throw std::runtime_error("StagingResources::ensureCapacity: vkCreateBuffer failed");
+        throw std::runtime_error("UploadFrame::ensureCapacity: vkCreateBuffer failed");
 
     VkMemoryRequirements memReqs;
     vkGetBufferMemoryRequirements(g_Device, buffer, &memReqs);
@@ -100,7 +121,7 @@ void StagingResources::ensureCapacity(VkDeviceSize requiredSize)
     uint32_t memType = findMemoryType(memReqs.memoryTypeBits,
         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
     if (memType == 0xFFFFFFFF)
-        throw std::runtime_error("StagingResources::ensureCapacity: no suitable memory type");
+        throw std::runtime_error("UploadFrame::ensureCapacity: no suitable memory type");
 
     VkMemoryAllocateInfo allocInfo = {};
     allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
@@ -108,32 +129,32 @@ void StagingResources::ensureCapacity(VkDeviceSize requiredSize)
     allocInfo.memoryTypeIndex = memType;
     err = vkAllocateMemory(g_Device, &allocInfo, nullptr, &memory);
     if (err != VK_SUCCESS)
-        throw std::runtime_error("StagingResources::ensureCapacity: vkAllocateMemory failed");
+        throw std::runtime_error("UploadFrame::ensureCapacity: vkAllocateMemory failed");
 
     err = vkBindBufferMemory(g_Device, buffer, memory, 0);
     if (err != VK_SUCCESS)
     {
         vkFreeMemory(g_Device, memory, nullptr);
         vkDestroyBuffer(g_Device, buffer, nullptr);
-        throw std::runtime_error("StagingResources::ensureCapacity: vkBindBufferMemory failed");
+        throw std::runtime_error("UploadFrame::ensureCapacity: vkBindBufferMemory failed");
     }
 
     // Persistently map (HOST_COHERENT — no explicit flush needed).
     err = vkMapMemory(g_Device, memory, 0, newCap, 0, &mappedPtr);
     if (err != VK_SUCCESS)
-        throw std::runtime_error("StagingResources::ensureCapacity: vkMapMemory failed");
+        throw std::runtime_error("UploadFrame::ensureCapacity: vkMapMemory failed");
 
     capacity = newCap;
 }
 
-void StagingResources::destroy()
+void UploadFrame::destroy(VkCommandPool pool)
 {
-    // Wait for any in-flight upload to finish before tearing down resources.
-    if (uploadFence != VK_NULL_HANDLE)
+    // Wait for in-flight copies to finish before tearing down resources.
+    if (fence != VK_NULL_HANDLE)
     {
-        vkWaitForFences(g_Device, 1, &uploadFence, VK_TRUE, UINT64_MAX);
-        vkDestroyFence(g_Device, uploadFence, nullptr);
-        uploadFence = VK_NULL_HANDLE;
+        vkWaitForFences(g_Device, 1, &fence, VK_TRUE, UINT64_MAX);
+        vkDestroyFence(g_Device, fence, nullptr);
+        fence = VK_NULL_HANDLE;
     }
     if (mappedPtr)
     {
@@ -142,14 +163,9 @@ void StagingResources::destroy()
     }
     if (commandBuffer != VK_NULL_HANDLE)
     {
-        vkFreeCommandBuffers(g_Device, commandPool, 1, &commandBuffer);
+        vkFreeCommandBuffers(g_Device, pool, 1, &commandBuffer);
         commandBuffer = VK_NULL_HANDLE;
     }
-    if (commandPool != VK_NULL_HANDLE)
-    {
-        vkDestroyCommandPool(g_Device, commandPool, nullptr);
-        commandPool = VK_NULL_HANDLE;
-    }
     if (buffer != VK_NULL_HANDLE)
     {
         vkDestroyBuffer(g_Device, buffer, nullptr);
@@ -161,6 +177,116 @@ void StagingResources::destroy()
         memory = VK_NULL_HANDLE;
     }
     capacity = 0;
+    used = 0;
+    serial = 0;
+    recording = false;
+}
+
+/// Open the current slot for recording if it is not already, waiting for
+/// its previous batch (normally long complete) and growing its staging
+/// buffer to at least `minCapacity` while it is idle.
+static UploadFrame& beginBatch(VkDeviceSize minCapacity)
+{
+    UploadFrame& f = g_Uploads.frames[g_Uploads.current];
+    if (f.recording)
+        return f;
+
+    if (vkGetFenceStatus(g_Device, f.fence) == VK_NOT_READY)
+        ++g_Uploads.stats.stalls;
+    VkResult err = vkWaitForFences(g_Device, 1, &f.fence, VK_TRUE, UINT64_MAX);
+    if (err != VK_SUCCESS)
+        throw std::runtime_error("UpdateTexture: vkWaitForFences failed");
+    err = vkResetFences(g_Device, 1, &f.fence);
+    if (err != VK_SUCCESS)
+        throw std::runtime_error("UpdateTexture: vkResetFences failed");
+
+    f.ensureCapacity(minCapacity);
+
+    err = vkResetCommandBuffer(f.commandBuffer, 0);
+    if (err != VK_SUCCESS)
+        throw std::runtime_error("UpdateTexture: vkResetCommandBuffer failed");
+
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    err = vkBeginCommandBuffer(f.commandBuffer, &beginInfo);
+    if (err != VK_SUCCESS)
+        throw std::runtime_error("UpdateTexture: vkBeginCommandBuffer failed");
+
+    f.used = 0;
+    f.serial = g_Uploads.nextSerial++;
+    f.recording = true;
+    return f;
+}
+
+/// Wait until the batch with the given serial has completed on the GPU.
+static void waitForBatch(uint64_t serial)
+{
+    for (UploadFrame& f : g_Uploads.frames)
+        if (f.serial == serial && !f.recording)
+            vkWaitForFences(g_Device, 1, &f.fence, VK_TRUE, UINT64_MAX);
+}
+
+/// Record the transition of @p tex into a transfer layout.  On first use
+/// the image is UNDEFINED (contents discarded); afterwards it is
+/// SHADER_READ_ONLY_OPTIMAL.
+static void toTransferLayout(VkCommandBuffer cb, const VulkanTexture* tex, VkImageLayout layout)
+{
+    VkImageMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = tex->uploaded
+        ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+        : VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = layout;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = tex->image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+    barrier.srcAccessMask = tex->uploaded
+        ? (VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT)
+        : static_cast<VkAccessFlags>(0);
+    barrier.dstAccessMask = (layout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL)
+        ? VK_ACCESS_TRANSFER_READ_BIT
+        : VK_ACCESS_TRANSFER_WRITE_BIT;
+
+    // A texture written twice in one batch must also wait for its
+    // earlier copy, hence the TRANSFER source stage.
+    VkPipelineStageFlags srcStage = tex->uploaded
+        ? (VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT)
+        : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+    vkCmdPipelineBarrier(cb, srcStage,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+/// Record the transition of @p tex from transfer @p layout back to
+/// SHADER_READ_ONLY_OPTIMAL.
+static void toShaderReadLayout(VkCommandBuffer cb, const VulkanTexture* tex, VkImageLayout layout)
+{
+    VkImageMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = layout;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = tex->image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+    barrier.srcAccessMask = (layout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL)
+        ? VK_ACCESS_TRANSFER_READ_BIT
+        : VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+    vkCmdPipelineBarrier(cb,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        0, 0, nullptr, 0, nullptr, 1, &barrier);
 }
 
 namespace VulkanHelpers {
@@ -171,7 +297,7 @@ void Init(VkDevice device, VkPhysicalDevice physical_device, uint32_t queue_fami
     g_QueueFamily = queue_family;
     g_Queue = queue;
     g_DescriptorPool = pool;
-    g_CommandPool = command_pool;  // Kept for reference; staging uses its own pool below.
+    g_CommandPool = command_pool;  // Kept for reference; uploads use their own pool below.
 
     // Create a dedicated command pool for texture uploads, independent of the
     // frame render pool so that frame resets cannot invalidate upload commands.
@@ -179,28 +305,32 @@ void Init(VkDevice device, VkPhysicalDevice physical_device, uint32_t queue_fami
     poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
     poolInfo.queueFamilyIndex = queue_family;
     poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-    VkResult err = vkCreateCommandPool(g_Device, &poolInfo, nullptr, &g_Staging.commandPool);
+    VkResult err = vkCreateCommandPool(g_Device, &poolInfo, nullptr, &g_Uploads.commandPool);
     if (err != VK_SUCCESS)
         throw std::runtime_error("VulkanHelpers::Init: failed to create upload command pool");
 
-    // Allocate the persistent upload command buffer from the dedicated pool.
-    VkCommandBufferAllocateInfo cbAllocInfo = {};
-    cbAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    cbAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    cbAllocInfo.commandPool = g_Staging.commandPool;
-    cbAllocInfo.commandBufferCount = 1;
-    err = vkAllocateCommandBuffers(g_Device, &cbAllocInfo, &g_Staging.commandBuffer);
-    if (err != VK_SUCCESS)
-        throw std::runtime_error("VulkanHelpers::Init: failed to allocate upload command buffer");
-
-    // Create the upload fence pre-signaled so the first UpdateTexture() call
-    // does not wait on an unsignaled fence.
-    VkFenceCreateInfo fenceInfo = {};
-    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-    fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-    err = vkCreateFence(g_Device, &fenceInfo, nullptr, &g_Staging.uploadFence);
-    if (err != VK_SUCCESS)
-        throw std::runtime_error("VulkanHelpers::Init: failed to create upload fence");
+    for (UploadFrame& f : g_Uploads.frames)
+    {
+        // One persistent upload command buffer per ring slot.
+        VkCommandBufferAllocateInfo cbAllocInfo = {};
+        cbAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        cbAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        cbAllocInfo.commandPool = g_Uploads.commandPool;
+        cbAllocInfo.commandBufferCount = 1;
+        err = vkAllocateCommandBuffers(g_Device, &cbAllocInfo, &f.commandBuffer);
+        if (err != VK_SUCCESS)
+            throw std::runtime_error("VulkanHelpers::Init: failed to allocate upload command buffer");
+
+        // Pre-signaled so the first batch in each slot does not wait.
+        VkFenceCreateInfo fenceInfo = {};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+        err = vkCreateFence(g_Device, &fenceInfo, nullptr, &f.fence);
+        if (err != VK_SUCCESS)
+            throw std::runtime_error("VulkanHelpers::Init: failed to create upload fence");
+    }
+    g_Uploads.current = 0;
+    g_Uploads.stats = UploadStats{};
 }
 
 std::unique_ptr<VulkanTexture> CreateTexture(int w, int h, const void* data) {
@@ -230,7 +360,9 @@ std::unique_ptr<VulkanTexture> CreateTexture(int w, int h, const void* data) {
         info.arrayLayers = 1;
         info.samples = VK_SAMPLE_COUNT_1_BIT;
         info.tiling = VK_IMAGE_TILING_OPTIMAL;
-        info.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+        info.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+                     VK_IMAGE_USAGE_TRANSFER_SRC_BIT |  // atlas compaction copies
+                     VK_IMAGE_USAGE_STORAGE_BIT;        // GPU slicing writes
         info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
         info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
         err = vkCreateImage(g_Device, &info, nullptr, &tex->image);
@@ -301,133 +433,156 @@ std::unique_ptr<VulkanTexture> CreateTexture(int w, int h, const void* data) {
 void UpdateTexture(VulkanTexture* tex, const void* data) {
     if (!data || !tex)
         throw std::runtime_error("UpdateTexture: null texture or data pointer");
+    UpdateTextureRegion(tex, 0, 0, tex->width, tex->height, data);
+}
 
-    VkDeviceSize image_size = tex->width * tex->height * 4;
-
-    // Wait for the previous upload to complete before reusing the staging
-    // buffer and command buffer.  The fence is pre-signaled at Init() so this
-    // is a no-op on the first call.  This replaces the old vkQueueWaitIdle
-    // call and allows the GPU to process the previous upload in parallel with
-    // the CPU-side pixel generation that happens before UpdateTexture().
-    VkResult err = vkWaitForFences(g_Device, 1, &g_Staging.uploadFence, VK_TRUE, UINT64_MAX);
-    if (err != VK_SUCCESS)
-        throw std::runtime_error("UpdateTexture: vkWaitForFences failed");
-    err = vkResetFences(g_Device, 1, &g_Staging.uploadFence);
-    if (err != VK_SUCCESS)
-        throw std::runtime_error("UpdateTexture: vkResetFences failed");
-
-    // Grow the persistent staging buffer if needed (no-op when large enough).
-    g_Staging.ensureCapacity(image_size);
-
-    // Copy pixel data into the persistently-mapped staging buffer.
-    std::memcpy(g_Staging.mappedPtr, data, static_cast<size_t>(image_size));
-
-    // Reset and re-record the persistent command buffer.
-    err = vkResetCommandBuffer(g_Staging.commandBuffer, 0);
-    if (err != VK_SUCCESS)
-        throw std::runtime_error("UpdateTexture: vkResetCommandBuffer failed");
+void UpdateTextureRegion(VulkanTexture* tex, int x, int y, int w, int h, const void* data) {
+    if (!tex)
+        throw std::runtime_error("UpdateTextureRegion: null texture");
 
-    VkCommandBufferBeginInfo beginInfo = {};
-    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-    err = vkBeginCommandBuffer(g_Staging.commandBuffer, &beginInfo);
-    if (err != VK_SUCCESS)
-        throw std::runtime_error("UpdateTexture: vkBeginCommandBuffer failed");
+    VkDeviceSize image_size = static_cast<VkDeviceSize>(w) * h * 4;
 
-    // Transition to TRANSFER_DST.
-    // On first upload the image is UNDEFINED; on subsequent uploads
-    // it is SHADER_READ_ONLY_OPTIMAL.
+    // Sub-allocate from the current slot's staging buffer.  When the batch
+    // is full, submit it and continue in the next slot, sized for the whole
+    // batch so later frames with the same update load fit in one submit.
+    UploadFrame* f = &beginBatch(std::max(image_size, g_Uploads.batchHint));
+    VkDeviceSize offset = (f->used + kStagingAlignment - 1) & ~(kStagingAlignment - 1);
+    if (offset + image_size > f->capacity)
     {
-        VkImageMemoryBarrier barrier = {};
-        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        barrier.oldLayout = tex->uploaded
-            ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
-            : VK_IMAGE_LAYOUT_UNDEFINED;
-        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.image = tex->image;
-        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        barrier.subresourceRange.baseMipLevel = 0;
-        barrier.subresourceRange.levelCount = 1;
-        barrier.subresourceRange.baseArrayLayer = 0;
-        barrier.subresourceRange.layerCount = 1;
-        barrier.srcAccessMask = tex->uploaded
-            ? VK_ACCESS_SHADER_READ_BIT
-            : static_cast<VkAccessFlags>(0);
-        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-
-        VkPipelineStageFlags srcStage = tex->uploaded
-            ? VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT
-            : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-        vkCmdPipelineBarrier(g_Staging.commandBuffer, srcStage,
-            VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+        g_Uploads.batchHint = std::max(g_Uploads.batchHint, offset + image_size);
+        FlushUploads();
+        f = &beginBatch(std::max(image_size, g_Uploads.batchHint));
+        offset = 0;
     }
+    f->used = offset + image_size;
+
+    // Copy pixel data (or zeros) into the persistently-mapped staging buffer.
+    uint8_t* dst = static_cast<uint8_t*>(f->mappedPtr) + offset;
+    if (data)
+        std::memcpy(dst, data, static_cast<size_t>(image_size));
+    else
+        std::memset(dst, 0, static_cast<size_t>(image_size));
+
+    toTransferLayout(f->commandBuffer, tex, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
 
     VkBufferImageCopy region = {};
-    region.bufferOffset = 0;
+    region.bufferOffset = offset;
     region.bufferRowLength = 0;
     region.bufferImageHeight = 0;
     region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
     region.imageSubresource.mipLevel = 0;
     region.imageSubresource.baseArrayLayer = 0;
     region.imageSubresource.layerCount = 1;
-    region.imageOffset = {0, 0, 0};
-    region.imageExtent = {static_cast<uint32_t>(tex->width),
-                          static_cast<uint32_t>(tex->height), 1};
+    region.imageOffset = {x, y, 0};
+    region.imageExtent = {static_cast<uint32_t>(w), static_cast<uint32_t>(h), 1};
 
-    vkCmdCopyBufferToImage(g_Staging.commandBuffer, g_Staging.buffer,
+    vkCmdCopyBufferToImage(f->commandBuffer, f->buffer,
         tex->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
 
-    // Transition to SHADER_READ_ONLY
-    {
-        VkImageMemoryBarrier barrier = {};
-        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.image = tex->image;
-        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        barrier.subresourceRange.baseMipLevel = 0;
-        barrier.subresourceRange.levelCount = 1;
-        barrier.subresourceRange.baseArrayLayer = 0;
-        barrier.subresourceRange.layerCount = 1;
-        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-        vkCmdPipelineBarrier(g_Staging.commandBuffer,
-            VK_PIPELINE_STAGE_TRANSFER_BIT,
-            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-            0, 0, nullptr, 0, nullptr, 1, &barrier);
-    }
+    toShaderReadLayout(f->commandBuffer, tex, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
 
-    err = vkEndCommandBuffer(g_Staging.commandBuffer);
+    tex->uploaded = true;
+    tex->uploadSerial = f->serial;
+    ++g_Uploads.stats.copies;
+    g_Uploads.stats.bytes += image_size;
+}
+
+void CopyTextureRegions(VulkanTexture* src, VulkanTexture* dst,
+                        const std::vector<VkImageCopy>& regions) {
+    if (!src || !dst || src == dst)
+        throw std::runtime_error("CopyTextureRegions: invalid source or destination");
+    if (regions.empty() || !src->uploaded)
+        return;
+
+    UploadFrame& f = beginBatch(g_Uploads.batchHint);
+    toTransferLayout(f.commandBuffer, src, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+    toTransferLayout(f.commandBuffer, dst, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+
+    vkCmdCopyImage(f.commandBuffer,
+        src->image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+        dst->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        static_cast<uint32_t>(regions.size()), regions.data());
+
+    toShaderReadLayout(f.commandBuffer, src, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+    toShaderReadLayout(f.commandBuffer, dst, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+
+    dst->uploaded = true;
+    src->uploadSerial = f.serial;
+    dst->uploadSerial = f.serial;
+    ++g_Uploads.stats.copies;
+}
+
+void FlushUploads() {
+    UploadFrame& f = g_Uploads.frames[g_Uploads.current];
+    if (!f.recording)
+        return;
+
+    VkResult err = vkEndCommandBuffer(f.commandBuffer);
     if (err != VK_SUCCESS)
-        throw std::runtime_error("UpdateTexture: vkEndCommandBuffer failed");
+        throw std::runtime_error("FlushUploads: vkEndCommandBuffer failed");
 
     VkSubmitInfo submitInfo = {};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
     submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &g_Staging.commandBuffer;
+    submitInfo.pCommandBuffers = &f.commandBuffer;
 
-    // Submit with the upload fence — the GPU signals it when the transfer
-    // completes.  The next UpdateTexture() (or destroy()) will wait on it.
-    // No vkQueueWaitIdle — the GPU and CPU now run in parallel.
-    err = vkQueueSubmit(g_Queue, 1, &submitInfo, g_Staging.uploadFence);
+    // The fence is signalled when the copies complete; the slot is only
+    // waited on when the ring comes back round to it.  Frame rendering is
+    // submitted later to the same queue, so its fragment-shader reads are
+    // ordered after the copies by the barriers above.
+    err = vkQueueSubmit(g_Queue, 1, &submitInfo, f.fence);
     if (err != VK_SUCCESS)
-        throw std::runtime_error("UpdateTexture: vkQueueSubmit failed (err=" +
+        throw std::runtime_error("FlushUploads: vkQueueSubmit failed (err=" +
                                  std::to_string(err) + ")");
 
-    tex->uploaded = true;
+    f.recording = false;
+    ++g_Uploads.stats.submits;
+    g_Uploads.current = (g_Uploads.current + 1) % kUploadFrames;
+}
+
+VkCommandBuffer BatchCommandBuffer(uint64_t& serial) {
+    UploadFrame& f = beginBatch(g_Uploads.batchHint);
+    serial = f.serial;
+    return f.commandBuffer;
+}
+
+bool BatchComplete(uint64_t serial) {
+    for (UploadFrame& f : g_Uploads.frames)
+        if (f.serial == serial)
+            return !f.recording && vkGetFenceStatus(g_Device, f.fence) == VK_SUCCESS;
+    // Slots are waited on before reuse, so an older batch has completed
+    return true;
+}
+
+UploadStats TakeUploadStats() {
+    UploadStats s = g_Uploads.stats;
+    g_Uploads.stats = UploadStats{};
+    return s;
 }
 
 void Shutdown() {
-    g_Staging.destroy();
+    FlushUploads();
+    for (UploadFrame& f : g_Uploads.frames)
+        f.destroy(g_Uploads.commandPool);
+    if (g_Uploads.commandPool != VK_NULL_HANDLE)
+    {
+        vkDestroyCommandPool(g_Device, g_Uploads.commandPool, nullptr);
+        g_Uploads.commandPool = VK_NULL_HANDLE;
+    }
+    g_Uploads.batchHint = 0;
 }
 
 void DestroyTexture(VulkanTexture* tex) {
     if (!tex) return;
+    // The image may still be the target of a recorded or in-flight copy.
+    if (tex->uploadSerial != 0)
+    {
+        if (g_Uploads.frames[g_Uploads.current].recording &&
+            g_Uploads.frames[g_Uploads.current].serial == tex->uploadSerial)
+            FlushUploads();
+        waitForBatch(tex->uploadSerial);
+        tex->uploadSerial = 0;
+    }
     tex->cleanup(g_Device);
 }
 
@@ -449,6 +604,6 @@ VulkanTexture::~VulkanTexture()
 {
     if (image != VK_NULL_HANDLE || descriptor_set != VK_NULL_HANDLE)
     {
-        cleanup(g_Device);
+        VulkanHelpers::DestroyTexture(this);
     }
 }
@@ -0,0 +1,694 @@
+#include "VulkanVolumeSlicer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#include "AppState.h"  // debugLoggingEnabled()
+#include "VulkanHelpers.h"
+
+namespace {
+
+#ifdef HAS_VOLUME_SLICE_SPIRV
+/// src/shaders/volume_slice.comp, compiled by glslc -mfmt=c
+const uint32_t kVolumeSliceSpirv[] =
+#include "volume_slice.comp.inc"
+;
+#endif
+
+/// One layer in the shader's parameter buffer (std430 layout).
+struct LayerParams
+{
+    float base[4];    ///< w: blend alpha
+    float dpx[4];
+    float dpy[4];
+    float dims[4];
+    float range[4];   ///< rangeMin, rangeMax, invSpan, useLog
+};
+
+/// Bytes of parameters per dispatch: the layers, then their colour slots.
+constexpr VkDeviceSize kParamBytes =
+    sizeof(LayerParams) * kMaxVolumeSliceLayers +
+    sizeof(uint32_t) * kVolumeSliceSlots * kMaxVolumeSliceLayers;
+
+struct PushConstants
+{
+    int32_t offset[2];
+    int32_t size[2];
+    int32_t count;
+    int32_t blend;
+};
+
+constexpr uint32_t kGroupSize = 8;   ///< local_size_x/y of the shader
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Lifecycle
+// ---------------------------------------------------------------------------
+
+bool VulkanVolumeSlicer::initialize(VkPhysicalDevice physicalDevice, VkDevice device,
+                                    uint32_t queueFamily, VkQueue queue,
+                                    VkPipelineCache pipelineCache)
+{
+#ifndef HAS_VOLUME_SLICE_SPIRV
+    (void)physicalDevice; (void)device; (void)queueFamily; (void)queue; (void)pipelineCache;
+    if (debugLoggingEnabled())
+        std::cerr << "[gpu-slicing] Built without glslc: no Vulkan slicing shader\n";
+    return false;
+#else
+    physicalDevice_ = physicalDevice;
+    device_ = device;
+    queue_ = queue;
+
+    // The upload batch runs on the graphics queue, which must also do compute
+    uint32_t familyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> families(familyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, families.data());
+    bool compute = queueFamily < familyCount &&
+                   (families[queueFamily].queueFlags & VK_QUEUE_COMPUTE_BIT);
+
+    VkFormatProperties volumeFormat, targetFormat;
+    vkGetPhysicalDeviceFormatProperties(physicalDevice, VK_FORMAT_R32_SFLOAT, &volumeFormat);
+    vkGetPhysicalDeviceFormatProperties(physicalDevice, VK_FORMAT_R8G8B8A8_UNORM, &targetFormat);
+    VkPhysicalDeviceProperties props;
+    vkGetPhysicalDeviceProperties(physicalDevice, &props);
+    const VkPhysicalDeviceLimits& limits = props.limits;
+
+    if (!compute ||
+        !(volumeFormat.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) ||
+        !(targetFormat.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT) ||
+        limits.maxPerStageDescriptorSampledImages < static_cast<uint32_t>(kMaxVolumeSliceLayers) ||
+        limits.maxPerStageDescriptorSamplers < static_cast<uint32_t>(kMaxVolumeSliceLayers))
+    {
+        if (debugLoggingEnabled())
+            std::cerr << "[gpu-slicing] Vulkan device lacks compute or float 3D images\n";
+        return false;
+    }
+    max3DSize_ = limits.maxImageDimension3D;
+    VkDeviceSize align = std::max<VkDeviceSize>(limits.minStorageBufferOffsetAlignment, 16);
+    paramStride_ = (kParamBytes + align - 1) / align * align;
+
+    bool ok = true;
+    auto check = [&](VkResult err) { ok = ok && err == VK_SUCCESS; };
+
+    {
+        VkCommandPoolCreateInfo info = {};
+        info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+        info.queueFamilyIndex = queueFamily;
+        check(vkCreateCommandPool(device_, &info, nullptr, &commandPool_));
+    }
+    {
+        VkSamplerCreateInfo info = {};
+        info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+        info.magFilter = VK_FILTER_NEAREST;
+        info.minFilter = VK_FILTER_NEAREST;
+        info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+        info.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        info.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        info.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        info.maxAnisotropy = 1.0f;
+        if (ok)
+            check(vkCreateSampler(device_, &info, nullptr, &sampler_));
+    }
+    {
+        VkDescriptorSetLayoutBinding bindings[3] = {};
+        bindings[0].binding = 0;
+        bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        bindings[0].descriptorCount = 1;
+        bindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        bindings[1].binding = 1;
+        bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        bindings[1].descriptorCount = kMaxVolumeSliceLayers;
+        bindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        bindings[2].binding = 2;
+        bindings[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[2].descriptorCount = 1;
+        bindings[2].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+        VkDescriptorSetLayoutCreateInfo info = {};
+        info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        info.bindingCount = 3;
+        info.pBindings = bindings;
+        if (ok)
+            check(vkCreateDescriptorSetLayout(device_, &info, nullptr, &setLayout_));
+    }
+    {
+        VkPushConstantRange range = {};
+        range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        range.size = sizeof(PushConstants);
+
+        VkPipelineLayoutCreateInfo info = {};
+        info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        info.setLayoutCount = 1;
+        info.pSetLayouts = &setLayout_;
+        info.pushConstantRangeCount = 1;
+        info.pPushConstantRanges = &range;
+        if (ok)
+            check(vkCreatePipelineLayout(device_, &info, nullptr, &pipelineLayout_));
+    }
+
+    VkShaderModule module = VK_NULL_HANDLE;
+    if (ok)
+    {
+        VkShaderModuleCreateInfo info = {};
+        info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+        info.codeSize = sizeof(kVolumeSliceSpirv);
+        info.pCode = kVolumeSliceSpirv;
+        check(vkCreateShaderModule(device_, &info, nullptr, &module));
+    }
+    if (ok)
+    {
+        VkComputePipelineCreateInfo info = {};
+        info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        info.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        info.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        info.stage.module = module;
+        info.stage.pName = "main";
+        info.layout = pipelineLayout_;
+        check(vkCreateComputePipelines(device_, pipelineCache, 1, &info, nullptr, &pipeline_));
+        if (!ok)
+            pipeline_ = VK_NULL_HANDLE;
+    }
+    if (module != VK_NULL_HANDLE)
+        vkDestroyShaderModule(device_, module, nullptr);
+
+    if (!ok)
+    {
+        std::cerr << "[gpu-slicing] Failed to create the Vulkan slicing pipeline\n";
+        shutdown();
+        return false;
+    }
+
+    if (debugLoggingEnabled())
+        std::cerr << "[gpu-slicing] Enabled (Vulkan compute): " << kMaxVolumeSliceLayers
+                  << " overlay layers, 3D images up to " << max3DSize_ << "^3\n";
+    return true;
+#endif
+}
+
+void VulkanVolumeSlicer::shutdown()
+{
+    if (device_ == VK_NULL_HANDLE)
+        return;
+    vkDeviceWaitIdle(device_);
+
+    for (auto& entry : volumes_)
+        destroyVolumeImage(*entry.second);
+    volumes_.clear();
+    for (auto& vi : retired_)
+        destroyVolumeImage(*vi);
+    retired_.clear();
+    for (auto& a : arenas_)
+        destroyArena(*a);
+    arenas_.clear();
+
+    if (pipeline_ != VK_NULL_HANDLE)
+        vkDestroyPipeline(device_, pipeline_, nullptr);
+    if (pipelineLayout_ != VK_NULL_HANDLE)
+        vkDestroyPipelineLayout(device_, pipelineLayout_, nullptr);
+    if (setLayout_ != VK_NULL_HANDLE)
+        vkDestroyDescriptorSetLayout(device_, setLayout_, nullptr);
+    if (sampler_ != VK_NULL_HANDLE)
+        vkDestroySampler(device_, sampler_, nullptr);
+    if (commandPool_ != VK_NULL_HANDLE)
+        vkDestroyCommandPool(device_, commandPool_, nullptr);
+    pipeline_ = VK_NULL_HANDLE;
+    pipelineLayout_ = VK_NULL_HANDLE;
+    setLayout_ = VK_NULL_HANDLE;
+    sampler_ = VK_NULL_HANDLE;
+    commandPool_ = VK_NULL_HANDLE;
+    device_ = VK_NULL_HANDLE;
+}
+
+uint32_t VulkanVolumeSlicer::findMemoryType(uint32_t typeBits,
+                                            VkMemoryPropertyFlags properties) const
+{
+    VkPhysicalDeviceMemoryProperties mem;
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice_, &mem);
+    for (uint32_t i = 0; i < mem.memoryTypeCount; ++i)
+        if ((typeBits & (1u << i)) && (mem.memoryTypes[i].propertyFlags & properties) == properties)
+            return i;
+    return 0xFFFFFFFF;
+}
+
+// ---------------------------------------------------------------------------
+// Volumes
+// ---------------------------------------------------------------------------
+
+std::unique_ptr<VolumeTexture> VulkanVolumeSlicer::createVolumeTexture(
+    int dimX, int dimY, int dimZ, const float* data)
+{
+    if (!supported() || !data || dimX <= 0 || dimY <= 0 || dimZ <= 0 ||
+        static_cast<uint32_t>(std::max({dimX, dimY, dimZ})) > max3DSize_)
+        return nullptr;
+    collectRetired();
+
+    auto vi = std::make_unique<VolumeImage>();
+    const VkDeviceSize bytes = static_cast<VkDeviceSize>(dimX) * dimY * dimZ * sizeof(float);
+    VkBuffer staging = VK_NULL_HANDLE;
+    VkDeviceMemory stagingMemory = VK_NULL_HANDLE;
+    VkCommandBuffer cb = VK_NULL_HANDLE;
+    VkFence fence = VK_NULL_HANDLE;
+
+    auto release = [&]() {
+        if (fence != VK_NULL_HANDLE)
+            vkDestroyFence(device_, fence, nullptr);
+        if (cb != VK_NULL_HANDLE)
+            vkFreeCommandBuffers(device_, commandPool_, 1, &cb);
+        if (staging != VK_NULL_HANDLE)
+            vkDestroyBuffer(device_, staging, nullptr);
+        if (stagingMemory != VK_NULL_HANDLE)
+            vkFreeMemory(device_, stagingMemory, nullptr);
+    };
+    // Out of memory (large multi-volume sessions): leave it to the CPU path
+    auto fail = [&]() -> std::unique_ptr<VolumeTexture> {
+        release();
+        destroyVolumeImage(*vi);
+        if (debugLoggingEnabled())
+            std::cerr << "[gpu-slicing] Failed to upload " << dimX << "x" << dimY
+                      << "x" << dimZ << " volume image\n";
+        return nullptr;
+    };
+
+    // Device-local 3D image
+    {
+        VkImageCreateInfo info = {};
+        info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        info.imageType = VK_IMAGE_TYPE_3D;
+        info.format = VK_FORMAT_R32_SFLOAT;
+        info.extent = {static_cast<uint32_t>(dimX), static_cast<uint32_t>(dimY),
+                       static_cast<uint32_t>(dimZ)};
+        info.mipLevels = 1;
+        info.arrayLayers = 1;
+        info.samples = VK_SAMPLE_COUNT_1_BIT;
+        info.tiling = VK_IMAGE_TILING_OPTIMAL;
+        info.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+        info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        if (vkCreateImage(device_, &info, nullptr, &vi->image) != VK_SUCCESS)
+            return fail();
+
+        VkMemoryRequirements req;
+        vkGetImageMemoryRequirements(device_, vi->image, &req);
+        VkMemoryAllocateInfo alloc = {};
+        alloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        alloc.allocationSize = req.size;
+        alloc.memoryTypeIndex = findMemoryType(req.memoryTypeBits,
+                                               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        if (alloc.memoryTypeIndex == 0xFFFFFFFF ||
+            vkAllocateMemory(device_, &alloc, nullptr, &vi->memory) != VK_SUCCESS ||
+            vkBindImageMemory(device_, vi->image, vi->memory, 0) != VK_SUCCESS)
+            return fail();
+
+        VkImageViewCreateInfo view = {};
+        view.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        view.image = vi->image;
+        view.viewType = VK_IMAGE_VIEW_TYPE_3D;
+        view.format = VK_FORMAT_R32_SFLOAT;
+        view.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        view.subresourceRange.levelCount = 1;
+        view.subresourceRange.layerCount = 1;
+        if (vkCreateImageView(device_, &view, nullptr, &vi->view) != VK_SUCCESS)
+            return fail();
+    }
+
+    // Staging buffer: volumes are too large for the upload ring, and are
+    // uploaded rarely enough that waiting for the copy is fine
+    {
+        VkBufferCreateInfo info = {};
+        info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        info.size = bytes;
+        info.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+        info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        if (vkCreateBuffer(device_, &info, nullptr, &staging) != VK_SUCCESS)
+            return fail();
+
+        VkMemoryRequirements req;
+        vkGetBufferMemoryRequirements(device_, staging, &req);
+        VkMemoryAllocateInfo alloc = {};
+        alloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        alloc.allocationSize = req.size;
+        alloc.memoryTypeIndex = findMemoryType(req.memoryTypeBits,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        void* mapped = nullptr;
+        if (alloc.memoryTypeIndex == 0xFFFFFFFF ||
+            vkAllocateMemory(device_, &alloc, nullptr, &stagingMemory) != VK_SUCCESS ||
+            vkBindBufferMemory(device_, staging, stagingMemory, 0) != VK_SUCCESS ||
+            vkMapMemory(device_, stagingMemory, 0, bytes, 0, &mapped) != VK_SUCCESS)
+            return fail();
+        std::memcpy(mapped, data, static_cast<size_t>(bytes));
+        vkUnmapMemory(device_, stagingMemory);
+    }
+
+    {
+        VkCommandBufferAllocateInfo alloc = {};
+        alloc.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        alloc.commandPool = commandPool_;
+        alloc.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        alloc.commandBufferCount = 1;
+        VkFenceCreateInfo fenceInfo = {};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        VkCommandBufferBeginInfo begin = {};
+        begin.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        begin.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        if (vkAllocateCommandBuffers(device_, &alloc, &cb) != VK_SUCCESS ||
+            vkCreateFence(device_, &fenceInfo, nullptr, &fence) != VK_SUCCESS ||
+            vkBeginCommandBuffer(cb, &begin) != VK_SUCCESS)
+            return fail();
+
+        VkImageMemoryBarrier barrier = {};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = vi->image;
+        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        barrier.subresourceRange.levelCount = 1;
+        barrier.subresourceRange.layerCount = 1;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        vkCmdPipelineBarrier(cb, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        VkBufferImageCopy region = {};
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.layerCount = 1;
+        region.imageExtent = {static_cast<uint32_t>(dimX), static_cast<uint32_t>(dimY),
+                              static_cast<uint32_t>(dimZ)};
+        vkCmdCopyBufferToImage(cb, staging, vi->image,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(cb, VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        VkSubmitInfo submit = {};
+        submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submit.commandBufferCount = 1;
+        submit.pCommandBuffers = &cb;
+        if (vkEndCommandBuffer(cb) != VK_SUCCESS ||
+            vkQueueSubmit(queue_, 1, &submit, fence) != VK_SUCCESS ||
+            vkWaitForFences(device_, 1, &fence, VK_TRUE, UINT64_MAX) != VK_SUCCESS)
+            return fail();
+    }
+    release();
+
+    auto vt = std::make_unique<VolumeTexture>();
+    vt->id = reinterpret_cast<uintptr_t>(vi.get());
+    vt->dimX = dimX;
+    vt->dimY = dimY;
+    vt->dimZ = dimZ;
+    VolumeImage* key = vi.get();
+    volumes_[key] = std::move(vi);
+    return vt;
+}
+
+void VulkanVolumeSlicer::destroyVolumeTexture(VolumeTexture* vt)
+{
+    if (!vt || !vt->id)
+        return;
+    auto it = volumes_.find(reinterpret_cast<VolumeImage*>(vt->id));
+    if (it != volumes_.end())
+    {
+        // A recorded or in-flight dispatch may still read it
+        retired_.push_back(std::move(it->second));
+        volumes_.erase(it);
+        collectRetired();
+    }
+    vt->id = 0;
+}
+
+void VulkanVolumeSlicer::destroyVolumeImage(VolumeImage& vi)
+{
+    if (vi.view != VK_NULL_HANDLE)
+        vkDestroyImageView(device_, vi.view, nullptr);
+    if (vi.image != VK_NULL_HANDLE)
+        vkDestroyImage(device_, vi.image, nullptr);
+    if (vi.memory != VK_NULL_HANDLE)
+        vkFreeMemory(device_, vi.memory, nullptr);
+    vi = VolumeImage{};
+}
+
+void VulkanVolumeSlicer::collectRetired()
+{
+    retired_.erase(std::remove_if(retired_.begin(), retired_.end(),
+                                  [&](std::unique_ptr<VolumeImage>& vi) {
+                                      if (!VulkanHelpers::BatchComplete(vi->serial))
+                                          return false;
+                                      destroyVolumeImage(*vi);
+                                      return true;
+                                  }),
+                   retired_.end());
+}
+
+// ---------------------------------------------------------------------------
+// Arenas
+// ---------------------------------------------------------------------------
+
+bool VulkanVolumeSlicer::createArena(Arena& a)
+{
+    VkDescriptorPoolSize sizes[] = {
+        { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,          kArenaDispatches },
+        { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, kArenaDispatches * kMaxVolumeSliceLayers },
+        { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,         kArenaDispatches },
+    };
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.maxSets = kArenaDispatches;
+    poolInfo.poolSizeCount = 3;
+    poolInfo.pPoolSizes = sizes;
+    if (vkCreateDescriptorPool(device_, &poolInfo, nullptr, &a.pool) != VK_SUCCESS)
+        return false;
+
+    VkBufferCreateInfo info = {};
+    info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    info.size = paramStride_ * kArenaDispatches;
+    info.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    if (vkCreateBuffer(device_, &info, nullptr, &a.buffer) != VK_SUCCESS)
+        return false;
+
+    VkMemoryRequirements req;
+    vkGetBufferMemoryRequirements(device_, a.buffer, &req);
+    VkMemoryAllocateInfo alloc = {};
+    alloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    alloc.allocationSize = req.size;
+    alloc.memoryTypeIndex = findMemoryType(req.memoryTypeBits,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    return alloc.memoryTypeIndex != 0xFFFFFFFF &&
+           vkAllocateMemory(device_, &alloc, nullptr, &a.memory) == VK_SUCCESS &&
+           vkBindBufferMemory(device_, a.buffer, a.memory, 0) == VK_SUCCESS &&
+           vkMapMemory(device_, a.memory, 0, info.size, 0, &a.mapped) == VK_SUCCESS;
+}
+
+void VulkanVolumeSlicer::destroyArena(Arena& a)
+{
+    if (a.mapped)
+        vkUnmapMemory(device_, a.memory);
+    if (a.buffer != VK_NULL_HANDLE)
+        vkDestroyBuffer(device_, a.buffer, nullptr);
+    if (a.memory != VK_NULL_HANDLE)
+        vkFreeMemory(device_, a.memory, nullptr);
+    if (a.pool != VK_NULL_HANDLE)
+        vkDestroyDescriptorPool(device_, a.pool, nullptr);
+    a = Arena{};
+}
+
+VulkanVolumeSlicer::Arena* VulkanVolumeSlicer::arena(uint64_t serial)
+{
+    Arena* reuse = nullptr;
+    for (auto& a : arenas_)
+    {
+        if (a->serial == serial && a->used < kArenaDispatches)
+            return a.get();
+        if (!reuse && a->serial != serial && VulkanHelpers::BatchComplete(a->serial))
+            reuse = a.get();
+    }
+
+    if (reuse)
+    {
+        vkResetDescriptorPool(device_, reuse->pool, 0);
+    }
+    else
+    {
+        auto a = std::make_unique<Arena>();
+        if (!createArena(*a))
+        {
+            destroyArena(*a);
+            return nullptr;
+        }
+        arenas_.push_back(std::move(a));
+        reuse = arenas_.back().get();
+    }
+    reuse->used = 0;
+    reuse->serial = serial;
+    return reuse;
+}
+
+// ---------------------------------------------------------------------------
+// Rendering
+// ---------------------------------------------------------------------------
+
+bool VulkanVolumeSlicer::render(VulkanTexture* target, int x, int y, int w, int h,
+                                const VolumeSliceLayer* layers, int count, bool blend)
+{
+    if (!supported() || !target || target->image_view == VK_NULL_HANDLE ||
+        w <= 0 || h <= 0 || x < 0 || y < 0 ||
+        x + w > target->width || y + h > target->height ||
+        count < 1 || count > kMaxVolumeSliceLayers || (!blend && count != 1))
+        return false;
+
+    VolumeImage* images[kMaxVolumeSliceLayers] = {};
+    for (int i = 0; i < count; ++i)
+    {
+        if (!layers[i].volume || !layers[i].slots)
+            return false;
+        auto it = volumes_.find(reinterpret_cast<VolumeImage*>(layers[i].volume->id));
+        if (it == volumes_.end())
+            return false;
+        images[i] = it->second.get();
+    }
+    collectRetired();
+
+    uint64_t serial = 0;
+    VkCommandBuffer cb = VulkanHelpers::BatchCommandBuffer(serial);
+    Arena* a = arena(serial);
+    if (!a)
+        return false;
+
+    // Layer parameters and colour slots: ~9 KB per dispatch
+    const VkDeviceSize offset = paramStride_ * a->used;
+    uint8_t* params = static_cast<uint8_t*>(a->mapped) + offset;
+    LayerParams lp[kMaxVolumeSliceLayers] = {};
+    for (int i = 0; i < count; ++i)
+    {
+        const VolumeSliceLayer& L = layers[i];
+        for (int c = 0; c < 3; ++c)
+        {
+            lp[i].base[c] = L.base[c];
+            lp[i].dpx[c] = L.dpx[c];
+            lp[i].dpy[c] = L.dpy[c];
+        }
+        lp[i].base[3] = L.alpha;
+        lp[i].dims[0] = static_cast<float>(L.volume->dimX);
+        lp[i].dims[1] = static_cast<float>(L.volume->dimY);
+        lp[i].dims[2] = static_cast<float>(L.volume->dimZ);
+        lp[i].range[0] = L.rangeMin;
+        lp[i].range[1] = L.rangeMax;
+        lp[i].range[2] = L.invSpan;
+        lp[i].range[3] = L.useLog ? 1.0f : 0.0f;
+        std::memcpy(params + sizeof(lp) + sizeof(uint32_t) * kVolumeSliceSlots * i,
+                    L.slots, sizeof(uint32_t) * kVolumeSliceSlots);
+    }
+    std::memcpy(params, lp, sizeof(lp));
+
+    VkDescriptorSet set = VK_NULL_HANDLE;
+    {
+        VkDescriptorSetAllocateInfo alloc = {};
+        alloc.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        alloc.descriptorPool = a->pool;
+        alloc.descriptorSetCount = 1;
+        alloc.pSetLayouts = &setLayout_;
+        if (vkAllocateDescriptorSets(device_, &alloc, &set) != VK_SUCCESS)
+            return false;
+    }
+    ++a->used;
+
+    // Every sampler slot must be valid; unused ones repeat the first layer
+    VkDescriptorImageInfo targetInfo = {};
+    targetInfo.imageView = target->image_view;
+    targetInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+    VkDescriptorImageInfo volumeInfo[kMaxVolumeSliceLayers];
+    for (int i = 0; i < kMaxVolumeSliceLayers; ++i)
+    {
+        volumeInfo[i].sampler = sampler_;
+        volumeInfo[i].imageView = images[i < count ? i : 0]->view;
+        volumeInfo[i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    }
+    VkDescriptorBufferInfo paramInfo = {};
+    paramInfo.buffer = a->buffer;
+    paramInfo.offset = offset;
+    paramInfo.range = kParamBytes;
+
+    VkWriteDescriptorSet writes[3] = {};
+    for (VkWriteDescriptorSet& wr : writes)
+    {
+        wr.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        wr.dstSet = set;
+        wr.descriptorCount = 1;
+    }
+    writes[0].dstBinding = 0;
+    writes[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    writes[0].pImageInfo = &targetInfo;
+    writes[1].dstBinding = 1;
+    writes[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    writes[1].descriptorCount = kMaxVolumeSliceLayers;
+    writes[1].pImageInfo = volumeInfo;
+    writes[2].dstBinding = 2;
+    writes[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    writes[2].pBufferInfo = &paramInfo;
+    vkUpdateDescriptorSets(device_, 3, writes, 0, nullptr);
+
+    // Into GENERAL for the shader writes.  Earlier frames may still sample
+    // the image and copies or dispatches of this batch may have written it.
+    VkImageMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = target->uploaded
+        ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+        : VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = target->image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.layerCount = 1;
+    barrier.srcAccessMask = target->uploaded
+        ? (VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT)
+        : static_cast<VkAccessFlags>(0);
+    barrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    VkPipelineStageFlags srcStage = target->uploaded
+        ? (VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT |
+           VK_PIPELINE_STAGE_TRANSFER_BIT)
+        : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+    vkCmdPipelineBarrier(cb, srcStage, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    PushConstants pc = {};
+    pc.offset[0] = x;
+    pc.offset[1] = y;
+    pc.size[0] = w;
+    pc.size[1] = h;
+    pc.count = count;
+    pc.blend = blend ? 1 : 0;
+    vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_);
+    vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout_,
+                            0, 1, &set, 0, nullptr);
+    vkCmdPushConstants(cb, pipelineLayout_, VK_SHADER_STAGE_COMPUTE_BIT,
+                       0, sizeof(pc), &pc);
+    vkCmdDispatch(cb, (static_cast<uint32_t>(w) + kGroupSize - 1) / kGroupSize,
+                  (static_cast<uint32_t>(h) + kGroupSize - 1) / kGroupSize, 1);
+
+    // Back to SHADER_READ_ONLY, as VulkanHelpers expects of uploaded images
+    barrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT |
+                            VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(cb, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT |
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    target->uploaded = true;
+    target->uploadSerial = serial;
+    for (int i = 0; i < count; ++i)
+        images[i]->serial = serial;
+    return true;
+}
@@ -6,14 +6,17 @@
 #include <string>
 #include <string_view>
 #include <algorithm>
+#include <chrono>
 #include <memory>
 #include <optional>
 #include <cstdio>
 #include <cmath>
 #include <filesystem>
 #include <fstream>
+#include <functional>
 #include <sstream>
 #include <stdexcept>
+#include <utility>
 
 #define GLFW_INCLUDE_NONE
 #include <GLFW/glfw3.h>
@@ -21,15 +24,22 @@
 #include "AppConfig.h"
 #include "AppState.h"
 #include "ColourMap.h"
+#include "FrameScheduler.h"
 #include "GraphicsBackend.h"
 #include "Interface.h"
 #include "Prefetcher.h"
+#include "ThumbnailCache.h"
 #include "QCState.h"
 #include "Volume.h"
 #include "ViewManager.h"
+#include "VolumeLoader.h"
 #include "WindowManager.h"
 #include "WaylandTouchInput.h"
 
+#ifdef HAS_OSMESA
+#include "BatchRenderer.h"
+#endif
+
 #include <glm/glm.hpp>
 
 extern "C" {
@@ -45,6 +55,52 @@ static void glfwErrorCallback(int error, const char* description)
         std::cerr << "[glfw] Error " << error << ": " << description << "\n";
 }
 
+// ---------------------------------------------------------------------------
+// Startup timing — printed with --debug.  Scripts run many short sessions,
+// so time to the first presented frame matters.
+// ---------------------------------------------------------------------------
+class StartupTimer
+{
+public:
+    /// Record that @p phase finished now.
+    void mark(const char* phase)
+    {
+        phases_.emplace_back(phase, Clock::now());
+    }
+
+    /// Milliseconds since construction.
+    long long elapsedMs() const
+    {
+        return msBetween(start_, Clock::now());
+    }
+
+    /// Print each phase and the total since construction.
+    void report() const
+    {
+        if (!debugLoggingEnabled())
+            return;
+        std::cerr << "[startup]";
+        Clock::time_point prev = start_;
+        for (const auto& [phase, t] : phases_)
+        {
+            std::cerr << " " << phase << " " << msBetween(prev, t) << " ms,";
+            prev = t;
+        }
+        std::cerr << " total " << msBetween(start_, prev) << " ms\n";
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    static long long msBetween(Clock::time_point a, Clock::time_point b)
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(b - a).count();
+    }
+
+    Clock::time_point start_ = Clock::now();
+    std::vector<std::pair<const char*, Clock::time_point>> phases_;
+};
+
 // ---------------------------------------------------------------------------
 // CLI argument parsing (replaces cxxopts)
 // ---------------------------------------------------------------------------
@@ -72,6 +128,8 @@ struct ParsedArgs
     std::string qcInputPath;
     std::string qcOutputPath;
     bool qcSingleMode = false;
+    std::string qcQueueDir;
+    std::string rater;
 
     bool syncAll    = false;
     bool syncCursor = false;
@@ -79,6 +137,14 @@ struct ParsedArgs
     bool syncPan    = false;
 
     std::optional<float> scaleFactor;
+    bool gpuSlicing = false;
+    bool palettedSlices = false;
+
+    std::optional<std::string> recordDir;
+    int recordEvery = 1;
+
+    std::optional<std::string> batchDir;
+    int batchJobs = 0;
 
     std::vector<std::string> volumeFiles;
     std::vector<PerVolOpts>  perVolOpts;
@@ -114,11 +180,24 @@ static void printUsage()
         "  -h, --help           Show this help message\n"
         "      --test           Launch with a generated test volume\n"
         "      --scale <factor> Override screen content scale (HiDPI)\n"
+        "      --gpu-slicing    Slice and colour-map volumes on the GPU (OpenGL2, Vulkan)\n"
+        "      --paletted-slices  Upload slices as colour indices + LUT (OpenGL2)\n"
+        "      --record <dir>   Record frames to <dir>/frameNNNNNN.png from startup\n"
+        "      --record-every <n>  Record every n-th frame (default 1; also Shift+P)\n"
+        "\n"
+        "Batch rendering (new_register_batch):\n"
+        "      --batch <dir>    Render without a window: one PNG per QC row (--qc/--qc1)\n"
+        "                       or one of the volumes/config given, into <dir>\n"
+        "      --jobs <n>       Parallel render processes (default: one per core)\n"
         "\n"
         "QC mode:\n"
         "      --qc <csv>       Enable QC mode with input CSV (per-column verdicts)\n"
         "      --qc1 <csv>      Enable QC mode with single verdict per row\n"
         "      --qc-output <csv>  Output CSV for QC verdicts (required with --qc/--qc1)\n"
+        "      --qc-queue <dir>  Share the study with other raters: claim blocks of rows\n"
+        "                       through a work queue in <dir> (e.g. on NFS), next to\n"
+        "                       a shared --qc-output\n"
+        "      --rater <name>   Rater name in the work queue (default: user@host)\n"
         "\n"
         "Synchronization:\n"
         "      --sync           Synchronize all (cursor, zoom, pan)\n"
@@ -174,6 +253,8 @@ static std::optional<ParsedArgs> parseArgs(int argc, char** argv)
         if (arg == "-h" || arg == "--help")    { args.help = true;  continue; }
         if (arg == "-d" || arg == "--debug")   { args.debug = true; continue; }
         if (arg == "--test")                   { args.test = true;  continue; }
+        if (arg == "--gpu-slicing")            { args.gpuSlicing = true; continue; }
+        if (arg == "--paletted-slices")        { args.palettedSlices = true; continue; }
 
         if (arg == "--sync")        { args.syncAll = true;    continue; }
         if (arg == "--sync-cursor") { args.syncCursor = true; continue; }
@@ -295,6 +376,70 @@ static std::optional<ParsedArgs> parseArgs(int argc, char** argv)
             continue;
         }
 
+        if (arg == "--qc-queue")
+        {
+            ++i;
+            if (!requireValue(i, argc, "--qc-queue"))
+                return std::nullopt;
+            args.qcQueueDir = argv[i];
+            continue;
+        }
+
+        if (arg == "--rater")
+        {
+            ++i;
+            if (!requireValue(i, argc, "--rater"))
+                return std::nullopt;
+            args.rater = argv[i];
+            continue;
+        }
+
+        if (arg == "--record")
+        {
+            ++i;
+            if (!requireValue(i, argc, "--record"))
+                return std::nullopt;
+            args.recordDir = argv[i];
+            continue;
+        }
+
+        if (arg == "--record-every")
+        {
+            ++i;
+            if (!requireValue(i, argc, "--record-every"))
+                return std::nullopt;
+            args.recordEvery = std::stoi(argv[i]);
+            if (args.recordEvery < 1)
+            {
+                std::cerr << "Error: --record-every must be at least 1.\n";
+                return std::nullopt;
+            }
+            continue;
+        }
+
+        if (arg == "--batch")
+        {
+            ++i;
+            if (!requireValue(i, argc, "--batch"))
+                return std::nullopt;
+            args.batchDir = argv[i];
+            continue;
+        }
+
+        if (arg == "--jobs")
+        {
+            ++i;
+            if (!requireValue(i, argc, "--jobs"))
+                return std::nullopt;
+            args.batchJobs = std::stoi(argv[i]);
+            if (args.batchJobs < 1)
+            {
+                std::cerr << "Error: --jobs must be at least 1.\n";
+                return std::nullopt;
+            }
+            continue;
+        }
+
         if (arg == "--scale")
         {
             ++i;
@@ -359,12 +504,105 @@ static std::optional<ParsedArgs> parseArgs(int argc, char** argv)
     return args;
 }
 
+#ifdef HAS_OSMESA
+// ---------------------------------------------------------------------------
+// Batch mode
+// ---------------------------------------------------------------------------
+
+/// Render the QC rows, or the volumes given, to PNGs without a window
+/// (--batch).  Each image is configured as the interactive viewer would
+/// show it on startup: config file, QC column settings, CLI options, tags.
+static int runBatchMode(const ParsedArgs& args, const AppConfig& cfg, AppState& state,
+                        QCState& qcState, const std::vector<std::string>& volumeFiles,
+                        const std::function<void(int)>& applyCliVolumeOptions)
+{
+    std::vector<BatchItem> items;
+    if (qcState.active)
+    {
+        items = batchItemsForQC(qcState);
+    }
+    else if (!volumeFiles.empty())
+    {
+        // Named after the first volume, without .mnc/.nii(.gz)
+        std::filesystem::path name = std::filesystem::path(volumeFiles.front()).filename();
+        if (name.extension() == ".gz")
+            name = name.stem();
+        items.push_back(BatchItem{name.stem().string(), volumeFiles, -1});
+    }
+    else
+    {
+        std::cerr << "Error: --batch needs a QC CSV (--qc/--qc1) or volume files.\n";
+        return 1;
+    }
+
+    // Same default layout size as the window, without the monitor clamp
+    int numVols = qcState.active ? qcState.columnCount()
+                                 : static_cast<int>(volumeFiles.size());
+    if (numVols < 1) numVols = 1;
+    constexpr int colWidth  = 300;
+    constexpr int baseHeight = 480;
+    int totalCols = numVols + (numVols > 1 ? 1 : 0);
+    float scale = args.scaleFactor.value_or(1.0f);
+
+    BatchOptions options;
+    options.outputDir = *args.batchDir;
+    options.jobs = args.batchJobs;
+    options.width = cfg.global.windowWidth.value_or(
+        static_cast<int>(colWidth * totalCols * scale));
+    options.height = cfg.global.windowHeight.value_or(
+        static_cast<int>(baseHeight * scale));
+    options.scale = args.scaleFactor;
+    options.fontPath = cfg.global.fontPath;
+    options.fontSize = cfg.global.fontSize;
+    options.gpuSlicing = args.gpuSlicing;
+    options.palettedSlices = args.palettedSlices;
+
+    auto setup = [&](AppState& st, const BatchItem& item)
+    {
+        st.applyConfig(cfg, options.width, options.height);
+        if (args.syncCursor || args.syncAll) st.syncCursors_ = true;
+        if (args.syncZoom   || args.syncAll) st.syncZoom_ = true;
+        if (args.syncPan    || args.syncAll) st.syncPan_ = true;
+
+        if (item.qcRow >= 0)
+        {
+            for (int ci = 0; ci < qcState.columnCount() && ci < st.volumeCount(); ++ci)
+            {
+                auto it = qcState.columnConfigs.find(qcState.columnNames[ci]);
+                if (it == qcState.columnConfigs.end())
+                    continue;
+                VolumeViewState& vs = st.viewStates_[ci];
+                auto cmOpt = colourMapByName(it->second.colourMap);
+                if (cmOpt) vs.colourMap = *cmOpt;
+                if (it->second.valueMin) vs.valueRange[0] = *it->second.valueMin;
+                if (it->second.valueMax) vs.valueRange[1] = *it->second.valueMax;
+            }
+            return;
+        }
+
+        for (int vi = 0; vi < st.volumeCount(); ++vi)
+        {
+            if (!st.volumes_[vi].data.empty())
+                applyCliVolumeOptions(vi);
+        }
+        if (!args.tagsPath.empty())
+            st.loadCombinedTags(args.tagsPath);
+        else
+            for (int vi = 0; vi < st.volumeCount(); ++vi)
+                st.loadTagsForVolume(vi);
+    };
+
+    return runBatch(items, options, state, qcState, setup);
+}
+#endif
+
 // ---------------------------------------------------------------------------
 // main
 // ---------------------------------------------------------------------------
 
   int main(int argc, char** argv)
     {
+        StartupTimer startupTimer;
         bool glfwInitialized = false;
 
         try
@@ -391,7 +629,8 @@ static std::optional<ParsedArgs> parseArgs(int argc, char** argv)
         std::string qcInputPath = args.qcInputPath;
         std::string qcOutputPath = args.qcOutputPath;
 
-        if (!qcInputPath.empty() && qcOutputPath.empty())
+        // Batch mode only renders; verdicts are not written
+        if (!qcInputPath.empty() && qcOutputPath.empty() && !args.batchDir)
         {
             std::cerr << "Error: --qc requires --qc-output <path>\n";
             return 1;
@@ -404,8 +643,12 @@ static std::optional<ParsedArgs> parseArgs(int argc, char** argv)
         std::vector<std::string> volumeFiles = std::move(args.volumeFiles);
 
         // --- Backend selection ---
-        BackendType backendType;
-        if (!cliBackendName.empty())
+        BackendType backendType = BackendType::OpenGL2;
+        if (args.batchDir)
+        {
+            // Batch mode always renders with the offscreen backend
+        }
+        else if (!cliBackendName.empty())
         {
             if (cliBackendName == "auto")
             {
@@ -431,7 +674,7 @@ static std::optional<ParsedArgs> parseArgs(int argc, char** argv)
             backendType = GraphicsBackend::detectBest();
         }
 
-        if (debugLoggingEnabled())
+        if (debugLoggingEnabled() && !args.batchDir)
         {
             std::cerr << "[backend] Using: " << GraphicsBackend::backendName(backendType) << "\n";
             std::cerr << "[backend] Available:";
@@ -469,8 +712,16 @@ static std::optional<ParsedArgs> parseArgs(int argc, char** argv)
             qcState.inputCsvPath = qcInputPath;
             qcState.outputCsvPath = qcOutputPath;
             qcState.loadInputCsv(qcInputPath);
-            if (std::filesystem::exists(qcOutputPath))
-                qcState.loadOutputCsv(qcOutputPath);
+            if (!args.qcQueueDir.empty() && !args.batchDir)
+            {
+                qcState.workQueue = std::make_shared<QCWorkQueue>(
+                    args.qcQueueDir,
+                    args.rater.empty() ? QCWorkQueue::defaultRater() : args.rater,
+                    qcState.rowCount());
+            }
+            // Also replays the journal of a session that did not exit cleanly
+            // (with a work queue, every rater's journal)
+            qcState.loadOutputCsv(qcOutputPath);
             if (mergedCfg.qcColumns)
                 qcState.columnConfigs = *mergedCfg.qcColumns;
             qcState.showOverlay = mergedCfg.global.showOverlay;
@@ -484,6 +735,17 @@ static std::optional<ParsedArgs> parseArgs(int argc, char** argv)
             // Just determine the starting row.
             int startRow = qcState.firstUnratedRow();
             if (startRow < 0) startRow = 0;
+            if (qcState.workQueue)
+            {
+                // The first unrated row of the first block nobody holds
+                startRow = qcState.stepRow(-1, 1);
+                if (startRow < 0)
+                {
+                    std::cerr << "QC work queue " << args.qcQueueDir
+                              << ": every row is rated or held by another rater.\n";
+                    return 0;
+                }
+            }
             qcState.currentRowIndex = startRow;
         }
         else if (volumeFiles.empty() && !mergedCfg.volumes.empty())
@@ -495,35 +757,60 @@ static std::optional<ParsedArgs> parseArgs(int argc, char** argv)
             }
         }
 
-        if (!qcState.active && !volumeFiles.empty())
+        // CLI per-volume flags (LUT, range, label) override config values.
+        auto applyCliVolumeOptions = [&](int vi)
         {
-            for (const auto& path : volumeFiles)
+            if (vi >= static_cast<int>(args.perVolOpts.size()))
+                return;
+            const PerVolOpts& opts = args.perVolOpts[vi];
+            if (opts.colourMap.has_value())
+                state.viewStates_[vi].colourMap = *opts.colourMap;
+            if (opts.range.has_value())
+                state.viewStates_[vi].valueRange = *opts.range;
+            // Label volumes: mark and load LUTs.
+            if (opts.isLabel)
             {
-                try
-                {
-                    state.loadVolume(path);
-                }
-                catch (const std::exception& e)
-                {
-                    std::cerr << "Failed to load volume: " << e.what() << "\n";
-                }
+                state.volumes_[vi].setLabelVolume(true);
+                // Default to Viridis for label volumes unless an explicit LUT was given.
+                if (!opts.colourMap.has_value())
+                    state.viewStates_[vi].colourMap = ColourMapType::Viridis;
             }
+            if (opts.labelDescFile.has_value())
+                state.volumes_[vi].loadLabelDescriptionFile(*opts.labelDescFile);
+        };
+
+        if (args.batchDir)
+        {
+#ifdef HAS_OSMESA
+            return runBatchMode(args, mergedCfg, state, qcState, volumeFiles,
+                                applyCliVolumeOptions);
+#else
+            std::cerr << "Error: --batch is not available in this build; "
+                         "use new_register_batch.\n";
+            return 1;
+#endif
+        }
+
+        std::unique_ptr<VolumeLoader> volumeLoader;
+        if (!qcState.active && !volumeFiles.empty())
+        {
+            // Decode the volumes in the background while GLFW, the backend
+            // and ImGui start up.  Each column is a placeholder until its
+            // volume arrives (installed by the main loop).
+            for (const auto& path : volumeFiles)
+                state.addPendingVolume(path);
+            volumeLoader = std::make_unique<VolumeLoader>(volumeFiles);
 
             // Resolve duplicate basenames (e.g. 1/vol.mnc and 2/vol.mnc)
             // so that each ImGui window gets a unique title.
             state.disambiguateVolumeNames();
 
-            // Load tags: if --tags was specified, use combined tag file;
-            // otherwise fall back to per-volume auto-discovery.
+            // Tags are loaded once every volume has arrived (see
+            // installLoadedVolumes below).
             if (!cliTagPath.empty()) {
                 std::snprintf(state.combinedTagPath_,
                               sizeof(state.combinedTagPath_),
                               "%s", cliTagPath.c_str());
-                state.loadCombinedTags(cliTagPath);
-            } else {
-                for (size_t volIdx = 0; volIdx < state.volumeCount(); ++volIdx) {
-                    state.loadTagsForVolume(static_cast<int>(volIdx));
-                }
             }
         }
         else if (!qcState.active && useTestData)
@@ -543,6 +830,8 @@ static std::optional<ParsedArgs> parseArgs(int argc, char** argv)
             return 1;
         }
 
+        startupTimer.mark("input");
+
         // On Wayland sessions, force GLFW to use its native Wayland backend so that
         // wl_touch events (finger touch on touch screens) are delivered correctly.
         // Without this, GLFW may use XWayland where touch events are silently dropped.
@@ -807,6 +1096,8 @@ static std::optional<ParsedArgs> parseArgs(int argc, char** argv)
             return 1;
         }
 
+        startupTimer.mark("window+backend");
+
         // Update window title after potential fallback
         glfwSetWindowTitle(window, (std::string("New Register (") +
             GraphicsBackend::backendName(backendType) + ")").c_str());
@@ -841,12 +1132,30 @@ static std::optional<ParsedArgs> parseArgs(int argc, char** argv)
         backend->setFontConfig(mergedCfg.global.fontPath, mergedCfg.global.fontSize);
 
         backend->initImGui(window);
+        startupTimer.mark("imgui");
 
 #ifdef HAS_WAYLAND_TOUCH
         WaylandTouch::install(window);
 #endif
 
         state.dpiScale_ = backend->imguiScale();
+
+        if (args.gpuSlicing)
+        {
+            state.gpuSlicing_ = backend->supportsVolumeSlicing();
+            if (!state.gpuSlicing_)
+                std::cerr << "[gpu-slicing] Not supported by the "
+                          << GraphicsBackend::backendName(backendType)
+                          << " backend, using the CPU renderer\n";
+        }
+        if (args.palettedSlices)
+        {
+            state.palettedSlices_ = backend->supportsPalettedSlices();
+            if (!state.palettedSlices_)
+                std::cerr << "[paletted-slices] Not supported by the "
+                          << GraphicsBackend::backendName(backendType)
+                          << " backend, uploading RGBA slices\n";
+        }
         state.localConfigPath_ = localConfigPath;
 
         ViewManager viewManager(state, *backend);
@@ -856,8 +1165,8 @@ static std::optional<ParsedArgs> parseArgs(int argc, char** argv)
         WindowManager windowManager;
         windowManager.setFramebufferCallback(window, backend.get());
 
-        // Create prefetcher for QC mode — queues adjacent rows for
-        // main-thread loading (libminc/HDF5 are not thread-safe).
+        // Create prefetcher for QC mode — reads the rows around the
+        // current one into the volume cache on a background thread.
         std::unique_ptr<Prefetcher> prefetcher;
         if (qcState.active)
         {
@@ -865,10 +1174,46 @@ static std::optional<ParsedArgs> parseArgs(int argc, char** argv)
             interface.setPrefetcher(prefetcher.get());
         }
 
+        // QC thumbnails: rendered in the background from cached volumes or
+        // the middle slice of the files, and kept in a cache file next to
+        // the output CSV.  Reading one slice keeps libmincMutex() free for
+        // the prefetcher.
+        std::unique_ptr<ThumbnailCache> thumbnails;
+        if (qcState.active)
+        {
+            thumbnails = std::make_unique<ThumbnailCache>([&state](const std::string& path) {
+                Volume vol;
+                if (!state.volumeCache_.get(path, vol))
+                    vol.loadMidAxialSlice(path);
+                return vol;
+            });
+            if (!qcState.outputCsvPath.empty())
+                thumbnails->open(qcState.outputCsvPath + ".thumbs");
+            interface.setThumbnails(thumbnails.get());
+        }
+
         if (qcState.active && qcState.rowCount() > 0)
         {
             const auto& paths = qcState.pathsForRow(qcState.currentRowIndex);
+            const QCState::Clock::time_point rowStart = QCState::Clock::now();
+            if (prefetcher)
+            {
+                prefetcher->rowChanged(qcState.currentRowIndex, qcState);
+                prefetcher->awaitRow(paths);
+            }
+            const QCState::Clock::time_point rowRead = QCState::Clock::now();
             state.loadVolumeSet(paths);
+
+            // The first row's visit: nothing is cached yet
+            QCRowVisit visit;
+            visit.row = qcState.currentRowIndex;
+            visit.read = std::chrono::duration<double>(rowRead - rowStart).count();
+            visit.load = std::chrono::duration<double>(QCState::Clock::now() - rowRead).count();
+            visit.missLoad = visit.read + visit.load;
+            visit.cacheMisses = static_cast<int>(
+                std::count_if(paths.begin(), paths.end(),
+                              [](const std::string& p) { return !p.empty(); }));
+            qcState.beginRowVisit(visit, rowStart);
             // Apply global config (sync flags, overlays, colour maps, etc.)
             state.applyConfig(mergedCfg, initW, initH);
             // CLI sync flags override config values.
@@ -889,25 +1234,6 @@ static std::optional<ParsedArgs> parseArgs(int argc, char** argv)
                 }
             }
             viewManager.initializeAllTextures();
-
-            // Queue adjacent rows for prefetching (loaded incrementally each frame).
-            if (prefetcher)
-            {
-                std::vector<std::string> prefetchPaths;
-                int row = qcState.currentRowIndex;
-                if (row > 0)
-                {
-                    const auto& prev = qcState.pathsForRow(row - 1);
-                    prefetchPaths.insert(prefetchPaths.end(), prev.begin(), prev.end());
-                }
-                if (row + 1 < qcState.rowCount())
-                {
-                    const auto& next = qcState.pathsForRow(row + 1);
-                    prefetchPaths.insert(prefetchPaths.end(), next.begin(), next.end());
-                }
-                if (!prefetchPaths.empty())
-                    prefetcher->requestPrefetch(prefetchPaths);
-            }
         }
         else if (!state.volumes_.empty())
         {
@@ -919,51 +1245,99 @@ static std::optional<ParsedArgs> parseArgs(int argc, char** argv)
             if (cliSyncZoom)   state.syncZoom_ = true;
             if (cliSyncPan)    state.syncPan_ = true;
 
-            // CLI LUT flags override config colour maps.
-            for (size_t vi = 0; vi < args.perVolOpts.size() && vi < static_cast<size_t>(state.volumeCount()); ++vi)
+            // Volumes still loading are configured when they arrive.
+            for (int vi = 0; vi < state.volumeCount(); ++vi)
             {
-                if (args.perVolOpts[vi].colourMap.has_value())
-                {
-                    state.viewStates_[vi].colourMap = *args.perVolOpts[vi].colourMap;
-                }
+                if (!state.isVolumeLoading(vi))
+                    applyCliVolumeOptions(vi);
             }
 
-            // CLI range flags: override value range.
-            for (size_t vi = 0; vi < args.perVolOpts.size() && vi < static_cast<size_t>(state.volumeCount()); ++vi)
+            viewManager.initializeAllTextures();
+        }
+
+        interface.setRecordEvery(args.recordEvery);
+        if (args.recordDir)
+            interface.startRecording(*args.recordDir, args.recordEvery);
+
+        // Fill in the placeholder columns as background loads finish.
+        auto installLoadedVolumes = [&]()
+        {
+            bool installed = false;
+            for (VolumeLoader::Result& loaded : volumeLoader->takeLoaded())
             {
-                if (args.perVolOpts[vi].range.has_value())
-                {
-                    state.viewStates_[vi].valueRange = *args.perVolOpts[vi].range;
-                }
+                int vi = static_cast<int>(loaded.index);
+                if (!loaded.error.empty())
+                    std::cerr << "Failed to load volume: " << loaded.error << "\n";
+
+                // Slice prefetch jobs read volume data on a worker thread
+                viewManager.clearSliceCache();
+                state.installVolume(vi, std::move(loaded.volume));
+                if (state.volumes_[vi].data.empty())
+                    continue;
+                state.applyVolumeConfig(mergedCfg, vi);
+                applyCliVolumeOptions(vi);
+                viewManager.invalidateLabelCache(vi);
+                for (int v = 0; v < 3; ++v)
+                    viewManager.updateSliceTexture(vi, v);
+                installed = true;
             }
+            if (installed && state.hasOverlay())
+                viewManager.updateAllOverlayTextures();
 
-            // CLI label flags: mark volumes as label volumes and load LUTs.
-            for (size_t vi = 0; vi < args.perVolOpts.size() && vi < static_cast<size_t>(state.volumeCount()); ++vi)
-            {
-                if (args.perVolOpts[vi].isLabel)
-                {
-                    state.volumes_[vi].setLabelVolume(true);
-                    // Default to Viridis for label volumes unless an explicit LUT was given.
-                    if (!args.perVolOpts[vi].colourMap.has_value())
-                        state.viewStates_[vi].colourMap = ColourMapType::Viridis;
-                }
-                if (args.perVolOpts[vi].labelDescFile.has_value())
-                {
-                    state.volumes_[vi].loadLabelDescriptionFile(*args.perVolOpts[vi].labelDescFile);
+            if (!volumeLoader->done())
+                return;
+
+            // Tag files are read through libminc, which the MINC loader
+            // thread was using until now.  Load tags: if --tags was
+            // specified, use combined tag file; otherwise fall back to
+            // per-volume auto-discovery.
+            if (!cliTagPath.empty()) {
+                state.loadCombinedTags(cliTagPath);
+            } else {
+                for (int volIdx = 0; volIdx < state.volumeCount(); ++volIdx) {
+                    state.loadTagsForVolume(volIdx);
                 }
             }
-
-            viewManager.initializeAllTextures();
-        }
+            if (debugLoggingEnabled())
+                std::cerr << "[startup] " << volumeLoader->total()
+                          << " volume(s) loaded after " << startupTimer.elapsedMs() << " ms\n";
+            volumeLoader.reset();
+        };
+
+        startupTimer.mark("content");
+        bool firstFrame = true;
+
+        // Block for events while nothing changes instead of redrawing at
+        // the refresh rate; keep rendering while work is pending.
+        FrameScheduler scheduler([] { glfwPostEmptyEvent(); });
+        if (volumeLoader)
+            volumeLoader->setNotify([&scheduler] { scheduler.notify(); });
+        if (thumbnails)
+            thumbnails->setNotify([&scheduler] { scheduler.notify(); });
 
         while (!glfwWindowShouldClose(window))
         {
-            glfwPollEvents();
+            bool busy = interface.needsFrames() ||
+                        ImGui::GetIO().WantTextInput;   // blinking cursor
+            bool input = false;
+            if (scheduler.shouldWait(busy))
+            {
+                auto waitStart = FrameScheduler::Clock::now();
+                glfwWaitEventsTimeout(scheduler.idleTimeout());
+                // Returning before the timeout means an event arrived,
+                // including ones ImGui does not see (expose, resize).
+                input = std::chrono::duration<double>(FrameScheduler::Clock::now() - waitStart)
+                            .count() < scheduler.idleTimeout();
+            }
+            else
+            {
+                glfwPollEvents();
+            }
+            input = input || ImGui::GetCurrentContext()->InputEventsQueue.Size > 0;
+            scheduler.beginFrame(input);
 
-            // Incrementally load one prefetched volume per frame (main thread
-            // only — libminc/HDF5 are not thread-safe).
-            if (prefetcher)
-                prefetcher->loadPending();
+            if (volumeLoader)
+                installLoadedVolumes();
 
             // Handle deferred swapchain rebuild (triggered by framebuffer resize callback)
             if (windowManager.needsSwapchainRebuild())
@@ -974,6 +1348,7 @@ static std::optional<ParsedArgs> parseArgs(int argc, char** argv)
                 {
                     backend->rebuildSwapchain(width, height);
                     windowManager.resetRebuildFlag();
+                    scheduler.requestFrames();
                 }
             }
 
@@ -984,13 +1359,60 @@ static std::optional<ParsedArgs> parseArgs(int argc, char** argv)
 
             ImGui::Render();
             backend->endFrame();
+            if (qcState.active)
+                qcState.frameShown(QCState::Clock::now());
+            if (qcState.workQueue)
+                qcState.workQueue->renew();
+
+            if (firstFrame)
+            {
+                startupTimer.mark("first frame");
+                startupTimer.report();
+                firstFrame = false;
+            }
         }
 
+        // Closed while loading: let the loaders finish before the
+        // scheduler they notify goes away
+        volumeLoader.reset();
+
         backend->waitIdle();
+        interface.finishCaptures(*backend);
 
         if (qcState.active)
+        {
             qcState.saveOutputCsv();
+            qcState.closeWorkQueue();
+            qcState.endRowVisit(QCState::Clock::now());
+            if (debugLoggingEnabled() && qcState.timingSummary().visits > 0)
+            {
+                const QCTimingSummary& ts = qcState.timingSummary();
+                std::cerr << "[qc] " << ts.visits << " row(s): first image p50 "
+                          << ts.firstImageP50 * 1000.0 << " ms, p95 "
+                          << ts.firstImageP95 * 1000.0 << " ms; " << ts.cacheHits
+                          << " volume(s) cached, " << ts.cacheMisses << " read ("
+                          << ts.missLoad << " s); " << ts.rowsPerHour << " rows/hour\n";
+            }
+        }
 
+        // Stop the thumbnail worker before the scheduler it notifies goes away
+        if (thumbnails)
+        {
+            thumbnails->save();
+            interface.releaseThumbnails(*backend);
+            interface.setThumbnails(nullptr);
+            thumbnails.reset();
+        }
+
+        if (prefetcher && debugLoggingEnabled())
+        {
+            Prefetcher::Stats ps = prefetcher->stats();
+            std::cerr << "[prefetch] " << ps.hits << " of " << ps.switches
+                      << " row switch(es) cached, " << ps.stallSeconds << " s stalled (max "
+                      << ps.maxStallSeconds << " s); " << ps.loaded << " volume(s) read, "
+                      << ps.failed << " failed; window " << ps.ahead << " ahead, "
+                      << ps.behind << " behind\n";
+        }
         viewManager.destroyAllTextures();
         backend->shutdownTextureSystem();
 
@@ -259,6 +259,24 @@ int main(int argc, char** argv)
 
         bool useOverlay = (volumes.size() >= 2);
 
+        // Colour transfer tables and label palettes are shared by every
+        // slice of the mosaic
+        std::vector<const Volume*> volPtrs;
+        std::vector<ColourTransfer> transfers;
+        std::vector<LabelPalette> labelPalettes(volumes.size());
+        std::vector<const LabelPalette*> palettes(volumes.size(), nullptr);
+        for (size_t i = 0; i < volumes.size(); ++i)
+        {
+            volPtrs.push_back(&volumes[i]);
+            transfers.push_back(buildColourTransfer(params[i]));
+            if (volumes[i].isLabelVolume())
+            {
+                labelPalettes[i] = buildLabelPalette(volumes[i], transfers[i]);
+                palettes[i] = &labelPalettes[i];
+            }
+        }
+        const TransformResult* xfm = xfmResult.valid ? &xfmResult : nullptr;
+
         for (int vi : viewOrder)
         {
             if (sliceCoords[vi].empty())
@@ -272,16 +290,12 @@ int main(int argc, char** argv)
                 RenderedSlice raw;
                 if (useOverlay)
                 {
-                    std::vector<const Volume*> volPtrs;
-                    for (auto& v : volumes)
-                        volPtrs.push_back(&v);
-
-                    const TransformResult* xfm = xfmResult.valid ? &xfmResult : nullptr;
-                    raw = renderOverlaySlice(volPtrs, params, vi, sliceIdx, xfm);
+                    raw = renderOverlaySlice(volPtrs, params, transfers, palettes,
+                                             vi, sliceIdx, xfm);
                 }
                 else
                 {
-                    raw = renderSlice(volumes[0], params[0], vi, sliceIdx);
+                    raw = renderSlice(volumes[0], transfers[0], palettes[0], vi, sliceIdx);
                 }
 
                 // Apply crop before aspect resampling (crop is in voxel space)
@@ -30,6 +30,7 @@ struct Texture
     ImTextureID id = 0;
     int width  = 0;
     int height = 0;
+    int mipLevels = 1;
 };
 
 /// Abstract graphics backend interface.
@@ -108,10 +109,14 @@ public:
 
     // --- Texture management ---
 
-    /// Create a GPU texture from RGBA8 pixel data.
-    virtual std::unique_ptr<Texture> createTexture(int w, int h, const void* data) = 0;
+    /// Create a GPU texture from RGBA8 pixel data.  With @p mipLevels > 1,
+    /// @p data holds that many levels laid out as in MipChain.h, and the
+    /// texture is sampled trilinearly.
+    virtual std::unique_ptr<Texture> createTexture(int w, int h, const void* data,
+                                                   int mipLevels = 1) = 0;
 
-    /// Update an existing texture with new pixel data (same dimensions).
+    /// Update an existing texture with new pixel data (same dimensions and
+    /// number of mip levels).
     virtual void updateTexture(Texture* tex, const void* data) = 0;
 
     /// Destroy GPU resources associated with a texture.
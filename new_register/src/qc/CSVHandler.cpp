@@ -147,6 +147,7 @@ bool CSVHandler::loadInputCSV(const std::string& filename)
         records_.push_back(record);
     }
     
+    recount();
     std::cout << "Loaded " << records_.size() << " records from " << filename << std::endl;
     return !records_.empty();
 }
@@ -209,6 +210,7 @@ bool CSVHandler::loadOutputCSV(const std::string& filename)
     if (!loadedRecords.empty())
     {
         records_ = loadedRecords;
+        recount();
         std::cout << "Resumed from " << filename << " (" << records_.size() << " records)" << std::endl;
         return true;
     }
@@ -242,4 +244,30 @@ bool CSVHandler::saveOutputCSV(const std::string& filename)
     return true;
 }
 
+void CSVHandler::setStatus(size_t index, const std::string& status)
+{
+    QCRecord& record = records_[index];
+    countStatus(record.qc_status, -1);
+    record.qc_status = status;
+    countStatus(record.qc_status, +1);
+}
+
+void CSVHandler::countStatus(const std::string& status, int delta)
+{
+    if (status.empty())
+        return;
+    ratedCount_ += delta;
+    if (status == "Pass")
+        passCount_ += delta;
+    else if (status == "Fail")
+        failCount_ += delta;
+}
+
+void CSVHandler::recount()
+{
+    ratedCount_ = passCount_ = failCount_ = 0;
+    for (const auto& record : records_)
+        countStatus(record.qc_status, +1);
+}
+
 } // namespace QC
@@ -33,15 +33,34 @@ public:
     // Save output CSV (id, visit, picture, QC, notes)
     bool saveOutputCSV(const std::string& filename);
 
-    // Get all records
+    // Get all records (change qc_status through setStatus())
     const std::vector<QCRecord>& getRecords() const { return records_; }
     std::vector<QCRecord>& getRecords() { return records_; }
 
     // Get record count
     size_t getRecordCount() const { return records_.size(); }
 
+    // Set a record's QC status ("Pass", "Fail" or empty), keeping the
+    // counters below current
+    void setStatus(size_t index, const std::string& status);
+
+    // Records with a status / with "Pass" / with "Fail"; maintained
+    // incrementally so the UI need not scan every record per frame
+    size_t getRatedCount() const { return ratedCount_; }
+    size_t getPassCount() const { return passCount_; }
+    size_t getFailCount() const { return failCount_; }
+
 private:
     std::vector<QCRecord> records_;
+    size_t ratedCount_ = 0;
+    size_t passCount_ = 0;
+    size_t failCount_ = 0;
+
+    // Helper: add (+1) or remove (-1) a status from the counters
+    void countStatus(const std::string& status, int delta);
+
+    // Helper: rebuild the counters after loading
+    void recount();
 
     // Helper: trim whitespace
     static std::string trim(const std::string& str);
@@ -0,0 +1,346 @@
+#include "ImageDecoder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <exception>
+
+namespace QC
+{
+
+ImageDecoder::ImageDecoder(DecodeFn decode, size_t maxBytes, unsigned workers)
+    : decode_(std::move(decode))
+    , maxBytes_(maxBytes)
+{
+    if (workers == 0)
+    {
+        // Leave a core for the main thread
+        unsigned cores = std::thread::hardware_concurrency();
+        workers = std::clamp(cores > 1 ? cores - 1 : 1u, 1u, 4u);
+    }
+    for (unsigned i = 0; i < workers; ++i)
+        workers_.emplace_back([this] { run(); });
+}
+
+ImageDecoder::~ImageDecoder()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+        queue_.clear();
+    }
+    workCv_.notify_all();
+    doneCv_.notify_all();
+    // Waits for decodes already running
+    for (std::thread& t : workers_)
+        t.join();
+}
+
+void ImageDecoder::setDisplaySize(int width, int height)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    displayWidth_ = width;
+    displayHeight_ = height;
+}
+
+void ImageDecoder::setMipmaps(bool enabled)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    mipmaps_ = enabled;
+}
+
+void ImageDecoder::setDecodedCallback(std::function<void()> callback)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    onDecoded_ = std::move(callback);
+}
+
+void ImageDecoder::prefetch(const std::vector<std::string>& paths)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.clear();
+        // Mark the cached ones as used, the most urgent last so it ends up
+        // at the front of the LRU list
+        for (auto p = paths.rbegin(); p != paths.rend(); ++p)
+        {
+            auto it = index_.find(Key{*p, Resolution::Display});
+            if (it != index_.end())
+                touch(it);
+        }
+        for (const std::string& p : paths)
+        {
+            Key key{p, Resolution::Display};
+            if (!p.empty() && !index_.count(key) && !inFlight_.count(key) &&
+                std::find(queue_.begin(), queue_.end(), key) == queue_.end())
+                queue_.push_back(std::move(key));
+        }
+    }
+    workCv_.notify_all();
+}
+
+void ImageDecoder::enqueueFront(const Key& key)
+{
+    if (index_.count(key) || inFlight_.count(key))
+        return;
+    queue_.erase(std::remove(queue_.begin(), queue_.end(), key), queue_.end());
+    queue_.push_front(key);
+    workCv_.notify_one();
+}
+
+void ImageDecoder::request(const std::string& path, Resolution resolution)
+{
+    if (path.empty())
+        return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    enqueueFront(Key{path, resolution});
+}
+
+ImageDecoder::ImagePtr ImageDecoder::acquire(const std::string& path, Resolution resolution)
+{
+    // A row without a picture: nothing to decode or cache
+    if (path.empty())
+        return std::make_shared<const Image>();
+
+    const Key key{path, resolution};
+    auto start = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(mutex_);
+    ++stats_.acquired;
+    pinned_ = key;
+
+    auto it = index_.find(key);
+    if (it != index_.end())
+    {
+        ++stats_.hits;
+        touch(it);
+        return it->second->second;
+    }
+
+    // Not decoded yet: move it to the head of the queue unless a worker
+    // already has it
+    enqueueFront(key);
+    doneCv_.wait(lock, [&] { return stop_ || index_.count(key) > 0; });
+    stats_.waitSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    it = index_.find(key);
+    if (it == index_.end())
+        return std::make_shared<const Image>();   // shutting down
+    touch(it);
+    return it->second->second;
+}
+
+ImageDecoder::ImagePtr ImageDecoder::find(const std::string& path, Resolution resolution) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(Key{path, resolution});
+    return it != index_.end() ? it->second->second : nullptr;
+}
+
+bool ImageDecoder::contains(const std::string& path, Resolution resolution) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return index_.count(Key{path, resolution}) > 0;
+}
+
+size_t ImageDecoder::bytes() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return bytes_;
+}
+
+ImageDecoder::Stats ImageDecoder::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+// ---------------------------------------------------------------------------
+// Reduction
+// ---------------------------------------------------------------------------
+
+int ImageDecoder::reductionSteps(int width, int height, int maxWidth, int maxHeight)
+{
+    if (maxWidth <= 0 || maxHeight <= 0)
+        return 0;
+    // The fit is limited by the tighter side; halve while the image at
+    // half the size still covers it there
+    int steps = 0;
+    while (width >= 2 && height >= 2 &&
+           (width / 2 >= maxWidth || height / 2 >= maxHeight))
+    {
+        width /= 2;
+        height /= 2;
+        ++steps;
+    }
+    return steps;
+}
+
+void ImageDecoder::halve(const unsigned char* src, int width, int height, unsigned char* dst)
+{
+    const int dw = mipLevelSize(width, 1);
+    const int dh = mipLevelSize(height, 1);
+    const size_t srcStride = static_cast<size_t>(width) * 4;
+
+    for (int y = 0; y < dh; ++y)
+    {
+        const unsigned char* row0 = src + static_cast<size_t>(std::min(2 * y, height - 1)) * srcStride;
+        const unsigned char* row1 = src + static_cast<size_t>(std::min(2 * y + 1, height - 1)) * srcStride;
+        unsigned char* out = dst + static_cast<size_t>(y) * dw * 4;
+
+        // Pairs of whole pixels, channel by channel: no branches, so the
+        // compiler can vectorize it
+        const int pairs = width / 2;
+        for (int px = 0; px < pairs; ++px)
+        {
+            const unsigned char* a = row0 + px * 8;
+            const unsigned char* b = row1 + px * 8;
+            for (int c = 0; c < 4; ++c)
+                out[px * 4 + c] = static_cast<unsigned char>((a[c] + a[c + 4] + b[c] + b[c + 4] + 2) >> 2);
+        }
+        // A single column is averaged with itself
+        if (pairs < dw)
+        {
+            const int x = (width - 1) * 4;
+            for (int c = 0; c < 4; ++c)
+                out[pairs * 4 + c] = static_cast<unsigned char>(
+                    (2 * row0[x + c] + 2 * row1[x + c] + 2) >> 2);
+        }
+    }
+}
+
+ImageDecoder::Image ImageDecoder::reduce(Image image, int steps, bool mipmaps)
+{
+    if (image.fullWidth == 0)
+    {
+        image.fullWidth = image.width;
+        image.fullHeight = image.height;
+    }
+    if (!image.pixels || (steps == 0 && !mipmaps))
+        return image;
+
+    // Halve into a scratch buffer until the display level is reached
+    int w = image.width;
+    int h = image.height;
+    std::unique_ptr<unsigned char, void (*)(void*)> level(std::move(image.pixels));
+    for (int i = 0; i < steps; ++i)
+    {
+        const int nw = mipLevelSize(w, 1);
+        const int nh = mipLevelSize(h, 1);
+        std::unique_ptr<unsigned char, void (*)(void*)> next(
+            static_cast<unsigned char*>(std::malloc(static_cast<size_t>(nw) * nh * 4)), std::free);
+        if (!next)
+            return Image{};
+        halve(level.get(), w, h, next.get());
+        level = std::move(next);
+        w = nw;
+        h = nh;
+    }
+
+    image.width = w;
+    image.height = h;
+    image.mipLevels = mipmaps ? mipLevelCount(w, h) : 1;
+    if (image.mipLevels == 1)
+    {
+        image.pixels = std::move(level);
+        return image;
+    }
+
+    // Mip chain: the display level first, each level halved from the one
+    // before it
+    unsigned char* chain = static_cast<unsigned char*>(
+        std::malloc(mipChainBytes(w, h, image.mipLevels)));
+    if (!chain)
+        return Image{};
+    std::memcpy(chain, level.get(), static_cast<size_t>(w) * h * 4);
+    for (int i = 1; i < image.mipLevels; ++i)
+    {
+        halve(chain + mipLevelOffset(w, h, i - 1), mipLevelSize(w, i - 1), mipLevelSize(h, i - 1),
+              chain + mipLevelOffset(w, h, i));
+    }
+    image.pixels.reset(chain);
+    return image;
+}
+
+// ---------------------------------------------------------------------------
+// Cache and workers
+// ---------------------------------------------------------------------------
+
+void ImageDecoder::touch(Index::iterator it)
+{
+    lru_.splice(lru_.begin(), lru_, it->second);
+}
+
+void ImageDecoder::insert(const Key& key, ImagePtr image)
+{
+    bytes_ += image->bytes();
+    lru_.emplace_front(key, std::move(image));
+    index_[key] = lru_.begin();
+
+    // Drop from the back, keeping the new image and the pinned one
+    auto victim = lru_.end();
+    while (bytes_ > maxBytes_ && victim != std::next(lru_.begin()))
+    {
+        --victim;
+        if (victim->first == pinned_)
+            continue;
+        bytes_ -= victim->second->bytes();
+        index_.erase(victim->first);
+        victim = lru_.erase(victim);
+    }
+}
+
+void ImageDecoder::run()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;)
+    {
+        workCv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+        if (stop_)
+            return;
+
+        Key key = std::move(queue_.front());
+        queue_.pop_front();
+        if (index_.count(key) || inFlight_.count(key))
+            continue;
+        inFlight_.insert(key);
+        const bool full = key.resolution == Resolution::Full;
+        const int displayWidth = displayWidth_;
+        const int displayHeight = displayHeight_;
+        const bool mipmaps = mipmaps_;
+        std::function<void()> onDecoded = onDecoded_;
+        lock.unlock();
+
+        // A throwing decoder must not take the worker (and the process)
+        // down: the image is cached as failed, like a decoder error
+        Image decoded;
+        try
+        {
+            decoded = decode_(key.path);
+        }
+        catch (const std::exception&)
+        {
+            decoded = Image{};
+        }
+        int steps = full ? 0 : reductionSteps(decoded.width, decoded.height,
+                                              displayWidth, displayHeight);
+        auto image = std::make_shared<Image>(reduce(std::move(decoded), steps, mipmaps));
+
+        lock.lock();
+        inFlight_.erase(key);
+        if (image->pixels)
+            ++stats_.decoded;
+        else
+            ++stats_.failed;
+        insert(key, std::move(image));
+        doneCv_.notify_all();
+
+        if (onDecoded)
+        {
+            lock.unlock();
+            onDecoded();
+            lock.lock();
+        }
+    }
+}
+
+} // namespace QC
@@ -0,0 +1,186 @@
+#ifndef IMAGE_DECODER_H
+#define IMAGE_DECODER_H
+
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "MipChain.h"
+
+namespace QC
+{
+
+// Decodes images on a pool of worker threads into an LRU cache of RGBA
+// buffers, so that stepping through the QC list does not wait for PNG
+// decoding.  The main thread calls prefetch() with the images around the
+// current one after each navigation step, and acquire() for the image it
+// is about to upload; acquire() returns immediately when the image was
+// decoded ahead of time.
+//
+// The cache is bounded by the total size of its pixel buffers.  When it is
+// full, the least recently used images are dropped first; prefetch() marks
+// its images as used, so those near the current record stay.  The image
+// most recently acquired is never dropped, however large.
+//
+// Images are reduced on the worker to the size they are shown at: after
+// setDisplaySize(), each one is halved with a 2x2 box filter while it
+// still covers the display area at half the size, so the GPU never
+// minifies by more than 2x and large mosaics are uploaded at a fraction of
+// their size.  Resolution::Full asks for the image as decoded, for zooming
+// in.  With setMipmaps(), a mip chain is built below the uploaded level.
+//
+// Decoding itself is done by a function passed to the constructor
+// (stbi_load in new_qc), which must be safe to call from several threads.
+// If it throws, the image is cached as failed.
+class ImageDecoder
+{
+public:
+    struct Image
+    {
+        int width = 0;
+        int height = 0;
+        int channels = 0;     // channels in the file; pixels are always RGBA
+        int fullWidth = 0;    // size in the file, before reduction
+        int fullHeight = 0;
+        int mipLevels = 1;
+        // mipLevels levels laid out as in MipChain.h, freed with free();
+        // null if decoding failed
+        std::unique_ptr<unsigned char, void (*)(void*)> pixels{nullptr, std::free};
+
+        size_t bytes() const { return pixels ? mipChainBytes(width, height, mipLevels) : 0; }
+        bool reduced() const { return width < fullWidth || height < fullHeight; }
+    };
+    using ImagePtr = std::shared_ptr<const Image>;
+    // Returns one RGBA level at the file's size (fullWidth/fullHeight unset)
+    using DecodeFn = std::function<Image(const std::string& path)>;
+
+    enum class Resolution
+    {
+        Display,   // reduced to the display size
+        Full,      // as decoded
+    };
+
+    struct Stats
+    {
+        int acquired = 0;           // acquire() calls
+        int hits = 0;               // ... that found the image decoded
+        double waitSeconds = 0.0;   // time acquire() waited, in total
+        int decoded = 0;            // images decoded by the workers
+        int failed = 0;
+    };
+
+    static constexpr size_t kDefaultMaxBytes = size_t(512) << 20;
+
+    // @p workers: 0 picks one per spare core, up to 4.
+    explicit ImageDecoder(DecodeFn decode, size_t maxBytes = kDefaultMaxBytes,
+                          unsigned workers = 0);
+    ~ImageDecoder();
+
+    // Not copyable or movable (owns the worker threads).
+    ImageDecoder(const ImageDecoder&) = delete;
+    ImageDecoder& operator=(const ImageDecoder&) = delete;
+
+    // Size of the image area in pixels, for images decoded from now on;
+    // 0 disables reduction.
+    void setDisplaySize(int width, int height);
+
+    // Build mip chains for images decoded from now on.
+    void setMipmaps(bool enabled);
+
+    // Called on a worker thread after each decode, e.g. to wake the
+    // main loop.  Set before queueing work.
+    void setDecodedCallback(std::function<void()> callback);
+
+    // Decode @p paths at display resolution, most urgent first.  Replaces
+    // the images queued by the previous call that have not started yet.
+    void prefetch(const std::vector<std::string>& paths);
+
+    // Queue @p path ahead of the prefetched images, without waiting.
+    void request(const std::string& path, Resolution resolution);
+
+    // The decoded image for @p path, waiting for (or queueing) its decode
+    // if needed.  A failed decode, or an empty path (a CSV row without a
+    // picture), returns an image without pixels.
+    ImagePtr acquire(const std::string& path, Resolution resolution = Resolution::Display);
+
+    // The decoded image if it is cached, else null; does not wait.
+    ImagePtr find(const std::string& path, Resolution resolution) const;
+
+    bool contains(const std::string& path, Resolution resolution = Resolution::Display) const;
+    size_t bytes() const;
+    size_t maxBytes() const { return maxBytes_; }
+    unsigned workerCount() const { return static_cast<unsigned>(workers_.size()); }
+    Stats stats() const;
+
+    // Halvings that keep a @p width x @p height image at least as large as
+    // its fit into @p maxWidth x @p maxHeight.
+    static int reductionSteps(int width, int height, int maxWidth, int maxHeight);
+
+    // 2x2 box filter of one RGBA level into @p dst (mipLevelSize() of each
+    // side).  As in GPU mip generation, an odd last row or column is
+    // dropped, and a side of one pixel stays one pixel.
+    static void halve(const unsigned char* src, int width, int height, unsigned char* dst);
+
+    // @p image reduced by @p steps halvings, then with a full mip chain if
+    // @p mipmaps.  Returns @p image itself when there is nothing to do.
+    static Image reduce(Image image, int steps, bool mipmaps);
+
+private:
+    // Cache and queue key: a path at one resolution
+    struct Key
+    {
+        std::string path;
+        Resolution resolution = Resolution::Display;
+
+        bool operator==(const Key& o) const { return resolution == o.resolution && path == o.path; }
+    };
+    struct KeyHash
+    {
+        size_t operator()(const Key& k) const
+        {
+            return std::hash<std::string>()(k.path) ^ static_cast<size_t>(k.resolution);
+        }
+    };
+    using Entry = std::pair<Key, ImagePtr>;
+    using Index = std::unordered_map<Key, std::list<Entry>::iterator, KeyHash>;
+
+    void run();
+    void enqueueFront(const Key& key);               // mutex_ held
+    void touch(Index::iterator it);                  // mutex_ held
+    void insert(const Key& key, ImagePtr image);     // mutex_ held
+
+    DecodeFn decode_;
+    size_t maxBytes_;
+    std::function<void()> onDecoded_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable workCv_;    // queue filled or stop requested
+    std::condition_variable doneCv_;    // an image was decoded
+    std::deque<Key> queue_;             // most urgent first
+    std::unordered_set<Key, KeyHash> inFlight_;
+    std::list<Entry> lru_;              // most recently used first
+    Index index_;
+    size_t bytes_ = 0;
+    Key pinned_;                        // last acquired key, never evicted
+    int displayWidth_ = 0;
+    int displayHeight_ = 0;
+    bool mipmaps_ = false;
+    bool stop_ = false;
+    Stats stats_;
+
+    std::vector<std::thread> workers_;  // declared last: started once the rest exists
+};
+
+} // namespace QC
+
+#endif // IMAGE_DECODER_H
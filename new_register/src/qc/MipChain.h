@@ -0,0 +1,51 @@
+#ifndef MIP_CHAIN_H
+#define MIP_CHAIN_H
+
+#include <algorithm>
+#include <cstddef>
+
+namespace QC
+{
+
+// Layout of an RGBA8 mip chain in one buffer: level 0 first, each level
+// half the size of the previous one (rounded down, at least 1 pixel), with
+// no padding between levels.  Shared by ImageDecoder, which builds the
+// chain, and the backends, which upload it.
+
+// Size of @p level for a level-0 size of @p size.
+inline int mipLevelSize(int size, int level)
+{
+    return std::max(1, size >> level);
+}
+
+// Levels in a full chain down to 1x1.
+inline int mipLevelCount(int w, int h)
+{
+    int levels = 1;
+    while (w > 1 || h > 1)
+    {
+        w = std::max(1, w / 2);
+        h = std::max(1, h / 2);
+        ++levels;
+    }
+    return levels;
+}
+
+// Byte offset of @p level in the buffer.
+inline size_t mipLevelOffset(int w, int h, int level)
+{
+    size_t offset = 0;
+    for (int i = 0; i < level; ++i)
+        offset += static_cast<size_t>(mipLevelSize(w, i)) * mipLevelSize(h, i) * 4;
+    return offset;
+}
+
+// Bytes of the first @p levels levels.
+inline size_t mipChainBytes(int w, int h, int levels)
+{
+    return mipLevelOffset(w, h, levels);
+}
+
+} // namespace QC
+
+#endif // MIP_CHAIN_H
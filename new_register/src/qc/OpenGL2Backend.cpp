@@ -1,5 +1,6 @@
 #include "OpenGL2Backend.h"
 #include "Backend.h"
+#include "MipChain.h"
 
 #include <imgui.h>
 #include <imgui_internal.h>
@@ -16,6 +17,11 @@
 #include <GL/gl.h>
 #endif
 
+// OpenGL 1.2; missing from the Windows 1.1 headers
+#ifndef GL_TEXTURE_MAX_LEVEL
+#define GL_TEXTURE_MAX_LEVEL 0x813D
+#endif
+
 #include <iostream>
 #include <stdexcept>
 #include <cstring>
@@ -262,16 +268,26 @@ std::vector<uint8_t> OpenGL2Backend::captureScreenshot(int& width, int& height)
 // Texture management
 // ---------------------------------------------------------------------------
 
-std::unique_ptr<Texture> OpenGL2Backend::createTexture(int w, int h, const void* data)
+std::unique_ptr<Texture> OpenGL2Backend::createTexture(int w, int h, const void* data,
+                                                       int mipLevels)
 {
     GLuint texId = 0;
     GL_CHECK(glGenTextures(1, &texId));
     GL_CHECK(glBindTexture(GL_TEXTURE_2D, texId));
-    GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                             mipLevels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR));
     GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
     GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
     GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
-    GL_CHECK(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, data));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, mipLevels - 1));
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    for (int level = 0; level < mipLevels; ++level)
+    {
+        GL_CHECK(glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA,
+                              QC::mipLevelSize(w, level), QC::mipLevelSize(h, level), 0,
+                              GL_RGBA, GL_UNSIGNED_BYTE,
+                              bytes ? bytes + QC::mipLevelOffset(w, h, level) : nullptr));
+    }
     GL_CHECK(glBindTexture(GL_TEXTURE_2D, 0));
 
     if (texId == 0)
@@ -281,6 +297,7 @@ std::unique_ptr<Texture> OpenGL2Backend::createTexture(int w, int h, const void*
     tex->id     = static_cast<ImTextureID>(static_cast<intptr_t>(texId));
     tex->width  = w;
     tex->height = h;
+    tex->mipLevels = mipLevels;
 
     glTextures_[tex->id] = texId;
     return tex;
@@ -292,9 +309,15 @@ void OpenGL2Backend::updateTexture(Texture* tex, const void* data)
     auto it = glTextures_.find(tex->id);
     if (it == glTextures_.end()) return;
 
+    const auto* bytes = static_cast<const unsigned char*>(data);
     GL_CHECK(glBindTexture(GL_TEXTURE_2D, it->second));
-    GL_CHECK(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, tex->width, tex->height,
-                    GL_RGBA, GL_UNSIGNED_BYTE, data));
+    for (int level = 0; level < tex->mipLevels; ++level)
+    {
+        GL_CHECK(glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0,
+                        QC::mipLevelSize(tex->width, level), QC::mipLevelSize(tex->height, level),
+                        GL_RGBA, GL_UNSIGNED_BYTE,
+                        bytes + QC::mipLevelOffset(tex->width, tex->height, level)));
+    }
     GL_CHECK(glBindTexture(GL_TEXTURE_2D, 0));
 }
 
@@ -37,7 +37,8 @@ public:
 
     std::vector<uint8_t> captureScreenshot(int& width, int& height) override;
 
-    std::unique_ptr<Texture> createTexture(int w, int h, const void* data) override;
+    std::unique_ptr<Texture> createTexture(int w, int h, const void* data,
+                                           int mipLevels) override;
     void updateTexture(Texture* tex, const void* data) override;
     void destroyTexture(Texture* tex) override;
     void shutdownTextureSystem() override;
@@ -1,5 +1,5 @@
 #include "QCApp.h"
-#include "OsPrefetch.h"
+#include "FrameScheduler.h"
 #include <iostream>
 #include <algorithm>
 #include <cmath>
@@ -10,6 +10,7 @@
 #include <GLFW/glfw3.h>
 
 #include "imgui.h"
+#include "imgui_internal.h"
 #include "WaylandTouchInput.h"
 
 namespace QC
@@ -23,7 +24,8 @@ QCApp::~QCApp()
 }
 
 bool QCApp::init(const std::string& inputFile, const std::string& outputFile,
-                 const std::optional<float>& scaleFactor, BackendType backendType)
+                 const std::optional<float>& scaleFactor, BackendType backendType,
+                 bool mipmaps)
 {
     outputFile_ = outputFile;
 
@@ -154,14 +156,26 @@ bool QCApp::init(const std::string& inputFile, const std::string& outputFile,
     WaylandTouch::install(window_);
 #endif
 
-    // Load initial image
-    loadImage(csvHandler_.getRecords()[currentIndex_].picture_path);
+    // Images are decoded on worker threads; only the upload happens here
+    decoder_ = std::make_unique<ImageDecoder>([](const std::string& path) {
+        ImageDecoder::Image image;
+        image.pixels.reset(stbi_load(path.c_str(), &image.width, &image.height,
+                                     &image.channels, 4));
+        return image;
+    });
+    decoder_->setMipmaps(mipmaps);
+    // Wake the main loop when a full-resolution image is ready to swap in
+    decoder_->setDecodedCallback([] { glfwPostEmptyEvent(); });
+    // Until the first frame lays out the image panel, reduce to the window
+    {
+        int fbW, fbH;
+        glfwGetFramebufferSize(window_, &fbW, &fbH);
+        decoder_->setDisplaySize(fbW, fbH);
+    }
 
-    // Prefetch the first few records so initial navigation is instant
-    if (csvHandler_.getRecordCount() > 1)
-        os_prefetch_file(csvHandler_.getRecords()[1].picture_path);
-    if (csvHandler_.getRecordCount() > 2)
-        os_prefetch_file(csvHandler_.getRecords()[2].picture_path);
+    // Load initial image, and decode the next ones while it is viewed
+    prefetchAround(currentIndex_, 1);
+    loadImage(csvHandler_.getRecords()[currentIndex_].picture_path);
 
     running_ = true;
     return true;
@@ -169,9 +183,26 @@ bool QCApp::init(const std::string& inputFile, const std::string& outputFile,
 
 void QCApp::run()
 {
+    // Redraw only after input or while the UI needs it; a reviewer
+    // looking at one image should not keep the GPU busy.
+    FrameScheduler scheduler([] { glfwPostEmptyEvent(); });
+
     while (running_)
     {
-        glfwPollEvents();
+        bool input = false;
+        if (scheduler.shouldWait(ImGui::GetIO().WantTextInput))
+        {
+            auto waitStart = FrameScheduler::Clock::now();
+            glfwWaitEventsTimeout(scheduler.idleTimeout());
+            input = std::chrono::duration<double>(FrameScheduler::Clock::now() - waitStart)
+                        .count() < scheduler.idleTimeout();
+        }
+        else
+        {
+            glfwPollEvents();
+        }
+        input = input || ImGui::GetCurrentContext()->InputEventsQueue.Size > 0;
+        scheduler.beginFrame(input);
 
         // Handle swapchain rebuild (Vulkan resize)
         if (backend_->needsSwapchainRebuild())
@@ -179,7 +210,10 @@ void QCApp::run()
             int w, h;
             glfwGetFramebufferSize(window_, &w, &h);
             if (w > 0 && h > 0)
+            {
                 backend_->rebuildSwapchain(w, h);
+                scheduler.requestFrames();
+            }
         }
 
         backend_->beginFrame();
@@ -205,6 +239,16 @@ void QCApp::shutdown()
     // GPU is idle causes VK_ERROR_DEVICE_LOST on the next vkDeviceWaitIdle call.
     backend_->waitIdle();
 
+    // Stop the decode workers and report how often navigation found its
+    // image already decoded
+    if (decoder_)
+    {
+        ImageDecoder::Stats st = decoder_->stats();
+        std::cout << "Image cache: " << st.hits << "/" << st.acquired << " hits, "
+                  << st.waitSeconds << " s waiting for decodes" << std::endl;
+        decoder_.reset();
+    }
+
     if (currentImage_.texture)
     {
         backend_->destroyTexture(currentImage_.texture.get());
@@ -236,36 +280,82 @@ void QCApp::shutdown()
 
 void QCApp::loadImage(const std::string& path)
 {
-    // Destroy previous texture — wait for GPU to finish all in-flight frames first.
-    // Without this, the Vulkan descriptor set freed by destroyTexture() may still be
-    // referenced by a submitted (but not yet executed) command buffer, causing
-    // vkQueueWaitIdle to fail with device-lost in the next UpdateTexture() call.
-    if (currentImage_.texture)
-    {
-        backend_->waitIdle();
-        backend_->destroyTexture(currentImage_.texture.get());
-        currentImage_.texture.reset();
-    }
+    // Usually decoded ahead by prefetchAround(); otherwise waits for it
+    ImageDecoder::ImagePtr image = decoder_->acquire(path);
+    currentImage_.path = path;
+    zoom_ = 1.0f;
 
-    int width, height, channels;
-    unsigned char* data = stbi_load(path.c_str(), &width, &height, &channels, 4);
-
-    if (!data)
+    if (!image->pixels)
     {
         std::cerr << "Warning: Failed to load image: " << path << std::endl;
+        if (currentImage_.texture)
+        {
+            backend_->destroyTexture(currentImage_.texture.get());
+            currentImage_.texture.reset();
+        }
         currentImage_.width = 0;
         currentImage_.height = 0;
         return;
     }
 
-    currentImage_.width = width;
-    currentImage_.height = height;
-    currentImage_.channels = channels;
+    uploadImage(*image);
 
-    currentImage_.texture = backend_->createTexture(width, height, data);
-    stbi_image_free(data);
+    std::cout << "Loaded image: " << path << " (" << image->fullWidth << "x" << image->fullHeight;
+    if (image->reduced())
+        std::cout << ", shown at " << image->width << "x" << image->height;
+    std::cout << ")" << std::endl;
+}
+
+void QCApp::uploadImage(const ImageDecoder::Image& image)
+{
+    // An image of the same size is uploaded into the current texture.
+    // Otherwise the old texture is destroyed; the backend defers freeing it
+    // until no in-flight frame can still sample it, so switching images
+    // never waits for the GPU to drain.
+    if (currentImage_.texture &&
+        currentImage_.texture->width == image.width && currentImage_.texture->height == image.height &&
+        currentImage_.texture->mipLevels == image.mipLevels)
+    {
+        backend_->updateTexture(currentImage_.texture.get(), image.pixels.get());
+    }
+    else
+    {
+        if (currentImage_.texture)
+            backend_->destroyTexture(currentImage_.texture.get());
+        currentImage_.texture = backend_->createTexture(image.width, image.height,
+                                                        image.pixels.get(), image.mipLevels);
+    }
 
-    std::cout << "Loaded image: " << path << " (" << width << "x" << height << ")" << std::endl;
+    currentImage_.width = image.width;
+    currentImage_.height = image.height;
+    currentImage_.fullWidth = image.fullWidth;
+    currentImage_.fullHeight = image.fullHeight;
+    currentImage_.channels = image.channels;
+}
+
+void QCApp::setZoom(float zoom)
+{
+    zoom_ = std::clamp(zoom, 1.0f, kMaxZoom);
+}
+
+void QCApp::prefetchAround(size_t index, int direction)
+{
+    // The current image first, then alternately the next and previous
+    // ones, starting in the direction of travel
+    const auto& records = csvHandler_.getRecords();
+    std::vector<std::string> paths;
+    paths.push_back(records[index].picture_path);
+    for (size_t d = 1; d <= kPrefetchAhead; ++d)
+    {
+        for (int side : {direction, -direction})
+        {
+            if (side > 0 && index + d < records.size())
+                paths.push_back(records[index + d].picture_path);
+            else if (side < 0 && index >= d)
+                paths.push_back(records[index - d].picture_path);
+        }
+    }
+    decoder_->prefetch(paths);
 }
 
 void QCApp::renderCaseList()
@@ -283,41 +373,50 @@ void QCApp::renderCaseList()
         ImGui::TableSetupScrollFreeze(0, 1);
         ImGui::TableHeadersRow();
 
-        for (size_t ri = 0; ri < records.size(); ++ri)
+        // Only the visible rows are submitted, so the list costs the same
+        // for any number of records
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(records.size()));
+        if (scrollToCurrentRow_)
+            clipper.IncludeItemByIndex(static_cast<int>(currentIndex_));
+        while (clipper.Step())
         {
-            ImGui::TableNextRow();
+            for (size_t ri = clipper.DisplayStart; ri < static_cast<size_t>(clipper.DisplayEnd); ++ri)
+            {
+                ImGui::TableNextRow();
 
-            const auto& record = records[ri];
-            bool isCurrent = (ri == currentIndex_);
+                const auto& record = records[ri];
+                bool isCurrent = (ri == currentIndex_);
 
-            if (record.qc_status == "Fail")
-                ImGui::TableSetBgColor(ImGuiTableBgTarget_RowBg0, IM_COL32(180, 40, 40, 60));
-            else if (record.qc_status == "Pass")
-                ImGui::TableSetBgColor(ImGuiTableBgTarget_RowBg0, IM_COL32(40, 180, 40, 60));
+                if (record.qc_status == "Fail")
+                    ImGui::TableSetBgColor(ImGuiTableBgTarget_RowBg0, IM_COL32(180, 40, 40, 60));
+                else if (record.qc_status == "Pass")
+                    ImGui::TableSetBgColor(ImGuiTableBgTarget_RowBg0, IM_COL32(40, 180, 40, 60));
 
-            ImGui::TableSetColumnIndex(0);
+                ImGui::TableSetColumnIndex(0);
 
-            char selectId[64];
-            std::snprintf(selectId, sizeof(selectId), "##qc_%zu", ri);
-            ImGuiSelectableFlags selFlags = ImGuiSelectableFlags_SpanAllColumns
-                                          | ImGuiSelectableFlags_AllowOverlap;
-            if (ImGui::Selectable(selectId, isCurrent, selFlags))
-                navigateTo(ri);
+                char selectId[64];
+                std::snprintf(selectId, sizeof(selectId), "##qc_%zu", ri);
+                ImGuiSelectableFlags selFlags = ImGuiSelectableFlags_SpanAllColumns
+                                              | ImGuiSelectableFlags_AllowOverlap;
+                if (ImGui::Selectable(selectId, isCurrent, selFlags))
+                    navigateTo(ri);
 
-            if (isCurrent && scrollToCurrentRow_)
-            {
-                ImGui::SetScrollHereY();
-                scrollToCurrentRow_ = false;
-            }
+                if (isCurrent && scrollToCurrentRow_)
+                {
+                    ImGui::SetScrollHereY();
+                    scrollToCurrentRow_ = false;
+                }
 
-            ImGui::SameLine();
-            ImGui::Text("%zu", ri);
+                ImGui::SameLine();
+                ImGui::Text("%zu", ri);
 
-            ImGui::TableSetColumnIndex(1);
-            ImGui::Text("%s", record.id.c_str());
+                ImGui::TableSetColumnIndex(1);
+                ImGui::Text("%s", record.id.c_str());
 
-            ImGui::TableSetColumnIndex(2);
-            ImGui::Text("%s", record.visit.c_str());
+                ImGui::TableSetColumnIndex(2);
+                ImGui::Text("%s", record.visit.c_str());
+            }
         }
 
         ImGui::EndTable();
@@ -407,11 +506,11 @@ void QCApp::renderUI()
 
     ImGui::Separator();
 
-    int completedCount = 0;
-    for (const auto& record : records)
-        if (!record.qc_status.empty()) completedCount++;
+    int completedCount = static_cast<int>(csvHandler_.getRatedCount());
 
     ImGui::Text("%d / %d rated", completedCount, static_cast<int>(records.size()));
+    ImGui::TextDisabled("Pass %zu  Fail %zu", csvHandler_.getPassCount(),
+                        csvHandler_.getFailCount());
 
     float progress = static_cast<float>(completedCount) / static_cast<float>(records.size());
     ImGui::ProgressBar(progress, ImVec2(0, 20));
@@ -422,6 +521,7 @@ void QCApp::renderUI()
     ImGui::Text("P - Mark as Pass");
     ImGui::Text("F - Mark as Fail");
     ImGui::Text("←/→ - Navigate");
+    ImGui::Text("Wheel, +/- - Zoom; 0 - Fit");
     ImGui::Text("Ctrl+S - Save");
     ImGui::PopStyleColor();
 
@@ -432,7 +532,9 @@ void QCApp::renderUI()
     ImGui::EndChild();
 
     ImGui::SameLine();
-    ImGui::BeginChild("RightColumn", ImVec2(rightColumnWidth, 0), false);
+    // Scrolls when zoomed in; the wheel zooms instead of scrolling
+    ImGui::BeginChild("RightColumn", ImVec2(rightColumnWidth, 0), false,
+                      ImGuiWindowFlags_HorizontalScrollbar | ImGuiWindowFlags_NoScrollWithMouse);
 
     renderImage();
 
@@ -449,21 +551,66 @@ void QCApp::renderImage()
         return;
     }
 
+    ImGuiIO& io = ImGui::GetIO();
     float availWidth = ImGui::GetContentRegionAvail().x;
     float availHeight = ImGui::GetContentRegionAvail().y;
 
-    float imageAspect = static_cast<float>(currentImage_.width) / static_cast<float>(currentImage_.height);
-    float displayWidth = availWidth;
-    float displayHeight = displayWidth / imageAspect;
+    // Images are decoded at the size of this panel on screen
+    float fbScale = io.DisplayFramebufferScale.x;
+    decoder_->setDisplaySize(static_cast<int>(availWidth * fbScale),
+                             static_cast<int>(availHeight * fbScale));
+
+    float imageAspect = static_cast<float>(currentImage_.fullWidth) / static_cast<float>(currentImage_.fullHeight);
+    float fitWidth = availWidth;
+    float fitHeight = fitWidth / imageAspect;
 
-    if (displayHeight > availHeight)
+    if (fitHeight > availHeight)
     {
-        displayHeight = availHeight;
-        displayWidth = displayHeight * imageAspect;
+        fitHeight = availHeight;
+        fitWidth = fitHeight * imageAspect;
     }
 
-    float startX = (availWidth - displayWidth) * 0.5f;
-    float startY = (availHeight - displayHeight) * 0.5f;
+    // The wheel zooms about the mouse position; dragging pans
+    ImVec2 mouse(io.MousePos.x - ImGui::GetWindowPos().x, io.MousePos.y - ImGui::GetWindowPos().y);
+    if (ImGui::IsWindowHovered() && io.MouseWheel != 0.0f)
+    {
+        float oldZoom = zoom_;
+        float oldOffsetX = std::max(0.0f, (availWidth - fitWidth * oldZoom) * 0.5f);
+        float oldOffsetY = std::max(0.0f, (availHeight - fitHeight * oldZoom) * 0.5f);
+        float fx = (ImGui::GetScrollX() + mouse.x - oldOffsetX) / (fitWidth * oldZoom);
+        float fy = (ImGui::GetScrollY() + mouse.y - oldOffsetY) / (fitHeight * oldZoom);
+
+        setZoom(zoom_ * std::pow(1.25f, io.MouseWheel));
+
+        float offsetX = std::max(0.0f, (availWidth - fitWidth * zoom_) * 0.5f);
+        float offsetY = std::max(0.0f, (availHeight - fitHeight * zoom_) * 0.5f);
+        ImGui::SetScrollX(fx * fitWidth * zoom_ + offsetX - mouse.x);
+        ImGui::SetScrollY(fy * fitHeight * zoom_ + offsetY - mouse.y);
+    }
+    else if (ImGui::IsWindowHovered() && ImGui::IsMouseDragging(ImGuiMouseButton_Left))
+    {
+        ImGui::SetScrollX(ImGui::GetScrollX() - io.MouseDelta.x);
+        ImGui::SetScrollY(ImGui::GetScrollY() - io.MouseDelta.y);
+    }
+
+    float displayWidth = fitWidth * zoom_;
+    float displayHeight = fitHeight * zoom_;
+
+    // Zoomed (or resized) past the reduced texture: swap in the full
+    // image once a worker has decoded it
+    if (currentImage_.width < currentImage_.fullWidth &&
+        displayWidth * fbScale > static_cast<float>(currentImage_.width))
+    {
+        ImageDecoder::ImagePtr full = decoder_->find(currentImage_.path,
+                                                     ImageDecoder::Resolution::Full);
+        if (!full)
+            decoder_->request(currentImage_.path, ImageDecoder::Resolution::Full);
+        else if (full->pixels)
+            uploadImage(*full);
+    }
+
+    float startX = std::max(0.0f, (availWidth - displayWidth) * 0.5f);
+    float startY = std::max(0.0f, (availHeight - displayHeight) * 0.5f);
 
     ImGui::SetCursorPosX(startX);
     ImGui::SetCursorPosY(startY);
@@ -475,13 +622,11 @@ void QCApp::navigateTo(size_t index)
 {
     if (index < csvHandler_.getRecordCount())
     {
+        int direction = index < currentIndex_ ? -1 : 1;
         currentIndex_ = index;
         scrollToCurrentRow_ = true;
+        prefetchAround(currentIndex_, direction);
         loadImage(csvHandler_.getRecords()[currentIndex_].picture_path);
-        if (index + 1 < csvHandler_.getRecordCount())
-            os_prefetch_file(csvHandler_.getRecords()[index + 1].picture_path);
-        if (index >= 1)
-            os_prefetch_file(csvHandler_.getRecords()[index - 1].picture_path);
     }
 }
 
@@ -491,9 +636,8 @@ void QCApp::navigatePrevious()
     {
         --currentIndex_;
         scrollToCurrentRow_ = true;
+        prefetchAround(currentIndex_, -1);
         loadImage(csvHandler_.getRecords()[currentIndex_].picture_path);
-        if (currentIndex_ >= 2)
-            os_prefetch_file(csvHandler_.getRecords()[currentIndex_ - 2].picture_path);
     }
 }
 
@@ -503,24 +647,21 @@ void QCApp::navigateNext()
     {
         ++currentIndex_;
         scrollToCurrentRow_ = true;
+        prefetchAround(currentIndex_, 1);
         loadImage(csvHandler_.getRecords()[currentIndex_].picture_path);
-        if (currentIndex_ + 2 < csvHandler_.getRecordCount())
-            os_prefetch_file(csvHandler_.getRecords()[currentIndex_ + 2].picture_path);
     }
 }
 
 void QCApp::markAsPass()
 {
-    auto& records = csvHandler_.getRecords();
-    records[currentIndex_].qc_status = "Pass";
+    csvHandler_.setStatus(currentIndex_, "Pass");
     if (autoSave_) saveProgress();
     navigateNext();
 }
 
 void QCApp::markAsFail()
 {
-    auto& records = csvHandler_.getRecords();
-    records[currentIndex_].qc_status = "Fail";
+    csvHandler_.setStatus(currentIndex_, "Fail");
     if (autoSave_) saveProgress();
     navigateNext();
 }
@@ -543,6 +684,17 @@ void QCApp::handleKeyboard(int key, int scancode, int action, int mods)
         case GLFW_KEY_PAGE_UP:   navigatePrevious(); break;
         case GLFW_KEY_RIGHT:
         case GLFW_KEY_PAGE_DOWN: navigateNext(); break;
+        case GLFW_KEY_EQUAL:
+        case GLFW_KEY_KP_ADD:
+            setZoom(zoom_ * 1.25f);
+            break;
+        case GLFW_KEY_MINUS:
+        case GLFW_KEY_KP_SUBTRACT:
+            setZoom(zoom_ / 1.25f);
+            break;
+        case GLFW_KEY_0:
+            setZoom(1.0f);
+            break;
         case GLFW_KEY_S:
             if (mods & GLFW_MOD_CONTROL) saveProgress();
             break;
@@ -7,6 +7,7 @@
 #include <optional>
 #include "CSVHandler.h"
 #include "Backend.h"
+#include "ImageDecoder.h"
 
 struct GLFWwindow;
 
@@ -15,8 +16,11 @@ namespace QC
 
 struct ImageData
 {
-    int width = 0;
+    std::string path;
+    int width = 0;          // texture size; smaller than the file when reduced
     int height = 0;
+    int fullWidth = 0;      // size in the file
+    int fullHeight = 0;
     int channels = 0;
     std::unique_ptr<Texture> texture;
 };
@@ -29,7 +33,8 @@ public:
 
     bool init(const std::string& inputFile, const std::string& outputFile,
               const std::optional<float>& scaleFactor,
-              BackendType backendType = BackendType::OpenGL2);
+              BackendType backendType = BackendType::OpenGL2,
+              bool mipmaps = false);
 
     void run();
     void shutdown();
@@ -39,16 +44,25 @@ private:
     GLFWwindow* window_ = nullptr;
     CSVHandler csvHandler_;
     ImageData currentImage_;
+    std::unique_ptr<ImageDecoder> decoder_;
     std::string outputFile_;
     size_t currentIndex_ = 0;
     bool running_ = false;
 
     float imageScale_ = 1.0f;
     float currentScale_ = 1.0f;
+    float zoom_ = 1.0f;               // 1 = image fitted to the panel
     bool autoSave_ = true;
     bool scrollToCurrentRow_ = false;
 
+    // Images decoded ahead of the current one, on each side
+    static constexpr size_t kPrefetchAhead = 3;
+    static constexpr float kMaxZoom = 16.0f;
+
     void loadImage(const std::string& path);
+    void uploadImage(const ImageDecoder::Image& image);
+    void setZoom(float zoom);
+    void prefetchAround(size_t index, int direction);
     void renderUI();
     void renderImage();
     void renderCaseList();
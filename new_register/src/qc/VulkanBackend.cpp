@@ -436,6 +436,8 @@ void VulkanBackend::shutdown()
     VkResult err = vkDeviceWaitIdle(device_);
     checkVkResult(err);
 
+    destroyFrameFences();
+
     ImGui_ImplVulkanH_DestroyWindow(instance_, device_, &windowData_, allocator_);
 
     vkDestroyCommandPool(device_, commandPool_, allocator_);
@@ -463,6 +465,7 @@ void VulkanBackend::waitIdle()
     {
         VkResult err = vkDeviceWaitIdle(device_);
         checkVkResult(err);
+        reclaimRetiredTextures(true);
     }
 }
 
@@ -606,6 +609,10 @@ void VulkanBackend::frameRender(ImDrawData* drawData)
     checkVkResult(err);
     err = vkQueueSubmit(queue_, 1, &submitInfo, fd->Fence);
     checkVkResult(err);
+
+    ++frameCount_;
+    signalFrameFence();
+    reclaimRetiredTextures(false);
 }
 
 void VulkanBackend::framePresent()
@@ -904,15 +911,17 @@ std::vector<uint8_t> VulkanBackend::captureScreenshot(int& width, int& height)
 // Texture management
 // ---------------------------------------------------------------------------
 
-std::unique_ptr<Texture> VulkanBackend::createTexture(int w, int h, const void* data)
+std::unique_ptr<Texture> VulkanBackend::createTexture(int w, int h, const void* data,
+                                                      int mipLevels)
 {
-    auto vkTex = VulkanHelpers::CreateTexture(w, h, data);
+    auto vkTex = VulkanHelpers::CreateTexture(w, h, data, mipLevels);
     if (!vkTex) return nullptr;
 
     auto tex = std::make_unique<Texture>();
     tex->id     = reinterpret_cast<ImTextureID>(vkTex->descriptor_set);
     tex->width  = vkTex->width;
     tex->height = vkTex->height;
+    tex->mipLevels = vkTex->mipLevels;
 
     vulkanTextures_[tex->id] = std::move(vkTex);
     return tex;
@@ -932,14 +941,82 @@ void VulkanBackend::destroyTexture(Texture* tex)
     auto it = vulkanTextures_.find(tex->id);
     if (it != vulkanTextures_.end())
     {
-        VulkanHelpers::DestroyTexture(it->second.get());
+        // The last submitted frames may still sample it
+        retiredTextures_.push_back(RetiredTexture{std::move(it->second), frameCount_});
         vulkanTextures_.erase(it);
     }
     tex->id = 0;
 }
 
+void VulkanBackend::signalFrameFence()
+{
+    VkFence fence = VK_NULL_HANDLE;
+    if (!freeFences_.empty())
+    {
+        fence = freeFences_.back();
+        freeFences_.pop_back();
+    }
+    else
+    {
+        VkFenceCreateInfo info = {};
+        info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        VkResult err = vkCreateFence(device_, &info, allocator_, &fence);
+        checkVkResult(err);
+    }
+
+    // An empty submit signals once all earlier work on the queue is done
+    VkResult err = vkQueueSubmit(queue_, 0, nullptr, fence);
+    checkVkResult(err);
+    frameFences_.push_back(FrameFence{fence, frameCount_});
+}
+
+void VulkanBackend::pollFrameFences(bool idle)
+{
+    while (!frameFences_.empty())
+    {
+        const FrameFence& front = frameFences_.front();
+        if (!idle && vkGetFenceStatus(device_, front.fence) != VK_SUCCESS)
+            break;
+        VkResult err = vkResetFences(device_, 1, &front.fence);
+        checkVkResult(err);
+        completedFrames_ = front.frame;
+        freeFences_.push_back(front.fence);
+        frameFences_.pop_front();
+    }
+    if (idle)
+        completedFrames_ = frameCount_;
+}
+
+void VulkanBackend::destroyFrameFences()
+{
+    for (const FrameFence& f : frameFences_)
+        vkDestroyFence(device_, f.fence, allocator_);
+    for (VkFence fence : freeFences_)
+        vkDestroyFence(device_, fence, allocator_);
+    frameFences_.clear();
+    freeFences_.clear();
+}
+
+void VulkanBackend::reclaimRetiredTextures(bool idle)
+{
+    // Draw data recorded before the destroy may still reference the texture,
+    // so it is due once the frame after the destroy has finished.
+    pollFrameFences(idle);
+    while (!retiredTextures_.empty() &&
+           (idle || completedFrames_ > retiredTextures_.front().frame))
+    {
+        VulkanHelpers::DestroyTexture(retiredTextures_.front().texture.get());
+        retiredTextures_.pop_front();
+    }
+}
+
 void VulkanBackend::shutdownTextureSystem()
 {
+    // Frames still in flight sample the textures freed below
+    VkResult err = vkDeviceWaitIdle(device_);
+    checkVkResult(err);
+
     vulkanTextures_.clear();
+    retiredTextures_.clear();
     VulkanHelpers::Shutdown();
 }
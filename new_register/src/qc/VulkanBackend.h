@@ -9,7 +9,9 @@
 #include <vulkan/vulkan.h>
 #include <backends/imgui_impl_vulkan.h>
 
+#include <deque>
 #include <map>
+#include <vector>
 
 /// Vulkan implementation of the Backend interface.
 class VulkanBackend : public Backend
@@ -41,7 +43,8 @@ public:
 
     std::vector<uint8_t> captureScreenshot(int& width, int& height) override;
 
-    std::unique_ptr<Texture> createTexture(int w, int h, const void* data) override;
+    std::unique_ptr<Texture> createTexture(int w, int h, const void* data,
+                                           int mipLevels) override;
     void updateTexture(Texture* tex, const void* data) override;
     void destroyTexture(Texture* tex) override;
     void shutdownTextureSystem() override;
@@ -71,6 +74,35 @@ private:
 
     std::map<ImTextureID, std::unique_ptr<VulkanTexture>> vulkanTextures_;
 
+    /// Fence queued behind a submitted frame. ImGui's frame fences are
+    /// indexed by swapchain image, so they cannot tell which frames retired.
+    struct FrameFence {
+        VkFence  fence = VK_NULL_HANDLE;
+        uint64_t frame = 0;   ///< frameCount_ after the submit
+    };
+    std::deque<FrameFence> frameFences_;     ///< in flight, oldest first
+    std::vector<VkFence>   freeFences_;
+    uint64_t frameCount_      = 0;  ///< frames submitted
+    uint64_t completedFrames_ = 0;  ///< frames known to have finished
+
+    /// Queue a fence behind the frame just submitted.
+    void signalFrameFence();
+    /// Advance completedFrames_ past every signalled fence (all frames if
+    /// @p idle, after the device has been waited on).
+    void pollFrameFences(bool idle);
+    void destroyFrameFences();
+
+    /// Destroyed textures, kept until the first frame submitted after the
+    /// destroy has finished (fence-tracked deferred destruction).
+    struct RetiredTexture {
+        std::unique_ptr<VulkanTexture> texture;
+        uint64_t frame = 0;   ///< frameCount_ when destroyed
+    };
+    std::deque<RetiredTexture> retiredTextures_;
+
+    /// Free the retired textures that are due (all of them if @p idle).
+    void reclaimRetiredTextures(bool idle);
+
     void createInstance(const char** extensions, uint32_t extensionCount);
     void createDevice();
     void createSwapchainWindow(int width, int height);
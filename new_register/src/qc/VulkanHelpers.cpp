@@ -1,10 +1,12 @@
 #include "VulkanHelpers.h"
+#include "MipChain.h"
 #include <backends/imgui_impl_vulkan.h>
 #include <cstdio>
 #include <cstring>
 #include <stdexcept>
 #include <string>
 #include <memory>
+#include <vector>
 
 static VkDevice g_Device = VK_NULL_HANDLE;
 static VkPhysicalDevice g_PhysicalDevice = VK_NULL_HANDLE;
@@ -15,11 +17,14 @@ static VkCommandPool g_CommandPool = VK_NULL_HANDLE;
 
 /// Persistent staging resources reused across all UpdateTexture calls.
 /// The buffer grows to accommodate the largest texture and is never shrunk.
-/// The command buffer is allocated once and reset before each use.
+/// The command buffer is allocated once and reset before each use; the
+/// fence tracks the last upload, so only the next upload (or destroying a
+/// texture) waits for it instead of draining the whole queue.
 struct StagingResources {
     VkBuffer buffer = VK_NULL_HANDLE;
     VkDeviceMemory memory = VK_NULL_HANDLE;
     VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+    VkFence fence = VK_NULL_HANDLE;              ///< Signaled when the last upload completes.
     void* mappedPtr = nullptr;
     VkDeviceSize capacity = 0;
 
@@ -118,6 +123,12 @@ void StagingResources::ensureCapacity(VkDeviceSize requiredSize)
 
 void StagingResources::destroy()
 {
+    if (fence != VK_NULL_HANDLE)
+    {
+        vkWaitForFences(g_Device, 1, &fence, VK_TRUE, UINT64_MAX);
+        vkDestroyFence(g_Device, fence, nullptr);
+        fence = VK_NULL_HANDLE;
+    }
     if (mappedPtr)
     {
         vkUnmapMemory(g_Device, memory);
@@ -159,13 +170,22 @@ void Init(VkDevice device, VkPhysicalDevice physical_device, uint32_t queue_fami
     VkResult err = vkAllocateCommandBuffers(g_Device, &cbAllocInfo, &g_Staging.commandBuffer);
     if (err != VK_SUCCESS)
         throw std::runtime_error("VulkanHelpers::Init: failed to allocate upload command buffer");
+
+    // Pre-signaled so the first upload does not wait.
+    VkFenceCreateInfo fenceInfo = {};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+    err = vkCreateFence(g_Device, &fenceInfo, nullptr, &g_Staging.fence);
+    if (err != VK_SUCCESS)
+        throw std::runtime_error("VulkanHelpers::Init: failed to create upload fence");
 }
 
-std::unique_ptr<VulkanTexture> CreateTexture(int w, int h, const void* data) {
+std::unique_ptr<VulkanTexture> CreateTexture(int w, int h, const void* data, int mipLevels) {
     auto tex = std::make_unique<VulkanTexture>();
     tex->width = w;
     tex->height = h;
-    tex->size = w * h * 4;
+    tex->mipLevels = mipLevels;
+    tex->size = QC::mipChainBytes(w, h, mipLevels);
 
     VkResult err;
 
@@ -183,7 +203,7 @@ std::unique_ptr<VulkanTexture> CreateTexture(int w, int h, const void* data) {
         info.extent.width = w;
         info.extent.height = h;
         info.extent.depth = 1;
-        info.mipLevels = 1;
+        info.mipLevels = static_cast<uint32_t>(mipLevels);
         info.arrayLayers = 1;
         info.samples = VK_SAMPLE_COUNT_1_BIT;
         info.tiling = VK_IMAGE_TILING_OPTIMAL;
@@ -238,7 +258,7 @@ std::unique_ptr<VulkanTexture> CreateTexture(int w, int h, const void* data) {
         info.viewType = VK_IMAGE_VIEW_TYPE_2D;
         info.format = VK_FORMAT_R8G8B8A8_UNORM;
         info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        info.subresourceRange.levelCount = 1;
+        info.subresourceRange.levelCount = static_cast<uint32_t>(mipLevels);
         info.subresourceRange.layerCount = 1;
         err = vkCreateImageView(g_Device, &info, nullptr, &tex->image_view);
         if (err != VK_SUCCESS) fail("vkCreateImageView failed");
@@ -258,12 +278,21 @@ void UpdateTexture(VulkanTexture* tex, const void* data) {
     if (!data || !tex)
         throw std::runtime_error("UpdateTexture: null texture or data pointer");
 
-    VkDeviceSize image_size = tex->width * tex->height * 4;
+    VkDeviceSize image_size = tex->size;
+
+    // The staging buffer and command buffer are free once the previous
+    // upload has completed.
+    VkResult err = vkWaitForFences(g_Device, 1, &g_Staging.fence, VK_TRUE, UINT64_MAX);
+    if (err != VK_SUCCESS)
+        throw std::runtime_error("UpdateTexture: vkWaitForFences failed");
+    err = vkResetFences(g_Device, 1, &g_Staging.fence);
+    if (err != VK_SUCCESS)
+        throw std::runtime_error("UpdateTexture: vkResetFences failed");
 
     g_Staging.ensureCapacity(image_size);
     std::memcpy(g_Staging.mappedPtr, data, static_cast<size_t>(image_size));
 
-    VkResult err = vkResetCommandBuffer(g_Staging.commandBuffer, 0);
+    err = vkResetCommandBuffer(g_Staging.commandBuffer, 0);
     if (err != VK_SUCCESS)
         throw std::runtime_error("UpdateTexture: vkResetCommandBuffer failed");
 
@@ -286,7 +315,7 @@ void UpdateTexture(VulkanTexture* tex, const void* data) {
         barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
         barrier.image = tex->image;
         barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        barrier.subresourceRange.levelCount = 1;
+        barrier.subresourceRange.levelCount = static_cast<uint32_t>(tex->mipLevels);
         barrier.subresourceRange.layerCount = 1;
         barrier.srcAccessMask = tex->uploaded ? VK_ACCESS_SHADER_READ_BIT : static_cast<VkAccessFlags>(0);
         barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
@@ -298,13 +327,22 @@ void UpdateTexture(VulkanTexture* tex, const void* data) {
             VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
     }
 
-    VkBufferImageCopy region = {};
-    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    region.imageSubresource.layerCount = 1;
-    region.imageExtent = {static_cast<uint32_t>(tex->width), static_cast<uint32_t>(tex->height), 1};
+    // One region per mip level, packed in the staging buffer as in MipChain.h
+    std::vector<VkBufferImageCopy> regions(static_cast<size_t>(tex->mipLevels));
+    for (int level = 0; level < tex->mipLevels; ++level)
+    {
+        VkBufferImageCopy& region = regions[level];
+        region.bufferOffset = QC::mipLevelOffset(tex->width, tex->height, level);
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = static_cast<uint32_t>(level);
+        region.imageSubresource.layerCount = 1;
+        region.imageExtent = {static_cast<uint32_t>(QC::mipLevelSize(tex->width, level)),
+                              static_cast<uint32_t>(QC::mipLevelSize(tex->height, level)), 1};
+    }
 
     vkCmdCopyBufferToImage(g_Staging.commandBuffer, g_Staging.buffer,
-        tex->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+        tex->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        static_cast<uint32_t>(regions.size()), regions.data());
 
     // Transition to SHADER_READ_ONLY
     {
@@ -316,7 +354,7 @@ void UpdateTexture(VulkanTexture* tex, const void* data) {
         barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
         barrier.image = tex->image;
         barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        barrier.subresourceRange.levelCount = 1;
+        barrier.subresourceRange.levelCount = static_cast<uint32_t>(tex->mipLevels);
         barrier.subresourceRange.layerCount = 1;
         barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
         barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
@@ -336,12 +374,11 @@ void UpdateTexture(VulkanTexture* tex, const void* data) {
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = &g_Staging.commandBuffer;
 
-    err = vkQueueSubmit(g_Queue, 1, &submitInfo, VK_NULL_HANDLE);
+    // Frames are submitted later to the same queue, so their reads are
+    // ordered after the copy by the barriers above.
+    err = vkQueueSubmit(g_Queue, 1, &submitInfo, g_Staging.fence);
     if (err != VK_SUCCESS)
         throw std::runtime_error("UpdateTexture: vkQueueSubmit failed (err=" + std::to_string(err) + ")");
-    err = vkQueueWaitIdle(g_Queue);
-    if (err != VK_SUCCESS)
-        throw std::runtime_error("UpdateTexture: vkQueueWaitIdle failed");
 
     tex->uploaded = true;
 }
@@ -352,6 +389,9 @@ void Shutdown() {
 
 void DestroyTexture(VulkanTexture* tex) {
     if (!tex) return;
+    // The image may still be the target of the last upload.
+    if (g_Staging.fence != VK_NULL_HANDLE)
+        vkWaitForFences(g_Device, 1, &g_Staging.fence, VK_TRUE, UINT64_MAX);
     tex->cleanup(g_Device);
 }
 
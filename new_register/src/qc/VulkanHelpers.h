@@ -13,7 +13,8 @@ public:
 
     int width = 0;
     int height = 0;
-    VkDeviceSize size = 0;
+    int mipLevels = 1;
+    VkDeviceSize size = 0;      ///< bytes of all mip levels
 
     /// True after the first successful upload (layout is
     /// VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL).
@@ -27,7 +28,7 @@ public:
 namespace VulkanHelpers {
     void Init(VkDevice device, VkPhysicalDevice physical_device, uint32_t queue_family, VkQueue queue, VkDescriptorPool pool, VkCommandPool command_pool);
     void Shutdown();
-    std::unique_ptr<VulkanTexture> CreateTexture(int w, int h, const void* data);
+    std::unique_ptr<VulkanTexture> CreateTexture(int w, int h, const void* data, int mipLevels = 1);
     void UpdateTexture(VulkanTexture* texture, const void* data);
     void DestroyTexture(VulkanTexture* texture);
 }
@@ -18,6 +18,7 @@ void printUsage(const char* programName)
               << "  --version         Show version information\n"
               << "  --scale <factor>  Override screen content scale (HiDPI)\n"
               << "  --backend <name>  Graphics backend: vulkan (default), opengl2\n"
+              << "  --mipmaps         Build mip maps for smoother zooming (more memory)\n"
               << "\n"
               << "Input CSV format:\n"
               << "  id,visit,picture\n"
@@ -34,6 +35,7 @@ void printUsage(const char* programName)
               << "  F            Mark current image as Fail\n"
               << "  Left/Right   Navigate between images\n"
               << "  Page Up/Down Navigate between images\n"
+              << "  Wheel, +/-   Zoom the image (drag to pan), 0 to fit\n"
               << "  Ctrl+S       Save progress manually\n"
               << "  Escape       Exit application\n"
               << "\n"
@@ -67,6 +69,7 @@ int main(int argc, char* argv[])
     std::string outputFile;
     std::optional<float> scaleFactor;
     BackendType backendType = Backend::detectBest();
+    bool mipmaps = false;
 
     for (int i = 1; i < argc; ++i)
     {
@@ -113,6 +116,10 @@ int main(int argc, char* argv[])
             }
             backendType = *parsed;
         }
+        else if (arg == "--mipmaps")
+        {
+            mipmaps = true;
+        }
         else if (arg[0] == '-')
         {
             std::cerr << "Unknown option: " << arg << "\n";
@@ -143,7 +150,7 @@ int main(int argc, char* argv[])
 
     QC::QCApp app;
 
-    if (!app.init(inputFile, outputFile, scaleFactor, backendType))
+    if (!app.init(inputFile, outputFile, scaleFactor, backendType, mipmaps))
         return 1;
 
     app.run();
@@ -0,0 +1,217 @@
+/// test_colour_transfer.cpp — precomposed colour transfer tables.
+///
+/// Checks that ColourTransfer::map() (table path, incl. the 16-bit keyed
+/// log table) produces exactly the colour the per-voxel reference formula
+/// gives, for every combination of log, invert and clamp modes, and that
+/// paletted slice indices reproduce renderSlice() through their palette.
+
+#include "ColourMap.h"
+#include "SliceRenderer.h"
+
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <vector>
+
+static int failures = 0;
+
+static void check(bool cond, const char* msg, int line)
+{
+    if (!cond)
+    {
+        std::fprintf(stderr, "FAIL (line %d): %s\n", line, msg);
+        ++failures;
+    }
+}
+
+#define CHECK(cond, msg) check((cond), (msg), __LINE__)
+
+/// Reference: the per-voxel colour path as it was before precomposition.
+static uint32_t referenceColour(const VolumeRenderParams& p, float val)
+{
+    const ColourLut& baseLut = colourMapLut(p.colourMap);
+    ColourLut lut = p.invertColourMap ? invertColourLut(baseLut) : baseLut;
+
+    auto clampColour = [&](int mode, bool isOver) -> uint32_t {
+        if (mode == kSliceClampTransparent) return 0x00000000;
+        if (mode == kSliceClampBlack)       return 0xFF000000;
+        if (mode == kSliceClampRed)         return 0xFF0000FF;
+        if (mode == kSliceClampGreen)       return 0xFF00FF00;
+        if (mode == kSliceClampBlue)        return 0xFFFF0000;
+        if (mode == kSliceClampYellow)      return 0xFF00FFFF;
+        if (mode == kSliceClampWhite)       return 0xFFFFFFFF;
+        ColourMapType m = p.colourMap;
+        if (mode >= 0 && mode < colourMapCount())
+            m = static_cast<ColourMapType>(mode);
+        const ColourLut& l = colourMapLut(m);
+        if (isOver)
+            return p.invertColourMap ? l.table[0] : l.table[255];
+        return p.invertColourMap ? l.table[255] : l.table[0];
+    };
+    uint32_t under = clampColour(p.underColourMode, false);
+    uint32_t over  = clampColour(p.overColourMode, true);
+
+    float lo = static_cast<float>(p.valueMin);
+    float hi = static_cast<float>(p.valueMax);
+    float displayVal = val;
+    if (p.useLogTransform)
+    {
+        lo = (lo <= 0.0f) ? -10.0f : std::log10(lo);
+        hi = (hi <= 0.0f) ? -10.0f : std::log10(hi);
+        if (val <= 0.0f)
+            return under;
+        displayVal = std::log10(val);
+    }
+    float span = hi - lo;
+    if (span < 1e-12f)
+        span = 1e-12f;
+    float invSpan = 1.0f / span;
+
+    if (displayVal < lo) return under;
+    if (displayVal > hi) return over;
+    int idx = static_cast<int>((displayVal - lo) * invSpan * 255.0f + 0.5f);
+    if (idx > 255)
+        idx = 255;
+    return lut.table[idx];
+}
+
+int main()
+{
+    // Sample values: a dense linear sweep, a geometric sweep over many
+    // decades (exercises every log-table key class), and special values.
+    std::vector<float> samples;
+    for (int i = -2000; i <= 12000; ++i)
+        samples.push_back(static_cast<float>(i) * 0.1f);
+    for (float v = 1e-12f; v < 1e8f; v *= 1.0137f)
+    {
+        samples.push_back(v);
+        samples.push_back(-v);
+    }
+    samples.push_back(0.0f);
+    samples.push_back(-0.0f);
+    samples.push_back(std::numeric_limits<float>::denorm_min());
+    samples.push_back(std::numeric_limits<float>::max());
+    samples.push_back(std::numeric_limits<float>::infinity());
+    samples.push_back(-std::numeric_limits<float>::infinity());
+
+    const int clampModes[] = { kSliceClampCurrent, kSliceClampTransparent,
+                               kSliceClampRed, kSliceClampWhite,
+                               static_cast<int>(ColourMapType::HotMetal) };
+    const double ranges[][2] = { {0.0, 1000.0}, {3.5, 77.25}, {1e-3, 1e5},
+                                 {-50.0, 50.0}, {10.0, 10.0} };
+
+    // 1. map() matches the reference for every parameter combination.
+    for (int log = 0; log < 2; ++log)
+    for (int inv = 0; inv < 2; ++inv)
+    for (int under : clampModes)
+    for (int over : clampModes)
+    for (const auto& r : ranges)
+    {
+        VolumeRenderParams p;
+        p.valueMin = r[0];
+        p.valueMax = r[1];
+        p.colourMap = ColourMapType::Spectral;
+        p.useLogTransform = (log != 0);
+        p.invertColourMap = (inv != 0);
+        p.underColourMode = under;
+        p.overColourMode = over;
+
+        ColourTransfer t = buildColourTransfer(p);
+        int mismatches = 0;
+        for (float v : samples)
+            if (t.map(v) != referenceColour(p, v))
+                ++mismatches;
+        if (mismatches != 0)
+            std::fprintf(stderr, "  log=%d inv=%d under=%d over=%d range=[%g,%g]: "
+                         "%d mismatches\n", log, inv, under, over, r[0], r[1],
+                         mismatches);
+        CHECK(mismatches == 0, "transfer must match reference colour path");
+    }
+
+    // 2. Log table resolves the vast majority of keys without fallback.
+    {
+        VolumeRenderParams p;
+        p.valueMin = 1.0;
+        p.valueMax = 1e4;
+        p.useLogTransform = true;
+        ColourTransfer t = buildColourTransfer(p);
+        CHECK(t.logSlots.size() == 65536u, "log table should have 2^16 keys");
+        int mixed = 0;
+        for (uint16_t s : t.logSlots)
+            if (s == ColourTransfer::kMixedKey)
+                ++mixed;
+        CHECK(mixed < 1024, "too many log keys need exact fallback");
+    }
+
+    // 3. Linear mode builds no log table; matches() tracks colour fields only.
+    {
+        VolumeRenderParams p;
+        ColourTransfer t = buildColourTransfer(p);
+        CHECK(t.logSlots.empty(), "linear transfer should not build a log table");
+        CHECK(t.matches(p), "transfer should match its own params");
+
+        VolumeRenderParams q = p;
+        q.overlayAlpha = 0.25f;
+        CHECK(t.matches(q), "overlay alpha is not part of the transfer");
+        q.invertColourMap = true;
+        CHECK(!t.matches(q), "invert change must invalidate the transfer");
+    }
+
+    // 4. Indices + palette reproduce renderSlice() at both index widths.
+    {
+        Volume vol;
+        vol.dimensions = glm::ivec3(7, 5, 4);
+        vol.data.resize(7 * 5 * 4);
+        for (size_t i = 0; i < vol.data.size(); ++i)
+            vol.data[i] = static_cast<float>(i) * 0.75f - 10.0f;
+
+        for (int log = 0; log < 2; ++log)
+        for (int under : clampModes)
+        for (int over : clampModes)
+        {
+            VolumeRenderParams p;
+            p.valueMin = log ? 0.5 : 5.0;
+            p.valueMax = 80.0;
+            p.colourMap = ColourMapType::HotMetal;
+            p.useLogTransform = (log != 0);
+            p.underColourMode = under;
+            p.overColourMode = over;
+            ColourTransfer t = buildColourTransfer(p);
+            bool lutEnds = (under == kSliceClampCurrent && over == kSliceClampCurrent);
+            CHECK(!lutEnds || t.indexBytes() == 1, "default clamps should fit 8-bit indices");
+
+            for (int bytes = t.indexBytes(); bytes <= 2; ++bytes)
+            {
+                uint32_t palette[kLutSize + 2];
+                int count = slicePalette(t, bytes, palette);
+                for (int view = 0; view < 3; ++view)
+                {
+                    RenderedSlice ref = renderSlice(vol, t, view, 2);
+                    IndexedSlice idx = renderSliceIndices(vol, t, bytes, view, 2);
+                    bool same = idx.width == ref.width && idx.height == ref.height &&
+                                idx.indexBytes == bytes &&
+                                idx.indices.size() == ref.pixels.size() * bytes;
+                    for (size_t i = 0; same && i < ref.pixels.size(); ++i)
+                    {
+                        int k = (bytes == 1)
+                            ? idx.indices[i]
+                            : reinterpret_cast<const uint16_t*>(idx.indices.data())[i];
+                        same = k < count && palette[k] == ref.pixels[i];
+                    }
+                    CHECK(same, "palette[index] must equal the rendered colour");
+                }
+            }
+        }
+    }
+
+    if (failures == 0)
+    {
+        std::printf("All colour transfer tests passed.\n");
+        return 0;
+    }
+    else
+    {
+        std::fprintf(stderr, "%d test(s) failed.\n", failures);
+        return 1;
+    }
+}
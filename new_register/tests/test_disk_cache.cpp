@@ -0,0 +1,134 @@
+/// test_disk_cache.cpp — startup cache files (Vulkan pipeline cache).
+///
+/// No GPU needed; the pipeline cache header is built by hand and files go
+/// to a temporary directory.
+///
+/// Tests:
+///   1. userCacheDir() follows XDG_CACHE_HOME, then HOME
+///   2. writeCacheFile() creates directories and round-trips the data
+///   3. pipelineCacheHeaderMatches() rejects other devices and bad headers
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "DiskCache.h"
+
+namespace fs = std::filesystem;
+
+static int testsPassed = 0;
+static int testsFailed = 0;
+
+#define TEST(name) \
+    std::cerr << "  TEST: " << name << " ... ";
+
+#define PASS() \
+    do { std::cerr << "PASS\n"; ++testsPassed; } while (0)
+
+#define FAIL(msg) \
+    do { std::cerr << "FAIL: " << msg << "\n"; ++testsFailed; } while (0)
+
+/// A pipeline cache blob as a driver would return it: 32-byte header
+/// followed by @p payload opaque bytes.
+static std::vector<uint8_t> pipelineBlob(uint32_t version, uint32_t vendor, uint32_t device,
+                                         const uint8_t uuid[16], size_t payload)
+{
+    uint32_t fields[4] = {32, version, vendor, device};
+    std::vector<uint8_t> data(32 + payload, 0xAB);
+    std::memcpy(data.data(), fields, sizeof(fields));
+    std::memcpy(data.data() + 16, uuid, 16);
+    return data;
+}
+
+int main()
+{
+    std::cerr << "=== DiskCacheTest ===\n\n";
+
+    fs::path dir = fs::temp_directory_path() / "nr_test_disk_cache";
+    fs::remove_all(dir);
+
+    // -----------------------------------------------------------------------
+    // 1. Cache directory
+    // -----------------------------------------------------------------------
+    {
+        TEST("userCacheDir follows XDG_CACHE_HOME, then HOME");
+        setenv("XDG_CACHE_HOME", "/xdg/cache", 1);
+        setenv("HOME", "/home/someone", 1);
+        bool ok = userCacheDir() == "/xdg/cache/new_register";
+        // Relative XDG paths are invalid per the spec and ignored
+        setenv("XDG_CACHE_HOME", "relative", 1);
+        ok = ok && userCacheDir() == "/home/someone/.cache/new_register";
+        unsetenv("XDG_CACHE_HOME");
+        ok = ok && userCacheDir() == "/home/someone/.cache/new_register";
+        if (ok)
+            PASS();
+        else
+            FAIL("got " << userCacheDir());
+    }
+
+    // -----------------------------------------------------------------------
+    // 2. Round trip
+    // -----------------------------------------------------------------------
+    {
+        TEST("cache files round-trip through nested directories");
+        std::string path = (dir / "a" / "b" / "cache.bin").string();
+        std::vector<uint8_t> data(70000);
+        for (size_t i = 0; i < data.size(); ++i)
+            data[i] = static_cast<uint8_t>(i * 31);
+        std::vector<uint8_t> back;
+        bool ok = writeCacheFile(path, data) && readCacheFile(path, back) && back == data;
+        // Overwriting replaces the file and leaves no temporary behind
+        data.resize(10);
+        ok = ok && writeCacheFile(path, data) && readCacheFile(path, back) && back == data;
+        auto files = std::distance(fs::directory_iterator(dir / "a" / "b"),
+                                   fs::directory_iterator());
+        ok = ok && files == 1;
+        ok = ok && !readCacheFile((dir / "missing.bin").string(), back);
+        if (ok)
+            PASS();
+        else
+            FAIL("data mismatch or stray files (" << files << " files)");
+    }
+
+    // -----------------------------------------------------------------------
+    // 3. Pipeline cache header
+    // -----------------------------------------------------------------------
+    {
+        TEST("pipeline cache header identifies the device");
+        uint8_t uuid[16], other[16];
+        for (int i = 0; i < 16; ++i)
+        {
+            uuid[i] = static_cast<uint8_t>(i);
+            other[i] = static_cast<uint8_t>(i);
+        }
+        other[15] = 0xFF;
+        bool ok = pipelineCacheHeaderMatches(pipelineBlob(1, 0x10DE, 0x2204, uuid, 100),
+                                             0x10DE, 0x2204, uuid);
+        ok = ok && !pipelineCacheHeaderMatches(pipelineBlob(1, 0x10DE, 0x2204, uuid, 100),
+                                               0x10DE, 0x2204, other);
+        ok = ok && !pipelineCacheHeaderMatches(pipelineBlob(1, 0x1002, 0x2204, uuid, 100),
+                                               0x10DE, 0x2204, uuid);
+        ok = ok && !pipelineCacheHeaderMatches(pipelineBlob(1, 0x10DE, 0x2205, uuid, 100),
+                                               0x10DE, 0x2204, uuid);
+        ok = ok && !pipelineCacheHeaderMatches(pipelineBlob(2, 0x10DE, 0x2204, uuid, 100),
+                                               0x10DE, 0x2204, uuid);
+        std::vector<uint8_t> truncated = pipelineBlob(1, 0x10DE, 0x2204, uuid, 0);
+        truncated.resize(20);
+        ok = ok && !pipelineCacheHeaderMatches(truncated, 0x10DE, 0x2204, uuid);
+        ok = ok && hexString(uuid, 4) == "00010203" && hexString(other + 15, 1) == "ff";
+        if (ok)
+            PASS();
+        else
+            FAIL("header accepted or rejected wrongly");
+    }
+
+    fs::remove_all(dir);
+
+    std::cerr << "\n" << testsPassed << " passed, " << testsFailed << " failed\n";
+    return testsFailed > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,152 @@
+/// test_frame_recorder.cpp — background PNG writer for screenshots and
+/// frame recordings.
+///
+/// No external files or GPU needed; writes into a temporary directory.
+///
+/// Tests:
+///   1. nextFreeIndex() continues after the highest existing number
+///   2. Queued frames are written as PNGs with the submitted pixels
+///   3. A full queue refuses frames; accepted + dropped == submitted
+
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include "FrameRecorder.h"
+
+namespace fs = std::filesystem;
+
+static int testsPassed = 0;
+static int testsFailed = 0;
+
+#define TEST(name) \
+    std::cerr << "  TEST: " << name << " ... ";
+
+#define PASS() \
+    do { std::cerr << "PASS\n"; ++testsPassed; } while (0)
+
+#define FAIL(msg) \
+    do { std::cerr << "FAIL: " << msg << "\n"; ++testsFailed; } while (0)
+
+static std::vector<uint8_t> pattern(int w, int h, uint8_t seed)
+{
+    std::vector<uint8_t> px(static_cast<size_t>(w) * h * 4);
+    for (size_t i = 0; i < px.size(); ++i)
+        px[i] = static_cast<uint8_t>(i * 7 + seed);
+    for (size_t i = 3; i < px.size(); i += 4)
+        px[i] = 255;
+    return px;
+}
+
+static void touch(const fs::path& p)
+{
+    std::ofstream(p.string()) << "x";
+}
+
+int main()
+{
+    std::cerr << "=== FrameRecorderTest ===\n\n";
+
+    fs::path dir = fs::temp_directory_path() / "nr_test_frame_recorder";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+
+    // -----------------------------------------------------------------------
+    // 1. Numbering
+    // -----------------------------------------------------------------------
+    {
+        TEST("nextFreeIndex skips existing numbers");
+        bool ok = FrameRecorder::nextFreeIndex(dir.string(), "screenshot", ".png") == 1;
+        touch(dir / "screenshot000001.png");
+        touch(dir / "screenshot000007.png");
+        touch(dir / "screenshot000009.txt");     // other suffix
+        touch(dir / "screenshotABC.png");        // not a number
+        fs::create_directories(dir / "record000003");
+        ok = ok && FrameRecorder::nextFreeIndex(dir.string(), "screenshot", ".png") == 8;
+        ok = ok && FrameRecorder::nextFreeIndex(dir.string(), "record", "") == 4;
+        ok = ok && FrameRecorder::nextFreeIndex((dir / "missing").string(), "frame", ".png") == 1;
+        ok = ok && FrameRecorder::numberedName("frame", 42, ".png") == "frame000042.png";
+        if (ok)
+            PASS();
+        else
+            FAIL("unexpected index or name");
+    }
+
+    // -----------------------------------------------------------------------
+    // 2. Writing
+    // -----------------------------------------------------------------------
+    {
+        TEST("queued frames are written as PNGs");
+        bool ok = true;
+        {
+            FrameRecorder recorder(2, 8);
+            for (int i = 0; i < 4; ++i)
+            {
+                std::string path = (dir / FrameRecorder::numberedName("frame", i + 1, ".png")).string();
+                ok = ok && recorder.submit(path, pattern(33 + i, 17, static_cast<uint8_t>(i)),
+                                           33 + i, 17);
+            }
+            recorder.waitIdle();
+            ok = ok && recorder.pending() == 0 && recorder.stats().written == 4;
+        }
+        for (int i = 0; i < 4 && ok; ++i)
+        {
+            std::string path = (dir / FrameRecorder::numberedName("frame", i + 1, ".png")).string();
+            int w = 0, h = 0, channels = 0;
+            unsigned char* data = stbi_load(path.c_str(), &w, &h, &channels, 4);
+            ok = data && w == 33 + i && h == 17;
+            if (ok)
+            {
+                std::vector<uint8_t> expected = pattern(w, h, static_cast<uint8_t>(i));
+                ok = std::equal(expected.begin(), expected.end(), data);
+            }
+            stbi_image_free(data);
+        }
+        if (ok)
+            PASS();
+        else
+            FAIL("missing file or pixel mismatch");
+    }
+
+    // -----------------------------------------------------------------------
+    // 3. Backlog limit
+    // -----------------------------------------------------------------------
+    {
+        TEST("full queue drops frames instead of blocking");
+        uint64_t accepted = 0;
+        const int submitted = 20;
+        FrameRecorder recorder(1, 2);
+        for (int i = 0; i < submitted; ++i)
+        {
+            std::string path = (dir / FrameRecorder::numberedName("big", i, ".png")).string();
+            if (recorder.submit(path, pattern(256, 256, static_cast<uint8_t>(i)), 256, 256))
+                ++accepted;
+        }
+        recorder.waitIdle();
+        FrameRecorder::Stats st = recorder.stats();
+        bool ok = accepted >= 1 && st.written == accepted &&
+                  st.written + st.dropped == static_cast<uint64_t>(submitted);
+        // A frame handed to an invalid path is counted as failed, not dropped
+        ok = ok && recorder.submit((dir / "missing" / "x.png").string(),
+                                   pattern(4, 4, 0), 4, 4);
+        recorder.waitIdle();
+        ok = ok && recorder.stats().failed == 1;
+        if (ok)
+            PASS();
+        else
+            FAIL("accepted " << accepted << ", written " << st.written
+                 << ", dropped " << st.dropped);
+    }
+
+    fs::remove_all(dir);
+
+    std::cerr << "\n" << testsPassed << " passed, " << testsFailed << " failed\n";
+    return testsFailed > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
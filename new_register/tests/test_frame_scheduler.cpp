@@ -0,0 +1,116 @@
+/// test_frame_scheduler.cpp — wait/poll decisions and background-work
+/// budget of the event-driven main loop.
+///
+/// No window or GPU needed; FrameScheduler is header-only.
+///
+/// Tests:
+///   1. Startup and input render kSettleFrames frames, then the loop waits
+///   2. notify() from a worker thread wakes the loop for one frame
+///   3. The work budget expires; busy callers never wait
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+
+#include "FrameScheduler.h"
+
+static int testsPassed = 0;
+static int testsFailed = 0;
+
+#define TEST(name) \
+    std::cerr << "  TEST: " << name << " ... ";
+
+#define PASS() \
+    do { std::cerr << "PASS\n"; ++testsPassed; } while (0)
+
+#define FAIL(msg) \
+    do { std::cerr << "FAIL: " << msg << "\n"; ++testsFailed; } while (0)
+
+/// Frames rendered before shouldWait() turns true (capped at 100).
+static int framesUntilWait(FrameScheduler& s, bool input)
+{
+    int frames = 0;
+    while (!s.shouldWait() && frames < 100)
+    {
+        s.beginFrame(input && frames == 0);
+        ++frames;
+    }
+    return frames;
+}
+
+int main()
+{
+    std::cerr << "=== FrameSchedulerTest ===\n\n";
+
+    // -----------------------------------------------------------------------
+    // 1. Settle frames
+    // -----------------------------------------------------------------------
+    {
+        TEST("startup and input render a few frames, then wait");
+        FrameScheduler s;
+        int startup = framesUntilWait(s, false);
+        bool ok = startup == FrameScheduler::kSettleFrames;
+        // A timeout wake-up without input renders exactly one frame
+        s.beginFrame(false);
+        ok = ok && s.shouldWait();
+        // Input while waiting: the frame plus kSettleFrames - 1 more
+        s.beginFrame(true);
+        ok = ok && framesUntilWait(s, false) == FrameScheduler::kSettleFrames - 1;
+        // Requests never shorten an earlier, longer one
+        s.requestFrames(10);
+        s.requestFrames(2);
+        ok = ok && framesUntilWait(s, false) == 10;
+        if (ok)
+            PASS();
+        else
+            FAIL("startup rendered " << startup << " frames");
+    }
+
+    // -----------------------------------------------------------------------
+    // 2. Worker notification
+    // -----------------------------------------------------------------------
+    {
+        TEST("notify() from a worker wakes the loop");
+        std::atomic<int> wakes{0};
+        FrameScheduler s([&wakes] { ++wakes; });
+        framesUntilWait(s, false);
+        bool ok = s.shouldWait();
+        std::thread worker([&s] { s.notify(); });
+        worker.join();
+        ok = ok && wakes == 1 && !s.shouldWait();
+        // One frame consumes the notification
+        s.beginFrame(false);
+        ok = ok && s.shouldWait();
+        if (ok)
+            PASS();
+        else
+            FAIL("wakes " << wakes.load() << ", shouldWait " << s.shouldWait());
+    }
+
+    // -----------------------------------------------------------------------
+    // 3. Work budget
+    // -----------------------------------------------------------------------
+    {
+        TEST("work budget expires and busy callers keep rendering");
+        using namespace std::chrono;
+        FrameScheduler s({}, milliseconds(20));
+        framesUntilWait(s, false);
+        bool ok = !s.shouldWait(true) && s.shouldWait(false);
+        s.beginFrame(false);
+        ok = ok && s.workTimeLeft();
+        std::this_thread::sleep_for(milliseconds(30));
+        ok = ok && !s.workTimeLeft();
+        FrameScheduler none({}, microseconds(0));
+        none.beginFrame(false);
+        ok = ok && !none.workTimeLeft();
+        if (ok)
+            PASS();
+        else
+            FAIL("unexpected budget or wait state");
+    }
+
+    std::cerr << "\n" << testsPassed << " passed, " << testsFailed << " failed\n";
+    return testsFailed > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,862 @@
+/// test_gpu_slicing.cpp — GPU slicing (GLVolumeSlicer, VulkanVolumeSlicer)
+/// against the CPU renderer.
+///
+/// Usage: test_gpu_slicing <tests_dir> [gl|vulkan]
+///
+/// Renders through an OSMesa (llvmpipe) context and, in Vulkan builds,
+/// through a headless Vulkan device (lavapipe when installed), and reads
+/// the slice textures back.  The optional second argument limits the run
+/// to one backend.  A backend that cannot do GPU slicing is skipped;
+/// exits with 77 (skipped) when none of the selected ones can.  The
+/// Vulkan device runs under VK_LAYER_KHRONOS_validation when the layer is
+/// installed, and any validation error fails the run.
+///
+/// Tests:
+///   1. Test-mode volume slices match the CPU reference PNGs (±1)
+///   2. Range / invert / clamp / log variants match renderSlice()
+///   3. Two-volume overlay with a scaled, shifted second volume matches
+///      renderOverlaySlice()
+///   4. Paletted slices (8- and 16-bit index textures + LUT) match
+///      renderSlice()
+///   5. Tests 1-3 through VulkanVolumeSlicer, rendering into a rectangle
+///      of a larger image as into an atlas page
+///   6. No Vulkan validation errors (when the validation layer is present)
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include <GL/osmesa.h>
+#include <GL/gl.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "ColourMap.h"
+#include "GLVolumeSlicer.h"
+#include "SliceRenderer.h"
+#include "Volume.h"
+#include "imgui_impl_osmesa.h"
+
+#ifdef HAS_VULKAN
+#include <cstring>
+#include "VulkanHelpers.h"
+#include "VulkanVolumeSlicer.h"
+#endif
+
+static int testsPassed = 0;
+static int testsFailed = 0;
+
+#define TEST(name) \
+    std::cerr << "  TEST: " << name << " ... ";
+
+#define PASS() \
+    do { std::cerr << "PASS\n"; ++testsPassed; } while (0)
+
+#define FAIL(msg) \
+    do { std::cerr << "FAIL: " << msg << "\n"; ++testsFailed; } while (0)
+
+static GLVolumeSlicer::GLProc getProc(const char* name)
+{
+    return reinterpret_cast<GLVolumeSlicer::GLProc>(OSMesaGetProcAddress(name));
+}
+
+/// Pixels differing by more than ±1 in any of R, G, B or A.
+static int countMismatches(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b)
+{
+    if (a.size() != b.size())
+        return -1;
+    int mismatches = 0;
+    for (size_t i = 0; i < a.size(); ++i)
+        for (int sh = 0; sh < 32; sh += 8)
+        {
+            int ca = (a[i] >> sh) & 0xFF;
+            int cb = (b[i] >> sh) & 0xFF;
+            if (std::abs(ca - cb) > 1)
+            {
+                ++mismatches;
+                break;
+            }
+        }
+    return mismatches;
+}
+
+/// Render @p count layers into a fresh w x h texture and read it back.
+static std::vector<uint32_t> renderOnGl(GLVolumeSlicer& slicer, int w, int h,
+                                         const VolumeSliceLayer* layers, int count,
+                                         bool blend)
+{
+    GLuint tex = 0;
+    glGenTextures(1, &tex);
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    std::vector<uint32_t> pixels;
+    if (slicer.render(tex, w, h, layers, count, blend))
+    {
+        pixels.resize(static_cast<size_t>(w) * h);
+        glBindTexture(GL_TEXTURE_2D, tex);
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+    glDeleteTextures(1, &tex);
+    return pixels;
+}
+
+/// Layer for one volume slice, using the same voxel walk as renderSlice().
+static VolumeSliceLayer sliceLayer(const VolumeTexture& vt, const ColourTransfer& t,
+                                   int viewIndex, int sliceIndex, int& w, int& h)
+{
+    VolumeSliceLayer L;
+    L.volume = &vt;
+    L.slots = t.slots.data();
+    L.rangeMin = t.rangeMin;
+    L.rangeMax = t.rangeMax;
+    L.invSpan = t.invSpan;
+    L.useLog = t.useLog;
+    float s = static_cast<float>(sliceIndex);
+    if (viewIndex == 0)
+    {
+        w = vt.dimX; h = vt.dimY;
+        L.base[2] = s;
+    }
+    else if (viewIndex == 1)
+    {
+        w = vt.dimY; h = vt.dimZ;
+        L.base[0] = s;
+        L.dpx[0] = 0.0f; L.dpx[1] = 1.0f;
+        L.dpy[1] = 0.0f; L.dpy[2] = 1.0f;
+    }
+    else
+    {
+        w = vt.dimX; h = vt.dimZ;
+        L.base[1] = s;
+        L.dpy[1] = 0.0f; L.dpy[2] = 1.0f;
+    }
+    return L;
+}
+
+static bool loadPng(const std::string& path, int w, int h, std::vector<uint32_t>& out)
+{
+    int pw = 0, ph = 0, channels = 0;
+    unsigned char* data = stbi_load(path.c_str(), &pw, &ph, &channels, 4);
+    if (!data)
+        return false;
+    bool ok = (pw == w && ph == h);
+    if (ok)
+    {
+        out.resize(static_cast<size_t>(w) * h);
+        for (int i = 0; i < w * h; ++i)
+            out[i] = data[i * 4] | (data[i * 4 + 1] << 8) | (data[i * 4 + 2] << 16) |
+                     (0xFFu << 24);
+    }
+    stbi_image_free(data);
+    return ok;
+}
+
+/// A GPU slicer under test.
+struct SlicerApi
+{
+    const char* name;
+    std::function<std::unique_ptr<VolumeTexture>(const Volume&)> upload;
+    std::function<void(VolumeTexture*)> destroy;
+    /// Render @p count layers into a fresh w x h texture and read it back
+    /// (empty if rendering failed).
+    std::function<std::vector<uint32_t>(int w, int h, const VolumeSliceLayer* layers,
+                                        int count, bool blend)> render;
+};
+
+/// Tests 1-3 against @p api.
+static void runSlicingTests(const SlicerApi& api, const Volume& vol, const std::string& dir)
+{
+    // -----------------------------------------------------------------------
+    // 1. Test-mode reference PNGs
+    // -----------------------------------------------------------------------
+    auto vt = api.upload(vol);
+    if (!vt)
+    {
+        TEST(std::string(api.name) + " upload");
+        FAIL("could not upload the test volume");
+        return;
+    }
+
+    struct RefCase { const char* name; ColourMapType map; int view; const char* png; };
+    const RefCase refs[] = {
+        { "axial_gray",    ColourMapType::GrayScale, 0, "testmode_ax_gray.png" },
+        { "sagittal_gray", ColourMapType::GrayScale, 1, "testmode_sa_gray.png" },
+        { "coronal_gray",  ColourMapType::GrayScale, 2, "testmode_co_gray.png" },
+        { "axial_hot",     ColourMapType::HotMetal,  0, "testmode_ax_hot.png" },
+        { "sagittal_hot",  ColourMapType::HotMetal,  1, "testmode_sa_hot.png" },
+        { "coronal_hot",   ColourMapType::HotMetal,  2, "testmode_co_hot.png" },
+    };
+    for (const RefCase& rc : refs)
+    {
+        TEST(std::string(api.name) + " " + rc.name);
+        VolumeRenderParams p;
+        p.valueMin = vol.min_value;
+        p.valueMax = vol.max_value;
+        p.colourMap = rc.map;
+        ColourTransfer t = buildColourTransfer(p);
+        int centre[3] = { vol.dimensions.z / 2, vol.dimensions.x / 2, vol.dimensions.y / 2 };
+        int w = 0, h = 0;
+        VolumeSliceLayer L = sliceLayer(*vt, t, rc.view, centre[rc.view], w, h);
+        std::vector<uint32_t> gpu = api.render(w, h, &L, 1, false);
+        std::vector<uint32_t> ref;
+        if (gpu.empty())
+            FAIL("render failed");
+        else if (!loadPng(dir + rc.png, w, h, ref))
+            FAIL("cannot load reference PNG");
+        else if (int mm = countMismatches(gpu, ref); mm != 0)
+            FAIL(std::to_string(mm) + " pixel(s) differ from reference");
+        else
+            PASS();
+    }
+
+    // -----------------------------------------------------------------------
+    // 2. Colour-mapping variants against renderSlice()
+    // -----------------------------------------------------------------------
+    {
+        struct Variant { const char* name; bool log; bool invert; int under; int over;
+                         double lo, hi; int maxMismatch; };
+        // Log mode evaluates log10 as log2 * log10(2) on the GPU, so values
+        // within an ulp of a colour-bin edge may land in the neighbour bin.
+        const Variant variants[] = {
+            { "narrow range, transparent under, red over", false, false,
+              kSliceClampTransparent, kSliceClampRed, 40.0, 60.0, 0 },
+            { "inverted spectral", false, true,
+              kSliceClampCurrent, kSliceClampCurrent, 0.0, 80.0, 0 },
+            { "log transform", true, false,
+              kSliceClampBlue, kSliceClampWhite, 1.0, 90.0, 8 },
+        };
+        for (const Variant& v : variants)
+        {
+            TEST(std::string(api.name) + " " + v.name);
+            VolumeRenderParams p;
+            p.valueMin = v.lo;
+            p.valueMax = v.hi;
+            p.colourMap = ColourMapType::Spectral;
+            p.useLogTransform = v.log;
+            p.invertColourMap = v.invert;
+            p.underColourMode = v.under;
+            p.overColourMode = v.over;
+            ColourTransfer t = buildColourTransfer(p);
+
+            int total = 0;
+            bool ok = true;
+            for (int view = 0; view < 3 && ok; ++view)
+            {
+                int w = 0, h = 0;
+                VolumeSliceLayer L = sliceLayer(*vt, t, view, 17, w, h);
+                std::vector<uint32_t> gpu = api.render(w, h, &L, 1, false);
+                RenderedSlice cpu = renderSlice(vol, t, view, 17);
+                int mm = countMismatches(gpu, cpu.pixels);
+                ok = (mm >= 0);
+                total += mm;
+            }
+            if (ok && total <= v.maxMismatch)
+                PASS();
+            else
+                FAIL(std::to_string(total) + " pixel(s) differ from renderSlice");
+        }
+    }
+
+    // -----------------------------------------------------------------------
+    // 3. Overlay blend against renderOverlaySlice()
+    // -----------------------------------------------------------------------
+    {
+        TEST(std::string(api.name) + " two-volume overlay matches renderOverlaySlice");
+
+        // Second volume: half resolution, shifted by 3 voxels along x
+        Volume vol1;
+        vol1.dimensions = glm::ivec3(vol.dimensions.x / 2, vol.dimensions.y / 2,
+                                     vol.dimensions.z / 2);
+        vol1.data.resize(static_cast<size_t>(vol1.dimensions.x) * vol1.dimensions.y *
+                         vol1.dimensions.z);
+        for (size_t i = 0; i < vol1.data.size(); ++i)
+            vol1.data[i] = static_cast<float>(i % 97);
+        vol1.min_value = 0.0f;
+        vol1.max_value = 96.0f;
+        vol1.voxelToWorld = vol.voxelToWorld *
+            glm::dmat4(2.0, 0.0, 0.0, 0.0,
+                       0.0, 2.0, 0.0, 0.0,
+                       0.0, 0.0, 2.0, 0.0,
+                       3.0, 0.0, 0.0, 1.0);
+        vol1.worldToVoxel = glm::inverse(vol1.voxelToWorld);
+        auto vt1 = api.upload(vol1);
+
+        VolumeRenderParams p0;
+        p0.valueMin = vol.min_value;
+        p0.valueMax = vol.max_value;
+        p0.overlayAlpha = 0.6f;
+        VolumeRenderParams p1;
+        p1.valueMin = 10.0;
+        p1.valueMax = 80.0;
+        p1.colourMap = ColourMapType::HotMetal;
+        p1.underColourMode = kSliceClampTransparent;
+        p1.overlayAlpha = 0.4f;
+        ColourTransfer t0 = buildColourTransfer(p0);
+        ColourTransfer t1 = buildColourTransfer(p1);
+
+        int total = 0, pixels = 0;
+        bool ok = (vt1 != nullptr);
+        for (int view = 0; view < 3 && ok; ++view)
+        {
+            int slice = 20;
+            int w = 0, h = 0;
+            VolumeSliceLayer layers[2];
+            layers[0] = sliceLayer(*vt, t0, view, slice, w, h);
+            layers[0].alpha = p0.overlayAlpha;
+
+            // vol0 voxel -> vol1 voxel, walked from the slice corner
+            glm::dmat4 M = vol1.worldToVoxel * vol.voxelToWorld;
+            glm::dvec3 base(layers[0].base[0], layers[0].base[1], layers[0].base[2]);
+            glm::dvec3 dpx(layers[0].dpx[0], layers[0].dpx[1], layers[0].dpx[2]);
+            glm::dvec3 dpy(layers[0].dpy[0], layers[0].dpy[1], layers[0].dpy[2]);
+            glm::dvec4 b = M * glm::dvec4(base, 1.0);
+            glm::dvec4 dx = M * glm::dvec4(dpx, 0.0);
+            glm::dvec4 dy = M * glm::dvec4(dpy, 0.0);
+            int w1 = 0, h1 = 0;
+            layers[1] = sliceLayer(*vt1, t1, 0, 0, w1, h1);
+            for (int c = 0; c < 3; ++c)
+            {
+                layers[1].base[c] = static_cast<float>(b[c]);
+                layers[1].dpx[c] = static_cast<float>(dx[c]);
+                layers[1].dpy[c] = static_cast<float>(dy[c]);
+            }
+            layers[1].alpha = p1.overlayAlpha;
+
+            std::vector<uint32_t> gpu = api.render(w, h, layers, 2, true);
+            RenderedSlice cpu = renderOverlaySlice({ &vol, &vol1 }, { p0, p1 }, view,
+                                                   slice);
+            int mm = countMismatches(gpu, cpu.pixels);
+            ok = (mm >= 0);
+            total += mm;
+            pixels += w * h;
+        }
+        // Voxel centres exactly half-way between two samples may round
+        // differently in float (GPU) and double (CPU) arithmetic.
+        if (ok && total * 1000 <= pixels)
+            PASS();
+        else
+            FAIL(std::to_string(total) + " of " + std::to_string(pixels) +
+                 " pixel(s) differ from renderOverlaySlice");
+        if (vt1)
+            api.destroy(vt1.get());
+    }
+
+    api.destroy(vt.get());
+}
+
+/// Tests 1-4 on OSMesa.  Returns false if GL slicing is not available.
+static bool runGlTests(const Volume& vol, const std::string& dir)
+{
+    if (!osmesa_init(64, 64))
+    {
+        std::cerr << "No OSMesa context — skipping the GL tests\n";
+        return false;
+    }
+    GLVolumeSlicer slicer;
+    if (!slicer.initialize(getProc) || !slicer.supported())
+    {
+        std::cerr << "GPU slicing not supported by this GL context — skipping\n";
+        osmesa_shutdown();
+        return false;
+    }
+
+    SlicerApi api;
+    api.name = "[gl]";
+    api.upload = [&](const Volume& v) {
+        return slicer.createVolumeTexture(v.dimensions.x, v.dimensions.y, v.dimensions.z,
+                                          v.data.data());
+    };
+    api.destroy = [&](VolumeTexture* vt) { slicer.destroyVolumeTexture(vt); };
+    api.render = [&](int w, int h, const VolumeSliceLayer* layers, int count, bool blend) {
+        return renderOnGl(slicer, w, h, layers, count, blend);
+    };
+    runSlicingTests(api, vol, dir);
+
+    // -----------------------------------------------------------------------
+    // 4. Paletted slices against renderSlice()
+    // -----------------------------------------------------------------------
+    {
+        struct Variant { const char* name; int under; int over; bool invert; };
+        const Variant variants[] = {
+            { "paletted 8-bit (default clamps)", kSliceClampCurrent, kSliceClampCurrent, false },
+            { "paletted 16-bit (transparent under, red over)",
+              kSliceClampTransparent, kSliceClampRed, true },
+        };
+        for (const Variant& v : variants)
+        {
+            TEST(std::string(api.name) + " " + v.name);
+            VolumeRenderParams p;
+            p.valueMin = 20.0;
+            p.valueMax = 70.0;
+            p.colourMap = ColourMapType::Spectral;
+            p.invertColourMap = v.invert;
+            p.underColourMode = v.under;
+            p.overColourMode = v.over;
+            ColourTransfer t = buildColourTransfer(p);
+            int bytes = t.indexBytes();
+            uint32_t palette[kLutSize + 2];
+            int count = slicePalette(t, bytes, palette);
+
+            int total = 0;
+            std::string error;
+            for (int view = 0; view < 3 && error.empty(); ++view)
+            {
+                IndexedSlice idx = renderSliceIndices(vol, t, bytes, view, 17);
+                auto it = slicer.createIndexTexture(idx.width, idx.height, bytes);
+                if (!it)
+                {
+                    error = "index texture not supported";
+                    break;
+                }
+                slicer.updateIndexTexture(it.get(), idx.indices.data());
+
+                GLuint tex = 0;
+                glGenTextures(1, &tex);
+                glBindTexture(GL_TEXTURE_2D, tex);
+                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, idx.width, idx.height, 0,
+                             GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+                std::vector<uint32_t> gpu;
+                if (slicer.renderPaletted(tex, *it, palette, count))
+                {
+                    gpu.resize(static_cast<size_t>(idx.width) * idx.height);
+                    glBindTexture(GL_TEXTURE_2D, tex);
+                    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+                    glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, gpu.data());
+                }
+                glBindTexture(GL_TEXTURE_2D, 0);
+                glDeleteTextures(1, &tex);
+                slicer.destroyIndexTexture(it.get());
+
+                RenderedSlice cpu = renderSlice(vol, t, view, 17);
+                int mm = countMismatches(gpu, cpu.pixels);
+                if (mm < 0)
+                    error = "render failed";
+                else
+                    total += mm;
+            }
+            if (error == "index texture not supported" && bytes == 2)
+            {
+                std::cerr << "SKIP (no exact 16-bit textures)\n";
+                continue;
+            }
+            if (!error.empty())
+                FAIL(error);
+            else if (total != 0)
+                FAIL(std::to_string(total) + " pixel(s) differ from renderSlice");
+            else
+                PASS();
+        }
+    }
+
+    slicer.shutdown();
+    osmesa_shutdown();
+    return true;
+}
+
+#ifdef HAS_VULKAN
+// ---------------------------------------------------------------------------
+// Vulkan: a headless device, preferably a CPU one (lavapipe)
+// ---------------------------------------------------------------------------
+
+struct VulkanContext
+{
+    VkInstance       instance = VK_NULL_HANDLE;
+    VkPhysicalDevice physical = VK_NULL_HANDLE;
+    VkDevice         device   = VK_NULL_HANDLE;
+    uint32_t         family   = 0;
+    VkQueue          queue    = VK_NULL_HANDLE;
+    VkCommandPool    pool     = VK_NULL_HANDLE;
+    VkDebugUtilsMessengerEXT messenger = VK_NULL_HANDLE;
+    bool             validation = false;
+};
+
+static const char* kValidationLayer = "VK_LAYER_KHRONOS_validation";
+static int validationErrors = 0;
+
+static VKAPI_ATTR VkBool32 VKAPI_CALL onValidationMessage(
+    VkDebugUtilsMessageSeverityFlagBitsEXT severity,
+    VkDebugUtilsMessageTypeFlagsEXT,
+    const VkDebugUtilsMessengerCallbackDataEXT* data, void*)
+{
+    if (severity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT)
+    {
+        ++validationErrors;
+        std::cerr << "\n[validation] " << data->pMessage << "\n";
+    }
+    return VK_FALSE;
+}
+
+static bool hasValidationLayer()
+{
+    uint32_t count = 0;
+    vkEnumerateInstanceLayerProperties(&count, nullptr);
+    std::vector<VkLayerProperties> layers(count);
+    vkEnumerateInstanceLayerProperties(&count, layers.data());
+    for (const VkLayerProperties& layer : layers)
+        if (std::strcmp(layer.layerName, kValidationLayer) == 0)
+            return true;
+    return false;
+}
+
+static bool vulkanInit(VulkanContext& vk)
+{
+    VkApplicationInfo app = {};
+    app.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+    app.pApplicationName = "test_gpu_slicing";
+    app.apiVersion = VK_API_VERSION_1_0;
+    VkInstanceCreateInfo instInfo = {};
+    instInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    instInfo.pApplicationInfo = &app;
+
+    // The validation layer provides VK_EXT_debug_utils itself
+    const char* debugUtils = VK_EXT_DEBUG_UTILS_EXTENSION_NAME;
+    vk.validation = hasValidationLayer();
+    if (vk.validation)
+    {
+        instInfo.enabledLayerCount = 1;
+        instInfo.ppEnabledLayerNames = &kValidationLayer;
+        instInfo.enabledExtensionCount = 1;
+        instInfo.ppEnabledExtensionNames = &debugUtils;
+    }
+    else
+    {
+        std::cerr << kValidationLayer << " not installed — running without validation\n";
+    }
+    if (vkCreateInstance(&instInfo, nullptr, &vk.instance) != VK_SUCCESS)
+        return false;
+
+    if (vk.validation)
+    {
+        VkDebugUtilsMessengerCreateInfoEXT msgInfo = {};
+        msgInfo.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT;
+        msgInfo.messageSeverity = VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
+        msgInfo.messageType = VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT |
+                              VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT;
+        msgInfo.pfnUserCallback = onValidationMessage;
+        auto create = reinterpret_cast<PFN_vkCreateDebugUtilsMessengerEXT>(
+            vkGetInstanceProcAddr(vk.instance, "vkCreateDebugUtilsMessengerEXT"));
+        if (!create || create(vk.instance, &msgInfo, nullptr, &vk.messenger) != VK_SUCCESS)
+            vk.validation = false;
+    }
+
+    uint32_t count = 0;
+    vkEnumeratePhysicalDevices(vk.instance, &count, nullptr);
+    std::vector<VkPhysicalDevice> devices(count);
+    vkEnumeratePhysicalDevices(vk.instance, &count, devices.data());
+    bool cpu = false;
+    for (VkPhysicalDevice d : devices)
+    {
+        uint32_t familyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(d, &familyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> families(familyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(d, &familyCount, families.data());
+        for (uint32_t f = 0; f < familyCount; ++f)
+        {
+            // The backend slices on its graphics queue
+            const VkQueueFlags need = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT;
+            if ((families[f].queueFlags & need) != need)
+                continue;
+            VkPhysicalDeviceProperties props;
+            vkGetPhysicalDeviceProperties(d, &props);
+            bool isCpu = props.deviceType == VK_PHYSICAL_DEVICE_TYPE_CPU;
+            if (vk.physical == VK_NULL_HANDLE || (isCpu && !cpu))
+            {
+                vk.physical = d;
+                vk.family = f;
+                cpu = isCpu;
+            }
+            break;
+        }
+    }
+    if (vk.physical == VK_NULL_HANDLE)
+        return false;
+
+    float priority = 1.0f;
+    VkDeviceQueueCreateInfo queueInfo = {};
+    queueInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+    queueInfo.queueFamilyIndex = vk.family;
+    queueInfo.queueCount = 1;
+    queueInfo.pQueuePriorities = &priority;
+    VkDeviceCreateInfo devInfo = {};
+    devInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    devInfo.queueCreateInfoCount = 1;
+    devInfo.pQueueCreateInfos = &queueInfo;
+    if (vkCreateDevice(vk.physical, &devInfo, nullptr, &vk.device) != VK_SUCCESS)
+        return false;
+    vkGetDeviceQueue(vk.device, vk.family, 0, &vk.queue);
+
+    VkCommandPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    poolInfo.queueFamilyIndex = vk.family;
+    return vkCreateCommandPool(vk.device, &poolInfo, nullptr, &vk.pool) == VK_SUCCESS;
+}
+
+static void vulkanShutdown(VulkanContext& vk)
+{
+    if (vk.pool != VK_NULL_HANDLE)
+        vkDestroyCommandPool(vk.device, vk.pool, nullptr);
+    if (vk.device != VK_NULL_HANDLE)
+        vkDestroyDevice(vk.device, nullptr);
+    if (vk.messenger != VK_NULL_HANDLE)
+    {
+        auto destroy = reinterpret_cast<PFN_vkDestroyDebugUtilsMessengerEXT>(
+            vkGetInstanceProcAddr(vk.instance, "vkDestroyDebugUtilsMessengerEXT"));
+        if (destroy)
+            destroy(vk.instance, vk.messenger, nullptr);
+    }
+    if (vk.instance != VK_NULL_HANDLE)
+        vkDestroyInstance(vk.instance, nullptr);
+    vk = VulkanContext{};
+}
+
+static uint32_t memoryType(const VulkanContext& vk, uint32_t bits, VkMemoryPropertyFlags flags)
+{
+    VkPhysicalDeviceMemoryProperties mem;
+    vkGetPhysicalDeviceMemoryProperties(vk.physical, &mem);
+    for (uint32_t i = 0; i < mem.memoryTypeCount; ++i)
+        if ((bits & (1u << i)) && (mem.memoryTypes[i].propertyFlags & flags) == flags)
+            return i;
+    return 0;
+}
+
+/// An RGBA8 image like the backend's textures, without an ImGui descriptor.
+static std::unique_ptr<VulkanTexture> makeTarget(const VulkanContext& vk, int w, int h)
+{
+    auto tex = std::make_unique<VulkanTexture>();
+    tex->width = w;
+    tex->height = h;
+
+    VkImageCreateInfo info = {};
+    info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    info.imageType = VK_IMAGE_TYPE_2D;
+    info.format = VK_FORMAT_R8G8B8A8_UNORM;
+    info.extent = {static_cast<uint32_t>(w), static_cast<uint32_t>(h), 1};
+    info.mipLevels = 1;
+    info.arrayLayers = 1;
+    info.samples = VK_SAMPLE_COUNT_1_BIT;
+    info.tiling = VK_IMAGE_TILING_OPTIMAL;
+    info.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT |
+                 VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    vkCreateImage(vk.device, &info, nullptr, &tex->image);
+
+    VkMemoryRequirements req;
+    vkGetImageMemoryRequirements(vk.device, tex->image, &req);
+    VkMemoryAllocateInfo alloc = {};
+    alloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    alloc.allocationSize = req.size;
+    alloc.memoryTypeIndex = memoryType(vk, req.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    vkAllocateMemory(vk.device, &alloc, nullptr, &tex->image_memory);
+    vkBindImageMemory(vk.device, tex->image, tex->image_memory, 0);
+
+    VkImageViewCreateInfo view = {};
+    view.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    view.image = tex->image;
+    view.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    view.format = VK_FORMAT_R8G8B8A8_UNORM;
+    view.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    view.subresourceRange.levelCount = 1;
+    view.subresourceRange.layerCount = 1;
+    vkCreateImageView(vk.device, &view, nullptr, &tex->image_view);
+    return tex;
+}
+
+/// Copy the w x h rectangle at (x, y) of a rendered @p tex to the host.
+static std::vector<uint32_t> readBack(const VulkanContext& vk, VulkanTexture& tex,
+                                      int x, int y, int w, int h)
+{
+    const VkDeviceSize bytes = static_cast<VkDeviceSize>(w) * h * 4;
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkBufferCreateInfo info = {};
+    info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    info.size = bytes;
+    info.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    vkCreateBuffer(vk.device, &info, nullptr, &buffer);
+    VkMemoryRequirements req;
+    vkGetBufferMemoryRequirements(vk.device, buffer, &req);
+    VkMemoryAllocateInfo alloc = {};
+    alloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    alloc.allocationSize = req.size;
+    alloc.memoryTypeIndex = memoryType(vk, req.memoryTypeBits,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    vkAllocateMemory(vk.device, &alloc, nullptr, &memory);
+    vkBindBufferMemory(vk.device, buffer, memory, 0);
+
+    VkCommandBuffer cb = VK_NULL_HANDLE;
+    VkCommandBufferAllocateInfo cbInfo = {};
+    cbInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    cbInfo.commandPool = vk.pool;
+    cbInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    cbInfo.commandBufferCount = 1;
+    vkAllocateCommandBuffers(vk.device, &cbInfo, &cb);
+    VkCommandBufferBeginInfo begin = {};
+    begin.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(cb, &begin);
+
+    VkImageMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = tex.image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.layerCount = 1;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    vkCmdPipelineBarrier(cb, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0, 0, nullptr, 0, nullptr, 1, &barrier);
+    VkBufferImageCopy region = {};
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.layerCount = 1;
+    region.imageOffset = {x, y, 0};
+    region.imageExtent = {static_cast<uint32_t>(w), static_cast<uint32_t>(h), 1};
+    vkCmdCopyImageToBuffer(cb, tex.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, buffer,
+                           1, &region);
+    VkBufferMemoryBarrier host = {};
+    host.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    host.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    host.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    host.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    host.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    host.buffer = buffer;
+    host.size = VK_WHOLE_SIZE;
+    vkCmdPipelineBarrier(cb, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+                         0, 0, nullptr, 1, &host, 0, nullptr);
+    vkEndCommandBuffer(cb);
+
+    VkSubmitInfo submit = {};
+    submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit.commandBufferCount = 1;
+    submit.pCommandBuffers = &cb;
+    std::vector<uint32_t> pixels;
+    if (vkQueueSubmit(vk.queue, 1, &submit, VK_NULL_HANDLE) == VK_SUCCESS &&
+        vkQueueWaitIdle(vk.queue) == VK_SUCCESS)
+    {
+        void* mapped = nullptr;
+        vkMapMemory(vk.device, memory, 0, bytes, 0, &mapped);
+        pixels.resize(static_cast<size_t>(w) * h);
+        std::memcpy(pixels.data(), mapped, static_cast<size_t>(bytes));
+        vkUnmapMemory(vk.device, memory);
+    }
+    vkFreeCommandBuffers(vk.device, vk.pool, 1, &cb);
+    vkDestroyBuffer(vk.device, buffer, nullptr);
+    vkFreeMemory(vk.device, memory, nullptr);
+    return pixels;
+}
+
+/// Tests 5-6: tests 1-3 through VulkanVolumeSlicer, then the validation
+/// error count.  Returns false if there is no Vulkan device or the build
+/// has no slicing shader.
+static bool runVulkanTests(const Volume& vol, const std::string& dir)
+{
+    VulkanContext vk;
+    if (!vulkanInit(vk))
+    {
+        std::cerr << "No Vulkan device — skipping the Vulkan tests\n";
+        vulkanShutdown(vk);
+        return false;
+    }
+    VkPhysicalDeviceProperties props;
+    vkGetPhysicalDeviceProperties(vk.physical, &props);
+    std::cerr << "Vulkan device: " << props.deviceName << "\n";
+
+    VulkanHelpers::Init(vk.device, vk.physical, vk.family, vk.queue,
+                        VK_NULL_HANDLE, VK_NULL_HANDLE);
+    VulkanVolumeSlicer slicer;
+    bool ran = slicer.initialize(vk.physical, vk.device, vk.family, vk.queue);
+    if (!ran)
+    {
+        std::cerr << "GPU slicing not supported by this Vulkan build or device — skipping\n";
+    }
+    else
+    {
+        SlicerApi api;
+        api.name = "[vulkan]";
+        api.upload = [&](const Volume& v) {
+            return slicer.createVolumeTexture(v.dimensions.x, v.dimensions.y, v.dimensions.z,
+                                              v.data.data());
+        };
+        api.destroy = [&](VolumeTexture* vt) { slicer.destroyVolumeTexture(vt); };
+        api.render = [&](int w, int h, const VolumeSliceLayer* layers, int count, bool blend) {
+            // An offset rectangle of a larger image, as in an atlas page
+            const int x = 3, y = 2;
+            auto target = makeTarget(vk, w + 2 * x, h + 2 * y);
+            std::vector<uint32_t> pixels;
+            if (slicer.render(target.get(), x, y, w, h, layers, count, blend))
+            {
+                VulkanHelpers::FlushUploads();
+                pixels = readBack(vk, *target, x, y, w, h);
+            }
+            return pixels;
+        };
+        runSlicingTests(api, vol, dir);
+    }
+
+    slicer.shutdown();
+    VulkanHelpers::Shutdown();
+    const bool validation = vk.validation;
+    vulkanShutdown(vk);
+
+    if (ran && validation)
+    {
+        // 6. Messages are reported as they arrive; shutdown is included
+        TEST("[vulkan] no validation errors");
+        if (validationErrors == 0)
+            PASS();
+        else
+            FAIL(std::to_string(validationErrors) + " validation error(s)");
+    }
+    return ran;
+}
+#endif // HAS_VULKAN
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: test_gpu_slicing <tests_dir> [gl|vulkan]\n";
+        return 1;
+    }
+    std::string dir = argv[1];
+    if (!dir.empty() && dir.back() != '/')
+        dir += '/';
+    const std::string only = argc > 2 ? argv[2] : "";
+    if (!only.empty() && only != "gl" && only != "vulkan")
+    {
+        std::cerr << "Unknown backend '" << only << "' (expected gl or vulkan)\n";
+        return 1;
+    }
+
+    std::cerr << "=== GpuSlicingTest ===\n\n";
+
+    Volume vol;
+    vol.generate_test_data();
+
+    bool ran = false;
+    if (only != "vulkan")
+        ran = runGlTests(vol, dir);
+#ifdef HAS_VULKAN
+    if (only != "gl")
+        ran = runVulkanTests(vol, dir) || ran;
+#else
+    if (only == "vulkan")
+        std::cerr << "Built without Vulkan — skipping\n";
+#endif
+    if (!ran)
+        return 77;
+
+    std::cerr << "\n" << testsPassed << " passed, " << testsFailed << " failed\n";
+    return testsFailed > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
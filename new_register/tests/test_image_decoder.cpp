@@ -0,0 +1,282 @@
+/// test_image_decoder.cpp — new_qc's background image decoder and its
+/// byte-budgeted LRU cache.
+///
+/// No image files needed: the decoder is given a fake decode function that
+/// allocates a buffer whose size is encoded in the path ("w x h") and
+/// records the order of the calls.
+///
+/// Tests:
+///   1. acquire() decodes once; the second acquire() is a hit
+///   2. prefetch() decodes in order, and later acquire() calls are hits
+///   3. The byte budget evicts the least recently used images first
+///   4. A failed decode yields an image without pixels and is not retried
+///   5. Reduction to the display size, and the 2x2 box filter
+///   6. Mip chains, and full-resolution decodes next to reduced ones
+///   7. An empty path and a throwing decode yield images without pixels
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ImageDecoder.h"
+
+using QC::ImageDecoder;
+
+static int testsPassed = 0;
+static int testsFailed = 0;
+
+#define TEST(name) \
+    std::cerr << "  TEST: " << name << " ... ";
+
+#define PASS() \
+    do { std::cerr << "PASS\n"; ++testsPassed; } while (0)
+
+#define FAIL(msg) \
+    do { std::cerr << "FAIL: " << msg << "\n"; ++testsFailed; } while (0)
+
+/// Decodes "<name>:<w>x<h>" into a w*h RGBA buffer; "bad" paths fail and
+/// "throw" paths throw.
+struct FakeDecoder
+{
+    std::mutex mutex;
+    std::vector<std::string> calls;
+
+    ImageDecoder::DecodeFn fn()
+    {
+        return [this](const std::string& path) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                calls.push_back(path);
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            ImageDecoder::Image image;
+            if (path.rfind("bad", 0) == 0)
+                return image;
+            if (path.rfind("throw", 0) == 0)
+                throw std::runtime_error("cannot decode " + path);
+            size_t colon = path.find(':');
+            image.width = std::atoi(path.c_str() + colon + 1);
+            image.height = std::atoi(path.c_str() + path.find('x', colon) + 1);
+            image.channels = 3;
+            size_t bytes = static_cast<size_t>(image.width) * image.height * 4;
+            image.pixels.reset(static_cast<unsigned char*>(std::malloc(bytes)));
+            std::memset(image.pixels.get(), 0x7f, bytes);
+            return image;
+        };
+    }
+
+    size_t count()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return calls.size();
+    }
+};
+
+static void waitFor(const ImageDecoder& d, const std::string& path)
+{
+    for (int i = 0; i < 2000 && !d.contains(path); ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+int main()
+{
+    std::cerr << "=== ImageDecoderTest ===\n\n";
+
+    // -----------------------------------------------------------------------
+    // 1. Decode on demand
+    // -----------------------------------------------------------------------
+    {
+        TEST("acquire decodes once, then hits the cache");
+        FakeDecoder fake;
+        ImageDecoder d(fake.fn(), 1 << 20, 2);
+        ImageDecoder::ImagePtr a = d.acquire("a:16x8");
+        ImageDecoder::ImagePtr b = d.acquire("a:16x8");
+        ImageDecoder::Stats st = d.stats();
+        bool ok = a && a->pixels && a->width == 16 && a->height == 8 &&
+                  a->channels == 3 && a == b && fake.count() == 1 &&
+                  st.acquired == 2 && st.hits == 1 && d.bytes() == 16 * 8 * 4;
+        if (ok)
+            PASS();
+        else
+            FAIL("calls " << fake.count() << ", hits " << st.hits << "/" << st.acquired
+                 << ", bytes " << d.bytes());
+    }
+
+    // -----------------------------------------------------------------------
+    // 2. Prefetch order
+    // -----------------------------------------------------------------------
+    {
+        TEST("prefetch decodes most urgent first; acquire then hits");
+        FakeDecoder fake;
+        ImageDecoder d(fake.fn(), 1 << 20, 1);
+        std::vector<std::string> paths = {"p1:4x4", "p2:4x4", "p0:4x4", "p3:4x4"};
+        d.prefetch(paths);
+        waitFor(d, "p3:4x4");
+        bool ok = fake.calls == paths;
+        for (const std::string& p : paths)
+            ok = ok && d.acquire(p)->pixels != nullptr;
+        // Queued images already cached are not decoded again
+        d.prefetch(paths);
+        ok = ok && d.stats().hits == 4 && fake.count() == 4;
+        if (ok)
+            PASS();
+        else
+            FAIL("calls " << fake.count() << ", hits " << d.stats().hits);
+    }
+
+    // -----------------------------------------------------------------------
+    // 3. Byte budget
+    // -----------------------------------------------------------------------
+    {
+        TEST("byte budget evicts least recently used images");
+        FakeDecoder fake;
+        // Room for three 1 KiB images
+        ImageDecoder d(fake.fn(), 3 * 1024, 1);
+        d.acquire("a:16x16");
+        d.acquire("b:16x16");
+        d.acquire("c:16x16");
+        // Marking a as used makes b the oldest
+        d.prefetch({"a:16x16"});
+        d.acquire("d:16x16");
+        bool ok = d.contains("a:16x16") && !d.contains("b:16x16") &&
+                  d.contains("c:16x16") && d.contains("d:16x16") &&
+                  d.bytes() == 3 * 1024;
+        // An image larger than the budget is kept while it is current
+        d.acquire("big:64x64");
+        ok = ok && d.contains("big:64x64") && d.bytes() == 64 * 64 * 4;
+        if (ok)
+            PASS();
+        else
+            FAIL("bytes " << d.bytes());
+    }
+
+    // -----------------------------------------------------------------------
+    // 4. Failures
+    // -----------------------------------------------------------------------
+    {
+        TEST("a failed decode has no pixels and is not retried");
+        FakeDecoder fake;
+        ImageDecoder d(fake.fn(), 1 << 20, 2);
+        ImageDecoder::ImagePtr a = d.acquire("bad.png");
+        ImageDecoder::ImagePtr b = d.acquire("bad.png");
+        bool ok = a && !a->pixels && b && !b->pixels && fake.count() == 1 &&
+                  d.stats().failed == 1 && d.bytes() == 0;
+        if (ok)
+            PASS();
+        else
+            FAIL("calls " << fake.count() << ", failed " << d.stats().failed);
+    }
+
+    // -----------------------------------------------------------------------
+    // 5. Reduction
+    // -----------------------------------------------------------------------
+    {
+        TEST("images are halved while they still cover the display");
+        // 8000x1000 in a 1000x1000 panel is shown at 1000x125
+        bool ok = ImageDecoder::reductionSteps(8000, 1000, 1000, 1000) == 3 &&
+                  ImageDecoder::reductionSteps(800, 600, 1000, 1000) == 0 &&
+                  ImageDecoder::reductionSteps(4000, 4000, 1000, 1000) == 2 &&
+                  ImageDecoder::reductionSteps(3999, 3999, 1000, 1000) == 1 &&
+                  ImageDecoder::reductionSteps(4000, 4000, 0, 0) == 0;
+
+        // 3x3 -> 1x1: the odd last row and column are dropped
+        const unsigned char src[3 * 3 * 4] = {
+            0, 0, 0, 255,   4, 8, 12, 255,   100, 100, 100, 255,
+            8, 16, 24, 255, 12, 24, 36, 255, 100, 100, 100, 255,
+            100, 100, 100, 255, 100, 100, 100, 255, 100, 100, 100, 255,
+        };
+        unsigned char dst[4] = {};
+        ImageDecoder::halve(src, 3, 3, dst);
+        ok = ok && dst[0] == 6 && dst[1] == 12 && dst[2] == 18 && dst[3] == 255;
+        // A side of one pixel stays one pixel wide
+        const unsigned char column[1 * 2 * 4] = {10, 20, 30, 40, 30, 40, 50, 60};
+        ImageDecoder::halve(column, 1, 2, dst);
+        ok = ok && dst[0] == 20 && dst[1] == 30 && dst[2] == 40 && dst[3] == 50;
+
+        // Decoded through the pool at a display size
+        FakeDecoder fake;
+        ImageDecoder d(fake.fn(), 1 << 24, 1);
+        d.setDisplaySize(100, 100);
+        ImageDecoder::ImagePtr img = d.acquire("r:800x400");
+        ok = ok && img->width == 100 && img->height == 50 &&
+             img->fullWidth == 800 && img->fullHeight == 400 && img->reduced() &&
+             img->pixels.get()[0] == 0x7f && d.bytes() == 100 * 50 * 4;
+        if (ok)
+            PASS();
+        else
+            FAIL("steps " << ImageDecoder::reductionSteps(8000, 1000, 1000, 1000)
+                 << ", box " << int(dst[0]) << "," << int(dst[1]) << "," << int(dst[2])
+                 << ", image " << img->width << "x" << img->height);
+    }
+
+    // -----------------------------------------------------------------------
+    // 6. Mip chains and full resolution
+    // -----------------------------------------------------------------------
+    {
+        TEST("mip chains are appended; full resolution is cached separately");
+        bool ok = QC::mipLevelCount(1, 1) == 1 && QC::mipLevelCount(8, 2) == 4 &&
+                  QC::mipChainBytes(8, 2, 4) == (16 + 4 + 2 + 1) * 4 &&
+                  QC::mipLevelOffset(8, 2, 2) == (16 + 4) * 4;
+
+        FakeDecoder fake;
+        ImageDecoder d(fake.fn(), 1 << 24, 2);
+        d.setDisplaySize(64, 64);
+        d.setMipmaps(true);
+        ImageDecoder::ImagePtr shown = d.acquire("m:256x128");
+        ok = ok && shown->width == 64 && shown->height == 32 && shown->mipLevels == 7 &&
+             shown->bytes() == QC::mipChainBytes(64, 32, 7);
+        // The 1x1 level of a uniform image keeps its value
+        const unsigned char* last = shown->pixels.get() + QC::mipLevelOffset(64, 32, 6);
+        ok = ok && last[0] == 0x7f && last[3] == 0x7f;
+
+        ok = ok && !d.find("m:256x128", ImageDecoder::Resolution::Full);
+        d.request("m:256x128", ImageDecoder::Resolution::Full);
+        ImageDecoder::ImagePtr full = d.acquire("m:256x128", ImageDecoder::Resolution::Full);
+        ok = ok && full->width == 256 && full->height == 128 && !full->reduced() &&
+             full->mipLevels == 9 && fake.count() == 2 &&
+             d.find("m:256x128", ImageDecoder::Resolution::Display) == shown;
+        if (ok)
+            PASS();
+        else
+            FAIL("shown " << shown->width << "x" << shown->height << "/" << shown->mipLevels
+                 << ", full " << full->width << "x" << full->height << "/" << full->mipLevels
+                 << ", calls " << fake.count());
+    }
+
+    // -----------------------------------------------------------------------
+    // 7. Empty paths and throwing decodes
+    // -----------------------------------------------------------------------
+    {
+        TEST("an empty path and a throwing decode give images without pixels");
+        FakeDecoder fake;
+        ImageDecoder d(fake.fn(), 1 << 20, 2);
+        // A CSV row without a picture, at both resolutions
+        d.prefetch({"", "a:4x4"});
+        d.request("", ImageDecoder::Resolution::Full);
+        ImageDecoder::ImagePtr empty = d.acquire("");
+        ImageDecoder::ImagePtr emptyFull = d.acquire("", ImageDecoder::Resolution::Full);
+        ImageDecoder::ImagePtr thrown = d.acquire("throw:4x4");
+        ImageDecoder::ImagePtr after = d.acquire("b:4x4");
+        bool ok = empty && !empty->pixels && emptyFull && !emptyFull->pixels &&
+                  thrown && !thrown->pixels && after && after->pixels &&
+                  !d.contains("") && d.stats().failed == 1;
+        {
+            std::lock_guard<std::mutex> lock(fake.mutex);
+            for (const std::string& call : fake.calls)
+                ok = ok && !call.empty();
+        }
+        if (ok)
+            PASS();
+        else
+            FAIL("failed " << d.stats().failed << ", calls " << fake.count());
+    }
+
+    std::cerr << "\n" << testsPassed << " passed, " << testsFailed << " failed\n";
+    return testsFailed > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
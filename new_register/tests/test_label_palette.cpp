@@ -0,0 +1,195 @@
+/// test_label_palette.cpp — dense label id -> colour palettes.
+///
+/// No external files needed — label volumes are synthesised in memory and
+/// the label description file is written to the temp directory.
+///
+/// Tests:
+///   1. Colour-map palette follows the (rank+1)*255/count ranking
+///   2. Label 0 and ids absent from the volume are transparent
+///   3. Per-label LUT palette: LUT colours, hidden labels, unknown-label gray
+///   4. contentVersion() changes on LUT, label flag and data changes
+///   5. Very sparse ids fall back to the sparse map
+///   6. renderSlice on a label volume uses the palette colours
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "ColourMap.h"
+#include "SliceRenderer.h"
+#include "Volume.h"
+
+static int testsPassed = 0;
+static int testsFailed = 0;
+
+#define TEST(name) \
+    std::cerr << "  TEST: " << name << " ... ";
+
+#define PASS() \
+    do { std::cerr << "PASS\n"; ++testsPassed; } while (0)
+
+#define FAIL(msg) \
+    do { std::cerr << "FAIL: " << msg << "\n"; ++testsFailed; } while (0)
+
+// 4x4x1 label volume with the given ids (row-major, 16 entries)
+static Volume makeLabelVolume(const std::vector<float>& ids)
+{
+    Volume v;
+    v.dimensions = glm::ivec3(4, 4, 1);
+    v.data = ids;
+    v.min_value = 0.0f;
+    v.max_value = 1.0f;
+    v.setLabelVolume(true);
+    return v;
+}
+
+// Label description file hiding label 7 (columns: id r g b a visible)
+static std::string writeLabelDescription()
+{
+    const std::string path =
+        (std::filesystem::temp_directory_path() / "test_label_palette_lut.txt").string();
+    std::ofstream out(path);
+    out << "# id r g b a visible\n"
+        << "7 255 0 0 255 0\n"
+        << "12 0 255 0 255 1\n";
+    return path;
+}
+
+int main()
+{
+    std::cerr << "=== LabelPaletteTest ===\n\n";
+
+    const std::vector<float> ids = { 0, 3, 3, 7,
+                                     7, 7, 12, 0,
+                                     0, 3, 12, 12,
+                                     7, 0, 0, 3 };
+
+    VolumeRenderParams p;
+    p.colourMap = ColourMapType::HotMetal;
+    ColourTransfer transfer = buildColourTransfer(p);
+    const ColourLut& hot = colourMapLut(ColourMapType::HotMetal);
+    const std::string lutPath = writeLabelDescription();
+
+    // -----------------------------------------------------------------------
+    // 1 + 2. Colour-map ranking and transparency
+    // -----------------------------------------------------------------------
+    {
+        TEST("colour-map palette ranks labels 3,7,12 → LUT[85],[170],[255]");
+        Volume vol = makeLabelVolume(ids);
+        LabelPalette pal = buildLabelPalette(vol, transfer);
+
+        bool ok = pal.colour(3) == hot.table[85] &&
+                  pal.colour(7) == hot.table[170] &&
+                  pal.colour(12) == hot.table[255];
+        if (ok)
+            PASS();
+        else
+            FAIL("unexpected rank colours");
+
+        TEST("label 0 and absent labels are transparent");
+        if (pal.colour(0) == 0 && pal.colour(5) == 0 &&
+            pal.colour(-4) == 0 && pal.colour(1000) == 0)
+            PASS();
+        else
+            FAIL("expected transparent colours");
+    }
+
+    // -----------------------------------------------------------------------
+    // 3. Per-label LUT palette
+    // -----------------------------------------------------------------------
+    {
+        TEST("label LUT palette: hidden label transparent, unknown gray");
+        Volume vol = makeLabelVolume(ids);
+        vol.loadLabelDescriptionFile(lutPath);
+        LabelPalette pal = buildLabelPalette(vol, transfer, false);
+
+        uint32_t gray3 = (3 * 17) % 256;
+        uint32_t expect3 = gray3 | (gray3 << 8) | (gray3 << 16) | 0xFF000000;
+        uint32_t green12 = 0xFF00FF00;
+        if (pal.colour(7) == 0 && pal.colour(3) == expect3 && pal.colour(12) == green12)
+            PASS();
+        else
+            FAIL("label 7 should be hidden, label 3 gray, label 12 green");
+    }
+
+    // -----------------------------------------------------------------------
+    // 4. contentVersion invalidation
+    // -----------------------------------------------------------------------
+    {
+        TEST("contentVersion changes on LUT, label flag and data changes");
+        Volume vol = makeLabelVolume(ids);
+        uint64_t v0 = vol.contentVersion();
+        vol.loadLabelDescriptionFile(lutPath);
+        uint64_t v1 = vol.contentVersion();
+        vol.setLabelVolume(true);  // no-op
+        uint64_t v2 = vol.contentVersion();
+        vol.setLabelVolume(false);
+        uint64_t v3 = vol.contentVersion();
+        vol.setLabelVolume(true);
+        Volume other = makeLabelVolume(ids);
+
+        if (v1 != v0 && v2 == v1 && v3 != v2 && vol.contentVersion() != v3 &&
+            other.contentVersion() != vol.contentVersion())
+            PASS();
+        else
+            FAIL("version did not track label changes");
+
+        TEST("palette records the version it was built from");
+        LabelPalette pal = buildLabelPalette(vol, transfer);
+        if (pal.contentVersion == vol.contentVersion())
+            PASS();
+        else
+            FAIL("palette version mismatch");
+    }
+
+    // -----------------------------------------------------------------------
+    // 5. Sparse fallback
+    // -----------------------------------------------------------------------
+    {
+        TEST("very sparse ids use the sparse map");
+        std::vector<float> sparseIds(16, 0.0f);
+        sparseIds[1] = 1.0f;
+        sparseIds[2] = 4000000.0f;
+        Volume vol = makeLabelVolume(sparseIds);
+        LabelPalette pal = buildLabelPalette(vol, transfer);
+
+        if (pal.colours.empty() && pal.sparse.size() == 2 &&
+            pal.colour(1) == hot.table[127] &&
+            pal.colour(4000000) == hot.table[255] &&
+            pal.colour(2) == 0)
+            PASS();
+        else
+            FAIL("sparse palette lookup failed");
+    }
+
+    // -----------------------------------------------------------------------
+    // 6. renderSlice through the palette
+    // -----------------------------------------------------------------------
+    {
+        TEST("renderSlice label volume matches palette colours");
+        Volume vol = makeLabelVolume(ids);
+        LabelPalette pal = buildLabelPalette(vol, transfer);
+        RenderedSlice s = renderSlice(vol, p, 0, 0);
+
+        bool ok = (s.width == 4 && s.height == 4);
+        for (int y = 0; ok && y < 4; ++y)
+            for (int x = 0; x < 4; ++x)
+            {
+                int id = static_cast<int>(ids[y * 4 + x]);
+                if (s.pixels[(3 - y) * 4 + x] != pal.colour(id))
+                    ok = false;
+            }
+        if (ok)
+            PASS();
+        else
+            FAIL("rendered pixels differ from palette");
+    }
+
+    std::filesystem::remove(lutPath);
+
+    std::cerr << "\n" << testsPassed << " passed, " << testsFailed << " failed\n";
+    return testsFailed > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,121 @@
+/// test_mid_slice_load.cpp — Volume::loadMidAxialSlice() (QC thumbnails).
+///
+/// Usage: test_mid_slice_load <a.mnc> <b.mnc> <c.nii.gz>
+///
+/// Tests:
+///   1. The slice equals slice dimensions.z / 2 of a full load, voxel for
+///      voxel, and maps to the same world positions
+///   2. An empty or missing path throws
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "Volume.h"
+
+static int testsPassed = 0;
+static int testsFailed = 0;
+
+#define TEST(name) \
+    std::cerr << "  TEST: " << name << " ... ";
+
+#define PASS() \
+    do { std::cerr << "PASS\n"; ++testsPassed; } while (0)
+
+#define FAIL(msg) \
+    do { std::cerr << "FAIL: " << msg << "\n"; ++testsFailed; } while (0)
+
+/// Empty if @p slice is slice dimensions.z / 2 of @p full, else why not.
+static std::string compareSlice(const Volume& full, const Volume& slice)
+{
+    const int z = full.dimensions.z / 2;
+    if (slice.dimensions.x != full.dimensions.x || slice.dimensions.y != full.dimensions.y ||
+        slice.dimensions.z != 1)
+        return "dimensions differ";
+    if (slice.data.size() != static_cast<size_t>(slice.dimensions.x) * slice.dimensions.y)
+        return "data size " + std::to_string(slice.data.size());
+    for (int y = 0; y < full.dimensions.y; ++y)
+        for (int x = 0; x < full.dimensions.x; ++x)
+            if (slice.get(x, y, 0) != full.get(x, y, z))
+                return "voxel (" + std::to_string(x) + ", " + std::to_string(y) + ") differs";
+
+    // Corners of the slice land where they do in the full volume
+    const int xs[2] = {0, full.dimensions.x - 1};
+    const int ys[2] = {0, full.dimensions.y - 1};
+    for (int x : xs)
+        for (int y : ys)
+        {
+            glm::dvec3 a, b;
+            full.transformVoxelToWorld(glm::ivec3(x, y, z), a);
+            slice.transformVoxelToWorld(glm::ivec3(x, y, 0), b);
+            if (std::abs(a.x - b.x) > 1e-6 || std::abs(a.y - b.y) > 1e-6 ||
+                std::abs(a.z - b.z) > 1e-6)
+                return "world position of (" + std::to_string(x) + ", " + std::to_string(y) +
+                       ") differs";
+        }
+    return "";
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 4)
+    {
+        std::cerr << "Usage: " << argv[0] << " <a.mnc> <b.mnc> <c.nii.gz>\n";
+        return 1;
+    }
+    std::cerr << "=== MidSliceLoadTest ===\n\n";
+
+    // -----------------------------------------------------------------------
+    // 1. Slice matches the full volume
+    // -----------------------------------------------------------------------
+    for (int i = 1; i <= 3; ++i)
+    {
+        const std::string path = argv[i];
+        TEST("mid slice of " + path);
+        try
+        {
+            Volume full;
+            full.load(path);
+            Volume slice;
+            slice.loadMidAxialSlice(path);
+            const std::string why = compareSlice(full, slice);
+            if (why.empty())
+                PASS();
+            else
+                FAIL(why);
+        }
+        catch (const std::exception& e)
+        {
+            FAIL(e.what());
+        }
+    }
+
+    // -----------------------------------------------------------------------
+    // 2. Failures
+    // -----------------------------------------------------------------------
+    {
+        TEST("empty and missing paths throw");
+        int thrown = 0;
+        for (const char* path : {"", "/nonexistent/missing.mnc", "/nonexistent/missing.nii"})
+        {
+            try
+            {
+                Volume vol;
+                vol.loadMidAxialSlice(path);
+            }
+            catch (const std::runtime_error&)
+            {
+                ++thrown;
+            }
+        }
+        if (thrown == 3)
+            PASS();
+        else
+            FAIL(thrown << " of 3 threw");
+    }
+
+    std::cerr << "\n" << testsPassed << " passed, " << testsFailed << " failed\n";
+    return testsFailed > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
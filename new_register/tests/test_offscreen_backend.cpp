@@ -0,0 +1,153 @@
+/// test_offscreen_backend.cpp — OffscreenBackend (OSMesa) frames, textures
+/// and captures, as used by batch mode.
+///
+/// Usage: test_offscreen_backend
+///
+/// Exits with 77 (skipped) when no OSMesa context can be created.
+///
+/// Tests:
+///   1. A frame is rendered without a window and captured opaque, top row first
+///   2. createTexture()/updateTexture() images are drawn by ImGui
+///   3. rebuildSwapchain() resizes the framebuffer and the captures
+
+#include <imgui.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "OffscreenBackend.h"
+
+static int testsPassed = 0;
+static int testsFailed = 0;
+
+#define TEST(name) \
+    std::cerr << "  TEST: " << name << " ... ";
+
+#define PASS() \
+    do { std::cerr << "PASS\n"; ++testsPassed; } while (0)
+
+#define FAIL(msg) \
+    do { std::cerr << "FAIL: " << msg << "\n"; ++testsFailed; } while (0)
+
+/// Render one frame whose foreground draw list holds @p draw's output.
+template <typename Draw>
+static std::vector<uint8_t> renderFrame(OffscreenBackend& backend, int& w, int& h, Draw draw)
+{
+    backend.beginFrame();
+    backend.imguiNewFrame();
+    ImGui::NewFrame();
+    draw(ImGui::GetForegroundDrawList());
+    ImGui::Render();
+    backend.endFrame();
+    return backend.captureScreenshot(w, h);
+}
+
+static const uint8_t* pixelAt(const std::vector<uint8_t>& px, int w, int x, int y)
+{
+    return px.data() + (static_cast<size_t>(y) * w + x) * 4;
+}
+
+static bool near(const uint8_t* p, int r, int g, int b)
+{
+    auto close = [](int a, int e) { return a >= e - 3 && a <= e + 3; };
+    return close(p[0], r) && close(p[1], g) && close(p[2], b) && p[3] == 255;
+}
+
+int main()
+{
+    std::cerr << "=== OffscreenBackendTest ===\n\n";
+
+    OffscreenBackend backend(96, 64);
+    try
+    {
+        backend.initialize(nullptr);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "SKIP: " << e.what() << "\n";
+        return 77;
+    }
+    backend.initImGui(nullptr);
+
+    // Clear colour of OpenGL2Backend::renderDrawData(): 0.1 grey
+    const int clearGrey = 26;
+
+    // -----------------------------------------------------------------------
+    // 1. Frame and capture
+    // -----------------------------------------------------------------------
+    {
+        TEST("frame rendered and captured without a window");
+        int w = 0, h = 0;
+        std::vector<uint8_t> px = renderFrame(backend, w, h, [](ImDrawList* dl) {
+            dl->AddRectFilled(ImVec2(0, 0), ImVec2(10, 5), IM_COL32(255, 0, 0, 128));
+        });
+        bool ok = w == 96 && h == 64 && px.size() == static_cast<size_t>(w) * h * 4;
+        // Half-transparent red over grey, in the top-left corner; opaque
+        ok = ok && pixelAt(px, w, 2, 2)[0] > 120 && pixelAt(px, w, 2, 2)[1] < 30 &&
+             pixelAt(px, w, 2, 2)[3] == 255;
+        ok = ok && near(pixelAt(px, w, 2, 60), clearGrey, clearGrey, clearGrey);
+        ok = ok && near(pixelAt(px, w, 90, 2), clearGrey, clearGrey, clearGrey);
+        if (ok)
+            PASS();
+        else
+            FAIL("size " << w << "x" << h << " or unexpected pixels");
+    }
+
+    // -----------------------------------------------------------------------
+    // 2. Textures
+    // -----------------------------------------------------------------------
+    {
+        TEST("created and updated textures are drawn");
+        std::vector<uint8_t> green(8 * 8 * 4), blue(8 * 8 * 4);
+        for (size_t i = 0; i < green.size(); i += 4)
+        {
+            green[i + 1] = 255; green[i + 3] = 255;
+            blue[i + 2] = 255;  blue[i + 3] = 255;
+        }
+        std::unique_ptr<Texture> tex = backend.createTexture(8, 8, green.data());
+        auto drawTex = [&tex](ImDrawList* dl) {
+            dl->AddImage(tex->id, ImVec2(40, 20), ImVec2(56, 36));
+        };
+        int w = 0, h = 0;
+        std::vector<uint8_t> px = renderFrame(backend, w, h, drawTex);
+        bool ok = near(pixelAt(px, w, 48, 28), 0, 255, 0);
+        backend.updateTexture(tex.get(), blue.data());
+        px = renderFrame(backend, w, h, drawTex);
+        ok = ok && near(pixelAt(px, w, 48, 28), 0, 0, 255);
+        backend.destroyTexture(tex.get());
+        if (ok)
+            PASS();
+        else
+            FAIL("texture pixels not found in the frame");
+    }
+
+    // -----------------------------------------------------------------------
+    // 3. Resize
+    // -----------------------------------------------------------------------
+    {
+        TEST("rebuildSwapchain resizes the framebuffer");
+        backend.rebuildSwapchain(40, 120);
+        int w = 0, h = 0;
+        std::vector<uint8_t> px = renderFrame(backend, w, h, [](ImDrawList* dl) {
+            dl->AddRectFilled(ImVec2(0, 110), ImVec2(40, 120), IM_COL32(255, 255, 255, 255));
+        });
+        bool ok = w == 40 && h == 120 && backend.width() == 40 &&
+                  px.size() == static_cast<size_t>(w) * h * 4;
+        ok = ok && near(pixelAt(px, w, 20, 115), 255, 255, 255);
+        ok = ok && near(pixelAt(px, w, 20, 50), clearGrey, clearGrey, clearGrey);
+        if (ok)
+            PASS();
+        else
+            FAIL("size " << w << "x" << h << " or unexpected pixels");
+    }
+
+    backend.shutdownTextureSystem();
+    backend.shutdownImGui();
+    backend.shutdown();
+
+    std::cerr << "\n" << testsPassed << " passed, " << testsFailed << " failed\n";
+    return testsFailed > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,148 @@
+/// test_prefetch_window.cpp — QC look-ahead window: depth, direction and
+/// cache limits.
+///
+/// No files or threads needed; PrefetchWindow is header-only and takes the
+/// time from the caller.
+///
+/// Tests:
+///   1. Before any measurement the window is kMinAhead ahead, kBehind behind
+///   2. Slow reads relative to the rating pace deepen the window
+///   3. Moving up the list flips the plan; long pauses and jumps are ignored
+///   4. The cache's entry and byte limits cap the depth
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "PrefetchWindow.h"
+
+static int testsPassed = 0;
+static int testsFailed = 0;
+
+#define TEST(name) \
+    std::cerr << "  TEST: " << name << " ... ";
+
+#define PASS() \
+    do { std::cerr << "PASS\n"; ++testsPassed; } while (0)
+
+#define FAIL(msg) \
+    do { std::cerr << "FAIL: " << msg << "\n"; ++testsFailed; } while (0)
+
+using Clock = PrefetchWindow::Clock;
+
+static Clock::time_point at(double seconds)
+{
+    return Clock::time_point(std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(seconds)));
+}
+
+static std::ostream& operator<<(std::ostream& os, const std::vector<int>& v)
+{
+    for (size_t i = 0; i < v.size(); ++i)
+        os << (i ? "," : "") << v[i];
+    return os;
+}
+
+int main()
+{
+    std::cerr << "=== PrefetchWindowTest ===\n\n";
+
+    // -----------------------------------------------------------------------
+    // 1. Defaults
+    // -----------------------------------------------------------------------
+    {
+        TEST("unmeasured window: next rows first, then the previous one");
+        PrefetchWindow w;
+        w.rowChanged(5, at(0));
+        std::vector<int> plan = w.plan(5, 100);
+        std::vector<int> expected = {6, 4, 7};
+        bool ok = w.ahead() == PrefetchWindow::kMinAhead && w.behind() == 1 &&
+                  plan == expected;
+        // Clipped at the ends of the list
+        ok = ok && w.plan(0, 100) == std::vector<int>({1, 2});
+        ok = ok && w.plan(99, 100) == std::vector<int>({98});
+        if (ok)
+            PASS();
+        else
+            FAIL("ahead " << w.ahead() << ", plan " << plan);
+    }
+
+    // -----------------------------------------------------------------------
+    // 2. Adaptive depth
+    // -----------------------------------------------------------------------
+    {
+        TEST("rows read slower than rated deepen the window");
+        PrefetchWindow w;
+        w.setCacheLimits(size_t(1) << 40, 1000, 2);
+        // 2 s per row, 3 s to read a volume: 6 s per row of two columns
+        for (int row = 0; row <= 4; ++row)
+            w.rowChanged(row, at(2.0 * row));
+        w.volumeLoaded(3.0, 1000);
+        bool ok = w.secondsPerRow() > 1.99 && w.secondsPerRow() < 2.01 &&
+                  w.rowLoadSeconds() > 5.99 && w.rowLoadSeconds() < 6.01;
+        int slow = w.ahead();
+        ok = ok && slow == 4;   // ceil(6 / 2) + 1
+        // Fast reads fall back to the minimum
+        for (int i = 0; i < 30; ++i)
+            w.volumeLoaded(0.01, 1000);
+        ok = ok && w.ahead() == PrefetchWindow::kMinAhead;
+        if (ok)
+            PASS();
+        else
+            FAIL("s/row " << w.secondsPerRow() << ", row load " << w.rowLoadSeconds()
+                 << ", ahead " << slow << " then " << w.ahead());
+    }
+
+    // -----------------------------------------------------------------------
+    // 3. Direction and pace filtering
+    // -----------------------------------------------------------------------
+    {
+        TEST("moving up reverses the window; pauses and jumps do not set the pace");
+        PrefetchWindow w;
+        w.rowChanged(50, at(0));
+        w.rowChanged(49, at(1));
+        std::vector<int> plan = w.plan(49, 100);
+        bool ok = w.direction() == -1 && plan == std::vector<int>({48, 50, 47});
+        // A coffee break and a jump from the list leave the pace alone
+        w.rowChanged(48, at(1 + 120));
+        w.rowChanged(10, at(1 + 121));
+        ok = ok && w.secondsPerRow() > 0.99 && w.secondsPerRow() < 1.01;
+        ok = ok && w.direction() == -1;
+        w.rowChanged(11, at(1 + 122));
+        ok = ok && w.direction() == 1;
+        if (ok)
+            PASS();
+        else
+            FAIL("direction " << w.direction() << ", plan " << plan
+                 << ", s/row " << w.secondsPerRow());
+    }
+
+    // -----------------------------------------------------------------------
+    // 4. Cache limits
+    // -----------------------------------------------------------------------
+    {
+        TEST("cache entries and bytes cap the window");
+        PrefetchWindow w;
+        w.rowChanged(0, at(0));
+        w.rowChanged(1, at(0.5));
+        w.volumeLoaded(30.0, 100);   // needs far more than kMaxAhead
+        bool ok = w.ahead() == PrefetchWindow::kMaxAhead;
+        // 12 entries of 3 columns: 4 rows = current + behind + 2 ahead
+        w.setCacheLimits(size_t(1) << 40, 12, 3);
+        ok = ok && w.cachedRows() == 4 && w.ahead() == 2;
+        // 1000 bytes of 300-byte rows: 3 rows, one ahead
+        w.setCacheLimits(1000, 1000, 3);
+        ok = ok && w.cachedRows() == 3 && w.ahead() == 1;
+        // Even a cache too small for two rows prefetches the next one
+        w.setCacheLimits(100, 1000, 3);
+        ok = ok && w.ahead() == 1 && w.plan(5, 10) == std::vector<int>({6, 4});
+        if (ok)
+            PASS();
+        else
+            FAIL("cached rows " << w.cachedRows() << ", ahead " << w.ahead());
+    }
+
+    std::cerr << "\n" << testsPassed << " passed, " << testsFailed << " failed\n";
+    return testsFailed > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
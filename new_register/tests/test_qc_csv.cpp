@@ -1,11 +1,14 @@
 #include "QCState.h"
 
 #include <cassert>
+#include <chrono>
+#include <cmath>
 #include <cstdio>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <string>
+#include <vector>
 
 static int testsPassed = 0;
 static int testsFailed = 0;
@@ -65,8 +68,8 @@ TEST(parse_input_csv)
     ASSERT_EQ(qc.columnNames[1], "T2");
     ASSERT_EQ(qc.rowIds[0], "sub01");
     ASSERT_EQ(qc.rowIds[2], "sub03");
-    ASSERT_EQ(qc.rowPaths[1][0], "/data/sub02_t1.mnc");
-    ASSERT_EQ(qc.rowPaths[1][1], "/data/sub02_t2.mnc");
+    ASSERT_EQ(qc.pathsForRow(1)[0], "/data/sub02_t1.mnc");
+    ASSERT_EQ(qc.pathsForRow(1)[1], "/data/sub02_t2.mnc");
 
     // All results should be UNRATED
     for (const auto& r : qc.results)
@@ -91,9 +94,9 @@ TEST(quoted_fields)
 
     ASSERT_EQ(qc.rowCount(), 2);
     ASSERT_EQ(qc.rowIds[0], "sub,01");
-    ASSERT_EQ(qc.rowPaths[0][0], "/path/with \"quotes\"");
+    ASSERT_EQ(qc.pathsForRow(0)[0], "/path/with \"quotes\"");
     ASSERT_EQ(qc.rowIds[1], "sub02");
-    ASSERT_EQ(qc.rowPaths[1][0], "/normal/path.mnc");
+    ASSERT_EQ(qc.pathsForRow(1)[0], "/normal/path.mnc");
 }
 
 // ---- Test 3: Write + read round-trip ----
@@ -201,19 +204,318 @@ TEST(rated_count_and_first_unrated)
     ASSERT_EQ(qc.firstUnratedRow(), 0);
 
     // Rate sub01 partially (one column)
-    qc.results[0].verdicts[0] = VERDICT_PASS;
+    qc.setVerdict(0, 0, VERDICT_PASS);
     ASSERT_EQ(qc.ratedCount(), 1);
     ASSERT_EQ(qc.firstUnratedRow(), 1); // sub02 is first fully unrated
 
     // Rate sub02
-    qc.results[1].verdicts[1] = VERDICT_FAIL;
+    qc.setVerdict(1, 1, VERDICT_FAIL);
     ASSERT_EQ(qc.ratedCount(), 2);
     ASSERT_EQ(qc.firstUnratedRow(), 2); // sub03
 
     // Rate sub03
-    qc.results[2].verdicts[0] = VERDICT_PASS;
+    qc.setVerdict(2, 0, VERDICT_PASS);
     ASSERT_EQ(qc.ratedCount(), 3);
     ASSERT_EQ(qc.firstUnratedRow(), -1); // all rated
+
+    // Per-verdict counters follow every change
+    ASSERT_EQ(qc.verdictCount(VERDICT_PASS), 2);
+    ASSERT_EQ(qc.verdictCount(VERDICT_FAIL), 1);
+    qc.setVerdict(2, 0, VERDICT_WARN);
+    ASSERT_EQ(qc.verdictCount(VERDICT_PASS), 1);
+    ASSERT_EQ(qc.verdictCount(VERDICT_WARN), 1);
+
+    // Clearing a row makes it unrated again
+    qc.setVerdict(1, 1, VERDICT_UNRATED);
+    ASSERT_EQ(qc.ratedCount(), 2);
+    ASSERT_EQ(qc.firstUnratedRow(), 1);
+    ASSERT_EQ(qc.verdictCount(VERDICT_FAIL), 0);
+
+    // A second verdict in a rated row does not count the row twice
+    qc.setVerdict(0, 1, VERDICT_FAIL);
+    ASSERT_EQ(qc.ratedCount(), 2);
+}
+
+// ---- Test 7: Journal replay after an unclean exit ----
+TEST(journal_replay)
+{
+    TmpFile fin("qc_journal_input.csv",
+        "ID,T1,T2\n"
+        "sub01,a.mnc,b.mnc\n"
+        "sub02,c.mnc,d.mnc\n"
+        "sub03,e.mnc,f.mnc\n");
+
+    std::string outPath = (std::filesystem::temp_directory_path() / "qc_journal_output.csv").string();
+
+    QCState qc1;
+    qc1.loadInputCsv(fin.path);
+    qc1.outputCsvPath = outPath;
+    qc1.results[0].verdicts[0] = VERDICT_PASS;
+    qc1.saveOutputCsv();
+
+    // Changes go to the journal; the CSV is left alone
+    qc1.results[1].verdicts[1] = VERDICT_FAIL;
+    qc1.results[1].comments[1] = "motion, severe";
+    qc1.recordRow(1);
+    qc1.results[0].verdicts[0] = VERDICT_WARN;
+    qc1.recordRow(0);
+    qc1.results[1].verdicts[1] = VERDICT_WARN;
+    qc1.recordRow(1);
+    ASSERT_EQ(qc1.journalEntries(), 3);
+    ASSERT_TRUE(std::filesystem::exists(qc1.journalPath()));
+
+    // Torn last entry, as left by a crash mid-append
+    {
+        std::ofstream ofs(qc1.journalPath(), std::ios::app);
+        ofs << "sub03,PA";
+    }
+
+    // No exit-time save: the next session replays the journal
+    QCState qc2;
+    qc2.loadInputCsv(fin.path);
+    qc2.outputCsvPath = outPath;
+    qc2.loadOutputCsv(outPath);
+    ASSERT_EQ(qc2.results[0].verdicts[0], VERDICT_WARN);
+    ASSERT_EQ(qc2.results[1].verdicts[1], VERDICT_WARN);
+    ASSERT_EQ(qc2.results[1].comments[1], "motion, severe");
+    ASSERT_EQ(qc2.results[2].verdicts[0], VERDICT_UNRATED);
+
+    // The first change of the new session folds the old journal in
+    qc2.results[2].verdicts[0] = VERDICT_FAIL;
+    qc2.recordRow(2);
+    ASSERT_EQ(qc2.journalEntries(), 1);
+
+    // Compaction writes the CSV and removes the journal
+    qc2.saveOutputCsv();
+    ASSERT_TRUE(!std::filesystem::exists(qc2.journalPath()));
+    ASSERT_EQ(qc2.journalEntries(), 0);
+
+    QCState qc3;
+    qc3.loadInputCsv(fin.path);
+    qc3.loadOutputCsv(outPath);
+    ASSERT_EQ(qc3.results[0].verdicts[0], VERDICT_WARN);
+    ASSERT_EQ(qc3.results[1].verdicts[1], VERDICT_WARN);
+    ASSERT_EQ(qc3.results[2].verdicts[0], VERDICT_FAIL);
+
+    std::filesystem::remove(outPath);
+}
+
+// ---- Test 8: Journal compaction threshold ----
+TEST(journal_compaction)
+{
+    TmpFile fin("qc_compact_input.csv",
+        "ID,Vol\n"
+        "sub01,a.mnc\n"
+        "sub02,b.mnc\n");
+
+    std::string outPath = (std::filesystem::temp_directory_path() / "qc_compact_output.csv").string();
+    std::filesystem::remove(outPath);
+
+    QCState qc;
+    qc.singleVerdictMode = true;
+    qc.loadInputCsv(fin.path);
+    qc.outputCsvPath = outPath;
+    for (int i = 0; i < QCState::kJournalCompactEntries - 1; ++i)
+    {
+        qc.results[i % 2].verdicts[0] = i % 3;
+        qc.recordRow(i % 2);
+    }
+    ASSERT_TRUE(!std::filesystem::exists(outPath));
+    ASSERT_EQ(qc.journalEntries(), QCState::kJournalCompactEntries - 1);
+
+    qc.results[0].comments[0] = "last";
+    qc.recordRow(0);
+    ASSERT_EQ(qc.journalEntries(), 0);
+    ASSERT_TRUE(std::filesystem::exists(outPath));
+    ASSERT_TRUE(!std::filesystem::exists(qc.journalPath()));
+
+    QCState qc2;
+    qc2.singleVerdictMode = true;
+    qc2.loadInputCsv(fin.path);
+    qc2.loadOutputCsv(outPath);
+    ASSERT_EQ(qc2.results[0].verdicts[0], qc.results[0].verdicts[0]);
+    ASSERT_EQ(qc2.results[0].comments[0], "last");
+    ASSERT_EQ(qc2.results[1].verdicts[0], qc.results[1].verdicts[0]);
+
+    std::filesystem::remove(outPath);
+}
+
+// ---- Test 9: Multi-line quoted fields, CRLF and blank lines ----
+TEST(multiline_crlf_blank_lines)
+{
+    TmpFile fin("qc_multiline_input.csv",
+        "ID,T1,T2\r\n"
+        "\r\n"
+        "sub01,\"/data/two\nlines.mnc\",/data/b.mnc\r\n"
+        "\n"
+        "sub02,/data/c.mnc\r\n"
+        "\"sub \"\"03\"\"\",,/data/f.mnc");
+
+    QCState qc;
+    qc.loadInputCsv(fin.path);
+
+    ASSERT_EQ(qc.rowCount(), 3);
+    ASSERT_EQ(qc.rowIds[0], "sub01");
+    ASSERT_EQ(qc.rowIds[2], "sub \"03\"");
+    ASSERT_EQ(qc.pathsForRow(0)[0], "/data/two\nlines.mnc");
+    ASSERT_EQ(qc.pathsForRow(0)[1], "/data/b.mnc");
+    ASSERT_EQ(qc.pathsForRow(1)[0], "/data/c.mnc");
+    ASSERT_EQ(qc.pathsForRow(1)[1], "");   // missing field
+    ASSERT_EQ(qc.pathsForRow(2)[0], "");
+    ASSERT_EQ(qc.pathsForRow(2)[1], "/data/f.mnc");
+}
+
+// ---- Test 10: Large input, rows parsed on demand ----
+TEST(large_input_lazy_rows)
+{
+    const int rows = 200000;
+    std::string content = "ID,T1,mask\n";
+    content.reserve(static_cast<size_t>(rows) * 96);
+    for (int i = 0; i < rows; ++i)
+    {
+        std::string id = "sub" + std::to_string(i);
+        content += id + ",/study/derivatives/preproc/" + id + "/t1.mnc,"
+                   "/study/derivatives/preproc/" + id + "/mask.mnc\n";
+    }
+    TmpFile fin("qc_large_input.csv", content);
+
+    QCState qc;
+    qc.loadInputCsv(fin.path);
+    ASSERT_EQ(qc.rowCount(), rows);
+    ASSERT_EQ(qc.rowIds[rows - 1], "sub" + std::to_string(rows - 1));
+    ASSERT_EQ(qc.pathsForRow(123456)[1], "/study/derivatives/preproc/sub123456/mask.mnc");
+
+    // Verdicts of the last rows survive a save/load round trip
+    std::string outPath = (std::filesystem::temp_directory_path() / "qc_large_output.csv").string();
+    qc.outputCsvPath = outPath;
+    qc.results[rows - 1].verdicts[1] = VERDICT_FAIL;
+    qc.saveOutputCsv();
+
+    QCState qc2;
+    qc2.loadInputCsv(fin.path);
+    qc2.loadOutputCsv(outPath);
+    ASSERT_EQ(qc2.results[rows - 1].verdicts[1], VERDICT_FAIL);
+    ASSERT_EQ(qc2.ratedCount(), 1);
+
+    std::filesystem::remove(outPath);
+}
+
+// ---- Test 11: Row visit timing and the timing sidecar ----
+TEST(row_visit_timing)
+{
+    TmpFile fin("qc_timing_input.csv",
+        "ID,T1,T2\n"
+        "sub01,/data/a.mnc,/data/b.mnc\n"
+        "sub02,/data/c.mnc,/data/d.mnc\n"
+        "sub03,/data/e.mnc,/data/f.mnc\n");
+    std::string outPath = (std::filesystem::temp_directory_path() / "qc_timing_output.csv").string();
+
+    QCState qc;
+    qc.loadInputCsv(fin.path);
+    qc.outputCsvPath = outPath;
+    // Left by a version without the rater column: moved aside
+    std::ofstream(qc.timingPath()) << "session,row,ID\n1,0,sub01\n";
+
+    using ms = std::chrono::milliseconds;
+    const QCState::Clock::time_point t0 = QCState::Clock::now();
+
+    // Row 0: read 100 ms, shown at 150 ms
+    QCRowVisit v;
+    v.row = 0;
+    v.read = 0.1;
+    v.cacheMisses = 2;
+    v.missLoad = 0.1;
+    qc.currentRowIndex = 0;
+    qc.beginRowVisit(v, t0);
+    qc.frameShown(t0 + ms(150));
+    qc.frameShown(t0 + ms(400));   // later frames do not count
+    ASSERT_TRUE(qc.rowVisitOpen());
+    ASSERT_EQ(qc.timingSummary().visits, 0);
+    qc.setVerdict(0, 0, VERDICT_PASS);
+    qc.setVerdict(0, 1, VERDICT_FAIL);
+    ASSERT_EQ(qc.rowVisits()[0].verdictChanges, 2);
+    ASSERT_TRUE(qc.rowVisits()[0].verdict >= 0.0);
+
+    // Row 1 at 1 s, served from the cache; row 2 by a jump, never shown
+    v = QCRowVisit();
+    v.row = 1;
+    v.fromRow = 0;
+    v.load = 0.02;
+    v.cacheHits = 2;
+    v.hitLoad = 0.02;
+    qc.currentRowIndex = 1;
+    qc.beginRowVisit(v, t0 + ms(1000));
+    qc.frameShown(t0 + ms(1030));
+    v = QCRowVisit();
+    v.row = 0;
+    v.fromRow = 1;
+    qc.currentRowIndex = 0;
+    qc.beginRowVisit(v, t0 + ms(3000));
+    qc.endRowVisit(t0 + ms(3500));
+    qc.endRowVisit(t0 + ms(9000));   // already ended
+    ASSERT_TRUE(!qc.rowVisitOpen());
+
+    const auto& visits = qc.rowVisits();
+    ASSERT_EQ(visits.size(), size_t(3));
+    ASSERT_TRUE(std::abs(visits[0].firstImage - 0.15) < 1e-6);
+    ASSERT_TRUE(std::abs(visits[0].dwell - 1.0) < 1e-6);
+    ASSERT_TRUE(std::abs(visits[1].start - 1.0) < 1e-6);
+    ASSERT_TRUE(visits[1].verdict < 0.0);
+    ASSERT_TRUE(visits[2].firstImage < 0.0);
+
+    const QCTimingSummary& s = qc.timingSummary();
+    ASSERT_EQ(s.visits, 3);
+    ASSERT_EQ(s.cacheHits, 2);
+    ASSERT_EQ(s.cacheMisses, 2);
+    ASSERT_TRUE(std::abs(s.firstImageP50 - 0.03) < 1e-6);
+    ASSERT_TRUE(std::abs(s.firstImageP95 - 0.15) < 1e-6);
+    ASSERT_TRUE(std::abs(s.switchP95 - 0.1) < 1e-6);
+    ASSERT_TRUE(std::abs(s.rowsPerHour - 3 * 3600.0 / 3.5) < 1e-3);
+
+    // One line per visit under a header; the verdict cells of unshown,
+    // unrated rows are empty
+    std::ifstream in(qc.timingPath());
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(in, line);)
+        lines.push_back(line);
+    ASSERT_EQ(lines.size(), size_t(4));
+    ASSERT_EQ(lines[0].rfind("session,rater,row,ID,nav,from_row,", 0), size_t(0));
+    ASSERT_TRUE(lines[1].find(",0,sub01,first,-1,0.000,100.0,") != std::string::npos);
+    ASSERT_TRUE(lines[2].find(",1,sub02,next,0,") != std::string::npos);
+    ASSERT_TRUE(lines[3].find(",0,sub01,prev,1,") != std::string::npos);
+    ASSERT_TRUE(lines[3].find(",0.0,,0,0,0.0,0.0,,500.0,0") != std::string::npos);
+
+    // A later session appends without a second header
+    QCState qc2;
+    qc2.loadInputCsv(fin.path);
+    qc2.outputCsvPath = outPath;
+    v = QCRowVisit();
+    v.row = 2;
+    qc2.beginRowVisit(v, t0);
+    qc2.endRowVisit(t0 + ms(10));
+    in = std::ifstream(qc.timingPath());
+    int lineCount = 0;
+    for (std::string line; std::getline(in, line);)
+        ++lineCount;
+    ASSERT_EQ(lineCount, 5);
+    ASSERT_TRUE(std::filesystem::exists(qc.timingPath() + ".old"));
+
+    std::filesystem::remove(qc.timingPath());
+    std::filesystem::remove(qc.timingPath() + ".old");
+}
+
+// ---- Test 12: Nearest-rank percentiles ----
+TEST(timing_percentiles)
+{
+    ASSERT_EQ(QCState::percentile({}, 0.5), 0.0);
+    ASSERT_EQ(QCState::percentile({7.0}, 0.95), 7.0);
+    std::vector<double> values;
+    for (int i = 100; i >= 1; --i)
+        values.push_back(i);
+    ASSERT_EQ(QCState::percentile(values, 0.50), 50.0);
+    ASSERT_EQ(QCState::percentile(values, 0.95), 95.0);
+    ASSERT_EQ(QCState::percentile(values, 1.0), 100.0);
+    ASSERT_EQ(QCState::percentile(values, 0.0), 1.0);
 }
 
 int main()
@@ -0,0 +1,320 @@
+/// test_qc_work_queue.cpp — shared QC work queue: leases, take-over of
+/// expired leases, and per-rater journals merged into the output CSV.
+///
+/// Two QCWorkQueue / QCState instances in one process stand in for two
+/// raters on different machines sharing a directory.
+///
+/// Tests:
+///   1. Raters claim different blocks; a queue for another study is refused
+///   2. stepRow() walks the held rows, then claims the next open block
+///   3. Expired leases are taken over, done blocks never; renew() notices
+///   4. Journals merge into the output CSV and survive saves; blocks are
+///      finished or released at the end of a session
+///      (row-visit timing goes to a file per rater)
+///   5. A lease renewed while being taken over is put back, or kept beside
+///      a lease made meanwhile; finishing leaves a taken-over lease alone
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "QCState.h"
+#include "QCWorkQueue.h"
+
+namespace fs = std::filesystem;
+
+static int testsPassed = 0;
+static int testsFailed = 0;
+
+#define TEST(name) \
+    std::cerr << "  TEST: " << name << " ... ";
+
+#define PASS() \
+    do { std::cerr << "PASS\n"; ++testsPassed; } while (0)
+
+#define FAIL(msg) \
+    do { std::cerr << "FAIL: " << msg << "\n"; ++testsFailed; } while (0)
+
+static std::string readFile(const fs::path& path)
+{
+    std::ifstream in(path);
+    std::string line;
+    std::getline(in, line);
+    return line;
+}
+
+/// A QC session of rater @p rater over @p input, sharing queue @p dir.
+static QCState openSession(const std::string& input, const std::string& output,
+                           const std::string& dir, const std::string& rater)
+{
+    QCState qc;
+    qc.active = true;
+    qc.inputCsvPath = input;
+    qc.outputCsvPath = output;
+    qc.loadInputCsv(input);
+    qc.workQueue = std::make_shared<QCWorkQueue>(dir, rater, qc.rowCount(), 4);
+    qc.loadOutputCsv(output);
+    return qc;
+}
+
+int main()
+{
+    std::cerr << "=== QCWorkQueueTest ===\n\n";
+
+    fs::path root = fs::temp_directory_path() / ("nr_qc_queue_" + std::to_string(::getpid()));
+    fs::remove_all(root);
+    fs::create_directories(root);
+    const std::string input = (root / "study.csv").string();
+    {
+        std::ofstream out(input);
+        out << "ID,T1\n";
+        for (int i = 0; i < 10; ++i)
+            out << "sub" << i << ",/data/sub" << i << ".mnc\n";
+    }
+
+    // -----------------------------------------------------------------------
+    // 1. Claims
+    // -----------------------------------------------------------------------
+    {
+        TEST("raters claim different blocks");
+        const std::string dir = (root / "q1").string();
+        auto open = [](int) { return true; };
+        QCWorkQueue a(dir, "alice", 10, 4);
+        QCWorkQueue b(dir, "bob", 10, 8);   // block size set by alice
+        int ba = a.claim(open);
+        int bb = b.claim(open);
+        int bc = b.claim(open);
+        int none = a.claim(open);
+        bool ok = b.blockRows() == 4 && b.blockCount() == 3 &&
+                  ba == 0 && bb == 1 && bc == 2 && none == -1 &&
+                  a.owns(3) && !a.owns(4) && b.owns(4) && b.owns(9) && !b.owns(10) &&
+                  readFile(fs::path(dir) / "leases" / "4.lease") == "claimed bob";
+
+        // Rater names become file names
+        QCWorkQueue odd(dir, "eve/../x y", 10);
+        ok = ok && odd.journalPath() == (fs::path(dir) / "journals" / "eve_.._x_y.csv").string();
+
+        bool refused = false;
+        try
+        {
+            QCWorkQueue other(dir, "carol", 11);
+        }
+        catch (const std::runtime_error&)
+        {
+            refused = true;
+        }
+        if (ok && refused)
+            PASS();
+        else
+            FAIL("blocks " << ba << "," << bb << "," << bc << "," << none
+                 << (refused ? "" : ", other study accepted"));
+    }
+
+    // -----------------------------------------------------------------------
+    // 2. Navigation
+    // -----------------------------------------------------------------------
+    {
+        TEST("stepRow walks held rows and claims the next open block");
+        const std::string dir = (root / "q2").string();
+        const std::string output = (root / "q2_out.csv").string();
+        QCState alice = openSession(input, output, dir, "alice");
+        QCState bob = openSession(input, output, dir, "bob");
+
+        int a0 = alice.stepRow(-1, 1);   // claims rows 0-3
+        int b0 = bob.stepRow(-1, 1);     // claims rows 4-7
+        bool ok = a0 == 0 && b0 == 4 && alice.rowAvailable(3) && !alice.rowAvailable(4) &&
+                  alice.stepRow(2, 1) == 3 && alice.stepRow(0, -1) == -1 &&
+                  bob.stepRow(4, -1) == -1;
+
+        // Bob rates a row of his block; alice rates all of hers and moves
+        // on, seeing bob's verdict
+        bob.setVerdict(4, 0, 0);
+        bob.recordRow(4);
+        for (int r = 0; r < 4; ++r)
+        {
+            alice.setVerdict(r, 0, 1);
+            alice.recordRow(r);
+        }
+        int a1 = alice.stepRow(3, 1);   // claims rows 8-9
+        ok = ok && a1 == 8 && alice.rowAvailable(8) && !alice.rowAvailable(0) &&
+             alice.results[4].verdicts[0] == 0 &&   // bob's verdict merged
+             readFile(fs::path(dir) / "leases" / "0.done") == "done alice" &&
+             !fs::exists(fs::path(dir) / "leases" / "0.lease");
+        if (ok)
+            PASS();
+        else
+            FAIL("rows " << a0 << ", " << b0 << ", " << a1);
+    }
+
+    // -----------------------------------------------------------------------
+    // 3. Expiry
+    // -----------------------------------------------------------------------
+    {
+        TEST("expired leases are taken over; done blocks are not");
+        const std::string dir = (root / "q3").string();
+        auto open = [](int) { return true; };
+        QCWorkQueue a(dir, "alice", 10, 4, 60);
+        QCWorkQueue b(dir, "bob", 10, 4, 60);
+        a.claim(open);   // block 0
+        a.claim(open);   // block 1
+        a.finish(1);
+        // Alice walked away an hour ago
+        fs::last_write_time(fs::path(dir) / "leases" / "0.lease",
+                            fs::file_time_type::clock::now() - std::chrono::hours(1));
+        int first = b.claim(open);    // alice's expired block 0
+        int second = b.claim(open);   // not the done block 1
+        a.renew(true);
+        bool ok = first == 0 && second == 2 && a.heldBlocks().empty() &&
+                  readFile(fs::path(dir) / "leases" / "0.lease") == "claimed bob" &&
+                  readFile(fs::path(dir) / "leases" / "4.done") == "done alice";
+        // Bob's fresh lease is not expired for carol
+        QCWorkQueue c(dir, "carol", 10, 4, 60);
+        ok = ok && c.claim(open) == -1;
+        // A released block is open again
+        b.release(2);
+        ok = ok && !fs::exists(fs::path(dir) / "leases" / "8.lease") && c.claim(open) == 2;
+        if (ok)
+            PASS();
+        else
+            FAIL("claimed " << first << ", " << second << ", alice holds "
+                 << a.heldBlocks().size());
+    }
+
+    // -----------------------------------------------------------------------
+    // 4. Journals and output
+    // -----------------------------------------------------------------------
+    {
+        TEST("journals merge into the output CSV");
+        const std::string dir = (root / "q4").string();
+        const std::string output = (root / "q4_out.csv").string();
+        bool ok = false;
+        {
+            QCState alice = openSession(input, output, dir, "alice");
+            QCState bob = openSession(input, output, dir, "bob");
+            alice.stepRow(-1, 1);   // rows 0-3
+            bob.stepRow(-1, 1);     // rows 4-7
+            for (int r = 0; r < 4; ++r)
+            {
+                alice.setVerdict(r, 0, 2);
+                alice.recordRow(r);
+            }
+            bob.setVerdict(5, 0, 0);
+            bob.recordRow(5);
+
+            // Either rater's save has both raters' verdicts
+            bob.saveOutputCsv();
+            ok = fs::exists(alice.journalPath()) && fs::exists(bob.journalPath()) &&
+                 bob.ratedCount() == 5;
+
+            // Row-visit timing goes to a file per rater, naming the rater
+            QCRowVisit visit;
+            visit.row = 4;
+            bob.beginRowVisit(visit, QCState::Clock::now());
+            bob.endRowVisit(QCState::Clock::now());
+            std::ifstream timing(bob.timingPath());
+            std::string header, line;
+            std::getline(timing, header);
+            std::getline(timing, line);
+            ok = ok && bob.timingPath() == (fs::path(dir) / "timing" / "bob.csv").string() &&
+                 line.find(",bob,4,sub4,") != std::string::npos &&
+                 !fs::exists(alice.timingPath());
+            alice.closeWorkQueue();   // rated: done
+            bob.closeWorkQueue();     // partly rated: released
+            ok = ok && readFile(fs::path(dir) / "leases" / "0.done") == "done alice" &&
+                 !fs::exists(fs::path(dir) / "leases" / "4.lease");
+        }
+
+        // A later session sees every verdict, and continues with bob's block
+        QCState carol = openSession(input, output, dir, "carol");
+        QCState plain;
+        plain.loadInputCsv(input);
+        plain.loadOutputCsv(output);
+        int next = carol.stepRow(-1, 1);
+        ok = ok && plain.ratedCount() == 5 && plain.results[5].verdicts[0] == 0 &&
+             carol.ratedCount() == 5 && next == 4;
+        if (ok)
+            PASS();
+        else
+            FAIL("rated " << plain.ratedCount() << "/" << carol.ratedCount()
+                 << ", next row " << next);
+    }
+
+    // -----------------------------------------------------------------------
+    // 5. Races
+    // -----------------------------------------------------------------------
+    {
+        TEST("renewals during a take-over and finishing a taken-over block");
+        const std::string dir = (root / "q5").string();
+        const fs::path leases = fs::path(dir) / "leases";
+        auto open = [](int) { return true; };
+        auto expire = [&](const char* name) {
+            fs::last_write_time(leases / name,
+                                fs::file_time_type::clock::now() - std::chrono::hours(1));
+        };
+        // Alice's renewal of block 0 lands just before bob's rename: the
+        // renamed file has a fresh mtime
+        auto renewStale = [&]() {
+            for (const auto& entry : fs::directory_iterator(leases))
+                if (entry.path().filename().string().rfind("0.lease.stale.", 0) == 0)
+                    fs::last_write_time(entry.path(), fs::file_time_type::clock::now());
+        };
+        QCWorkQueue a(dir, "alice", 10, 4, 60);
+        QCWorkQueue b(dir, "bob", 10, 4, 60);
+        QCWorkQueue c(dir, "carol", 10, 4, 60);
+        a.claim(open);   // block 0
+
+        // Renewed: bob puts the lease back and claims the next block
+        expire("0.lease");
+        b.setTakeOverHook(renewStale);
+        int first = b.claim(open);
+        a.renew(true);
+        bool ok = first == 1 && readFile(leases / "0.lease") == "claimed alice" &&
+                  a.heldBlocks() == std::vector<int>{0};
+
+        // Renewed, and carol claims the block while it is renamed away: her
+        // lease stands, alice's is kept beside it and alice drops the block
+        expire("0.lease");
+        b.setTakeOverHook([&]() {
+            renewStale();
+            c.claim(open);
+        });
+        int second = b.claim([](int row) { return row < 4; });
+        a.renew(true);
+        int kept = 0;
+        for (const auto& entry : fs::directory_iterator(leases))
+            if (entry.path().filename().string().rfind("0.lease.stale.", 0) == 0 &&
+                readFile(entry.path()) == "claimed alice")
+                ++kept;
+        ok = ok && second == -1 && c.heldBlocks() == std::vector<int>{0} && kept == 1 &&
+             readFile(leases / "0.lease") == "claimed carol" && a.heldBlocks().empty();
+
+        // Bob finishes block 1 after carol took it over: her lease is left
+        // alone, the block is done and she drops it
+        b.setTakeOverHook(nullptr);
+        expire("4.lease");
+        int third = c.claim(open);
+        b.finish(1);
+        c.renew(true);
+        ok = ok && third == 1 && readFile(leases / "4.done") == "done bob" &&
+             readFile(leases / "4.lease") == "claimed carol" &&
+             c.heldBlocks() == std::vector<int>{0} && a.claim(open) == 2;
+        if (ok)
+            PASS();
+        else
+            FAIL("claimed " << first << ", " << second << ", " << third << ", kept " << kept);
+    }
+
+    std::error_code ec;
+    fs::remove_all(root, ec);
+
+    std::cerr << "\n" << testsPassed << " passed, " << testsFailed << " failed\n";
+    return testsFailed > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
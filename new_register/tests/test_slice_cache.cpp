@@ -0,0 +1,295 @@
+/// test_slice_cache.cpp — rendered-slice LRU cache and background prefetch.
+///
+/// No external files needed — volumes are synthesised in memory.
+///
+/// Tests:
+///   1. find/insert round trip, misses counted
+///   2. LRU eviction keeps the memory budget and the most recently used
+///   3. sliceParamsHash tracks colour params and content version only
+///   4. Prefetch jobs render in the background and match renderSlice
+///   5. Prefetch skips cached keys and replaces pending jobs per stream
+///   6. clear() waits for the worker and discards in-flight results
+///   7. A job that throws is dropped; the worker keeps running
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include "SliceCache.h"
+#include "SliceRenderer.h"
+#include "Volume.h"
+
+static int testsPassed = 0;
+static int testsFailed = 0;
+
+#define TEST(name) \
+    std::cerr << "  TEST: " << name << " ... ";
+
+#define PASS() \
+    do { std::cerr << "PASS\n"; ++testsPassed; } while (0)
+
+#define FAIL(msg) \
+    do { std::cerr << "FAIL: " << msg << "\n"; ++testsFailed; } while (0)
+
+// Solid w x h slice (w*h*4 bytes)
+static RenderedSlice makeSlice(int w, int h, uint32_t colour)
+{
+    RenderedSlice s;
+    s.width = w;
+    s.height = h;
+    s.pixels.assign(static_cast<size_t>(w) * h, colour);
+    return s;
+}
+
+static SliceKey key(int volume, int view, int slice)
+{
+    return SliceKey{volume, view, slice, 42};
+}
+
+int main()
+{
+    std::cerr << "=== SliceCacheTest ===\n\n";
+
+    // -----------------------------------------------------------------------
+    // 1. Round trip
+    // -----------------------------------------------------------------------
+    {
+        TEST("insert then find returns the same slice");
+        SliceCache cache;
+        SliceCache::SlicePtr missing = cache.find(key(0, 0, 5));
+        SliceCache::SlicePtr stored = cache.insert(key(0, 0, 5), makeSlice(4, 4, 0xFF00FF00));
+        SliceCache::SlicePtr found = cache.find(key(0, 0, 5));
+        SliceCache::SlicePtr other = cache.find(key(0, 1, 5));
+
+        SliceCache::Stats st = cache.stats();
+        if (!missing && found == stored && !other && found->pixels[0] == 0xFF00FF00 &&
+            st.hits == 1 && st.misses == 2 && st.entries == 1 && st.bytes == 64)
+            PASS();
+        else
+            FAIL("unexpected lookup results or stats");
+    }
+
+    // -----------------------------------------------------------------------
+    // 2. LRU eviction
+    // -----------------------------------------------------------------------
+    {
+        TEST("budget of 3 slices evicts the least recently used");
+        SliceCache cache(3 * 64);
+        cache.insert(key(0, 0, 0), makeSlice(4, 4, 1));
+        cache.insert(key(0, 0, 1), makeSlice(4, 4, 2));
+        cache.insert(key(0, 0, 2), makeSlice(4, 4, 3));
+        cache.find(key(0, 0, 0));                        // touch slice 0
+        SliceCache::SlicePtr held = cache.find(key(0, 0, 1));
+        cache.find(key(0, 0, 0));
+        cache.insert(key(0, 0, 3), makeSlice(4, 4, 4)); // evicts slice 2
+
+        SliceCache::Stats st = cache.stats();
+        bool ok = cache.find(key(0, 0, 0)) && cache.find(key(0, 0, 1)) &&
+                  !cache.find(key(0, 0, 2)) && cache.find(key(0, 0, 3)) &&
+                  st.bytes <= cache.budgetBytes() && st.evictions == 1;
+        if (ok)
+            PASS();
+        else
+            FAIL("wrong eviction victim or budget exceeded");
+
+        TEST("evicted slice stays valid for holders");
+        cache.insert(key(0, 0, 4), makeSlice(4, 4, 5));
+        cache.insert(key(0, 0, 5), makeSlice(4, 4, 6));
+        cache.insert(key(0, 0, 6), makeSlice(4, 4, 7));
+        if (!cache.find(key(0, 0, 1)) && held && held->pixels[15] == 2)
+            PASS();
+        else
+            FAIL("held slice was invalidated");
+    }
+
+    // -----------------------------------------------------------------------
+    // 3. Params hash
+    // -----------------------------------------------------------------------
+    {
+        TEST("params hash ignores alpha, tracks colours and version");
+        VolumeRenderParams p;
+        uint64_t h0 = sliceParamsHash(p, 1);
+        VolumeRenderParams q = p;
+        q.overlayAlpha = 0.3f;
+        uint64_t hAlpha = sliceParamsHash(q, 1);
+        q.valueMax = 2.0;
+        uint64_t hRange = sliceParamsHash(q, 1);
+        uint64_t hVersion = sliceParamsHash(p, 2);
+        VolumeRenderParams r = p;
+        r.invertColourMap = true;
+        uint64_t hInvert = sliceParamsHash(r, 1);
+
+        if (h0 == hAlpha && h0 != hRange && h0 != hVersion && h0 != hInvert)
+            PASS();
+        else
+            FAIL("hash does not track the render state");
+    }
+
+    // Volume used by the prefetch tests: 8x6x5 ramp
+    Volume vol;
+    vol.dimensions = glm::ivec3(8, 6, 5);
+    vol.data.resize(8 * 6 * 5);
+    for (size_t i = 0; i < vol.data.size(); ++i)
+        vol.data[i] = static_cast<float>(i);
+    vol.min_value = 0.0f;
+    vol.max_value = static_cast<float>(vol.data.size() - 1);
+
+    VolumeRenderParams params;
+    params.valueMax = vol.max_value;
+    ColourTransfer transfer = buildColourTransfer(params);
+    uint64_t hash = sliceParamsHash(params, vol.contentVersion());
+
+    auto renderJob = [&](int view, int s) {
+        SliceCache::Job job;
+        job.key = SliceKey{0, view, s, hash};
+        job.render = [&vol, &transfer, view, s]() {
+            return renderSlice(vol, transfer, nullptr, view, s);
+        };
+        return job;
+    };
+
+    // -----------------------------------------------------------------------
+    // 4. Background prefetch
+    // -----------------------------------------------------------------------
+    {
+        TEST("prefetched slices match renderSlice");
+        SliceCache cache;
+        std::vector<SliceCache::Job> jobs;
+        for (int s = 0; s < 5; ++s)
+            jobs.push_back(renderJob(0, s));
+        cache.prefetch(0, 0, std::move(jobs));
+        cache.waitIdle();
+
+        bool ok = cache.stats().prefetched == 5;
+        for (int s = 0; ok && s < 5; ++s)
+        {
+            SliceCache::SlicePtr got = cache.find(SliceKey{0, 0, s, hash});
+            RenderedSlice ref = renderSlice(vol, params, 0, s);
+            ok = got && got->width == ref.width && got->height == ref.height &&
+                 got->pixels == ref.pixels;
+        }
+        if (ok)
+            PASS();
+        else
+            FAIL("prefetched slice missing or different");
+    }
+
+    // -----------------------------------------------------------------------
+    // 5. Skipping and per-stream replacement
+    // -----------------------------------------------------------------------
+    {
+        TEST("cached keys are not rendered again");
+        SliceCache cache;
+        cache.insert(SliceKey{0, 1, 2, hash}, makeSlice(1, 1, 7));
+        std::vector<SliceCache::Job> jobs;
+        jobs.push_back(renderJob(1, 2));
+        jobs.push_back(renderJob(1, 3));
+        cache.prefetch(0, 1, std::move(jobs));
+        cache.waitIdle();
+
+        SliceCache::SlicePtr kept = cache.find(SliceKey{0, 1, 2, hash});
+        if (cache.stats().prefetched == 1 && kept && kept->pixels[0] == 7)
+            PASS();
+        else
+            FAIL("cached slice was re-rendered");
+
+        TEST("a new request replaces pending jobs of the same stream");
+        std::atomic<bool> release{false};
+        std::atomic<int> rendered{0};
+        auto gatedJob = [&](int view, int s) {
+            SliceCache::Job job;
+            job.key = SliceKey{0, view, s, hash + 1};
+            job.render = [&release, &rendered]() {
+                while (!release)
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                ++rendered;
+                return makeSlice(2, 2, 9);
+            };
+            return job;
+        };
+        std::vector<SliceCache::Job> first;
+        for (int s = 0; s < 4; ++s)
+            first.push_back(gatedJob(2, s));
+        std::vector<SliceCache::Job> otherView;
+        otherView.push_back(gatedJob(0, 0));
+        cache.prefetch(0, 2, std::move(first));
+        cache.prefetch(0, 0, std::move(otherView));
+        std::vector<SliceCache::Job> second;
+        second.push_back(gatedJob(2, 10));
+        cache.prefetch(0, 2, std::move(second));
+        release = true;
+        cache.waitIdle();
+
+        // At most the job already running from the first request survives
+        bool ok = rendered <= 3 &&
+                  cache.find(SliceKey{0, 2, 10, hash + 1}) &&
+                  cache.find(SliceKey{0, 0, 0, hash + 1}) &&
+                  !cache.find(SliceKey{0, 2, 3, hash + 1});
+        if (ok)
+            PASS();
+        else
+            FAIL("stale jobs of the stream still ran");
+    }
+
+    // -----------------------------------------------------------------------
+    // 6. clear()
+    // -----------------------------------------------------------------------
+    {
+        TEST("clear waits for the running job and drops its result");
+        SliceCache cache;
+        std::atomic<bool> started{false};
+        std::atomic<bool> finished{false};
+        SliceCache::Job job;
+        job.key = key(3, 0, 0);
+        job.render = [&]() {
+            started = true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            finished = true;
+            return makeSlice(2, 2, 1);
+        };
+        std::vector<SliceCache::Job> jobs;
+        jobs.push_back(std::move(job));
+        for (int s = 1; s < 8; ++s)
+            jobs.push_back(SliceCache::Job{key(3, 0, s), [] { return makeSlice(2, 2, 1); }});
+        cache.insert(key(9, 0, 0), makeSlice(2, 2, 1));
+        cache.prefetch(3, 0, std::move(jobs));
+        while (!started)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        cache.clear();
+
+        bool finishedAtClear = finished;
+        cache.waitIdle();
+        SliceCache::Stats st = cache.stats();
+        if (finishedAtClear && st.entries == 0 && st.bytes == 0 && st.prefetched == 0)
+            PASS();
+        else
+            FAIL("clear returned early or kept stale slices");
+    }
+
+    // -----------------------------------------------------------------------
+    // 7. Failing jobs
+    // -----------------------------------------------------------------------
+    {
+        TEST("a throwing job is dropped and the worker continues");
+        SliceCache cache;
+        std::vector<SliceCache::Job> jobs;
+        jobs.push_back(SliceCache::Job{key(4, 0, 0), []() -> RenderedSlice {
+            throw std::bad_alloc();
+        }});
+        jobs.push_back(SliceCache::Job{key(4, 0, 1), [] { return makeSlice(2, 2, 5); }});
+        cache.prefetch(4, 0, std::move(jobs));
+        cache.waitIdle();
+        if (!cache.find(key(4, 0, 0)) && cache.find(key(4, 0, 1)) &&
+            cache.stats().prefetched == 1)
+            PASS();
+        else
+            FAIL("failed job cached or later job lost");
+    }
+
+    std::cerr << "\n" << testsPassed << " passed, " << testsFailed << " failed\n";
+    return testsFailed > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
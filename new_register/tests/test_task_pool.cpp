@@ -0,0 +1,127 @@
+/// test_task_pool.cpp — the worker pool that renders slices and overlay
+/// bands in parallel (ViewManager::initializeAllTextures()).
+///
+/// Tests:
+///   1. Every task of a batch runs exactly once, on more than one thread
+///   2. Consecutive batches reuse the pool; empty and single-task batches
+///   3. A throwing task does not stop the others; run() rethrows
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "TaskPool.h"
+
+static int testsPassed = 0;
+static int testsFailed = 0;
+
+#define TEST(name) \
+    std::cerr << "  TEST: " << name << " ... ";
+
+#define PASS() \
+    do { std::cerr << "PASS\n"; ++testsPassed; } while (0)
+
+#define FAIL(msg) \
+    do { std::cerr << "FAIL: " << msg << "\n"; ++testsFailed; } while (0)
+
+int main()
+{
+    std::cerr << "=== TaskPoolTest ===\n\n";
+
+    // -----------------------------------------------------------------------
+    // 1. One batch
+    // -----------------------------------------------------------------------
+    {
+        TEST("every task runs once, spread over the threads");
+        TaskPool pool(3);
+        std::vector<std::atomic<int>> runs(200);
+        std::mutex mutex;
+        std::set<std::thread::id> threads;
+        std::vector<TaskPool::Task> tasks;
+        for (size_t i = 0; i < runs.size(); ++i)
+        {
+            tasks.push_back([&, i] {
+                ++runs[i];
+                // Long enough that the workers pick up tasks too
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+                std::lock_guard<std::mutex> lock(mutex);
+                threads.insert(std::this_thread::get_id());
+            });
+        }
+        pool.run(tasks);
+        bool ok = pool.threadCount() == 3 && threads.size() > 1;
+        for (const auto& r : runs)
+            ok = ok && r == 1;
+        if (ok)
+            PASS();
+        else
+            FAIL("threads used " << threads.size());
+    }
+
+    // -----------------------------------------------------------------------
+    // 2. Several batches
+    // -----------------------------------------------------------------------
+    {
+        TEST("batches reuse the pool; empty and single-task batches");
+        TaskPool pool(2);
+        std::atomic<int> total{0};
+        for (int batch = 0; batch < 50; ++batch)
+        {
+            std::vector<TaskPool::Task> tasks(batch % 5, [&] { ++total; });
+            pool.run(tasks);
+        }
+        // A single task runs on the calling thread
+        std::thread::id ranOn;
+        std::vector<TaskPool::Task> one{[&] { ranOn = std::this_thread::get_id(); }};
+        pool.run(one);
+        bool ok = total == 10 * (0 + 1 + 2 + 3 + 4) && ranOn == std::this_thread::get_id();
+        if (ok)
+            PASS();
+        else
+            FAIL("total " << total.load());
+    }
+
+    // -----------------------------------------------------------------------
+    // 3. Exceptions
+    // -----------------------------------------------------------------------
+    {
+        TEST("a throwing task is rethrown after the batch finishes");
+        TaskPool pool(2);
+        std::atomic<int> runs{0};
+        std::vector<TaskPool::Task> tasks;
+        for (int i = 0; i < 20; ++i)
+        {
+            tasks.push_back([&, i] {
+                ++runs;
+                if (i == 3)
+                    throw std::runtime_error("task 3");
+            });
+        }
+        bool threw = false;
+        try
+        {
+            pool.run(tasks);
+        }
+        catch (const std::runtime_error&)
+        {
+            threw = true;
+        }
+        // The pool stays usable
+        std::vector<TaskPool::Task> more(4, [&] { ++runs; });
+        pool.run(more);
+        bool ok = threw && runs == 24;
+        if (ok)
+            PASS();
+        else
+            FAIL("threw " << threw << ", runs " << runs.load());
+    }
+
+    std::cerr << "\n" << testsPassed << " passed, " << testsFailed << " failed\n";
+    return testsFailed > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,185 @@
+/// test_texture_atlas.cpp — shelf allocator behind the Vulkan texture atlas.
+///
+/// No external files or GPU needed.
+///
+/// Tests:
+///   1. Allocations stay inside the page and never overlap (gutters included)
+///   2. Oversized textures are refused; full pages refuse until a page is added
+///   3. Freed spans are merged and reused; empty pages return all their rows
+///   4. compact() repacks a fragmented page, keeping handles and sizes
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "TextureAtlas.h"
+
+static int testsPassed = 0;
+static int testsFailed = 0;
+
+#define TEST(name) \
+    std::cerr << "  TEST: " << name << " ... ";
+
+#define PASS() \
+    do { std::cerr << "PASS\n"; ++testsPassed; } while (0)
+
+#define FAIL(msg) \
+    do { std::cerr << "FAIL: " << msg << "\n"; ++testsFailed; } while (0)
+
+/// True if the padded regions of all live @p handles are disjoint and
+/// inside their page.
+static bool disjoint(const TextureAtlas& atlas, const std::vector<TextureAtlas::Handle>& handles)
+{
+    for (size_t i = 0; i < handles.size(); ++i)
+    {
+        AtlasRegion a = atlas.paddedRegion(handles[i]);
+        if (a.x < 0 || a.y < 0 || a.x + a.width > atlas.pageSize() ||
+            a.y + a.height > atlas.pageSize())
+            return false;
+        for (size_t j = i + 1; j < handles.size(); ++j)
+        {
+            AtlasRegion b = atlas.paddedRegion(handles[j]);
+            if (a.page == b.page && a.x < b.x + b.width && b.x < a.x + a.width &&
+                a.y < b.y + b.height && b.y < a.y + a.height)
+                return false;
+        }
+    }
+    return true;
+}
+
+int main()
+{
+    std::cerr << "=== TextureAtlasTest ===\n\n";
+
+    // -----------------------------------------------------------------------
+    // 1. Placement
+    // -----------------------------------------------------------------------
+    {
+        TEST("mixed slice sizes pack without overlap");
+        TextureAtlas atlas(1024, 4);
+        atlas.addPage();
+        // Three views each of a few volumes with differing dimensions
+        const int dims[][2] = {{193, 229}, {229, 193}, {193, 193},
+                               {181, 217}, {217, 181}, {181, 181},
+                               {96, 128}, {128, 96}, {96, 96}};
+        std::vector<TextureAtlas::Handle> handles;
+        bool ok = true;
+        for (const auto& d : dims)
+        {
+            TextureAtlas::Handle h = atlas.allocate(d[0], d[1]);
+            if (!h)
+            {
+                ok = false;
+                break;
+            }
+            const AtlasRegion& r = atlas.region(h);
+            if (r.width != d[0] || r.height != d[1] || r.page != 0)
+                ok = false;
+            handles.push_back(h);
+        }
+        if (!ok)
+            FAIL("allocation failed or has the wrong size");
+        else if (!disjoint(atlas, handles))
+            FAIL("regions overlap or leave the page");
+        else
+            PASS();
+    }
+
+    // -----------------------------------------------------------------------
+    // 2. Refusals
+    // -----------------------------------------------------------------------
+    {
+        TEST("oversized textures and full pages are refused");
+        TextureAtlas atlas(256, 2);
+        bool ok = !atlas.allocate(16, 16);          // no page open yet
+        atlas.addPage();
+        ok = ok && !atlas.accepts(200, 10) && !atlas.allocate(200, 10);
+        int count = 0;
+        while (atlas.allocate(60, 60))
+            ++count;
+        ok = ok && count == 16;                      // 4 x 4 of 62 x 62 padded
+        ok = ok && atlas.addPage() == 1 && atlas.allocate(60, 60) != 0;
+        ok = ok && atlas.addPage() == -1;            // maxPages reached
+        if (ok)
+            PASS();
+        else
+            FAIL("unexpected accept/refuse (" << count << " allocations)");
+    }
+
+    // -----------------------------------------------------------------------
+    // 3. Reuse
+    // -----------------------------------------------------------------------
+    {
+        TEST("freed spans merge and empty shelves return to the page");
+        TextureAtlas atlas(256, 1);
+        atlas.addPage();
+        TextureAtlas::Handle a = atlas.allocate(40, 40);
+        TextureAtlas::Handle b = atlas.allocate(40, 40);
+        TextureAtlas::Handle c = atlas.allocate(40, 40);
+        AtlasRegion ra = atlas.region(a);
+        atlas.release(a);
+        atlas.release(b);
+        // The merged hole takes a texture wider than either freed one
+        TextureAtlas::Handle d = atlas.allocate(80, 40);
+        bool ok = d && atlas.region(d).x == ra.x && atlas.region(d).y == ra.y;
+        atlas.release(c);
+        atlas.release(d);
+        atlas.release(d);                            // double release is a no-op
+        ok = ok && atlas.pageAllocations(0) == 0 && atlas.pageOccupancy(0) == 0.0;
+        // All rows are free again: one tall texture fits at the top
+        TextureAtlas::Handle e = atlas.allocate(120, 120);
+        ok = ok && e && atlas.region(e).y == 1;
+        if (ok)
+            PASS();
+        else
+            FAIL("freed space not reused");
+    }
+
+    // -----------------------------------------------------------------------
+    // 4. Compaction
+    // -----------------------------------------------------------------------
+    {
+        TEST("compact() repacks a fragmented page");
+        TextureAtlas atlas(256, 2);
+        atlas.addPage();
+        // Fill with small textures, then free every other one: plenty of
+        // area is free but no hole fits a larger texture.
+        std::vector<TextureAtlas::Handle> small;
+        while (TextureAtlas::Handle h = atlas.allocate(30, 30))
+            small.push_back(h);
+        std::vector<TextureAtlas::Handle> kept;
+        for (size_t i = 0; i < small.size(); ++i)
+        {
+            if (i % 2)
+                atlas.release(small[i]);
+            else
+                kept.push_back(small[i]);
+        }
+
+        bool ok = atlas.allocate(100, 60) == 0;
+        int candidate = atlas.compactionCandidate(100, 60);
+        ok = ok && candidate == 0;
+        std::vector<TextureAtlas::Move> moves = atlas.compact(candidate);
+        ok = ok && moves.size() == kept.size() && !atlas.pageOpen(0) &&
+             atlas.pageOpen(1);
+        for (const TextureAtlas::Move& m : moves)
+        {
+            const AtlasRegion& r = atlas.region(m.handle);
+            ok = ok && m.from.page == 0 && m.to.page == 1 &&
+                 r.page == 1 && r.x == m.to.x && r.y == m.to.y &&
+                 r.width == 30 && r.height == 30;
+        }
+        TextureAtlas::Handle big = atlas.allocate(100, 60);
+        ok = ok && big != 0;
+        if (big)
+            kept.push_back(big);
+        ok = ok && disjoint(atlas, kept);
+        if (ok)
+            PASS();
+        else
+            FAIL("compaction did not make room (" << moves.size() << " moves)");
+    }
+
+    std::cerr << "\n" << testsPassed << " passed, " << testsFailed << " failed\n";
+    return testsFailed > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
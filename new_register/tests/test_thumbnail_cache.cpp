@@ -0,0 +1,255 @@
+/// test_thumbnail_cache.cpp — QC thumbnails: box-filter reduction,
+/// background rendering and the persistent cache file.
+///
+/// No volume files needed: the cache's load function synthesises volumes
+/// in memory.  The paths are small temporary files, only for their size
+/// and modification time.
+///
+/// Tests:
+///   1. downsample() box-filters to the thumbnail size and keeps the aspect
+///   2. Requests render once in the background; params changes re-render
+///   3. A failed load gives an empty thumbnail and is not retried
+///   4. save()/open() round trip; changed volume files are re-rendered
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "ThumbnailCache.h"
+#include "Volume.h"
+
+namespace fs = std::filesystem;
+
+static int testsPassed = 0;
+static int testsFailed = 0;
+
+#define TEST(name) \
+    std::cerr << "  TEST: " << name << " ... ";
+
+#define PASS() \
+    do { std::cerr << "PASS\n"; ++testsPassed; } while (0)
+
+#define FAIL(msg) \
+    do { std::cerr << "FAIL: " << msg << "\n"; ++testsFailed; } while (0)
+
+/// Counts loads; "missing" paths throw, others give a 32x16x8 ramp.
+struct FakeLoader
+{
+    std::atomic<int> loads{0};
+
+    ThumbnailCache::LoadFn fn()
+    {
+        return [this](const std::string& path) {
+            ++loads;
+            if (path.find("missing") != std::string::npos)
+                throw std::runtime_error("cannot open " + path);
+            Volume vol;
+            vol.dimensions = glm::ivec3(32, 16, 8);
+            vol.data.resize(32 * 16 * 8);
+            for (size_t i = 0; i < vol.data.size(); ++i)
+                vol.data[i] = static_cast<float>(i % 32);
+            vol.min_value = 0.0f;
+            vol.max_value = 31.0f;
+            return vol;
+        };
+    }
+};
+
+static void writeFile(const fs::path& path, const std::string& content)
+{
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << content;
+}
+
+/// Wait until @p cache has an up-to-date thumbnail for @p r.
+static ThumbnailCache::ThumbnailPtr waitFor(const ThumbnailCache& cache,
+                                            const ThumbnailCache::Request& r)
+{
+    for (int i = 0; i < 2000; ++i)
+    {
+        if (ThumbnailCache::ThumbnailPtr t = cache.find(r))
+            return t;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return nullptr;
+}
+
+int main()
+{
+    std::cerr << "=== ThumbnailCacheTest ===\n\n";
+
+    fs::path dir = fs::temp_directory_path() / ("nr_thumbs_" + std::to_string(::getpid()));
+    fs::create_directories(dir);
+    const std::string volA = (dir / "a.mnc").string();
+    const std::string volB = (dir / "b.mnc").string();
+    writeFile(volA, "a");
+    writeFile(volB, "b");
+
+    // -----------------------------------------------------------------------
+    // 1. Reduction
+    // -----------------------------------------------------------------------
+    {
+        TEST("downsample box-filters and keeps the aspect");
+        // 8x4 of 2x2 blocks with grey levels 0, 40, 80, ... -> 4x2
+        RenderedSlice s;
+        s.width = 8;
+        s.height = 4;
+        s.pixels.resize(32);
+        for (int y = 0; y < 4; ++y)
+            for (int x = 0; x < 8; ++x)
+            {
+                uint32_t g = static_cast<uint32_t>(((y / 2) * 4 + x / 2) * 20);
+                s.pixels[y * 8 + x] = g | (g << 8) | (g << 16) | 0xFF000000u;
+            }
+        ThumbnailCache::Thumbnail t = ThumbnailCache::downsample(s, 1.0, 4);
+        bool ok = t.width == 4 && t.height == 2 &&
+                  t.pixels[0] == 0xFF000000u &&
+                  (t.pixels[5] & 0xFF) == 100 && (t.pixels[5] >> 24) == 0xFF;
+        // Odd spans average unequal boxes: 3 source columns into 2
+        RenderedSlice odd;
+        odd.width = 3;
+        odd.height = 1;
+        odd.pixels = {0xFF000000u, 0xFF000000u | 90u, 0xFF000000u | 200u};
+        ThumbnailCache::Thumbnail to = ThumbnailCache::downsample(odd, 1.0, 2);
+        ok = ok && to.width == 2 && to.height == 1 &&
+             (to.pixels[0] & 0xFF) == 0 && (to.pixels[1] & 0xFF) == 145;
+        // Pixels twice as wide as high: 8x4 shows as 16x4
+        ThumbnailCache::Thumbnail ta = ThumbnailCache::downsample(s, 2.0, 96);
+        ok = ok && ta.width == 16 && ta.height == 4;
+        // 400x100 at aspect 1 fits 96 wide
+        RenderedSlice wide;
+        wide.width = 400;
+        wide.height = 100;
+        wide.pixels.assign(400 * 100, 0xFF102030u);
+        ThumbnailCache::Thumbnail tw = ThumbnailCache::downsample(wide, 1.0, 96);
+        ok = ok && tw.width == 96 && tw.height == 24 && tw.pixels[100] == 0xFF102030u;
+        if (ok)
+            PASS();
+        else
+            FAIL(t.width << "x" << t.height << ", odd " << (to.pixels[1] & 0xFF)
+                 << ", aspect " << ta.width << "x" << ta.height
+                 << ", wide " << tw.width << "x" << tw.height);
+    }
+
+    // -----------------------------------------------------------------------
+    // 2. Background rendering
+    // -----------------------------------------------------------------------
+    {
+        TEST("requests render once; colour changes re-render");
+        FakeLoader loader;
+        std::atomic<int> notified{0};
+        ThumbnailCache cache(loader.fn(), 16);
+        cache.setNotify([&] { ++notified; });
+        ThumbnailCache::Request a{volA, VolumeRenderParams{}, true};
+        ThumbnailCache::Request b{volB, VolumeRenderParams{}, true};
+        bool ok = !cache.find(a);
+        cache.request({a, b});
+        ThumbnailCache::ThumbnailPtr ta = waitFor(cache, a);
+        ThumbnailCache::ThumbnailPtr tb = waitFor(cache, b);
+        // 32x16 mid-slice into 16x16: 16x8
+        ok = ok && ta && tb && ta->width == 16 && ta->height == 8 && loader.loads == 2;
+
+        // Up-to-date thumbnails are not queued again
+        cache.request({a, b});
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        ok = ok && loader.loads == 2;
+
+        // A different colour map is a different thumbnail
+        ThumbnailCache::Request hot = a;
+        hot.params.colourMap = ColourMapType::HotMetal;
+        ok = ok && !cache.find(hot);
+        cache.request({hot});
+        ThumbnailCache::ThumbnailPtr th = waitFor(cache, hot);
+        ok = ok && th && loader.loads == 3 && th->pixels != ta->pixels &&
+             !cache.find(a) && cache.stats().rendered == 3 && notified >= 3;
+        if (ok)
+            PASS();
+        else
+            FAIL("loads " << loader.loads.load() << ", rendered " << cache.stats().rendered);
+    }
+
+    // -----------------------------------------------------------------------
+    // 3. Failures
+    // -----------------------------------------------------------------------
+    {
+        TEST("failed loads give an empty thumbnail, once");
+        FakeLoader loader;
+        ThumbnailCache cache(loader.fn(), 16);
+        const std::string missing = (dir / "missing.mnc").string();
+        writeFile(missing, "x");
+        ThumbnailCache::Request m{missing, VolumeRenderParams{}, true};
+        cache.request({m});
+        ThumbnailCache::ThumbnailPtr t = waitFor(cache, m);
+        cache.request({m});
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        bool ok = t && t->width == 0 && t->pixels.empty() && loader.loads == 1 &&
+                  cache.stats().failed == 1;
+        // A path that does not exist is not even loaded
+        ThumbnailCache::Request gone{(dir / "gone.mnc").string(), VolumeRenderParams{}, true};
+        cache.request({gone});
+        ok = ok && waitFor(cache, gone) && loader.loads == 1;
+        if (ok)
+            PASS();
+        else
+            FAIL("loads " << loader.loads.load() << ", failed " << cache.stats().failed);
+    }
+
+    // -----------------------------------------------------------------------
+    // 4. Cache file
+    // -----------------------------------------------------------------------
+    {
+        TEST("the cache file restores thumbnails of unchanged volumes");
+        const std::string file = (dir / "qc.csv.thumbs").string();
+        ThumbnailCache::Request a{volA, VolumeRenderParams{}, true};
+        ThumbnailCache::Request b{volB, VolumeRenderParams{}, true};
+        ThumbnailCache::ThumbnailPtr original;
+        bool ok = false;
+        {
+            FakeLoader loader;
+            ThumbnailCache cache(loader.fn(), 16);
+            bool opened = cache.open(file);   // not there yet
+            cache.request({a, b});
+            original = waitFor(cache, a);
+            waitFor(cache, b);
+            ok = !opened && original && cache.save() && fs::exists(file);
+        }
+
+        FakeLoader loader;
+        ThumbnailCache cache(loader.fn(), 16);
+        ok = ok && cache.open(file) && cache.stats().fromFile == 2;
+        // Entries are verified against the volume file before use
+        ok = ok && !cache.find(a);
+        writeFile(volB, "changed");
+        cache.request({a, b});
+        ThumbnailCache::ThumbnailPtr ta = waitFor(cache, a);
+        ok = ok && ta && ta->pixels == original->pixels && waitFor(cache, b) &&
+             loader.loads == 1 && cache.stats().rendered == 1;
+
+        // Another thumbnail size cannot use the file
+        ThumbnailCache other(loader.fn(), 32);
+        ok = ok && !other.open(file);
+        // Neither can a damaged one
+        std::vector<char> bytes(64, 'x');
+        writeFile(file, std::string(bytes.begin(), bytes.end()));
+        ThumbnailCache damaged(loader.fn(), 16);
+        ok = ok && !damaged.open(file) && damaged.stats().fromFile == 0;
+        if (ok)
+            PASS();
+        else
+            FAIL("loads " << loader.loads.load() << ", from file " << cache.stats().fromFile);
+    }
+
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+
+    std::cerr << "\n" << testsPassed << " passed, " << testsFailed << " failed\n";
+    return testsFailed > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,131 @@
+/// test_volume_loader.cpp — background volume loading used at startup.
+///
+/// Usage: test_volume_loader <a.mnc> <b.mnc> <c.nii.gz>
+///
+/// Tests:
+///   1. Every volume arrives once, at its index, equal to a synchronous load
+///   2. A missing file arrives as an error with an empty volume
+///   3. setNotify() fires for results already waiting and for later ones
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Volume.h"
+#include "VolumeLoader.h"
+
+static int testsPassed = 0;
+static int testsFailed = 0;
+
+#define TEST(name) \
+    std::cerr << "  TEST: " << name << " ... ";
+
+#define PASS() \
+    do { std::cerr << "PASS\n"; ++testsPassed; } while (0)
+
+#define FAIL(msg) \
+    do { std::cerr << "FAIL: " << msg << "\n"; ++testsFailed; } while (0)
+
+/// Take results until the loader is done (bounded wait).
+static std::vector<VolumeLoader::Result> takeAll(VolumeLoader& loader)
+{
+    std::vector<VolumeLoader::Result> all;
+    for (int i = 0; i < 6000 && !loader.done(); ++i)
+    {
+        for (VolumeLoader::Result& r : loader.takeLoaded())
+            all.push_back(std::move(r));
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return all;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 4)
+    {
+        std::cerr << "Usage: " << argv[0] << " <a.mnc> <b.mnc> <c.nii.gz>\n";
+        return 1;
+    }
+    std::cerr << "=== VolumeLoaderTest ===\n\n";
+
+    // The NIfTI file twice, so two NIfTI loads can overlap
+    std::vector<std::string> paths = {argv[1], argv[3], argv[2], argv[3]};
+
+    // -----------------------------------------------------------------------
+    // 1. Results match synchronous loads
+    // -----------------------------------------------------------------------
+    {
+        TEST("each volume arrives once and matches a synchronous load");
+        VolumeLoader loader(paths);
+        std::vector<VolumeLoader::Result> results = takeAll(loader);
+        bool ok = loader.done() && results.size() == paths.size();
+        std::vector<int> seen(paths.size(), 0);
+        for (const VolumeLoader::Result& r : results)
+        {
+            if (r.index >= paths.size() || r.path != paths[r.index] || !r.error.empty())
+            {
+                ok = false;
+                continue;
+            }
+            ++seen[r.index];
+            Volume expected;
+            expected.load(r.path);
+            ok = ok && r.volume.dimensions == expected.dimensions &&
+                 r.volume.data == expected.data;
+        }
+        for (int n : seen)
+            ok = ok && n == 1;
+        if (ok)
+            PASS();
+        else
+            FAIL(results.size() << " results, done " << loader.done());
+    }
+
+    // -----------------------------------------------------------------------
+    // 2. Failures
+    // -----------------------------------------------------------------------
+    {
+        TEST("missing files arrive as errors");
+        VolumeLoader loader({"/nonexistent/missing.mnc", "", "/nonexistent/missing.nii"});
+        loader.waitAll();
+        std::vector<VolumeLoader::Result> results = loader.takeLoaded();
+        bool ok = results.size() == 3 && loader.done();
+        for (const VolumeLoader::Result& r : results)
+            ok = ok && !r.error.empty() && r.volume.data.empty();
+        if (ok)
+            PASS();
+        else
+            FAIL(results.size() << " results");
+    }
+
+    // -----------------------------------------------------------------------
+    // 3. Notification
+    // -----------------------------------------------------------------------
+    {
+        TEST("notify fires for waiting and later results");
+        std::atomic<int> notified{0};
+        VolumeLoader loader({argv[2], argv[1]});
+        loader.waitAll();
+        // Both finished before the callback existed: one catch-up call
+        loader.setNotify([&notified] { ++notified; });
+        bool ok = notified == 1 && loader.takeLoaded().size() == 2 && loader.done();
+
+        std::atomic<int> later{0};
+        VolumeLoader second({argv[3], argv[1]});
+        second.setNotify([&later] { ++later; });
+        second.waitAll();
+        second.takeLoaded();
+        ok = ok && later >= 1 && later <= 2 && second.done();
+        if (ok)
+            PASS();
+        else
+            FAIL("notified " << notified.load() << ", later " << later.load());
+    }
+
+    std::cerr << "\n" << testsPassed << " passed, " << testsFailed << " failed\n";
+    return testsFailed > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}